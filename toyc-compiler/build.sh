@@ -54,11 +54,13 @@ cmake .. -DCMAKE_BUILD_TYPE=Debug
 
 # 构建
 echo "Building..."
-make -j$(nproc) toyc
+make -j$(nproc) toyc toyc-sim toyc-bench
 
 echo -e "${GREEN}Build completed successfully!${NC}"
 echo ""
 echo "Executable: build/toyc"
+echo "Simulator:  build/toyc-sim"
+echo "Benchmark:  build/toyc-bench"
 echo ""
 
 # 运行测试
@@ -77,4 +79,6 @@ echo ""
 echo "Usage examples:"
 echo "  ./build/toyc test_samples/hello.tc"
 echo "  ./build/toyc --ast test_samples/factorial.tc"
-echo "  ./build/toyc -v test_samples/fibonacci.tc -o fib.s"
\ No newline at end of file
+echo "  ./run_workloads.sh build/toyc"
+echo "  ./build/toyc -v test_samples/fibonacci.tc -o fib.s"
+echo "  ./build/toyc-sim fib.s"
\ No newline at end of file
@@ -1,148 +1,645 @@
-#!/bin/bash
-
-COMPILER=$1
-TEST_DIR="test_samples"
-TEMP_DIR="/tmp/toyc_test_$$"
-
-# 颜色输出
-RED='\033[0;31m'
-GREEN='\033[0;32m'
-YELLOW='\033[1;33m'
-BLUE='\033[0;34m'
-NC='\033[0m'
-
-if [ -z "$COMPILER" ]; then
-    echo "Usage: $0 <compiler_path>"
-    exit 1
-fi
-
-if [ ! -x "$COMPILER" ]; then
-    echo -e "${RED}Error: Compiler not found or not executable: $COMPILER${NC}"
-    exit 1
-fi
-
-mkdir -p "$TEMP_DIR"
-
-echo -e "${BLUE}ToyC Compiler Test Suite${NC}"
-echo "=========================="
-echo "Compiler: $COMPILER"
-echo "Test directory: $TEST_DIR"
-echo "Temp directory: $TEMP_DIR"
-echo ""
-
-# 测试计数器
-total_tests=0
-passed_tests=0
-
-# 运行单个测试
-run_test() {
-    local test_file=$1
-    local test_name=$(basename "$test_file" .tc)
-    
-    echo -n "Testing $test_name... "
-    total_tests=$((total_tests + 1))
-    
-    # 编译测试
-    local output_file="$TEMP_DIR/$test_name.s"
-    if "$COMPILER" "$test_file" -o "$output_file" 2>"$TEMP_DIR/$test_name.err"; then
-        if [ -f "$output_file" ] && [ -s "$output_file" ]; then
-            echo -e "${GREEN}PASS${NC}"
-            passed_tests=$((passed_tests + 1))
-            
-            # 显示生成的汇编代码行数
-            local line_count=$(wc -l < "$output_file")
-            echo "  Generated $line_count lines of assembly"
-        else
-            echo -e "${RED}FAIL${NC} (empty output)"
-            echo "  Error: Output file is empty or not created"
-        fi
-    else
-        echo -e "${RED}FAIL${NC}"
-        echo "  Compilation failed for $test_file"
-        if [ -f "$TEMP_DIR/$test_name.err" ]; then
-            echo "  Error output:"
-            sed 's/^/    /' "$TEMP_DIR/$test_name.err"
-        fi
-    fi
-}
-
-# 运行特殊测试（AST打印）
-run_ast_test() {
-    local test_file=$1
-    local test_name=$(basename "$test_file" .tc)
-    
-    echo -n "Testing $test_name (AST)... "
-    
-    if "$COMPILER" "$test_file" --ast >/dev/null 2>&1; then
-        echo -e "${GREEN}PASS${NC}"
-        echo "  AST generation successful"
-    else
-        echo -e "${RED}FAIL${NC}"
-        echo "  AST generation failed"
-    fi
-}
-
-# 运行语法错误测试
-test_syntax_errors() {
-    echo ""
-    echo "Testing syntax error handling..."
-    
-    # 创建一个语法错误的测试文件
-    cat > "$TEMP_DIR/syntax_error.tc" << 'EOF'
-int main() {
-    int x = ;  // 语法错误
-    return x;
-}
-EOF
-    
-    echo -n "Testing syntax error detection... "
-    if "$COMPILER" "$TEMP_DIR/syntax_error.tc" -o "$TEMP_DIR/syntax_error.s" 2>/dev/null; then
-        echo -e "${RED}FAIL${NC} (should have failed)"
-    else
-        echo -e "${GREEN}PASS${NC}"
-    fi
-}
-
-# 主测试循环
-echo "Running compilation tests:"
-for test_file in "$TEST_DIR"/*.tc; do
-    if [ -f "$test_file" ]; then
-        run_test "$test_file"
-    fi
-done
-
-# AST测试
-echo ""
-echo "Running AST tests:"
-for test_file in "$TEST_DIR"/*.tc; do
-    if [ -f "$test_file" ]; then
-        run_ast_test "$test_file"
-    fi
-done
-
-# 语法错误测试
-test_syntax_errors
-
-echo ""
-echo "=========================="
-echo -e "Tests completed: ${GREEN}$passed_tests${NC}/${total_tests} passed"
-
-# 显示失败的测试
-failed_tests=$((total_tests - passed_tests))
-if [ $failed_tests -gt 0 ]; then
-    echo -e "${RED}$failed_tests tests failed${NC}"
-    echo ""
-    echo "Generated files are in: $TEMP_DIR"
-    echo "To clean up: rm -rf $TEMP_DIR"
-else
-    echo -e "${GREEN}All tests passed!${NC}"
-    # 清理临时文件
-    rm -rf "$TEMP_DIR"
-fi
-
-# 返回适当的退出码
-if [ $passed_tests -eq $total_tests ]; then
-    exit 0
-else
-    exit 1
+#!/bin/bash
+
+COMPILER=$1
+TEST_DIR="test_samples"
+TEMP_DIR="/tmp/toyc_test_$$"
+
+# 颜色输出
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+NC='\033[0m'
+
+if [ -z "$COMPILER" ]; then
+    echo "Usage: $0 <compiler_path>"
+    exit 1
+fi
+
+if [ ! -x "$COMPILER" ]; then
+    echo -e "${RED}Error: Compiler not found or not executable: $COMPILER${NC}"
+    exit 1
+fi
+
+mkdir -p "$TEMP_DIR"
+
+echo -e "${BLUE}ToyC Compiler Test Suite${NC}"
+echo "=========================="
+echo "Compiler: $COMPILER"
+echo "Test directory: $TEST_DIR"
+echo "Temp directory: $TEMP_DIR"
+echo ""
+
+# 测试计数器
+total_tests=0
+passed_tests=0
+
+# 运行单个测试
+run_test() {
+    local test_file=$1
+    local test_name=$(basename "$test_file" .tc)
+    
+    echo -n "Testing $test_name... "
+    total_tests=$((total_tests + 1))
+    
+    # 编译测试
+    local output_file="$TEMP_DIR/$test_name.s"
+    if "$COMPILER" "$test_file" -o "$output_file" 2>"$TEMP_DIR/$test_name.err"; then
+        if [ -f "$output_file" ] && [ -s "$output_file" ]; then
+            echo -e "${GREEN}PASS${NC}"
+            passed_tests=$((passed_tests + 1))
+            
+            # 显示生成的汇编代码行数
+            local line_count=$(wc -l < "$output_file")
+            echo "  Generated $line_count lines of assembly"
+        else
+            echo -e "${RED}FAIL${NC} (empty output)"
+            echo "  Error: Output file is empty or not created"
+        fi
+    else
+        echo -e "${RED}FAIL${NC}"
+        echo "  Compilation failed for $test_file"
+        if [ -f "$TEMP_DIR/$test_name.err" ]; then
+            echo "  Error output:"
+            sed 's/^/    /' "$TEMP_DIR/$test_name.err"
+        fi
+    fi
+}
+
+# 运行特殊测试（AST打印）
+run_ast_test() {
+    local test_file=$1
+    local test_name=$(basename "$test_file" .tc)
+    
+    echo -n "Testing $test_name (AST)... "
+    
+    if "$COMPILER" "$test_file" --ast >"$TEMP_DIR/$test_name.ast" 2>&1; then
+        # 手写语法分析器与 Bison 生成的分析器必须得到相同的AST
+        "$COMPILER" "$test_file" --ast --parser=bison >"$TEMP_DIR/$test_name.bison.ast" 2>&1
+        if cmp -s "$TEMP_DIR/$test_name.ast" "$TEMP_DIR/$test_name.bison.ast"; then
+            echo -e "${GREEN}PASS${NC}"
+            echo "  AST generation successful"
+        else
+            echo -e "${RED}FAIL${NC}"
+            echo "  AST differs from the Bison parser"
+            diff "$TEMP_DIR/$test_name.bison.ast" "$TEMP_DIR/$test_name.ast" | head -10 | sed 's/^/    /'
+        fi
+    else
+        echo -e "${RED}FAIL${NC}"
+        echo "  AST generation failed"
+    fi
+}
+
+# 运行语法错误测试
+test_syntax_errors() {
+    echo ""
+    echo "Testing syntax error handling..."
+    
+    # 创建一个语法错误的测试文件
+    cat > "$TEMP_DIR/syntax_error.tc" << 'EOF'
+int main() {
+    int x = ;  // 语法错误
+    return x;
+}
+EOF
+    
+    echo -n "Testing syntax error detection... "
+    if "$COMPILER" "$TEMP_DIR/syntax_error.tc" -o "$TEMP_DIR/syntax_error.s" 2>/dev/null; then
+        echo -e "${RED}FAIL${NC} (should have failed)"
+    else
+        echo -e "${GREEN}PASS${NC}"
+    fi
+}
+
+# 目标文件测试：-c 输出与参考汇编器的结果反汇编后逐条比较
+run_object_tests() {
+    echo ""
+    echo "Running object file tests:"
+    
+    if ! command -v llvm-mc >/dev/null 2>&1 || ! command -v llvm-objdump >/dev/null 2>&1; then
+        echo -e "${YELLOW}SKIP${NC} (llvm-mc / llvm-objdump not found)"
+        return
+    fi
+    
+    # 去掉文件头；参考汇编器可能用旧名 R_RISCV_CALL 表示同一种重定位
+    disassemble() {
+        llvm-objdump -d -r -M no-aliases --no-show-raw-insn "$1" | tail -n +3 | sed 's/R_RISCV_CALL_PLT/R_RISCV_CALL/'
+    }
+    
+    for test_file in "$TEST_DIR"/*.tc; do
+        local test_name=$(basename "$test_file" .tc)
+        local asm_file="$TEMP_DIR/$test_name.obj.s"
+        
+        echo -n "Testing $test_name (-c)... "
+        if ! "$COMPILER" "$test_file" -o "$asm_file" >/dev/null 2>&1 ||
+           ! llvm-mc -triple=riscv32 -mattr=+m,-relax -filetype=obj "$asm_file" -o "$TEMP_DIR/$test_name.ref.o" 2>/dev/null; then
+            echo -e "${YELLOW}SKIP${NC} (reference assembler rejects the output)"
+            continue
+        fi
+        
+        total_tests=$((total_tests + 1))
+        if ! "$COMPILER" -c "$test_file" -o "$TEMP_DIR/$test_name.o" >/dev/null 2>"$TEMP_DIR/$test_name.obj.err"; then
+            echo -e "${RED}FAIL${NC}"
+            sed 's/^/    /' "$TEMP_DIR/$test_name.obj.err"
+        elif diff <(disassemble "$TEMP_DIR/$test_name.ref.o") <(disassemble "$TEMP_DIR/$test_name.o") >"$TEMP_DIR/$test_name.obj.diff"; then
+            echo -e "${GREEN}PASS${NC}"
+            passed_tests=$((passed_tests + 1))
+        else
+            echo -e "${RED}FAIL${NC} (disassembly differs)"
+            head -20 "$TEMP_DIR/$test_name.obj.diff" | sed 's/^/    /'
+        fi
+    done
+}
+
+# 生成代码质量测试：在模拟器上检查返回值和动态指令数（见 run_workloads.sh）
+run_workload_tests() {
+    echo ""
+    echo "Running workload tests:"
+    
+    local simulator="$(dirname "$COMPILER")/toyc-sim"
+    if [ ! -x "$simulator" ]; then
+        echo -e "${YELLOW}SKIP${NC} (toyc-sim not found next to the compiler)"
+        return
+    fi
+    
+    total_tests=$((total_tests + 1))
+    if bash ./run_workloads.sh "$COMPILER" "$simulator" >"$TEMP_DIR/workloads.log" 2>&1; then
+        echo -e "Testing workloads... ${GREEN}PASS${NC}"
+        passed_tests=$((passed_tests + 1))
+    else
+        echo -e "Testing workloads... ${RED}FAIL${NC}"
+        grep -E 'FAIL|SLOWER' "$TEMP_DIR/workloads.log" | sed 's/^/    /'
+    fi
+}
+
+# 词法分析器差分测试：手写扫描器与 Flex 扫描器在随机输入和所有样例上的词法单元流必须一致
+run_lexer_tests() {
+    echo ""
+    echo "Running lexer tests:"
+    
+    local bench="$(dirname "$COMPILER")/toyc-bench"
+    if [ ! -x "$bench" ]; then
+        echo -e "${YELLOW}SKIP${NC} (toyc-bench not found next to the compiler)"
+        return
+    fi
+    
+    total_tests=$((total_tests + 1))
+    if "$bench" --lex-diff "$TEST_DIR"/*.tc workloads/*.tc >"$TEMP_DIR/lexers.log" 2>&1; then
+        echo -e "Testing fast lexer against flex... ${GREEN}PASS${NC}"
+        passed_tests=$((passed_tests + 1))
+    else
+        echo -e "Testing fast lexer against flex... ${RED}FAIL${NC}"
+        head -20 "$TEMP_DIR/lexers.log" | sed 's/^/    /'
+    fi
+}
+
+# 语法分析器差分测试：随机程序（含语法错误）上手写分析器与 Bison 的AST和错误信息必须一致
+run_parser_tests() {
+    echo ""
+    echo "Running parser tests:"
+    
+    local bench="$(dirname "$COMPILER")/toyc-bench"
+    if [ ! -x "$bench" ]; then
+        echo -e "${YELLOW}SKIP${NC} (toyc-bench not found next to the compiler)"
+        return
+    fi
+    
+    total_tests=$((total_tests + 1))
+    if "$bench" --parse-diff "$TEST_DIR"/*.tc workloads/*.tc >"$TEMP_DIR/parsers.log" 2>&1; then
+        echo -e "Testing pratt parser against bison... ${GREEN}PASS${NC}"
+        passed_tests=$((passed_tests + 1))
+    else
+        echo -e "Testing pratt parser against bison... ${RED}FAIL${NC}"
+        head -20 "$TEMP_DIR/parsers.log" | sed 's/^/    /'
+    fi
+}
+
+# 内存报告测试：--mem-report 输出的 JSON 必须包含峰值RSS、各阶段计数和数据结构大小
+run_mem_report_test() {
+    echo ""
+    echo "Running memory report test:"
+    
+    local report="$TEMP_DIR/mem_report.json"
+    total_tests=$((total_tests + 1))
+    echo -n "Testing --mem-report... "
+    if "$COMPILER" --mem-report="$report" "$TEST_DIR/factorial.tc" -o "$TEMP_DIR/mem_report.s" >/dev/null 2>&1 &&
+       grep -q '"peak_rss_kb": [1-9]' "$report" &&
+       grep -q '{"name": "codegen", "allocations": [1-9]' "$report" &&
+       grep -q '"ast_bytes": [1-9]' "$report" &&
+       grep -q '"symbol_table_bytes": [1-9]' "$report" &&
+       grep -q '"output_bytes": [1-9]' "$report"; then
+        echo -e "${GREEN}PASS${NC}"
+        passed_tests=$((passed_tests + 1))
+    else
+        echo -e "${RED}FAIL${NC}"
+        [ -f "$report" ] && sed 's/^/    /' "$report"
+    fi
+}
+
+# 并行编译测试：任意 -j 下按函数顺序合并，输出和诊断都与单线程逐字节相同
+run_parallel_tests() {
+    echo ""
+    echo "Running parallel compilation tests:"
+
+    local level test_file
+    for level in -O0 -O1; do
+        total_tests=$((total_tests + 1))
+        echo -n "Testing -j1 vs -j8 ($level)... "
+        local differs=""
+        for test_file in "$TEST_DIR"/*.tc workloads/*.tc; do
+            rm -f "$TEMP_DIR/parallel_j1.s" "$TEMP_DIR/parallel_j8.s"
+            "$COMPILER" $level -j1 "$test_file" -o "$TEMP_DIR/parallel_j1.s" >/dev/null 2>&1
+            "$COMPILER" $level -j8 "$test_file" -o "$TEMP_DIR/parallel_j8.s" >/dev/null 2>&1
+            if [ ! -s "$TEMP_DIR/parallel_j1.s" ] || ! cmp -s "$TEMP_DIR/parallel_j1.s" "$TEMP_DIR/parallel_j8.s"; then
+                differs="$differs $(basename "$test_file")"
+            fi
+        done
+        if [ -z "$differs" ]; then
+            echo -e "${GREEN}PASS${NC}"
+            passed_tests=$((passed_tests + 1))
+        else
+            echo -e "${RED}FAIL${NC} (output differs:$differs)"
+        fi
+    done
+
+    # 多个函数各有语义错误：诊断按源码顺序输出，与线程数无关
+    cat > "$TEMP_DIR/semantic_errors.tc" << 'EOF'
+int a(int x) {
+    return y + x;
+}
+
+int b(int x) {
+    return missing(x);
+}
+
+void c() {
+    return 1;
+}
+
+int d(int x) {
+    while (x > 0) {
+        x = x - z;
+    }
+    return a(x, x);
+}
+
+int main() {
+    int n = 2;
+    int n = 3;
+    return b(n) + q;
+}
+EOF
+    total_tests=$((total_tests + 1))
+    echo -n "Testing -j1 vs -j8 (diagnostics)... "
+    "$COMPILER" -j1 "$TEMP_DIR/semantic_errors.tc" -o "$TEMP_DIR/semantic_errors.s" >"$TEMP_DIR/errors_j1.log" 2>&1
+    "$COMPILER" -j8 "$TEMP_DIR/semantic_errors.tc" -o "$TEMP_DIR/semantic_errors.s" >"$TEMP_DIR/errors_j8.log" 2>&1
+    local errors=$(grep -c '^  Error [0-9]' "$TEMP_DIR/errors_j1.log")
+    if [ "$errors" -eq 7 ] && cmp -s "$TEMP_DIR/errors_j1.log" "$TEMP_DIR/errors_j8.log"; then
+        echo -e "${GREEN}PASS${NC}"
+        passed_tests=$((passed_tests + 1))
+    else
+        echo -e "${RED}FAIL${NC} ($errors errors)"
+        diff "$TEMP_DIR/errors_j1.log" "$TEMP_DIR/errors_j8.log" | head -10 | sed 's/^/    /'
+    fi
+}
+
+# 编译缓存测试：未命中后写入，再次编译命中且输出逐字节相同；-c 与汇编输出的键不同；
+# 超过 --cache-size 时淘汰最久未用的条目
+run_cache_tests() {
+    echo ""
+    echo "Running compilation cache tests:"
+
+    local dir="$TEMP_DIR/cache"
+    local test_file="$TEST_DIR/factorial.tc"
+    "$COMPILER" --no-cache "$test_file" -o "$TEMP_DIR/cache_ref.s" >/dev/null 2>&1
+    "$COMPILER" --no-cache -c "$test_file" -o "$TEMP_DIR/cache_ref.o" >/dev/null 2>&1
+
+    # 描述 额外参数 输出 期望的命中数 期望的未命中数
+    local name flags output hits misses
+    for test in "miss - cache_a.s 0 1" "hit - cache_b.s 1 1" \
+                "-c-miss -c cache_a.o 1 2" "-c-hit -c cache_b.o 2 2"; do
+        read -r name flags output hits misses <<< "$test"
+        [ "$flags" = "-" ] && flags=""
+        local reference="$TEMP_DIR/cache_ref.${output##*.}"
+
+        total_tests=$((total_tests + 1))
+        echo -n "Testing --cache ($name)... "
+        if ! "$COMPILER" --cache-dir="$dir" --stats $flags "$test_file" -o "$TEMP_DIR/$output" >"$TEMP_DIR/cache.log" 2>&1; then
+            echo -e "${RED}FAIL${NC}"
+            head -5 "$TEMP_DIR/cache.log" | sed 's/^/    /'
+        elif ! grep -q "cache-hits: $hits\$" "$TEMP_DIR/cache.log" ||
+             ! grep -q "cache-misses: $misses\$" "$TEMP_DIR/cache.log"; then
+            echo -e "${RED}FAIL${NC} (expected $hits hits, $misses misses)"
+            grep 'cache-' "$TEMP_DIR/cache.log" | sed 's/^/    /'
+        elif ! cmp -s "$TEMP_DIR/$output" "$reference"; then
+            echo -e "${RED}FAIL${NC} (output differs from an uncached build)"
+        else
+            echo -e "${GREEN}PASS${NC}"
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+
+    # 两个各约 0.7 MiB 的输出放不进 1 MiB：写入第二个时淘汰第一个
+    dir="$TEMP_DIR/cache_small"
+    for k in 1 2; do
+        awk -v k=$k 'BEGIN {
+            print "int main() {\n    int x = " k ";";
+            for (i = 0; i < 8000; i++) printf "    x = x * 3 + %d;\n", i;
+            print "    return x;\n}";
+        }' > "$TEMP_DIR/cache_big$k.tc"
+    done
+    for k in 1 2 2 1; do
+        "$COMPILER" --cache-dir="$dir" --cache-size=1 --stats "$TEMP_DIR/cache_big$k.tc" \
+            -o "$TEMP_DIR/cache_big$k.s" >"$TEMP_DIR/cache.log" 2>&1
+    done
+    local bytes=$(find "$dir" -mindepth 2 -type f -printf '%s\n' | awk '{ s += $1 } END { print s + 0 }')
+
+    total_tests=$((total_tests + 1))
+    echo -n "Testing --cache-size eviction... "
+    if grep -q "cache-hits: 1\$" "$TEMP_DIR/cache.log" &&
+       grep -q "cache-misses: 3\$" "$TEMP_DIR/cache.log" &&
+       grep -q "cache-evictions: 2\$" "$TEMP_DIR/cache.log" &&
+       [ "$bytes" -gt 0 ] && [ "$bytes" -le 1048576 ]; then
+        echo -e "${GREEN}PASS${NC}"
+        passed_tests=$((passed_tests + 1))
+    else
+        echo -e "${RED}FAIL${NC} ($bytes bytes cached)"
+        grep 'cache-' "$TEMP_DIR/cache.log" | sed 's/^/    /'
+    fi
+}
+
+# 编译服务测试：经 --connect 按文件路径和从标准输入各编译一次，输出与直接编译相同；
+# 从标准输入编译时汇编写到标准输出，状态信息走标准错误；SIGTERM 后删除套接字文件
+run_server_tests() {
+    echo ""
+    echo "Running compile server tests:"
+
+    local socket="$TEMP_DIR/server.sock"
+    local test_file="$TEST_DIR/factorial.tc"
+    "$COMPILER" "$test_file" -o "$TEMP_DIR/server_ref.s" >/dev/null 2>&1
+
+    "$COMPILER" --server "$socket" --workers=2 >"$TEMP_DIR/server.log" 2>&1 &
+    local server=$!
+    for i in $(seq 50); do
+        [ -S "$socket" ] && break
+        sleep 0.1
+    done
+
+    total_tests=$((total_tests + 1))
+    echo -n "Testing --connect (file)... "
+    if "$COMPILER" --connect "$socket" "$test_file" -o "$TEMP_DIR/server_file.s" >"$TEMP_DIR/server.out" 2>&1 &&
+       cmp -s "$TEMP_DIR/server_file.s" "$TEMP_DIR/server_ref.s" &&
+       grep -q "Compilation successful!" "$TEMP_DIR/server.out"; then
+        echo -e "${GREEN}PASS${NC}"
+        passed_tests=$((passed_tests + 1))
+    else
+        echo -e "${RED}FAIL${NC}"
+        head -5 "$TEMP_DIR/server.out" | sed 's/^/    /'
+    fi
+
+    total_tests=$((total_tests + 1))
+    echo -n "Testing --connect (stdin)... "
+    if "$COMPILER" --connect "$socket" - <"$test_file" >"$TEMP_DIR/server_stdin.s" 2>"$TEMP_DIR/server.err" &&
+       cmp -s "$TEMP_DIR/server_stdin.s" "$TEMP_DIR/server_ref.s" &&
+       grep -q "Compilation successful!" "$TEMP_DIR/server.err"; then
+        echo -e "${GREEN}PASS${NC}"
+        passed_tests=$((passed_tests + 1))
+    else
+        echo -e "${RED}FAIL${NC}"
+        head -5 "$TEMP_DIR/server.err" | sed 's/^/    /'
+    fi
+
+    total_tests=$((total_tests + 1))
+    echo -n "Testing --server shutdown... "
+    kill -TERM $server
+    wait $server 2>/dev/null
+    if [ ! -e "$socket" ]; then
+        echo -e "${GREEN}PASS${NC}"
+        passed_tests=$((passed_tests + 1))
+    else
+        echo -e "${RED}FAIL${NC} (socket file left behind)"
+        rm -f "$socket"
+    fi
+}
+
+# 增量编译测试：改动函数体后 --incremental 的输出必须与全新编译逐字节相同，
+# 只重新编译改动的函数和闭包里含有它的调用者（main 里的 mid(4) 在编译期折叠，依赖 leaf 的函数体）
+run_incremental_tests() {
+    echo ""
+    echo "Running incremental compilation tests:"
+
+    local dir="$TEMP_DIR/incremental"
+    mkdir -p "$dir"
+    cat > "$dir/v1.tc" << 'EOF'
+int leaf(int x) {
+    return x * 3 + 1;
+}
+
+int mid(int x) {
+    return leaf(x) + 2;
+}
+
+int work(int n) {
+    int s = 0;
+    while (n > 0) {
+        s = s + n;
+        n = n - 1;
+    }
+    return s;
+}
+
+int user(int n) {
+    return work(n) + 1;
+}
+
+int spare(int x) {
+    return x - 1;
+}
+
+int main() {
+    int n = 3;
+    return mid(4) + user(n);
+}
+EOF
+    sed 's/x \* 3 + 1/x * 5 + 1/' "$dir/v1.tc" > "$dir/v2.tc"
+    sed 's/s = s + n;/s = s + n * 2;/' "$dir/v2.tc" > "$dir/v3.tc"
+
+    # 版本 复用数 重新编译数：v2 改被折叠的纯函数 leaf（leaf/mid/main），v3 改被调用的 work（work/user/main）
+    local version reused compiled
+    for test in "v1 0 6" "v2 3 3" "v3 3 3"; do
+        read -r version reused compiled <<< "$test"
+        cp "$dir/$version.tc" "$dir/prog.tc"
+
+        total_tests=$((total_tests + 1))
+        echo -n "Testing --incremental ($version)... "
+        if ! "$COMPILER" --incremental --stats "$dir/prog.tc" -o "$dir/inc.s" >"$dir/stats.log" 2>&1 ||
+           ! "$COMPILER" "$dir/prog.tc" -o "$dir/clean.s" >/dev/null 2>&1; then
+            echo -e "${RED}FAIL${NC}"
+            head -5 "$dir/stats.log" | sed 's/^/    /'
+        elif ! cmp -s "$dir/inc.s" "$dir/clean.s"; then
+            echo -e "${RED}FAIL${NC} (output differs from a clean build)"
+            diff "$dir/clean.s" "$dir/inc.s" | head -10 | sed 's/^/    /'
+        elif ! grep -q "incremental-reused: $reused\$" "$dir/stats.log" ||
+             ! grep -q "incremental-compiled: $compiled\$" "$dir/stats.log"; then
+            echo -e "${RED}FAIL${NC} (expected $reused reused, $compiled compiled)"
+            grep 'incremental-' "$dir/stats.log" | sed 's/^/    /'
+        else
+            echo -e "${GREEN}PASS${NC}"
+            passed_tests=$((passed_tests + 1))
+        fi
+    done
+}
+
+# 深度压力测试：百万项的左深表达式和两万层嵌套的语句块，遍历和析构都不能耗尽调用栈，
+# 变量查找也不能随嵌套深度变慢
+run_stress_tests() {
+    echo ""
+    echo "Running stress tests:"
+
+    # a + a - a + ... 共 10^6 项，成对抵消后结果为 2a
+    awk 'BEGIN {
+        printf "int main() {\n    int a = 3;\n    return a";
+        for (i = 1; i < 1000000; i++) printf (i % 2 ? " + a" : " - a");
+        print ";\n}";
+    }' > "$TEMP_DIR/million_terms.tc"
+    # 每层 if 加一，返回 20000 % 256
+    awk 'BEGIN {
+        n = 20000;
+        print "int main() {\n    int x = 0;";
+        for (i = 0; i < n; i++) printf "if (x < %d) { x = x + 1;\n", n;
+        for (i = 0; i < n; i++) printf "}";
+        print "\n    return x % 256;\n}";
+    }' > "$TEMP_DIR/deep_nesting.tc"
+
+    local simulator="$(dirname "$COMPILER")/toyc-sim"
+    local name expected
+    for test in "million_terms 6" "deep_nesting 32"; do
+        read -r name expected <<< "$test"
+        local test_file="$TEMP_DIR/$name.tc"
+
+        total_tests=$((total_tests + 1))
+        echo -n "Testing $name (--run)... "
+        "$COMPILER" "$test_file" --run >/dev/null 2>"$TEMP_DIR/$name.err"
+        local status=$?
+        if [ $status -eq $expected ]; then
+            echo -e "${GREEN}PASS${NC}"
+            passed_tests=$((passed_tests + 1))
+        else
+            echo -e "${RED}FAIL${NC} (exit status $status, expected $expected)"
+            head -5 "$TEMP_DIR/$name.err" | sed 's/^/    /'
+        fi
+
+        echo -n "Testing $name (riscv32)... "
+        if [ ! -x "$simulator" ]; then
+            echo -e "${YELLOW}SKIP${NC} (toyc-sim not found next to the compiler)"
+        else
+            total_tests=$((total_tests + 1))
+            if ! "$COMPILER" "$test_file" -o "$TEMP_DIR/$name.s" >/dev/null 2>"$TEMP_DIR/$name.err"; then
+                echo -e "${RED}FAIL${NC}"
+                head -5 "$TEMP_DIR/$name.err" | sed 's/^/    /'
+            elif "$simulator" "$TEMP_DIR/$name.s" | grep -q "^Return value: *$expected\$"; then
+                echo -e "${GREEN}PASS${NC}"
+                passed_tests=$((passed_tests + 1))
+            else
+                echo -e "${RED}FAIL${NC} (wrong return value)"
+            fi
+        fi
+
+        # x86-64：宿主是 x86-64 且有 cc 时链接运行检查退出码，否则只检查能否编译
+        echo -n "Testing $name (x86_64)... "
+        total_tests=$((total_tests + 1))
+        if ! "$COMPILER" "$test_file" --target=x86_64 -o "$TEMP_DIR/$name.x86.s" >/dev/null 2>"$TEMP_DIR/$name.err"; then
+            echo -e "${RED}FAIL${NC}"
+            head -5 "$TEMP_DIR/$name.err" | sed 's/^/    /'
+        elif [ "$(uname -m)" != "x86_64" ] || ! command -v cc >/dev/null 2>&1; then
+            echo -e "${GREEN}PASS${NC} (compiled only)"
+            passed_tests=$((passed_tests + 1))
+        elif ! cc "$TEMP_DIR/$name.x86.s" -o "$TEMP_DIR/$name.x86" 2>"$TEMP_DIR/$name.err"; then
+            echo -e "${RED}FAIL${NC} (cc rejects the output)"
+            head -5 "$TEMP_DIR/$name.err" | sed 's/^/    /'
+        else
+            "$TEMP_DIR/$name.x86"
+            local status=$?
+            if [ $status -eq $expected ]; then
+                echo -e "${GREEN}PASS${NC}"
+                passed_tests=$((passed_tests + 1))
+            else
+                echo -e "${RED}FAIL${NC} (exit status $status, expected $expected)"
+            fi
+        fi
+    done
+}
+
+# 主测试循环
+echo "Running compilation tests:"
+for test_file in "$TEST_DIR"/*.tc; do
+    if [ -f "$test_file" ]; then
+        run_test "$test_file"
+    fi
+done
+
+# AST测试
+echo ""
+echo "Running AST tests:"
+for test_file in "$TEST_DIR"/*.tc; do
+    if [ -f "$test_file" ]; then
+        run_ast_test "$test_file"
+    fi
+done
+
+# 目标文件测试
+run_object_tests
+
+# 工作负载测试
+run_workload_tests
+
+# 词法分析器差分测试
+run_lexer_tests
+
+# 语法分析器差分测试
+run_parser_tests
+
+# 内存报告测试
+run_mem_report_test
+
+# 并行编译测试
+run_parallel_tests
+
+# 编译缓存测试
+run_cache_tests
+
+# 编译服务测试
+run_server_tests
+
+# 增量编译测试
+run_incremental_tests
+
+# 深度压力测试
+run_stress_tests
+
+# 语法错误测试
+test_syntax_errors
+
+echo ""
+echo "=========================="
+echo -e "Tests completed: ${GREEN}$passed_tests${NC}/${total_tests} passed"
+
+# 显示失败的测试
+failed_tests=$((total_tests - passed_tests))
+if [ $failed_tests -gt 0 ]; then
+    echo -e "${RED}$failed_tests tests failed${NC}"
+    echo ""
+    echo "Generated files are in: $TEMP_DIR"
+    echo "To clean up: rm -rf $TEMP_DIR"
+else
+    echo -e "${GREEN}All tests passed!${NC}"
+    # 清理临时文件
+    rm -rf "$TEMP_DIR"
+fi
+
+# 返回适当的退出码
+if [ $passed_tests -eq $total_tests ]; then
+    exit 0
+else
+    exit 1
 fi
\ No newline at end of file
@@ -0,0 +1,178 @@
+#!/bin/bash
+
+# 生成代码质量回归测试：编译 workloads/ 下的程序，在 toyc-sim 上运行，
+# 检查返回值，并把静态指令数和动态指令数与 workloads/baseline.txt 比较。
+# 动态指令数超过基线（加容差）即视为变慢，测试失败。
+
+COMPILER=""
+SIMULATOR=""
+UPDATE=0
+TOLERANCE=0
+WORKLOAD_DIR="workloads"
+BASELINE="$WORKLOAD_DIR/baseline.txt"
+OPT_LEVELS="-O0 -O1"
+MAX_INSTRUCTIONS=500000000
+TEMP_DIR="/tmp/toyc_workloads_$$"
+
+# 颜色输出
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+NC='\033[0m'
+
+usage() {
+    echo "Usage: $0 <compiler_path> [simulator_path] [--update] [--tolerance=<percent>]"
+    echo ""
+    echo "  simulator_path       toyc-sim binary (default: next to the compiler)"
+    echo "  --update             Rewrite $BASELINE from the current results"
+    echo "  --tolerance=<pct>    Allowed dynamic instruction growth (default: 0)"
+}
+
+for arg in "$@"; do
+    case "$arg" in
+        --update) UPDATE=1 ;;
+        --tolerance=*) TOLERANCE="${arg#--tolerance=}" ;;
+        -h|--help) usage; exit 0 ;;
+        -*) echo "Unknown option: $arg"; usage; exit 1 ;;
+        *)
+            if [ -z "$COMPILER" ]; then
+                COMPILER=$arg
+            elif [ -z "$SIMULATOR" ]; then
+                SIMULATOR=$arg
+            else
+                usage; exit 1
+            fi
+            ;;
+    esac
+done
+
+if [ -z "$COMPILER" ]; then
+    usage
+    exit 1
+fi
+
+if [ -z "$SIMULATOR" ]; then
+    SIMULATOR="$(dirname "$COMPILER")/toyc-sim"
+fi
+
+if [ ! -x "$COMPILER" ]; then
+    echo -e "${RED}Error: Compiler not found or not executable: $COMPILER${NC}"
+    exit 1
+fi
+
+if [ ! -x "$SIMULATOR" ]; then
+    echo -e "${RED}Error: Simulator not found or not executable: $SIMULATOR${NC}"
+    exit 1
+fi
+
+mkdir -p "$TEMP_DIR"
+
+echo -e "${BLUE}ToyC Workload Regression Suite${NC}"
+echo "=============================="
+echo "Compiler:  $COMPILER"
+echo "Simulator: $SIMULATOR"
+echo "Baseline:  $BASELINE (tolerance ${TOLERANCE}%)"
+echo ""
+
+# 读取基线：键为 "程序 优化级别"
+declare -A base_static
+declare -A base_dynamic
+if [ -f "$BASELINE" ]; then
+    while read -r name opt static dynamic; do
+        case "$name" in ''|'#'*) continue ;; esac
+        base_static["$name $opt"]=$static
+        base_dynamic["$name $opt"]=$dynamic
+    done < "$BASELINE"
+fi
+
+total=0
+failed=0
+results=()
+
+printf "%-16s %-4s %10s %10s %12s %12s  %s\n" "program" "opt" "static" "(base)" "dynamic" "(base)" "status"
+
+for test_file in "$WORKLOAD_DIR"/*.tc; do
+    name=$(basename "$test_file" .tc)
+    expected=$(sed -n 's|^// *expect: *\(-\{0,1\}[0-9][0-9]*\).*|\1|p' "$test_file" | head -n1)
+    if [ -z "$expected" ]; then
+        echo -e "${YELLOW}SKIP${NC} $name (no '// expect:' line)"
+        continue
+    fi
+
+    for opt in $OPT_LEVELS; do
+        total=$((total + 1))
+        key="$name $opt"
+        asm_file="$TEMP_DIR/$name$opt.s"
+        sim_out="$TEMP_DIR/$name$opt.sim"
+
+        if ! "$COMPILER" $opt "$test_file" -o "$asm_file" >/dev/null 2>"$TEMP_DIR/$name$opt.err"; then
+            printf "%-16s %-4s " "$name" "$opt"
+            echo -e "${RED}FAIL${NC} (compilation failed)"
+            sed 's/^/    /' "$TEMP_DIR/$name$opt.err"
+            failed=$((failed + 1))
+            continue
+        fi
+
+        "$SIMULATOR" --max-instructions=$MAX_INSTRUCTIONS "$asm_file" >"$sim_out" 2>&1
+        actual=$(sed -n 's/^Return value: *//p' "$sim_out")
+        static=$(sed -n 's/^Static instructions: *//p' "$sim_out")
+        dynamic=$(sed -n 's/^Instructions: *//p' "$sim_out")
+
+        bs=${base_static[$key]:--}
+        bd=${base_dynamic[$key]:--}
+        printf "%-16s %-4s %10s %10s %12s %12s  " "$name" "$opt" "${static:--}" "$bs" "${dynamic:--}" "$bd"
+
+        # 先看结果是否正确：错误的代码再快也没有意义
+        if [ "$actual" != "$expected" ]; then
+            echo -e "${RED}FAIL${NC} (returned ${actual:-nothing}, expected $expected)"
+            grep '^Error' "$sim_out" | sed 's/^/    /'
+            failed=$((failed + 1))
+            continue
+        fi
+
+        results+=("$name $opt $static $dynamic")
+
+        if [ "$bd" = "-" ]; then
+            echo -e "${YELLOW}NEW${NC} (not in baseline)"
+        elif [ $((dynamic * 100)) -gt $((bd * (100 + TOLERANCE))) ]; then
+            echo -e "${RED}SLOWER${NC} (+$((dynamic - bd)) instructions)"
+            failed=$((failed + 1))
+        elif [ "$dynamic" -lt "$bd" ]; then
+            echo -e "${GREEN}FASTER${NC} (-$((bd - dynamic)) instructions)"
+        elif [ "$static" -gt "$bs" ]; then
+            echo -e "${YELLOW}PASS${NC} (code size +$((static - bs)))"
+        else
+            echo -e "${GREEN}PASS${NC}"
+        fi
+    done
+done
+
+echo ""
+echo "=============================="
+
+if [ $UPDATE -eq 1 ]; then
+    if [ ${#results[@]} -lt $total ]; then
+        echo -e "${RED}Not updating baseline: some programs failed to compile or produced wrong results${NC}"
+    else
+        {
+            echo "# ToyC 工作负载基线（由 run_workloads.sh --update 生成）"
+            echo "# 程序 优化级别 静态指令数 动态指令数"
+            for line in "${results[@]}"; do
+                printf "%-16s %-4s %8s %12s\n" $line
+            done
+        } > "$BASELINE"
+        echo -e "${GREEN}Baseline updated: $BASELINE${NC}"
+        failed=0
+    fi
+fi
+
+if [ $failed -gt 0 ]; then
+    echo -e "${RED}$failed of $total workload runs failed${NC}"
+    echo "Generated files are in: $TEMP_DIR"
+    exit 1
+fi
+
+echo -e "${GREEN}All $total workload runs passed${NC}"
+rm -rf "$TEMP_DIR"
+exit 0
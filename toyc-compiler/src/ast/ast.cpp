@@ -1,234 +1,452 @@
-#include "ast/ast.hpp"
-#include <iostream>
-#include <iomanip>
-
-void printIndent(int indent) {
-    for (int i = 0; i < indent; ++i) {
-        std::cout << "  ";
-    }
-}
-
-// BinaryExpression
-void BinaryExpression::accept(Visitor& visitor) {
-    visitor.visit(*this);
-}
-
-void BinaryExpression::print(int indent) const {
-    printIndent(indent);
-    std::cout << "BinaryExpression: ";
-    switch (op) {
-        case ADD: std::cout << "+"; break;
-        case SUB: std::cout << "-"; break;
-        case MUL: std::cout << "*"; break;
-        case DIV: std::cout << "/"; break;
-        case MOD: std::cout << "%"; break;
-        case LT: std::cout << "<"; break;
-        case LE: std::cout << "<="; break;
-        case GT: std::cout << ">"; break;
-        case GE: std::cout << ">="; break;
-        case EQ: std::cout << "=="; break;
-        case NE: std::cout << "!="; break;
-        case AND: std::cout << "&&"; break;
-        case OR: std::cout << "||"; break;
-    }
-    std::cout << std::endl;
-    left->print(indent + 1);
-    right->print(indent + 1);
-}
-
-// UnaryExpression
-void UnaryExpression::accept(Visitor& visitor) {
-    visitor.visit(*this);
-}
-
-void UnaryExpression::print(int indent) const {
-    printIndent(indent);
-    std::cout << "UnaryExpression: ";
-    switch (op) {
-        case PLUS: std::cout << "+"; break;
-        case MINUS: std::cout << "-"; break;
-        case NOT: std::cout << "!"; break;
-    }
-    std::cout << std::endl;
-    operand->print(indent + 1);
-}
-
-// NumberLiteral
-void NumberLiteral::accept(Visitor& visitor) {
-    visitor.visit(*this);
-}
-
-void NumberLiteral::print(int indent) const {
-    printIndent(indent);
-    std::cout << "NumberLiteral: " << value << std::endl;
-}
-
-// Identifier
-void Identifier::accept(Visitor& visitor) {
-    visitor.visit(*this);
-}
-
-void Identifier::print(int indent) const {
-    printIndent(indent);
-    std::cout << "Identifier: " << name << std::endl;
-}
-
-// FunctionCall
-void FunctionCall::accept(Visitor& visitor) {
-    visitor.visit(*this);
-}
-
-void FunctionCall::print(int indent) const {
-    printIndent(indent);
-    std::cout << "FunctionCall: " << functionName << std::endl;
-    for (const auto& arg : arguments) {
-        arg->print(indent + 1);
-    }
-}
-
-// AssignmentStatement
-void AssignmentStatement::accept(Visitor& visitor) {
-    visitor.visit(*this);
-}
-
-void AssignmentStatement::print(int indent) const {
-    printIndent(indent);
-    std::cout << "Assignment: " << variable << std::endl;
-    value->print(indent + 1);
-}
-
-// VariableDeclaration
-void VariableDeclaration::accept(Visitor& visitor) {
-    visitor.visit(*this);
-}
-
-void VariableDeclaration::print(int indent) const {
-    printIndent(indent);
-    std::cout << "VariableDeclaration: " << name << std::endl;
-    if (initializer) {
-        initializer->print(indent + 1);
-    }
-}
-
-// Block
-void Block::accept(Visitor& visitor) {
-    visitor.visit(*this);
-}
-
-void Block::print(int indent) const {
-    printIndent(indent);
-    std::cout << "Block:" << std::endl;
-    for (const auto& stmt : statements) {
-        stmt->print(indent + 1);
-    }
-}
-
-// IfStatement
-void IfStatement::accept(Visitor& visitor) {
-    visitor.visit(*this);
-}
-
-void IfStatement::print(int indent) const {
-    printIndent(indent);
-    std::cout << "IfStatement:" << std::endl;
-    printIndent(indent + 1);
-    std::cout << "Condition:" << std::endl;
-    condition->print(indent + 2);
-    printIndent(indent + 1);
-    std::cout << "Then:" << std::endl;
-    thenStatement->print(indent + 2);
-    if (elseStatement) {
-        printIndent(indent + 1);
-        std::cout << "Else:" << std::endl;
-        elseStatement->print(indent + 2);
-    }
-}
-
-// WhileStatement
-void WhileStatement::accept(Visitor& visitor) {
-    visitor.visit(*this);
-}
-
-void WhileStatement::print(int indent) const {
-    printIndent(indent);
-    std::cout << "WhileStatement:" << std::endl;
-    printIndent(indent + 1);
-    std::cout << "Condition:" << std::endl;
-    condition->print(indent + 2);
-    printIndent(indent + 1);
-    std::cout << "Body:" << std::endl;
-    body->print(indent + 2);
-}
-
-// BreakStatement
-void BreakStatement::accept(Visitor& visitor) {
-    visitor.visit(*this);
-}
-
-void BreakStatement::print(int indent) const {
-    printIndent(indent);
-    std::cout << "BreakStatement" << std::endl;
-}
-
-// ContinueStatement
-void ContinueStatement::accept(Visitor& visitor) {
-    visitor.visit(*this);
-}
-
-void ContinueStatement::print(int indent) const {
-    printIndent(indent);
-    std::cout << "ContinueStatement" << std::endl;
-}
-
-// ReturnStatement
-void ReturnStatement::accept(Visitor& visitor) {
-    visitor.visit(*this);
-}
-
-void ReturnStatement::print(int indent) const {
-    printIndent(indent);
-    std::cout << "ReturnStatement:" << std::endl;
-    if (value) {
-        value->print(indent + 1);
-    }
-}
-
-// ExpressionStatement
-void ExpressionStatement::accept(Visitor& visitor) {
-    visitor.visit(*this);
-}
-
-void ExpressionStatement::print(int indent) const {
-    printIndent(indent);
-    std::cout << "ExpressionStatement:" << std::endl;
-    expression->print(indent + 1);
-}
-
-// FunctionDefinition
-void FunctionDefinition::accept(Visitor& visitor) {
-    visitor.visit(*this);
-}
-
-void FunctionDefinition::print(int indent) const {
-    printIndent(indent);
-    std::cout << "FunctionDefinition: " << name;
-    std::cout << " (" << (returnType == Expression::INT ? "int" : "void") << ")" << std::endl;
-    for (const auto& param : parameters) {
-        printIndent(indent + 1);
-        std::cout << "Parameter: " << param.name << " (int)" << std::endl;
-    }
-    body->print(indent + 1);
-}
-
-// CompilationUnit
-void CompilationUnit::accept(Visitor& visitor) {
-    visitor.visit(*this);
-}
-
-void CompilationUnit::print(int indent) const {
-    printIndent(indent);
-    std::cout << "CompilationUnit:" << std::endl;
-    for (const auto& func : functions) {
-        func->print(indent + 1);
-    }
+#include "ast/ast.hpp"
+#include <iostream>
+#include <iomanip>
+
+void printIndent(int indent) {
+    for (int i = 0; i < indent; ++i) {
+        std::cout << "  ";
+    }
+}
+
+namespace {
+
+// 当前线程上挂起和运行中的遍历协程，栈顶是正在执行的那个
+thread_local std::vector<std::coroutine_handle<Walk::promise_type>> walkStack;
+
+// 协程帧按16字节分档复用；每档最多保留 MAX_POOLED_FRAMES 个，
+// 深树遍历结束后多出来的帧还给堆
+constexpr size_t FRAME_GRANULE = 16;
+constexpr size_t MAX_POOLED_FRAME_SIZE = 1024;
+constexpr size_t MAX_POOLED_FRAMES = 4096;
+
+struct FramePool {
+    std::vector<std::vector<void*>> buckets;
+    
+    ~FramePool() {
+        for (auto& bucket : buckets) {
+            for (void* frame : bucket) ::operator delete(frame);
+        }
+    }
+};
+
+thread_local FramePool framePool;
+
+} // namespace
+
+// Walk
+void* Walk::promise_type::operator new(size_t size) {
+    if (size > MAX_POOLED_FRAME_SIZE) return ::operator new(size);
+    size_t bucket = (size + FRAME_GRANULE - 1) / FRAME_GRANULE;
+    auto& buckets = framePool.buckets;
+    if (bucket < buckets.size() && !buckets[bucket].empty()) {
+        void* frame = buckets[bucket].back();
+        buckets[bucket].pop_back();
+        return frame;
+    }
+    return ::operator new(bucket * FRAME_GRANULE);
+}
+
+void Walk::promise_type::operator delete(void* frame, size_t size) {
+    if (size > MAX_POOLED_FRAME_SIZE) {
+        ::operator delete(frame);
+        return;
+    }
+    size_t bucket = (size + FRAME_GRANULE - 1) / FRAME_GRANULE;
+    auto& buckets = framePool.buckets;
+    if (buckets.size() <= bucket) buckets.resize(bucket + 1);
+    if (buckets[bucket].size() >= MAX_POOLED_FRAMES) {
+        ::operator delete(frame);
+        return;
+    }
+    buckets[bucket].push_back(frame);
+}
+
+Walk::~Walk() {
+    if (handle) handle.destroy();
+}
+
+void Walk::await_suspend(std::coroutine_handle<>) noexcept {
+    walkStack.push_back(handle);
+}
+
+void Walk::await_resume() const {
+    if (handle.promise().exception) std::rethrow_exception(handle.promise().exception);
+}
+
+void Walk::run(Walk walk) {
+    // 嵌套的 run 只驱动自己压入的部分
+    size_t base = walkStack.size();
+    walkStack.push_back(walk.handle);
+    while (walkStack.size() > base) {
+        auto top = walkStack.back();
+        top.resume();
+        // 没有完成说明压入了子协程；完成后弹出，下一轮恢复等待它的父协程
+        if (top.done()) walkStack.pop_back();
+    }
+    if (walk.handle.promise().exception) std::rethrow_exception(walk.handle.promise().exception);
+}
+
+// ASTNode
+void ASTNode::print(int indent) const {
+    std::vector<PrintEntry> stack{{this, indent, nullptr}};
+    std::vector<PrintEntry> next;
+    while (!stack.empty()) {
+        PrintEntry entry = stack.back();
+        stack.pop_back();
+        if (!entry.node) {
+            printIndent(entry.indent);
+            std::cout << entry.label << std::endl;
+            continue;
+        }
+        next.clear();
+        entry.node->printNode(entry.indent, next);
+        stack.insert(stack.end(), next.rbegin(), next.rend());
+    }
+}
+
+void ASTNode::destroyChildren() {
+    std::vector<std::unique_ptr<ASTNode>> pending;
+    releaseChildren(pending);
+    while (!pending.empty()) {
+        std::unique_ptr<ASTNode> node = std::move(pending.back());
+        pending.pop_back();
+        // 先摘下子节点，node 析构时就没有子树了
+        node->releaseChildren(pending);
+    }
+}
+
+// BinaryExpression
+Walk BinaryExpression::accept(Visitor& visitor) {
+    return visitor.visit(*this);
+}
+
+void BinaryExpression::children(std::vector<ASTNode*>& out) const {
+    out.push_back(left.get());
+    out.push_back(right.get());
+}
+
+void BinaryExpression::releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) {
+    if (left) out.push_back(std::move(left));
+    if (right) out.push_back(std::move(right));
+}
+
+void BinaryExpression::printNode(int indent, std::vector<PrintEntry>& next) const {
+    printIndent(indent);
+    std::cout << "BinaryExpression: ";
+    switch (op) {
+        case ADD: std::cout << "+"; break;
+        case SUB: std::cout << "-"; break;
+        case MUL: std::cout << "*"; break;
+        case DIV: std::cout << "/"; break;
+        case MOD: std::cout << "%"; break;
+        case LT: std::cout << "<"; break;
+        case LE: std::cout << "<="; break;
+        case GT: std::cout << ">"; break;
+        case GE: std::cout << ">="; break;
+        case EQ: std::cout << "=="; break;
+        case NE: std::cout << "!="; break;
+        case AND: std::cout << "&&"; break;
+        case OR: std::cout << "||"; break;
+    }
+    std::cout << std::endl;
+    next.push_back({left.get(), indent + 1, nullptr});
+    next.push_back({right.get(), indent + 1, nullptr});
+}
+
+// UnaryExpression
+Walk UnaryExpression::accept(Visitor& visitor) {
+    return visitor.visit(*this);
+}
+
+void UnaryExpression::children(std::vector<ASTNode*>& out) const {
+    out.push_back(operand.get());
+}
+
+void UnaryExpression::releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) {
+    if (operand) out.push_back(std::move(operand));
+}
+
+void UnaryExpression::printNode(int indent, std::vector<PrintEntry>& next) const {
+    printIndent(indent);
+    std::cout << "UnaryExpression: ";
+    switch (op) {
+        case PLUS: std::cout << "+"; break;
+        case MINUS: std::cout << "-"; break;
+        case NOT: std::cout << "!"; break;
+    }
+    std::cout << std::endl;
+    next.push_back({operand.get(), indent + 1, nullptr});
+}
+
+// NumberLiteral
+Walk NumberLiteral::accept(Visitor& visitor) {
+    return visitor.visit(*this);
+}
+
+void NumberLiteral::printNode(int indent, std::vector<PrintEntry>&) const {
+    printIndent(indent);
+    std::cout << "NumberLiteral: " << value << std::endl;
+}
+
+// Identifier
+Walk Identifier::accept(Visitor& visitor) {
+    return visitor.visit(*this);
+}
+
+void Identifier::printNode(int indent, std::vector<PrintEntry>&) const {
+    printIndent(indent);
+    std::cout << "Identifier: " << name << std::endl;
+}
+
+// FunctionCall
+Walk FunctionCall::accept(Visitor& visitor) {
+    return visitor.visit(*this);
+}
+
+void FunctionCall::children(std::vector<ASTNode*>& out) const {
+    for (const auto& arg : arguments) {
+        out.push_back(arg.get());
+    }
+}
+
+void FunctionCall::releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) {
+    for (auto& arg : arguments) {
+        if (arg) out.push_back(std::move(arg));
+    }
+}
+
+void FunctionCall::printNode(int indent, std::vector<PrintEntry>& next) const {
+    printIndent(indent);
+    std::cout << "FunctionCall: " << functionName << std::endl;
+    for (const auto& arg : arguments) {
+        next.push_back({arg.get(), indent + 1, nullptr});
+    }
+}
+
+// AssignmentStatement
+Walk AssignmentStatement::accept(Visitor& visitor) {
+    return visitor.visit(*this);
+}
+
+void AssignmentStatement::children(std::vector<ASTNode*>& out) const {
+    out.push_back(value.get());
+}
+
+void AssignmentStatement::releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) {
+    if (value) out.push_back(std::move(value));
+}
+
+void AssignmentStatement::printNode(int indent, std::vector<PrintEntry>& next) const {
+    printIndent(indent);
+    std::cout << "Assignment: " << variable << std::endl;
+    next.push_back({value.get(), indent + 1, nullptr});
+}
+
+// VariableDeclaration
+Walk VariableDeclaration::accept(Visitor& visitor) {
+    return visitor.visit(*this);
+}
+
+void VariableDeclaration::children(std::vector<ASTNode*>& out) const {
+    if (initializer) out.push_back(initializer.get());
+}
+
+void VariableDeclaration::releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) {
+    if (initializer) out.push_back(std::move(initializer));
+}
+
+void VariableDeclaration::printNode(int indent, std::vector<PrintEntry>& next) const {
+    printIndent(indent);
+    std::cout << "VariableDeclaration: " << name << std::endl;
+    if (initializer) {
+        next.push_back({initializer.get(), indent + 1, nullptr});
+    }
+}
+
+// Block
+Walk Block::accept(Visitor& visitor) {
+    return visitor.visit(*this);
+}
+
+void Block::children(std::vector<ASTNode*>& out) const {
+    for (const auto& stmt : statements) {
+        out.push_back(stmt.get());
+    }
+}
+
+void Block::releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) {
+    for (auto& stmt : statements) {
+        if (stmt) out.push_back(std::move(stmt));
+    }
+}
+
+void Block::printNode(int indent, std::vector<PrintEntry>& next) const {
+    printIndent(indent);
+    std::cout << "Block:" << std::endl;
+    for (const auto& stmt : statements) {
+        next.push_back({stmt.get(), indent + 1, nullptr});
+    }
+}
+
+// IfStatement
+Walk IfStatement::accept(Visitor& visitor) {
+    return visitor.visit(*this);
+}
+
+void IfStatement::children(std::vector<ASTNode*>& out) const {
+    out.push_back(condition.get());
+    out.push_back(thenStatement.get());
+    if (elseStatement) out.push_back(elseStatement.get());
+}
+
+void IfStatement::releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) {
+    if (condition) out.push_back(std::move(condition));
+    if (thenStatement) out.push_back(std::move(thenStatement));
+    if (elseStatement) out.push_back(std::move(elseStatement));
+}
+
+void IfStatement::printNode(int indent, std::vector<PrintEntry>& next) const {
+    printIndent(indent);
+    std::cout << "IfStatement:" << std::endl;
+    next.push_back({nullptr, indent + 1, "Condition:"});
+    next.push_back({condition.get(), indent + 2, nullptr});
+    next.push_back({nullptr, indent + 1, "Then:"});
+    next.push_back({thenStatement.get(), indent + 2, nullptr});
+    if (elseStatement) {
+        next.push_back({nullptr, indent + 1, "Else:"});
+        next.push_back({elseStatement.get(), indent + 2, nullptr});
+    }
+}
+
+// WhileStatement
+Walk WhileStatement::accept(Visitor& visitor) {
+    return visitor.visit(*this);
+}
+
+void WhileStatement::children(std::vector<ASTNode*>& out) const {
+    out.push_back(condition.get());
+    out.push_back(body.get());
+}
+
+void WhileStatement::releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) {
+    if (condition) out.push_back(std::move(condition));
+    if (body) out.push_back(std::move(body));
+}
+
+void WhileStatement::printNode(int indent, std::vector<PrintEntry>& next) const {
+    printIndent(indent);
+    std::cout << "WhileStatement:" << std::endl;
+    next.push_back({nullptr, indent + 1, "Condition:"});
+    next.push_back({condition.get(), indent + 2, nullptr});
+    next.push_back({nullptr, indent + 1, "Body:"});
+    next.push_back({body.get(), indent + 2, nullptr});
+}
+
+// BreakStatement
+Walk BreakStatement::accept(Visitor& visitor) {
+    return visitor.visit(*this);
+}
+
+void BreakStatement::printNode(int indent, std::vector<PrintEntry>&) const {
+    printIndent(indent);
+    std::cout << "BreakStatement" << std::endl;
+}
+
+// ContinueStatement
+Walk ContinueStatement::accept(Visitor& visitor) {
+    return visitor.visit(*this);
+}
+
+void ContinueStatement::printNode(int indent, std::vector<PrintEntry>&) const {
+    printIndent(indent);
+    std::cout << "ContinueStatement" << std::endl;
+}
+
+// ReturnStatement
+Walk ReturnStatement::accept(Visitor& visitor) {
+    return visitor.visit(*this);
+}
+
+void ReturnStatement::children(std::vector<ASTNode*>& out) const {
+    if (value) out.push_back(value.get());
+}
+
+void ReturnStatement::releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) {
+    if (value) out.push_back(std::move(value));
+}
+
+void ReturnStatement::printNode(int indent, std::vector<PrintEntry>& next) const {
+    printIndent(indent);
+    std::cout << "ReturnStatement:" << std::endl;
+    if (value) {
+        next.push_back({value.get(), indent + 1, nullptr});
+    }
+}
+
+// ExpressionStatement
+Walk ExpressionStatement::accept(Visitor& visitor) {
+    return visitor.visit(*this);
+}
+
+void ExpressionStatement::children(std::vector<ASTNode*>& out) const {
+    out.push_back(expression.get());
+}
+
+void ExpressionStatement::releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) {
+    if (expression) out.push_back(std::move(expression));
+}
+
+void ExpressionStatement::printNode(int indent, std::vector<PrintEntry>& next) const {
+    printIndent(indent);
+    std::cout << "ExpressionStatement:" << std::endl;
+    next.push_back({expression.get(), indent + 1, nullptr});
+}
+
+// FunctionDefinition
+Walk FunctionDefinition::accept(Visitor& visitor) {
+    return visitor.visit(*this);
+}
+
+void FunctionDefinition::children(std::vector<ASTNode*>& out) const {
+    out.push_back(body.get());
+}
+
+void FunctionDefinition::releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) {
+    if (body) out.push_back(std::move(body));
+}
+
+void FunctionDefinition::printNode(int indent, std::vector<PrintEntry>& next) const {
+    printIndent(indent);
+    std::cout << "FunctionDefinition: " << name;
+    std::cout << " (" << (returnType == Expression::INT ? "int" : "void") << ")" << std::endl;
+    for (const auto& param : parameters) {
+        printIndent(indent + 1);
+        std::cout << "Parameter: " << param.name << " (int)" << std::endl;
+    }
+    next.push_back({body.get(), indent + 1, nullptr});
+}
+
+// CompilationUnit
+Walk CompilationUnit::accept(Visitor& visitor) {
+    return visitor.visit(*this);
+}
+
+void CompilationUnit::children(std::vector<ASTNode*>& out) const {
+    for (const auto& func : functions) {
+        out.push_back(func.get());
+    }
+}
+
+void CompilationUnit::releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) {
+    for (auto& func : functions) {
+        if (func) out.push_back(std::move(func));
+    }
+}
+
+void CompilationUnit::printNode(int indent, std::vector<PrintEntry>& next) const {
+    printIndent(indent);
+    std::cout << "CompilationUnit:" << std::endl;
+    for (const auto& func : functions) {
+        next.push_back({func.get(), indent + 1, nullptr});
+    }
 }
\ No newline at end of file
@@ -1,266 +1,421 @@
-#pragma once
-#include <memory>
-#include <vector>
-#include <string>
-#include <iostream>
-
-// 前向声明
-class Visitor;
-
-// AST节点基类
-class ASTNode {
-public:
-    virtual ~ASTNode() = default;
-    virtual void accept(Visitor& visitor) = 0;
-    virtual void print(int indent = 0) const = 0;
-};
-
-// 表达式基类
-class Expression : public ASTNode {
-public:
-    enum Type { INT, VOID };
-    virtual Type getType() const = 0;
-};
-
-// 语句基类
-class Statement : public ASTNode {};
-
-// 二元表达式
-class BinaryExpression : public Expression {
-public:
-    enum Operator { 
-        ADD, SUB, MUL, DIV, MOD,
-        LT, LE, GT, GE, EQ, NE,
-        AND, OR
-    };
-    
-    std::unique_ptr<Expression> left;
-    std::unique_ptr<Expression> right;
-    Operator op;
-    
-    BinaryExpression(std::unique_ptr<Expression> l, Operator o, std::unique_ptr<Expression> r)
-        : left(std::move(l)), op(o), right(std::move(r)) {}
-    
-    void accept(Visitor& visitor) override;
-    void print(int indent = 0) const override;
-    Type getType() const override { return INT; }
-};
-
-// 一元表达式
-class UnaryExpression : public Expression {
-public:
-    enum Operator { PLUS, MINUS, NOT };
-    
-    Operator op;
-    std::unique_ptr<Expression> operand;
-    
-    UnaryExpression(Operator o, std::unique_ptr<Expression> expr)
-        : op(o), operand(std::move(expr)) {}
-    
-    void accept(Visitor& visitor) override;
-    void print(int indent = 0) const override;
-    Type getType() const override { return INT; }
-};
-
-// 数字字面量
-class NumberLiteral : public Expression {
-public:
-    int value;
-    
-    NumberLiteral(int val) : value(val) {}
-    
-    void accept(Visitor& visitor) override;
-    void print(int indent = 0) const override;
-    Type getType() const override { return INT; }
-};
-
-// 标识符表达式
-class Identifier : public Expression {
-public:
-    std::string name;
-    
-    Identifier(const std::string& n) : name(n) {}
-    
-    void accept(Visitor& visitor) override;
-    void print(int indent = 0) const override;
-    Type getType() const override { return INT; }
-};
-
-// 函数调用表达式
-class FunctionCall : public Expression {
-public:
-    std::string functionName;
-    std::vector<std::unique_ptr<Expression>> arguments;
-    Expression::Type returnType;
-    
-    FunctionCall(const std::string& name, std::vector<std::unique_ptr<Expression>> args, Expression::Type type)
-        : functionName(name), arguments(std::move(args)), returnType(type) {}
-    
-    void accept(Visitor& visitor) override;
-    void print(int indent = 0) const override;
-    Type getType() const override { return returnType; }
-};
-
-// 赋值语句
-class AssignmentStatement : public Statement {
-public:
-    std::string variable;
-    std::unique_ptr<Expression> value;
-    
-    AssignmentStatement(const std::string& var, std::unique_ptr<Expression> val)
-        : variable(var), value(std::move(val)) {}
-    
-    void accept(Visitor& visitor) override;
-    void print(int indent = 0) const override;
-};
-
-// 变量声明语句
-class VariableDeclaration : public Statement {
-public:
-    std::string name;
-    std::unique_ptr<Expression> initializer;
-    
-    VariableDeclaration(const std::string& n, std::unique_ptr<Expression> init)
-        : name(n), initializer(std::move(init)) {}
-    
-    void accept(Visitor& visitor) override;
-    void print(int indent = 0) const override;
-};
-
-// 语句块
-class Block : public Statement {
-public:
-    std::vector<std::unique_ptr<Statement>> statements;
-    
-    void addStatement(std::unique_ptr<Statement> stmt) {
-        statements.push_back(std::move(stmt));
-    }
-    
-    void accept(Visitor& visitor) override;
-    void print(int indent = 0) const override;
-};
-
-// If语句
-class IfStatement : public Statement {
-public:
-    std::unique_ptr<Expression> condition;
-    std::unique_ptr<Statement> thenStatement;
-    std::unique_ptr<Statement> elseStatement; // 可选
-    
-    IfStatement(std::unique_ptr<Expression> cond, std::unique_ptr<Statement> then, 
-                std::unique_ptr<Statement> els = nullptr)
-        : condition(std::move(cond)), thenStatement(std::move(then)), elseStatement(std::move(els)) {}
-    
-    void accept(Visitor& visitor) override;
-    void print(int indent = 0) const override;
-};
-
-// While语句
-class WhileStatement : public Statement {
-public:
-    std::unique_ptr<Expression> condition;
-    std::unique_ptr<Statement> body;
-    
-    WhileStatement(std::unique_ptr<Expression> cond, std::unique_ptr<Statement> b)
-        : condition(std::move(cond)), body(std::move(b)) {}
-    
-    void accept(Visitor& visitor) override;
-    void print(int indent = 0) const override;
-};
-
-// Break语句
-class BreakStatement : public Statement {
-public:
-    void accept(Visitor& visitor) override;
-    void print(int indent = 0) const override;
-};
-
-// Continue语句
-class ContinueStatement : public Statement {
-public:
-    void accept(Visitor& visitor) override;
-    void print(int indent = 0) const override;
-};
-
-// Return语句
-class ReturnStatement : public Statement {
-public:
-    std::unique_ptr<Expression> value; // 可选
-    
-    ReturnStatement(std::unique_ptr<Expression> val = nullptr) : value(std::move(val)) {}
-    
-    void accept(Visitor& visitor) override;
-    void print(int indent = 0) const override;
-};
-
-// 表达式语句
-class ExpressionStatement : public Statement {
-public:
-    std::unique_ptr<Expression> expression;
-    
-    ExpressionStatement(std::unique_ptr<Expression> expr) : expression(std::move(expr)) {}
-    
-    void accept(Visitor& visitor) override;
-    void print(int indent = 0) const override;
-};
-
-// 参数定义
-class Parameter {
-public:
-    std::string name;
-    Expression::Type type;
-    
-    Parameter(const std::string& n, Expression::Type t) : name(n), type(t) {}
-};
-
-// 函数定义
-class FunctionDefinition : public ASTNode {
-public:
-    std::string name;
-    Expression::Type returnType;
-    std::vector<Parameter> parameters;
-    std::unique_ptr<Block> body;
-    
-    FunctionDefinition(const std::string& n, Expression::Type ret, 
-                      std::vector<Parameter> params, std::unique_ptr<Block> b)
-        : name(n), returnType(ret), parameters(std::move(params)), body(std::move(b)) {}
-    
-    void accept(Visitor& visitor) override;
-    void print(int indent = 0) const override;
-};
-
-// 编译单元（程序根节点）
-class CompilationUnit : public ASTNode {
-public:
-    std::vector<std::unique_ptr<FunctionDefinition>> functions;
-    
-    void addFunction(std::unique_ptr<FunctionDefinition> func) {
-        functions.push_back(std::move(func));
-    }
-    
-    void accept(Visitor& visitor) override;
-    void print(int indent = 0) const override;
-};
-
-// 访问者模式接口
-class Visitor {
-public:
-    virtual ~Visitor() = default;
-    
-    virtual void visit(BinaryExpression& node) = 0;
-    virtual void visit(UnaryExpression& node) = 0;
-    virtual void visit(NumberLiteral& node) = 0;
-    virtual void visit(Identifier& node) = 0;
-    virtual void visit(FunctionCall& node) = 0;
-    virtual void visit(AssignmentStatement& node) = 0;
-    virtual void visit(VariableDeclaration& node) = 0;
-    virtual void visit(Block& node) = 0;
-    virtual void visit(IfStatement& node) = 0;
-    virtual void visit(WhileStatement& node) = 0;
-    virtual void visit(BreakStatement& node) = 0;
-    virtual void visit(ContinueStatement& node) = 0;
-    virtual void visit(ReturnStatement& node) = 0;
-    virtual void visit(ExpressionStatement& node) = 0;
-    virtual void visit(FunctionDefinition& node) = 0;
-    virtual void visit(CompilationUnit& node) = 0;
+#pragma once
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <vector>
+#include <string>
+#include <iostream>
+
+// 前向声明
+class Visitor;
+class ASTNode;
+
+// 遍历协程：visit 写成协程，用 co_await child->accept(*this) 处理子节点。
+// 子节点的协程帧压在当前线程的显式栈上，由 Walk::run 循环驱动，父节点挂起等待，
+// 遍历不占用原生栈，AST 的深度只受堆内存限制
+class Walk {
+public:
+    struct promise_type {
+        std::exception_ptr exception;
+        
+        Walk get_return_object() { return Walk(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { exception = std::current_exception(); }
+        
+        // 协程帧按大小分档在线程内复用，每个节点一帧，避免反复向堆申请
+        static void* operator new(size_t size);
+        static void operator delete(void* frame, size_t size);
+    };
+    
+    Walk(Walk&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+    Walk& operator=(Walk&&) = delete;
+    ~Walk();
+    
+    // 执行到完成（可以嵌套调用）；协程中抛出的异常在这里重新抛出
+    static void run(Walk walk);
+    
+    // co_await：子协程压栈，父协程挂起，run 的循环先执行完子协程再恢复父协程；
+    // 子协程的帧归这个 Walk 临时对象所有，子协程抛出的异常在父协程中重新抛出
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<>) noexcept;
+    void await_resume() const;
+    
+private:
+    std::coroutine_handle<promise_type> handle;
+    
+    explicit Walk(std::coroutine_handle<promise_type> h) : handle(h) {}
+};
+
+// --ast 输出中待打印的一项：节点，或节点之间的标签行（node 为空）
+struct PrintEntry {
+    const ASTNode* node;
+    int indent;
+    const char* label;
+};
+
+// AST节点基类
+class ASTNode {
+public:
+    // 源码中的字节偏移，行列号只在输出诊断时由 SourceManager 计算；
+    // Bison 分析器和优化遍新建的节点没有位置
+    static constexpr uint32_t NO_OFFSET = 0xffffffffu;
+    uint32_t offset = NO_OFFSET;
+    
+    virtual ~ASTNode() = default;
+    virtual Walk accept(Visitor& visitor) = 0;
+    // 用显式栈按前序打印整棵子树
+    void print(int indent = 0) const;
+    // 按求值顺序追加直接子节点
+    virtual void children(std::vector<ASTNode*>&) const {}
+    
+protected:
+    // 打印本节点一行，并按顺序追加要接着打印的子节点和标签
+    virtual void printNode(int indent, std::vector<PrintEntry>& next) const = 0;
+    // 把直接子节点的所有权追加到传入的数组
+    virtual void releaseChildren(std::vector<std::unique_ptr<ASTNode>>&) {}
+    // 有子节点的类在析构函数中调用：子树逐层摘下放进显式栈逐个释放，
+    // 不沿 unique_ptr 的析构链递归
+    void destroyChildren();
+};
+
+// 以显式栈前序遍历 root 的子树；visit 返回 false 时不进入该节点的子节点
+template <typename F>
+void walkTree(ASTNode& root, F&& visit) {
+    std::vector<ASTNode*> stack{&root};
+    std::vector<ASTNode*> next;
+    while (!stack.empty()) {
+        ASTNode* node = stack.back();
+        stack.pop_back();
+        if (!visit(*node)) continue;
+        next.clear();
+        node->children(next);
+        stack.insert(stack.end(), next.rbegin(), next.rend());
+    }
+}
+
+// 表达式基类
+class Expression : public ASTNode {
+public:
+    enum Type { INT, VOID };
+    virtual Type getType() const = 0;
+};
+
+// 语句基类
+class Statement : public ASTNode {};
+
+// 二元表达式
+class BinaryExpression : public Expression {
+public:
+    enum Operator { 
+        ADD, SUB, MUL, DIV, MOD,
+        LT, LE, GT, GE, EQ, NE,
+        AND, OR
+    };
+    
+    std::unique_ptr<Expression> left;
+    std::unique_ptr<Expression> right;
+    Operator op;
+    
+    BinaryExpression(std::unique_ptr<Expression> l, Operator o, std::unique_ptr<Expression> r)
+        : left(std::move(l)), op(o), right(std::move(r)) {}
+    ~BinaryExpression() override { destroyChildren(); }
+    
+    Walk accept(Visitor& visitor) override;
+    void children(std::vector<ASTNode*>& out) const override;
+    Type getType() const override { return INT; }
+    
+protected:
+    void printNode(int indent, std::vector<PrintEntry>& next) const override;
+    void releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) override;
+};
+
+// 一元表达式
+class UnaryExpression : public Expression {
+public:
+    enum Operator { PLUS, MINUS, NOT };
+    
+    Operator op;
+    std::unique_ptr<Expression> operand;
+    
+    UnaryExpression(Operator o, std::unique_ptr<Expression> expr)
+        : op(o), operand(std::move(expr)) {}
+    ~UnaryExpression() override { destroyChildren(); }
+    
+    Walk accept(Visitor& visitor) override;
+    void children(std::vector<ASTNode*>& out) const override;
+    Type getType() const override { return INT; }
+    
+protected:
+    void printNode(int indent, std::vector<PrintEntry>& next) const override;
+    void releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) override;
+};
+
+// 数字字面量
+class NumberLiteral : public Expression {
+public:
+    int value;
+    
+    NumberLiteral(int val) : value(val) {}
+    
+    Walk accept(Visitor& visitor) override;
+    Type getType() const override { return INT; }
+    
+protected:
+    void printNode(int indent, std::vector<PrintEntry>& next) const override;
+};
+
+// 标识符表达式
+class Identifier : public Expression {
+public:
+    std::string name;
+    
+    Identifier(const std::string& n) : name(n) {}
+    
+    Walk accept(Visitor& visitor) override;
+    Type getType() const override { return INT; }
+    
+protected:
+    void printNode(int indent, std::vector<PrintEntry>& next) const override;
+};
+
+// 函数调用表达式
+class FunctionCall : public Expression {
+public:
+    std::string functionName;
+    std::vector<std::unique_ptr<Expression>> arguments;
+    Expression::Type returnType;
+    
+    FunctionCall(const std::string& name, std::vector<std::unique_ptr<Expression>> args, Expression::Type type)
+        : functionName(name), arguments(std::move(args)), returnType(type) {}
+    ~FunctionCall() override { destroyChildren(); }
+    
+    Walk accept(Visitor& visitor) override;
+    void children(std::vector<ASTNode*>& out) const override;
+    Type getType() const override { return returnType; }
+    
+protected:
+    void printNode(int indent, std::vector<PrintEntry>& next) const override;
+    void releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) override;
+};
+
+// 赋值语句
+class AssignmentStatement : public Statement {
+public:
+    std::string variable;
+    std::unique_ptr<Expression> value;
+    
+    AssignmentStatement(const std::string& var, std::unique_ptr<Expression> val)
+        : variable(var), value(std::move(val)) {}
+    ~AssignmentStatement() override { destroyChildren(); }
+    
+    Walk accept(Visitor& visitor) override;
+    void children(std::vector<ASTNode*>& out) const override;
+    
+protected:
+    void printNode(int indent, std::vector<PrintEntry>& next) const override;
+    void releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) override;
+};
+
+// 变量声明语句
+class VariableDeclaration : public Statement {
+public:
+    std::string name;
+    std::unique_ptr<Expression> initializer;
+    
+    VariableDeclaration(const std::string& n, std::unique_ptr<Expression> init)
+        : name(n), initializer(std::move(init)) {}
+    ~VariableDeclaration() override { destroyChildren(); }
+    
+    Walk accept(Visitor& visitor) override;
+    void children(std::vector<ASTNode*>& out) const override;
+    
+protected:
+    void printNode(int indent, std::vector<PrintEntry>& next) const override;
+    void releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) override;
+};
+
+// 语句块
+class Block : public Statement {
+public:
+    std::vector<std::unique_ptr<Statement>> statements;
+    
+    Block() = default;
+    ~Block() override { destroyChildren(); }
+    
+    void addStatement(std::unique_ptr<Statement> stmt) {
+        statements.push_back(std::move(stmt));
+    }
+    
+    Walk accept(Visitor& visitor) override;
+    void children(std::vector<ASTNode*>& out) const override;
+    
+protected:
+    void printNode(int indent, std::vector<PrintEntry>& next) const override;
+    void releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) override;
+};
+
+// If语句
+class IfStatement : public Statement {
+public:
+    std::unique_ptr<Expression> condition;
+    std::unique_ptr<Statement> thenStatement;
+    std::unique_ptr<Statement> elseStatement; // 可选
+    
+    IfStatement(std::unique_ptr<Expression> cond, std::unique_ptr<Statement> then, 
+                std::unique_ptr<Statement> els = nullptr)
+        : condition(std::move(cond)), thenStatement(std::move(then)), elseStatement(std::move(els)) {}
+    ~IfStatement() override { destroyChildren(); }
+    
+    Walk accept(Visitor& visitor) override;
+    void children(std::vector<ASTNode*>& out) const override;
+    
+protected:
+    void printNode(int indent, std::vector<PrintEntry>& next) const override;
+    void releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) override;
+};
+
+// While语句
+class WhileStatement : public Statement {
+public:
+    std::unique_ptr<Expression> condition;
+    std::unique_ptr<Statement> body;
+    
+    WhileStatement(std::unique_ptr<Expression> cond, std::unique_ptr<Statement> b)
+        : condition(std::move(cond)), body(std::move(b)) {}
+    ~WhileStatement() override { destroyChildren(); }
+    
+    Walk accept(Visitor& visitor) override;
+    void children(std::vector<ASTNode*>& out) const override;
+    
+protected:
+    void printNode(int indent, std::vector<PrintEntry>& next) const override;
+    void releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) override;
+};
+
+// Break语句
+class BreakStatement : public Statement {
+public:
+    Walk accept(Visitor& visitor) override;
+    
+protected:
+    void printNode(int indent, std::vector<PrintEntry>& next) const override;
+};
+
+// Continue语句
+class ContinueStatement : public Statement {
+public:
+    Walk accept(Visitor& visitor) override;
+    
+protected:
+    void printNode(int indent, std::vector<PrintEntry>& next) const override;
+};
+
+// Return语句
+class ReturnStatement : public Statement {
+public:
+    std::unique_ptr<Expression> value; // 可选
+    
+    ReturnStatement(std::unique_ptr<Expression> val = nullptr) : value(std::move(val)) {}
+    ~ReturnStatement() override { destroyChildren(); }
+    
+    Walk accept(Visitor& visitor) override;
+    void children(std::vector<ASTNode*>& out) const override;
+    
+protected:
+    void printNode(int indent, std::vector<PrintEntry>& next) const override;
+    void releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) override;
+};
+
+// 表达式语句
+class ExpressionStatement : public Statement {
+public:
+    std::unique_ptr<Expression> expression;
+    
+    ExpressionStatement(std::unique_ptr<Expression> expr) : expression(std::move(expr)) {}
+    ~ExpressionStatement() override { destroyChildren(); }
+    
+    Walk accept(Visitor& visitor) override;
+    void children(std::vector<ASTNode*>& out) const override;
+    
+protected:
+    void printNode(int indent, std::vector<PrintEntry>& next) const override;
+    void releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) override;
+};
+
+// 参数定义
+class Parameter {
+public:
+    std::string name;
+    Expression::Type type;
+    
+    Parameter(const std::string& n, Expression::Type t) : name(n), type(t) {}
+};
+
+// 函数定义
+class FunctionDefinition : public ASTNode {
+public:
+    std::string name;
+    Expression::Type returnType;
+    std::vector<Parameter> parameters;
+    std::unique_ptr<Block> body;
+    
+    FunctionDefinition(const std::string& n, Expression::Type ret, 
+                      std::vector<Parameter> params, std::unique_ptr<Block> b)
+        : name(n), returnType(ret), parameters(std::move(params)), body(std::move(b)) {}
+    ~FunctionDefinition() override { destroyChildren(); }
+    
+    Walk accept(Visitor& visitor) override;
+    void children(std::vector<ASTNode*>& out) const override;
+    
+protected:
+    void printNode(int indent, std::vector<PrintEntry>& next) const override;
+    void releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) override;
+};
+
+// 编译单元（程序根节点）
+class CompilationUnit : public ASTNode {
+public:
+    std::vector<std::unique_ptr<FunctionDefinition>> functions;
+    
+    CompilationUnit() = default;
+    ~CompilationUnit() override { destroyChildren(); }
+    
+    void addFunction(std::unique_ptr<FunctionDefinition> func) {
+        functions.push_back(std::move(func));
+    }
+    
+    Walk accept(Visitor& visitor) override;
+    void children(std::vector<ASTNode*>& out) const override;
+    
+protected:
+    void printNode(int indent, std::vector<PrintEntry>& next) const override;
+    void releaseChildren(std::vector<std::unique_ptr<ASTNode>>& out) override;
+};
+
+// 访问者模式接口
+// 各 visit 是 Walk 协程，子节点用 co_await child->accept(*this) 访问；
+// 从普通代码开始遍历用 Walk::run(node.accept(visitor))
+class Visitor {
+public:
+    virtual ~Visitor() = default;
+    
+    virtual Walk visit(BinaryExpression& node) = 0;
+    virtual Walk visit(UnaryExpression& node) = 0;
+    virtual Walk visit(NumberLiteral& node) = 0;
+    virtual Walk visit(Identifier& node) = 0;
+    virtual Walk visit(FunctionCall& node) = 0;
+    virtual Walk visit(AssignmentStatement& node) = 0;
+    virtual Walk visit(VariableDeclaration& node) = 0;
+    virtual Walk visit(Block& node) = 0;
+    virtual Walk visit(IfStatement& node) = 0;
+    virtual Walk visit(WhileStatement& node) = 0;
+    virtual Walk visit(BreakStatement& node) = 0;
+    virtual Walk visit(ContinueStatement& node) = 0;
+    virtual Walk visit(ReturnStatement& node) = 0;
+    virtual Walk visit(ExpressionStatement& node) = 0;
+    virtual Walk visit(FunctionDefinition& node) = 0;
+    virtual Walk visit(CompilationUnit& node) = 0;
 };
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include "bench/generators.hpp"
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+// size 个小函数，每个调用前一个，形成一条调用链
+std::string manyFunctions(int size) {
+    std::ostringstream out;
+    for (int k = 0; k < size; ++k) {
+        out << "int f" << k << "(int a, int b) {\n"
+            << "    int x = a + b * " << (k % 97 + 1) << ";\n"
+            << "    if (x > " << k << ") {\n"
+            << "        x = x - b;\n"
+            << "    } else {\n"
+            << "        x = x + 1;\n"
+            << "    }\n"
+            << "    while (x > 100) {\n"
+            << "        x = x / 2;\n"
+            << "    }\n";
+        if (k > 0) {
+            out << "    return x + f" << (k - 1) << "(b, x);\n";
+        } else {
+            out << "    return x;\n";
+        }
+        out << "}\n\n";
+    }
+    out << "int main() {\n"
+        << "    return f" << (size - 1) << "(1, 2);\n"
+        << "}\n";
+    return out.str();
+}
+
+// 深度为 size 的 if / while / 块交替嵌套
+// 缩进封顶，否则输入字节数随深度平方增长，掩盖编译器本身的增长
+std::string deepNesting(int size) {
+    std::ostringstream out;
+    out << "int main() {\n"
+        << "    int x = 0;\n";
+    auto indent = [](int depth) { return std::string(4 + 2 * std::min(depth, 16), ' '); };
+    for (int k = 0; k < size; ++k) {
+        switch (k % 3) {
+            case 0:  out << indent(k) << "if (x < " << (k + 1000) << ") {\n"; break;
+            case 1:  out << indent(k) << "while (x < " << k << ") {\n"; break;
+            default: out << indent(k) << "{\n"; break;
+        }
+        out << indent(k + 1) << "int v" << k << " = x + " << k << ";\n"
+            << indent(k + 1) << "x = v" << k << " - " << (k - 1) << ";\n";
+    }
+    for (int k = size - 1; k >= 0; --k) {
+        out << indent(k) << "}\n";
+    }
+    out << "    return x;\n"
+        << "}\n";
+    return out.str();
+}
+
+// 一条含 size 项的长表达式，混合运算符和括号，操作数均为变量避免被折叠
+std::string longExpression(int size) {
+    static const char* const ops[] = {" + ", " - ", " * ", " + ", " - ", " / "};
+    std::ostringstream out;
+    out << "int main() {\n"
+        << "    int a = 3;\n"
+        << "    int b = 5;\n"
+        << "    int c = 7;\n"
+        << "    int r = a";
+    for (int k = 1; k < size; ++k) {
+        out << ops[k % 6];
+        if (k % 5 == 0) {
+            out << "(b - c * a)";
+        } else {
+            out << (k % 3 == 0 ? "a" : k % 3 == 1 ? "b" : "c");
+        }
+        if (k % 16 == 0) out << "\n        ";
+    }
+    out << ";\n"
+        << "    return r;\n"
+        << "}\n";
+    return out.str();
+}
+
+// 单个函数内 size 条无分支语句，每条引入一个新变量
+std::string straightLine(int size) {
+    std::ostringstream out;
+    out << "int main() {\n"
+        << "    int v0 = 1;\n"
+        << "    int v1 = 2;\n";
+    for (int k = 2; k < size; ++k) {
+        out << "    int v" << k << " = v" << (k - 1) << " * 3 + v" << (k - 2)
+            << " - " << (k % 13) << ";\n";
+        if (k % 4 == 0) {
+            out << "    v" << (k / 2) << " = v" << k << " % 1000;\n";
+        }
+    }
+    out << "    return v" << (size - 1) << ";\n"
+        << "}\n";
+    return out.str();
+}
+
+// 宽调用图：size 个叶子函数，每 8 个叶子由一个中间函数调用，main 调用全部中间函数
+std::string wideCallGraph(int size) {
+    const int fanout = 8;
+    std::ostringstream out;
+    for (int k = 0; k < size; ++k) {
+        out << "int leaf" << k << "(int x) {\n"
+            << "    return x * " << (k % 7 + 2) << " + " << k << ";\n"
+            << "}\n\n";
+    }
+    int mids = (size + fanout - 1) / fanout;
+    for (int m = 0; m < mids; ++m) {
+        out << "int mid" << m << "(int x) {\n"
+            << "    int s = 0;\n";
+        for (int k = m * fanout; k < (m + 1) * fanout && k < size; ++k) {
+            out << "    s = s + leaf" << k << "(x + s);\n";
+        }
+        out << "    return s;\n"
+            << "}\n\n";
+    }
+    out << "int main() {\n"
+        << "    int t = 0;\n";
+    for (int m = 0; m < mids; ++m) {
+        out << "    t = t + mid" << m << "(t);\n";
+    }
+    out << "    return t;\n"
+        << "}\n";
+    return out.str();
+}
+
+} // namespace
+
+const std::vector<BenchGenerator>& benchGenerators() {
+    static const std::vector<BenchGenerator> generators = {
+        {"functions",  "chain of small functions",          1000, manyFunctions},
+        {"nesting",    "deeply nested if/while/blocks",     200,  deepNesting},
+        {"expression", "single long expression chain",      200,  longExpression},
+        {"straight",   "huge straight-line function body",  1000, straightLine},
+        {"callgraph",  "wide call graph (fan-out 8)",       2000, wideCallGraph}
+    };
+    return generators;
+}
+
+const BenchGenerator* findBenchGenerator(const std::string& name) {
+    for (const auto& gen : benchGenerators()) {
+        if (name == gen.name) return &gen;
+    }
+    return nullptr;
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// 合成大输入生成器：size 为规模参数（函数个数、嵌套深度、项数等），
+// 输出总能通过语义分析
+struct BenchGenerator {
+    const char* name;
+    const char* description;
+    int baseSize;                       // 默认规模序列的起点
+    std::string (*generate)(int size);
+};
+
+const std::vector<BenchGenerator>& benchGenerators();
+const BenchGenerator* findBenchGenerator(const std::string& name);
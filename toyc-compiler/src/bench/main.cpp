@@ -0,0 +1,993 @@
+#include <iostream>
+#include <algorithm>
+#include <iomanip>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+#include <random>
+#include <sstream>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "ast/ast.hpp"
+#include "semantic/analyzer.hpp"
+#include "opt/purity.hpp"
+#include "opt/consteval.hpp"
+#include "opt/cse.hpp"
+#include "codegen/riscv.hpp"
+#include "codegen/peephole.hpp"
+#include "codegen/layout.hpp"
+#include "codegen/machine.hpp"
+#include "codegen/scheduler.hpp"
+#include "codegen/encoder.hpp"
+#include "codegen/elf.hpp"
+#include "bench/generators.hpp"
+#include "parser.hpp"
+#include "lexer/token_buffer.hpp"
+#include "parser/pratt_parser.hpp"
+#include "utils/utils.hpp"
+
+extern FILE* yyin;
+extern int yylex();
+extern void yyrestart(FILE* file);
+extern int yyparse();
+extern std::unique_ptr<CompilationUnit> root;
+extern int yylineno;
+
+namespace {
+
+const char* const phaseNames[] = {"lex", "parse", "sema", "opt", "codegen", "backend", "encode"};
+const int PHASES = 7;
+const int ENCODE = 6;
+
+// 子进程通过管道回传的结果，必须是平凡可复制的
+struct BenchResult {
+    bool ok;
+    bool encoded;                   // 汇编能否被编码器接受
+    long tokens;
+    long assemblyLines;
+    double phase[PHASES];           // 毫秒
+    double total;
+    char error[200];
+};
+
+struct BenchRow {
+    std::string generator;
+    int size;
+    long lines;
+    long bytes;
+    BenchResult result;
+    long peakRssKb;
+};
+
+void printUsage(const char* programName) {
+    std::cout << "ToyC Compiler Throughput Benchmark v1.0\n"
+              << "Usage: " << programName << " [options]\n\n"
+              << "Options:\n"
+              << "  --only=<a,b>      Run only the named generators\n"
+              << "  --scale=<f>       Multiply every generator's base size (default: 1)\n"
+              << "  --steps=<n>       Number of doubling sizes per generator (default: 3)\n"
+              << "  --repeat=<n>      Runs per size, fastest is kept (default: 3)\n"
+              << "  --threshold=<e>   Flag scaling exponents above e (default: 1.3)\n"
+              << "  --timeout=<s>     Abandon a size after s seconds (default: 60)\n"
+              << "  --dump=<dir>      Write the generated inputs to <dir>\n"
+              << "  --strict          Exit with status 1 when superlinear scaling is flagged\n"
+              << "  --list            List generators\n"
+              << "  --lexers          Compare Flex and the hand-written lexer (tokens/s, identical streams)\n"
+              << "  --lex-diff[=<n>] [files...]\n"
+              << "                    Check both lexers on n random inputs (default 2000) and the given files\n"
+              << "  --parsers         Compare Bison and the hand-written parser (tokens/s, identical ASTs)\n"
+              << "  --parse-diff[=<n>] [files...]\n"
+              << "                    Check both parsers on n random programs (default 2000) and the given files\n"
+              << "  --help            Show this help\n\n"
+              << "Each size is compiled in a fresh child process so peak RSS is per input.\n";
+}
+
+void failWith(BenchResult& result, const std::string& message) {
+    result.ok = false;
+    std::snprintf(result.error, sizeof(result.error), "%s", message.c_str());
+}
+
+// 在子进程里跑一遍完整流水线（-O1 的 RISC-V 路径 + -c 编码），逐阶段计时
+void compileOnce(const std::string& source, BenchResult& result) {
+    std::memset(&result, 0, sizeof(result));
+    Utils::Timer phaseTimer;
+    Utils::Timer totalTimer;
+
+    // 与编译器默认一样先扫描成词法单元数组，语法分析单独计时
+    totalTimer.start();
+    phaseTimer.start();
+    TokenBuffer tokens;
+    tokens.lex(source);
+    result.tokens = static_cast<long>(tokens.size()) - 1;
+    result.phase[0] = phaseTimer.elapsedMilliseconds();
+
+    yylineno = 1;
+    root.reset();
+    phaseTimer.start();
+    PrattParser parser(tokens);
+    if (!parser.parse(root)) {
+        failWith(result, "parse failed");
+        return;
+    }
+    result.phase[1] = phaseTimer.elapsedMilliseconds();
+
+    phaseTimer.start();
+    SemanticAnalyzer analyzer;
+    if (!analyzer.analyze(*root)) {
+        failWith(result, "semantic analysis failed: " +
+                 (analyzer.getErrors().empty() ? std::string() : analyzer.getErrors()[0]));
+        return;
+    }
+    result.phase[2] = phaseTimer.elapsedMilliseconds();
+
+    phaseTimer.start();
+    PurityAnalyzer purity;
+    purity.analyze(*root);
+    PureCallFolder folder;
+    folder.run(*root, purity);
+    CommonSubexpressionEliminator cse;
+    cse.run(*root);
+    result.phase[3] = phaseTimer.elapsedMilliseconds();
+
+    phaseTimer.start();
+    std::unordered_map<std::string, FunctionInfo> functionTable;
+    for (const auto& func : root->functions) {
+        std::vector<Expression::Type> paramTypes;
+        for (const auto& param : func->parameters) {
+            paramTypes.push_back(param.type);
+        }
+        functionTable.insert_or_assign(func->name, FunctionInfo(func->name, func->returnType, paramTypes, true));
+    }
+    RISCVCodeGenerator generator;
+    std::string assembly = generator.generate(*root, functionTable);
+    result.phase[4] = phaseTimer.elapsedMilliseconds();
+
+    phaseTimer.start();
+    PeepholeOptimizer peephole;
+    assembly = peephole.optimize(assembly);
+    BlockPlacement placement;
+    assembly = placement.place(assembly);
+    InstructionScheduler scheduler(MachineModel::generic());
+    assembly = scheduler.schedule(assembly);
+    result.phase[5] = phaseTimer.elapsedMilliseconds();
+    result.assemblyLines = std::count(assembly.begin(), assembly.end(), '\n');
+
+    phaseTimer.start();
+    RV32Encoder encoder;
+    ObjectCode object;
+    result.encoded = encoder.encode(assembly, object);
+    if (result.encoded) {
+        writeElfObject(object);
+        result.phase[ENCODE] = phaseTimer.elapsedMilliseconds();
+    }
+
+    result.total = totalTimer.elapsedMilliseconds();
+    result.ok = true;
+}
+
+// fork 出子进程编译，返回结果和子进程的峰值常驻内存
+bool compileIsolated(const std::string& source, int timeoutSeconds, BenchResult& result, long& peakRssKb) {
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        alarm(timeoutSeconds);
+        BenchResult child;
+        compileOnce(source, child);
+        ssize_t written = write(fds[1], &child, sizeof(child));
+        // 跳过析构，AST 释放不计入结果
+        _exit(written == static_cast<ssize_t>(sizeof(child)) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    std::memset(&result, 0, sizeof(result));
+    size_t got = 0;
+    while (got < sizeof(result)) {
+        ssize_t n = read(fds[0], reinterpret_cast<char*>(&result) + got, sizeof(result) - got);
+        if (n <= 0) break;
+        got += n;
+    }
+    close(fds[0]);
+
+    int status = 0;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+    peakRssKb = usage.ru_maxrss;
+
+    if (got != sizeof(result)) {
+        std::memset(&result, 0, sizeof(result));
+        if (WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM) {
+            failWith(result, "timed out after " + std::to_string(timeoutSeconds) + " s");
+        } else if (WIFSIGNALED(status)) {
+            failWith(result, std::string("crashed: ") + strsignal(WTERMSIG(status)));
+        } else {
+            failWith(result, "child exited without a result");
+        }
+    }
+    return true;
+}
+
+std::string formatRate(double perSecond) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    if (perSecond >= 1e6) {
+        out << perSecond / 1e6 << "M";
+    } else if (perSecond >= 1e3) {
+        out << perSecond / 1e3 << "K";
+    } else {
+        out << perSecond;
+    }
+    return out.str();
+}
+
+void printRow(const BenchRow& row) {
+    std::cout << std::left << std::setw(11) << row.generator << std::right
+              << std::setw(7) << row.size
+              << std::setw(9) << row.lines
+              << std::setw(9) << row.result.tokens;
+    if (!row.result.ok) {
+        std::cout << "  " << row.result.error << "\n";
+        return;
+    }
+    std::cout << std::fixed << std::setprecision(1);
+    for (int p = 0; p < PHASES; ++p) {
+        if (p == ENCODE && !row.result.encoded) {
+            std::cout << std::setw(9) << "-";
+        } else {
+            std::cout << std::setw(9) << row.result.phase[p];
+        }
+    }
+    double seconds = row.result.total / 1000.0;
+    double lexSeconds = row.result.phase[0] / 1000.0;
+    std::cout << std::setw(10) << row.result.total
+              << std::setw(10) << (seconds > 0 ? formatRate(row.lines / seconds) : "-")
+              << std::setw(10) << (lexSeconds > 0 ? formatRate(row.result.tokens / lexSeconds) : "-")
+              << std::setw(9) << std::setprecision(1) << row.peakRssKb / 1024.0 << "\n";
+}
+
+// 两种扫描器逐个比较的词法单元
+struct LexedToken {
+    int code;
+    int line;
+    std::string text;   // 标识符的文本
+    int value;          // 数字的值
+};
+
+struct LexedStream {
+    std::vector<LexedToken> tokens;
+    std::string diagnostics;    // 扫描器写到 std::cerr 的未知字符提示
+};
+
+std::string describeToken(const LexedToken& token) {
+    std::ostringstream out;
+    out << "token " << token.code << " at line " << token.line;
+    if (token.code == IDENTIFIER) {
+        out << " \"" << token.text << "\"";
+    } else if (token.code == NUMBER) {
+        out << " " << token.value;
+    }
+    return out.str();
+}
+
+// 通过 yylex 取完整的词法单元流，tokens 为空时走 Flex 扫描器
+bool lexAll(const std::string& source, TokenBuffer* tokens, LexedStream& stream) {
+    FILE* input = nullptr;
+    if (tokens) {
+        tokens->lex(source);
+    } else {
+        // fmemopen 不接受长度为0的缓冲区
+        input = source.empty() ? fopen("/dev/null", "r")
+                               : fmemopen(const_cast<char*>(source.data()), source.size(), "r");
+        if (!input) return false;
+        yyin = input;
+        yyrestart(input);
+    }
+
+    std::ostringstream errors;
+    std::streambuf* saved = std::cerr.rdbuf(errors.rdbuf());
+    yylineno = 1;
+    TokenBuffer::setActive(tokens);
+    while (true) {
+        LexedToken token = {yylex(), yylineno, std::string(), 0};
+        if (token.code == IDENTIFIER) {
+            token.text = *yylval.string_val;
+            delete yylval.string_val;
+        } else if (token.code == NUMBER) {
+            token.value = yylval.int_val;
+        }
+        stream.tokens.push_back(token);
+        if (token.code == 0) break;
+    }
+    TokenBuffer::setActive(nullptr);
+    std::cerr.rdbuf(saved);
+    stream.diagnostics = errors.str();
+
+    if (input) fclose(input);
+    return true;
+}
+
+// 第一处差异的描述，完全相同时返回空串
+std::string compareLexers(const std::string& source) {
+    LexedStream flex;
+    LexedStream fast;
+    TokenBuffer tokens;
+    if (!lexAll(source, nullptr, flex) || !lexAll(source, &tokens, fast)) {
+        return "cannot open the input for Flex";
+    }
+
+    size_t count = std::min(flex.tokens.size(), fast.tokens.size());
+    for (size_t i = 0; i < count; ++i) {
+        const LexedToken& a = flex.tokens[i];
+        const LexedToken& b = fast.tokens[i];
+        if (a.code != b.code || a.line != b.line || a.text != b.text || a.value != b.value) {
+            return "token #" + std::to_string(i) + ": flex " + describeToken(a) + ", fast " + describeToken(b);
+        }
+    }
+    if (flex.diagnostics != fast.diagnostics) {
+        return "diagnostics differ\n--- flex\n" + flex.diagnostics + "--- fast\n" + fast.diagnostics;
+    }
+    return std::string();
+}
+
+// 只计数的扫描循环；两种扫描器都经过 yylex（包括标识符字符串的分配），和语法分析器看到的开销一致。
+// 手写扫描器的时间包括填充词法单元数组
+long countTokens(const std::string& source, bool fast, double& milliseconds) {
+    Utils::Timer timer;
+    long tokens = 0;
+    FILE* input = nullptr;
+    TokenBuffer buffer;
+    if (fast) {
+        buffer.lex(source);
+    } else {
+        input = fmemopen(const_cast<char*>(source.data()), source.size(), "r");
+        if (!input) return -1;
+        yyin = input;
+        yyrestart(input);
+    }
+    yylineno = 1;
+    TokenBuffer::setActive(fast ? &buffer : nullptr);
+    int code;
+    while ((code = yylex()) != 0) {
+        if (code == IDENTIFIER) delete yylval.string_val;
+        tokens++;
+    }
+    TokenBuffer::setActive(nullptr);
+    milliseconds = timer.elapsedMilliseconds();
+    if (input) fclose(input);
+    return tokens;
+}
+
+// --lexers：在各生成器的最大规模上比较两种扫描器的吞吐量，并检查词法单元流一致
+int benchLexers(const std::vector<const BenchGenerator*>& selected, double scale, int steps, int repeat) {
+    std::cout << "=== Lexer comparison (fastest of " << repeat << ") ===\n"
+              << std::left << std::setw(11) << "generator" << std::right
+              << std::setw(8) << "size" << std::setw(10) << "tokens"
+              << std::setw(10) << "flex ms" << std::setw(10) << "fast ms"
+              << std::setw(11) << "flex tok/s" << std::setw(11) << "fast tok/s"
+              << std::setw(9) << "speedup" << "\n";
+
+    bool mismatch = false;
+    for (const BenchGenerator* gen : selected) {
+        int size = std::max(1, static_cast<int>(gen->baseSize * scale)) << (steps - 1);
+        std::string source = gen->generate(size);
+
+        double flexMs = 0;
+        double fastMs = 0;
+        long tokens = 0;
+        for (int run = 0; run < repeat; ++run) {
+            double a = 0;
+            double b = 0;
+            tokens = countTokens(source, false, a);
+            countTokens(source, true, b);
+            flexMs = run == 0 ? a : std::min(flexMs, a);
+            fastMs = run == 0 ? b : std::min(fastMs, b);
+        }
+
+        std::cout << std::left << std::setw(11) << gen->name << std::right
+                  << std::setw(8) << size << std::setw(10) << tokens
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(10) << flexMs << std::setw(10) << fastMs
+                  << std::setw(11) << (flexMs > 0 ? formatRate(tokens / (flexMs / 1000.0)) : "-")
+                  << std::setw(11) << (fastMs > 0 ? formatRate(tokens / (fastMs / 1000.0)) : "-")
+                  << std::setw(8) << std::setprecision(1) << (fastMs > 0 ? flexMs / fastMs : 0.0) << "x\n";
+
+        std::string difference = compareLexers(source);
+        if (!difference.empty()) {
+            std::cout << "  MISMATCH: " << difference << "\n";
+            mismatch = true;
+        }
+    }
+    return mismatch ? 1 : 0;
+}
+
+// 随机拼接的词法单元片段：关键字前缀、带符号和前导零的数字、单独的 & |、
+// 各种注释、未知字符，以及跨过多个 SIMD 宽度的长标识符、空白和注释
+std::string randomLexInput(std::mt19937& rng) {
+    static const char* const pieces[] = {
+        "int", "void", "if", "else", "while", "break", "continue", "return",
+        "integer", "iff", "elsewhere", "returns", "_while", "Int", "i", "x1", "_",
+        "0", "7", "007", "42", "-5", "-0", "--1", "2147483647", "-2147483648", "99999999999",
+        "+", "-", "*", "/", "%", "=", "==", "!", "!=", "<", "<=", ">", ">=", "&&", "||", "&", "|",
+        "(", ")", "{", "}", ",", ";",
+        " ", "\t", "\r\n", "\n", "\n\n",
+        "// comment */ x\n", "//", "/* a */", "/* * / ** \n * */", "/**/", "/***/", "/*\n\n*/",
+        "@", "#", "$", "`", "\\", "\x7f", "\xe4\xbd\xa0", "\v", "\f", "'", "\"", ".", "[", "]",
+    };
+    const size_t pieceCount = sizeof(pieces) / sizeof(pieces[0]);
+    static const char identChars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_";
+    static const char spaceChars[] = " \t\r\n";
+    // 注释里的 '\0' 会让 lexer.l 的 yyinput 循环提前结束注释
+    static const char commentChars[] = {'a', ' ', '*', '\n', '/', '\0'};
+
+    std::string out;
+    int length = std::uniform_int_distribution<int>(0, 200)(rng);
+    for (int i = 0; i < length; ++i) {
+        int kind = std::uniform_int_distribution<int>(0, 19)(rng);
+        if (kind == 0) {
+            int n = std::uniform_int_distribution<int>(1, 90)(rng);
+            out += identChars[rng() % 52];
+            for (int k = 1; k < n; ++k) out += identChars[rng() % (sizeof(identChars) - 1)];
+        } else if (kind == 1) {
+            int n = std::uniform_int_distribution<int>(1, 90)(rng);
+            for (int k = 0; k < n; ++k) out += spaceChars[rng() % 4];
+        } else if (kind == 2) {
+            int n = std::uniform_int_distribution<int>(0, 90)(rng);
+            out += "/*";
+            for (int k = 0; k < n; ++k) out += commentChars[rng() % sizeof(commentChars)];
+            out += "*/";
+        } else {
+            out += pieces[rng() % pieceCount];
+        }
+        if (rng() % 2) out += ' ';
+    }
+    // 片段拼接可能意外打开 /* 注释，这里保证它闭合
+    out += "\n*/";
+    return out;
+}
+
+// --lex-diff：随机输入和给定文件上两种扫描器的词法单元流必须完全一致
+int lexDiff(int count, const std::vector<std::string>& files) {
+    std::mt19937 rng(12345);
+    for (int i = 0; i < count; ++i) {
+        std::string source = randomLexInput(rng);
+        std::string difference = compareLexers(source);
+        if (!difference.empty()) {
+            std::cout << "Lexer mismatch on random input #" << i << ": " << difference << "\n"
+                      << "--- input\n" << source << "\n";
+            return 1;
+        }
+    }
+    for (const auto& file : files) {
+        std::string source;
+        try {
+            source = Utils::readFile(file);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        std::string difference = compareLexers(source);
+        if (!difference.empty()) {
+            std::cout << "Lexer mismatch on " << file << ": " << difference << "\n";
+            return 1;
+        }
+    }
+    std::cout << "Lexers agree on " << count << " random inputs and " << files.size() << " files\n";
+    return 0;
+}
+
+// 一次语法分析的可比较结果：AST 的打印输出和写到 std::cerr 的内容
+struct ParseOutcome {
+    bool ok;
+    std::string ast;
+    std::string diagnostics;
+};
+
+ParseOutcome parseWith(TokenBuffer& tokens, bool pratt) {
+    ParseOutcome outcome;
+    std::ostringstream out;
+    std::ostringstream errors;
+    std::streambuf* savedOut = std::cout.rdbuf(out.rdbuf());
+    std::streambuf* savedErr = std::cerr.rdbuf(errors.rdbuf());
+
+    root.reset();
+    yylineno = 1;
+    if (pratt) {
+        PrattParser parser(tokens);
+        outcome.ok = parser.parse(root);
+        if (!outcome.ok) std::cerr << parser.getError() << std::endl;
+    } else {
+        tokens.rewind();
+        TokenBuffer::setActive(&tokens);
+        outcome.ok = yyparse() == 0 && root;
+        TokenBuffer::setActive(nullptr);
+    }
+    if (outcome.ok) root->print();
+    root.reset();
+
+    std::cout.rdbuf(savedOut);
+    std::cerr.rdbuf(savedErr);
+    outcome.ast = out.str();
+    outcome.diagnostics = errors.str();
+    return outcome;
+}
+
+// 第一处差异的描述，完全相同时返回空串；accepted 为 Bison 是否接受这个输入
+std::string compareParsers(const std::string& source, bool& accepted) {
+    TokenBuffer tokens;
+    tokens.lex(source);
+    ParseOutcome bison = parseWith(tokens, false);
+    ParseOutcome pratt = parseWith(tokens, true);
+    accepted = bison.ok;
+    if (bison.ok != pratt.ok) {
+        return std::string("bison ") + (bison.ok ? "accepts" : "rejects") + ", pratt " +
+               (pratt.ok ? "accepts" : "rejects") + "\n--- bison\n" + bison.diagnostics + "--- pratt\n" +
+               pratt.diagnostics;
+    }
+    if (bison.diagnostics != pratt.diagnostics) {
+        return "diagnostics differ\n--- bison\n" + bison.diagnostics + "--- pratt\n" + pratt.diagnostics;
+    }
+    if (bison.ast != pratt.ast) {
+        size_t at = std::mismatch(bison.ast.begin(), bison.ast.end(), pratt.ast.begin(), pratt.ast.end()).first -
+                    bison.ast.begin();
+        size_t line = std::count(bison.ast.begin(), bison.ast.begin() + at, '\n') + 1;
+        return "--ast output differs at line " + std::to_string(line);
+    }
+    return std::string();
+}
+
+// 按文法随机生成的程序（词法单元序列）：覆盖所有语句形式、悬空 else、
+// 连续的前缀运算符、各级优先级混合和嵌套调用
+class RandomProgram {
+private:
+    std::mt19937& rng;
+    std::vector<std::string> out;
+
+    int choose(int n) { return static_cast<int>(rng() % n); }
+
+    void expression(int depth) {
+        static const char* const binary[] = {"||", "&&", "<", "<=", ">", ">=", "==", "!=", "+", "-", "*", "/", "%"};
+        static const char* const unary[] = {"+", "-", "!"};
+        static const char* const names[] = {"a", "b", "x", "f"};
+        switch (depth > 4 ? choose(2) : choose(8)) {
+            case 0:
+                out.push_back(names[choose(4)]);
+                break;
+            case 1:
+                out.push_back(choose(8) ? std::to_string(choose(100)) : "-3");
+                break;
+            case 2:
+                out.push_back(unary[choose(3)]);
+                expression(depth + 1);
+                break;
+            case 3:
+            case 4:
+            case 5:
+                expression(depth + 1);
+                out.push_back(binary[choose(13)]);
+                expression(depth + 1);
+                break;
+            case 6:
+                out.push_back("(");
+                expression(depth + 1);
+                out.push_back(")");
+                break;
+            default: {
+                out.push_back(names[choose(4)]);
+                out.push_back("(");
+                int count = choose(4);
+                for (int i = 0; i < count; ++i) {
+                    if (i > 0) out.push_back(",");
+                    expression(depth + 1);
+                }
+                out.push_back(")");
+                break;
+            }
+        }
+    }
+
+    void statement(int depth) {
+        switch (depth > 3 ? 2 + choose(8) : choose(12)) {
+            case 0:
+            case 1:
+                block(depth + 1);
+                break;
+            case 2:
+                out.push_back(";");
+                break;
+            case 3:
+                expression(0);
+                out.push_back(";");
+                break;
+            case 4:
+                out.insert(out.end(), {"x", "="});
+                expression(0);
+                out.push_back(";");
+                break;
+            case 5:
+                out.insert(out.end(), {"int", "y", "="});
+                expression(0);
+                out.push_back(";");
+                break;
+            case 6:
+                out.push_back(choose(2) ? "break" : "continue");
+                out.push_back(";");
+                break;
+            case 7:
+                out.push_back("return");
+                if (choose(3)) expression(0);
+                out.push_back(";");
+                break;
+            case 8:
+            case 9:
+                out.insert(out.end(), {"if", "("});
+                expression(0);
+                out.push_back(")");
+                statement(depth + 1);
+                if (choose(2)) {
+                    out.push_back("else");
+                    statement(depth + 1);
+                }
+                break;
+            default:
+                out.insert(out.end(), {"while", "("});
+                expression(0);
+                out.push_back(")");
+                statement(depth + 1);
+                break;
+        }
+    }
+
+    void block(int depth) {
+        out.push_back("{");
+        int count = choose(5);
+        for (int i = 0; i < count; ++i) statement(depth);
+        out.push_back("}");
+    }
+
+public:
+    explicit RandomProgram(std::mt19937& rng) : rng(rng) {}
+
+    // mutate 时随机删除、复制、交换或插入几个词法单元，用来比较两者的出错位置
+    std::string generate(bool mutate) {
+        static const char* const extra[] = {"int", "void", "(", ")", "{", "}", ",", ";", "=", "else", "@", "x", "1"};
+        out.clear();
+        int functions = 1 + choose(3);
+        for (int f = 0; f < functions; ++f) {
+            out.push_back(choose(2) ? "int" : "void");
+            out.push_back("f" + std::to_string(f));
+            out.push_back("(");
+            int params = choose(3);
+            for (int i = 0; i < params; ++i) {
+                if (i > 0) out.push_back(",");
+                out.insert(out.end(), {"int", "p" + std::to_string(i)});
+            }
+            out.push_back(")");
+            block(0);
+        }
+
+        int mutations = mutate ? 1 + choose(2) : 0;
+        for (int m = 0; m < mutations; ++m) {
+            size_t at = rng() % out.size();
+            switch (choose(4)) {
+                case 0:
+                    out.erase(out.begin() + at);
+                    break;
+                case 1:
+                    out.insert(out.begin() + at, out[at]);
+                    break;
+                case 2:
+                    if (at + 1 < out.size()) std::swap(out[at], out[at + 1]);
+                    break;
+                default:
+                    out.insert(out.begin() + at, extra[choose(13)]);
+                    break;
+            }
+            if (out.empty()) break;
+        }
+
+        std::string source;
+        for (const auto& token : out) {
+            source += token;
+            source += choose(8) ? ' ' : '\n';
+        }
+        return source;
+    }
+};
+
+// --parse-diff：随机程序（一半带有语法错误）和给定文件上两个语法分析器的结果必须一致
+int parseDiff(int count, const std::vector<std::string>& files) {
+    std::mt19937 rng(54321);
+    RandomProgram generator(rng);
+    int rejected = 0;
+    for (int i = 0; i < count; ++i) {
+        std::string source = generator.generate(i % 2 == 1);
+        bool accepted;
+        std::string difference = compareParsers(source, accepted);
+        if (!difference.empty()) {
+            std::cout << "Parser mismatch on random program #" << i << ": " << difference << "\n"
+                      << "--- input\n" << source << "\n";
+            return 1;
+        }
+        rejected += accepted ? 0 : 1;
+    }
+    for (const auto& file : files) {
+        std::string source;
+        try {
+            source = Utils::readFile(file);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        bool accepted;
+        std::string difference = compareParsers(source, accepted);
+        if (!difference.empty()) {
+            std::cout << "Parser mismatch on " << file << ": " << difference << "\n";
+            return 1;
+        }
+    }
+    std::cout << "Parsers agree on " << count << " random programs (" << rejected << " with syntax errors) and "
+              << files.size() << " files\n";
+    return 0;
+}
+
+// --parsers：在各生成器的最大规模上比较 Bison 与手写语法分析器的吞吐量（不含词法分析和 AST 释放）
+int benchParsers(const std::vector<const BenchGenerator*>& selected, double scale, int steps, int repeat) {
+    std::cout << "=== Parser comparison (fastest of " << repeat << ") ===\n"
+              << std::left << std::setw(11) << "generator" << std::right
+              << std::setw(8) << "size" << std::setw(10) << "tokens"
+              << std::setw(10) << "bison ms" << std::setw(10) << "pratt ms"
+              << std::setw(12) << "bison tok/s" << std::setw(12) << "pratt tok/s"
+              << std::setw(9) << "speedup" << "\n";
+
+    bool mismatch = false;
+    for (const BenchGenerator* gen : selected) {
+        int size = std::max(1, static_cast<int>(gen->baseSize * scale)) << (steps - 1);
+        std::string source = gen->generate(size);
+        TokenBuffer tokens;
+        tokens.lex(source);
+        long count = static_cast<long>(tokens.size()) - 1;
+
+        double bisonMs = 0;
+        double prattMs = 0;
+        for (int run = 0; run < repeat; ++run) {
+            Utils::Timer timer;
+            tokens.rewind();
+            yylineno = 1;
+            TokenBuffer::setActive(&tokens);
+            yyparse();
+            TokenBuffer::setActive(nullptr);
+            double a = timer.elapsedMilliseconds();
+            root.reset();
+
+            timer.start();
+            PrattParser parser(tokens);
+            parser.parse(root);
+            double b = timer.elapsedMilliseconds();
+            root.reset();
+
+            bisonMs = run == 0 ? a : std::min(bisonMs, a);
+            prattMs = run == 0 ? b : std::min(prattMs, b);
+        }
+
+        std::cout << std::left << std::setw(11) << gen->name << std::right
+                  << std::setw(8) << size << std::setw(10) << count
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(10) << bisonMs << std::setw(10) << prattMs
+                  << std::setw(12) << (bisonMs > 0 ? formatRate(count / (bisonMs / 1000.0)) : "-")
+                  << std::setw(12) << (prattMs > 0 ? formatRate(count / (prattMs / 1000.0)) : "-")
+                  << std::setw(8) << std::setprecision(1) << (prattMs > 0 ? bisonMs / prattMs : 0.0) << "x\n";
+
+        bool accepted;
+        std::string difference = compareParsers(source, accepted);
+        if (!difference.empty()) {
+            std::cout << "  MISMATCH: " << difference << "\n";
+            mismatch = true;
+        }
+    }
+    return mismatch ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> only;
+    double scale = 1.0;
+    int steps = 3;
+    int repeat = 3;
+    double threshold = 1.3;
+    int timeoutSeconds = 60;
+    std::string dumpDir;
+    bool strict = false;
+    bool lexers = false;
+    int lexDiffCount = -1;
+    bool parsers = false;
+    int parseDiffCount = -1;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg.compare(0, 7, "--only=") == 0) {
+            only = Utils::split(arg.substr(7), ',');
+        } else if (arg.compare(0, 8, "--scale=") == 0) {
+            scale = std::atof(arg.c_str() + 8);
+        } else if (arg.compare(0, 8, "--steps=") == 0) {
+            steps = std::max(1, std::atoi(arg.c_str() + 8));
+        } else if (arg.compare(0, 9, "--repeat=") == 0) {
+            repeat = std::max(1, std::atoi(arg.c_str() + 9));
+        } else if (arg.compare(0, 12, "--threshold=") == 0) {
+            threshold = std::atof(arg.c_str() + 12);
+        } else if (arg.compare(0, 10, "--timeout=") == 0) {
+            timeoutSeconds = std::max(1, std::atoi(arg.c_str() + 10));
+        } else if (arg.compare(0, 7, "--dump=") == 0) {
+            dumpDir = arg.substr(7);
+        } else if (arg == "--strict") {
+            strict = true;
+        } else if (arg == "--lexers") {
+            lexers = true;
+        } else if (arg == "--parsers") {
+            parsers = true;
+        } else if (arg == "--parse-diff") {
+            parseDiffCount = 2000;
+        } else if (arg.compare(0, 13, "--parse-diff=") == 0) {
+            parseDiffCount = std::max(0, std::atoi(arg.c_str() + 13));
+        } else if (arg == "--lex-diff") {
+            lexDiffCount = 2000;
+        } else if (arg.compare(0, 11, "--lex-diff=") == 0) {
+            lexDiffCount = std::max(0, std::atoi(arg.c_str() + 11));
+        } else if (arg == "--list") {
+            for (const auto& gen : benchGenerators()) {
+                std::cout << std::left << std::setw(12) << gen.name << gen.description
+                          << " (base size " << gen.baseSize << ")\n";
+            }
+            return 0;
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg[0] != '-' && (lexDiffCount >= 0 || parseDiffCount >= 0)) {
+            files.push_back(arg);
+        } else {
+            std::cerr << "Error: Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (lexDiffCount >= 0 || parseDiffCount >= 0) {
+        int status = lexDiffCount >= 0 ? lexDiff(lexDiffCount, files) : 0;
+        if (status == 0 && parseDiffCount >= 0) status = parseDiff(parseDiffCount, files);
+        return status;
+    }
+
+    std::vector<const BenchGenerator*> selected;
+    if (only.empty()) {
+        for (const auto& gen : benchGenerators()) selected.push_back(&gen);
+    } else {
+        for (const auto& name : only) {
+            const BenchGenerator* gen = findBenchGenerator(Utils::trim(name));
+            if (!gen) {
+                std::cerr << "Error: Unknown generator: " << name << std::endl;
+                return 1;
+            }
+            selected.push_back(gen);
+        }
+    }
+
+    if (lexers || parsers) {
+        int status = lexers ? benchLexers(selected, scale, steps, repeat) : 0;
+        if (parsers) status |= benchParsers(selected, scale, steps, repeat);
+        return status;
+    }
+
+    // --dump 的目录不存在时创建（只建最后一级）
+    if (!dumpDir.empty() && mkdir(dumpDir.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::cerr << "Error: Cannot create dump directory: " << dumpDir << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    std::cout << "=== ToyC Compiler Benchmark ===\n"
+              << "Times in ms (fastest of " << repeat << "), lines/s over the whole pipeline, "
+              << "tokens/s for the lexer, RSS in MiB\n\n"
+              << std::left << std::setw(11) << "generator" << std::right
+              << std::setw(7) << "size" << std::setw(9) << "lines" << std::setw(9) << "tokens";
+    for (const char* name : phaseNames) std::cout << std::setw(9) << name;
+    std::cout << std::setw(10) << "total" << std::setw(10) << "lines/s"
+              << std::setw(10) << "tokens/s" << std::setw(9) << "RSS" << "\n";
+
+    std::vector<std::string> flagged;
+    for (const BenchGenerator* gen : selected) {
+        std::vector<BenchRow> rows;
+        int size = std::max(1, static_cast<int>(gen->baseSize * scale));
+        for (int step = 0; step < steps; ++step, size *= 2) {
+            std::string source = gen->generate(size);
+            if (!dumpDir.empty()) {
+                std::string path = Utils::joinPath(dumpDir, std::string(gen->name) + "_" + std::to_string(size) + ".tc");
+                if (!Utils::writeFile(path, source)) {
+                    std::cerr << "Error: Cannot write to output file: " << path << std::endl;
+                    return 1;
+                }
+            }
+
+            BenchRow row;
+            row.generator = gen->name;
+            row.size = size;
+            row.lines = std::count(source.begin(), source.end(), '\n');
+            row.bytes = source.size();
+            row.peakRssKb = 0;
+
+            // 每个阶段取多次运行中的最小值
+            for (int run = 0; run < repeat; ++run) {
+                BenchResult result;
+                long rss = 0;
+                if (!compileIsolated(source, timeoutSeconds, result, rss)) {
+                    std::cerr << "Error: fork failed" << std::endl;
+                    return 1;
+                }
+                if (run == 0 || !result.ok) {
+                    row.result = result;
+                    row.peakRssKb = rss;
+                    if (!result.ok) break;
+                    continue;
+                }
+                for (int p = 0; p < PHASES; ++p) {
+                    row.result.phase[p] = std::min(row.result.phase[p], result.phase[p]);
+                }
+                row.result.total = std::min(row.result.total, result.total);
+                row.peakRssKb = std::min(row.peakRssKb, rss);
+            }
+            printRow(row);
+            rows.push_back(row);
+            // 失败（超时、崩溃）后更大的规模没有意义
+            if (!row.result.ok) {
+                flagged.push_back(std::string(gen->name) + " " + std::to_string(size) + ": " + row.result.error);
+                break;
+            }
+        }
+
+        // 相邻规模间的增长指数：time ~ tokens^e
+        for (size_t i = 1; i < rows.size(); ++i) {
+            const BenchRow& a = rows[i - 1];
+            const BenchRow& b = rows[i];
+            if (!a.result.ok || !b.result.ok || b.result.tokens <= a.result.tokens) continue;
+            double growth = std::log(static_cast<double>(b.result.tokens) / a.result.tokens);
+            for (int p = 0; p <= PHASES; ++p) {
+                double before = p < PHASES ? a.result.phase[p] : a.result.total;
+                double after = p < PHASES ? b.result.phase[p] : b.result.total;
+                // 低于 1ms 的阶段噪声太大，不参与判断
+                if (before < 1.0 || after <= before) continue;
+                double exponent = std::log(after / before) / growth;
+                if (exponent > threshold) {
+                    std::ostringstream note;
+                    note << std::fixed << std::setprecision(2) << gen->name << " "
+                         << (p < PHASES ? phaseNames[p] : "total") << ": " << a.size << " -> " << b.size
+                         << " grows as n^" << exponent << " (" << before << " -> " << after << " ms)";
+                    flagged.push_back(note.str());
+                }
+            }
+        }
+    }
+
+    std::cout << "\n";
+    if (flagged.empty()) {
+        std::cout << "No superlinear scaling above n^" << threshold << "\n";
+        return 0;
+    }
+    std::cout << "SUPERLINEAR scaling (exponent > " << threshold << ") or failures:\n";
+    for (const auto& note : flagged) {
+        std::cout << "  " << note << "\n";
+    }
+    return strict ? 1 : 0;
+}
@@ -0,0 +1,332 @@
+#include "cache/cache.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef TOYC_VERSION
+#define TOYC_VERSION "1.0"
+#endif
+
+namespace {
+
+// 条目头：8字节魔数 + 8字节小端长度，用来识别被截断或不相关的文件
+const char entryMagic[8] = {'t', 'o', 'y', 'c', 'c', 'a', 'c', '1'};
+const size_t headerSize = 16;
+
+bool makeDirectories(const std::string& path) {
+    for (size_t pos = 1; pos <= path.size(); ++pos) {
+        if (pos != path.size() && path[pos] != '/') continue;
+        std::string prefix = path.substr(0, pos);
+        if (mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST) return false;
+    }
+    return true;
+}
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+// 查找计数：每次查找向计数文件追加一个字节，文件长度就是尚未汇总的次数。
+// 追加时持共享锁，汇总时持排他锁取走长度并截断，追加不会丢失也不会重复计入
+void appendCount(const std::string& path) {
+    int fd = open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (fd < 0) return;
+    flock(fd, LOCK_SH);
+    writeAll(fd, "+", 1);
+    close(fd);
+}
+
+long takeCount(const std::string& path) {
+    int fd = open(path.c_str(), O_RDWR);
+    if (fd < 0) return 0;
+    flock(fd, LOCK_EX);
+    struct stat st;
+    long count = fstat(fd, &st) == 0 ? static_cast<long>(st.st_size) : 0;
+    if (count > 0 && ftruncate(fd, 0) != 0) count = 0;
+    close(fd);
+    return count;
+}
+
+long pendingCount(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? static_cast<long>(st.st_size) : 0;
+}
+
+// 统计文件的文本格式：每行 "<名字> <值>"
+CompileCache::Counters parseCounters(const std::string& text) {
+    CompileCache::Counters counters;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string::npos) end = text.size();
+        std::string line = text.substr(pos, end - pos);
+        pos = end + 1;
+
+        size_t space = line.find(' ');
+        if (space == std::string::npos) continue;
+        std::string name = line.substr(0, space);
+        long long value = std::atoll(line.c_str() + space + 1);
+        if (name == "hits") counters.hits = value;
+        else if (name == "misses") counters.misses = value;
+        else if (name == "stores") counters.stores = value;
+        else if (name == "evictions") counters.evictions = value;
+        else if (name == "bytes") counters.bytes = value;
+    }
+    return counters;
+}
+
+std::string readAll(int fd) {
+    std::string text;
+    char buffer[512];
+    ssize_t n;
+    while ((n = pread(fd, buffer, sizeof(buffer), text.size())) > 0) {
+        text.append(buffer, n);
+    }
+    return text;
+}
+
+struct CacheEntry {
+    std::string path;
+    uint64_t size;
+    struct timespec used;
+};
+
+} // namespace
+
+bool readWholeFile(const std::string& path, std::string& data) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+
+    data.resize(static_cast<size_t>(st.st_size));
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t n = read(fd, &data[done], data.size() - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        done += n;
+    }
+    close(fd);
+    data.resize(done);
+    return done == static_cast<size_t>(st.st_size);
+}
+
+CompileCache::CompileCache(const std::string& dir, uint64_t maxBytes)
+    : dir(dir), maxBytes(maxBytes) {}
+
+std::string CompileCache::defaultDirectory() {
+    if (const char* env = std::getenv("TOYC_CACHE_DIR")) {
+        if (*env) return env;
+    }
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME")) {
+        if (*xdg) return std::string(xdg) + "/toyc";
+    }
+    if (const char* home = std::getenv("HOME")) {
+        if (*home) return std::string(home) + "/.cache/toyc";
+    }
+    return ".toyc-cache";
+}
+
+std::string CompileCache::compilerIdentity() {
+    std::string identity = "toyc " TOYC_VERSION;
+    struct stat st;
+    if (stat("/proc/self/exe", &st) == 0) {
+        identity += " " + std::to_string(st.st_size) + " " + std::to_string(st.st_mtim.tv_sec) +
+                    "." + std::to_string(st.st_mtim.tv_nsec);
+    } else {
+        identity += " " __DATE__ " " __TIME__;
+    }
+    return identity;
+}
+
+std::string CompileCache::makeKey(const std::string& source, const std::string& config) {
+    // 配置的哈希作为源码哈希的种子，避免拼接时复制整份源码
+    Hash128 seed = hash128(compilerIdentity() + '\0' + config);
+    return hash128(source, seed).hex();
+}
+
+std::string CompileCache::entryPath(const std::string& key) const {
+    return dir + "/" + key.substr(0, 2) + "/" + key;
+}
+
+bool CompileCache::lookup(const std::string& key, std::string& data) {
+    std::string path = entryPath(key);
+    std::string raw;
+    bool hit = readWholeFile(path, raw) && raw.size() >= headerSize &&
+               std::memcmp(raw.data(), entryMagic, sizeof(entryMagic)) == 0;
+    if (hit) {
+        uint64_t length = 0;
+        for (int i = 7; i >= 0; --i) {
+            length = (length << 8) | static_cast<unsigned char>(raw[8 + i]);
+        }
+        hit = length == raw.size() - headerSize;
+    }
+
+    if (hit) {
+        data.assign(raw, headerSize, std::string::npos);
+        // 刷新使用时间，淘汰时按它排序
+        utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+    } else {
+        // 目录不存在时计数文件也建不起来
+        makeDirectories(dir);
+    }
+    // 查找路径上只追加计数，不锁也不重写统计文件；下次写入条目时汇总
+    appendCount(dir + (hit ? "/hits.pending" : "/misses.pending"));
+    return hit;
+}
+
+bool CompileCache::store(const std::string& key, const std::string& data) {
+    std::string path = entryPath(key);
+    std::string subdir = path.substr(0, path.find_last_of('/'));
+    if (!makeDirectories(subdir)) {
+        error = "Cannot create cache directory: " + subdir;
+        return false;
+    }
+
+    // 先写临时文件（以'.'开头，淘汰扫描时跳过），再原子地rename到位
+    std::string temp = subdir + "/.tmp." + std::to_string(getpid()) + "." + key;
+    int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        error = "Cannot write cache entry: " + temp;
+        return false;
+    }
+
+    char header[headerSize];
+    std::memcpy(header, entryMagic, sizeof(entryMagic));
+    uint64_t length = data.size();
+    for (int i = 0; i < 8; ++i) {
+        header[8 + i] = static_cast<char>((length >> (8 * i)) & 0xff);
+    }
+    bool ok = writeAll(fd, header, headerSize) && writeAll(fd, data.data(), data.size());
+    ok = close(fd) == 0 && ok;
+
+    struct stat old;
+    int64_t replaced = stat(path.c_str(), &old) == 0 ? old.st_size : 0;
+    if (!ok || rename(temp.c_str(), path.c_str()) != 0) {
+        unlink(temp.c_str());
+        error = "Cannot write cache entry: " + path;
+        return false;
+    }
+
+    return updateStats(1, static_cast<int64_t>(headerSize + data.size()) - replaced);
+}
+
+void CompileCache::refreshTotals() {
+    std::string path = dir + "/stats";
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        flock(fd, LOCK_SH);
+        totals = parseCounters(readAll(fd));
+    } else {
+        totals = Counters();
+    }
+    totals.hits += pendingCount(dir + "/hits.pending");
+    totals.misses += pendingCount(dir + "/misses.pending");
+    if (fd >= 0) close(fd);
+}
+
+bool CompileCache::updateStats(long stores, int64_t bytes) {
+    if (!makeDirectories(dir)) {
+        error = "Cannot create cache directory: " + dir;
+        return false;
+    }
+
+    std::string path = dir + "/stats";
+    int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        error = "Cannot open cache statistics: " + path;
+        return false;
+    }
+    flock(fd, LOCK_EX);
+
+    Counters current = parseCounters(readAll(fd));
+    current.hits += takeCount(dir + "/hits.pending");
+    current.misses += takeCount(dir + "/misses.pending");
+    current.stores += stores;
+    if (bytes < 0 && static_cast<uint64_t>(-bytes) > current.bytes) {
+        current.bytes = 0;
+    } else {
+        current.bytes += bytes;
+    }
+    totals = current;
+
+    if (totals.bytes > maxBytes) {
+        evict(maxBytes / 10 * 9);
+    }
+
+    std::string out = "hits " + std::to_string(totals.hits) + "\n" +
+                      "misses " + std::to_string(totals.misses) + "\n" +
+                      "stores " + std::to_string(totals.stores) + "\n" +
+                      "evictions " + std::to_string(totals.evictions) + "\n" +
+                      "bytes " + std::to_string(totals.bytes) + "\n";
+    bool ok = ftruncate(fd, 0) == 0 && pwrite(fd, out.data(), out.size(), 0) == static_cast<ssize_t>(out.size());
+
+    flock(fd, LOCK_UN);
+    close(fd);
+    if (!ok) error = "Cannot update cache statistics: " + path;
+    return ok;
+}
+
+// 在统计锁内调用：扫描全部条目，从最久未用的开始删除直到不超过target，
+// 并用扫描结果校正累计大小
+void CompileCache::evict(uint64_t target) {
+    std::vector<CacheEntry> entries;
+    uint64_t total = 0;
+
+    DIR* top = opendir(dir.c_str());
+    if (!top) return;
+    while (struct dirent* sub = readdir(top)) {
+        if (sub->d_name[0] == '.' || std::strlen(sub->d_name) != 2) continue;
+        std::string subdir = dir + "/" + sub->d_name;
+        DIR* d = opendir(subdir.c_str());
+        if (!d) continue;
+        while (struct dirent* ent = readdir(d)) {
+            if (ent->d_name[0] == '.') continue;
+            CacheEntry entry;
+            entry.path = subdir + "/" + ent->d_name;
+            struct stat st;
+            if (stat(entry.path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) continue;
+            entry.size = st.st_size;
+            entry.used = st.st_mtim;
+            total += entry.size;
+            entries.push_back(std::move(entry));
+        }
+        closedir(d);
+    }
+    closedir(top);
+
+    std::sort(entries.begin(), entries.end(), [](const CacheEntry& a, const CacheEntry& b) {
+        if (a.used.tv_sec != b.used.tv_sec) return a.used.tv_sec < b.used.tv_sec;
+        return a.used.tv_nsec < b.used.tv_nsec;
+    });
+
+    for (const auto& entry : entries) {
+        if (total <= target) break;
+        if (unlink(entry.path.c_str()) == 0) {
+            total -= entry.size;
+            totals.evictions++;
+        }
+    }
+    totals.bytes = total;
+}
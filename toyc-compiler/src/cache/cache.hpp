@@ -0,0 +1,55 @@
+#pragma once
+#include "cache/hash.hpp"
+#include <cstdint>
+#include <string>
+
+// 内容寻址的编译结果缓存
+// 键是源码、编译器版本和影响输出的选项的哈希；条目按键的前两位分目录存放：
+//   <dir>/ab/<32位十六进制键>
+// 写入先落到同目录的临时文件再 rename，读者只会看到完整条目；
+// 总大小超过上限时按最近使用时间（mtime，命中时刷新）淘汰到上限的 90%。
+class CompileCache {
+public:
+    // 累计计数，保存在 <dir>/stats 中，多个进程通过 flock 互斥更新。
+    // 查找次数先追加到 hits.pending / misses.pending，写入条目时才汇总进 stats
+    struct Counters {
+        long hits = 0;
+        long misses = 0;
+        long stores = 0;
+        long evictions = 0;
+        uint64_t bytes = 0;
+    };
+
+private:
+    std::string dir;
+    uint64_t maxBytes;
+    Counters totals;
+    std::string error;
+
+public:
+    CompileCache(const std::string& dir, uint64_t maxBytes);
+
+    // 默认缓存目录：$TOYC_CACHE_DIR，否则 $XDG_CACHE_HOME/toyc 或 ~/.cache/toyc
+    static std::string defaultDirectory();
+    // 编译器身份：版本号加可执行文件的大小和修改时间，重新构建后旧条目自然失效
+    static std::string compilerIdentity();
+    static std::string makeKey(const std::string& source, const std::string& config);
+
+    // 命中时填充data并刷新条目的使用时间
+    bool lookup(const std::string& key, std::string& data);
+    bool store(const std::string& key, const std::string& data);
+
+    // 写入条目后 totals 已是最新值；只查找过的进程需要先 refreshTotals 读一次
+    void refreshTotals();
+    const Counters& getTotals() const { return totals; }
+    const std::string& getError() const { return error; }
+
+private:
+    std::string entryPath(const std::string& key) const;
+    // 在锁内汇总查找计数并更新累计值；bytes为负表示释放空间。超出上限时顺带淘汰
+    bool updateStats(long stores, int64_t bytes);
+    void evict(uint64_t target);
+};
+
+// 整个文件一次性读入（fstat 得到大小后单次 read），失败返回false
+bool readWholeFile(const std::string& path, std::string& data);
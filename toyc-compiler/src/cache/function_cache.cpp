@@ -0,0 +1,220 @@
+#include "cache/function_cache.hpp"
+#include "cache/cache.hpp"
+#include "cache/hash.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include <unistd.h>
+
+namespace {
+
+const char fileHeader[] = "toyc-fncache 1\n";
+
+// 子树序列化：前缀记号加括号，足以区分结构不同的树；顺带收集直接调用的函数
+// 显式栈展开，node 为空的项只追加 text（闭括号等），深层嵌套不会耗尽调用栈
+void serializeTree(const ASTNode& root, std::string& out, std::set<std::string>& callees) {
+    struct Item {
+        const ASTNode* node;
+        const char* text;
+    };
+    std::vector<Item> stack{{&root, nullptr}};
+    auto push = [&](const ASTNode* node) { stack.push_back({node, nullptr}); };
+    auto close = [&](const char* text) { stack.push_back({nullptr, text}); };
+
+    while (!stack.empty()) {
+        Item item = stack.back();
+        stack.pop_back();
+        const ASTNode* node = item.node;
+        if (!node) {
+            out += item.text;
+        } else if (auto num = dynamic_cast<const NumberLiteral*>(node)) {
+            out += "n" + std::to_string(num->value) + " ";
+        } else if (auto id = dynamic_cast<const Identifier*>(node)) {
+            out += "v" + id->name + " ";
+        } else if (auto bin = dynamic_cast<const BinaryExpression*>(node)) {
+            out += "(b" + std::to_string(bin->op) + " ";
+            close(")");
+            push(bin->right.get());
+            push(bin->left.get());
+        } else if (auto un = dynamic_cast<const UnaryExpression*>(node)) {
+            out += "(u" + std::to_string(un->op) + " ";
+            close(")");
+            push(un->operand.get());
+        } else if (auto call = dynamic_cast<const FunctionCall*>(node)) {
+            out += "(c" + call->functionName + " " + std::to_string(call->returnType) + " ";
+            close(")");
+            for (auto it = call->arguments.rbegin(); it != call->arguments.rend(); ++it) {
+                push(it->get());
+            }
+            callees.insert(call->functionName);
+        } else if (auto block = dynamic_cast<const Block*>(node)) {
+            out += "{";
+            close("}");
+            for (auto it = block->statements.rbegin(); it != block->statements.rend(); ++it) {
+                push(it->get());
+            }
+        } else if (auto decl = dynamic_cast<const VariableDeclaration*>(node)) {
+            out += "(d" + decl->name + " ";
+            close(")");
+            if (decl->initializer) push(decl->initializer.get());
+        } else if (auto assign = dynamic_cast<const AssignmentStatement*>(node)) {
+            out += "(=" + assign->variable + " ";
+            close(")");
+            push(assign->value.get());
+        } else if (auto ifStmt = dynamic_cast<const IfStatement*>(node)) {
+            out += "(if ";
+            close(")");
+            if (ifStmt->elseStatement) {
+                push(ifStmt->elseStatement.get());
+                close("else ");
+            }
+            push(ifStmt->thenStatement.get());
+            push(ifStmt->condition.get());
+        } else if (auto whileStmt = dynamic_cast<const WhileStatement*>(node)) {
+            out += "(while ";
+            close(")");
+            push(whileStmt->body.get());
+            push(whileStmt->condition.get());
+        } else if (auto ret = dynamic_cast<const ReturnStatement*>(node)) {
+            out += "(ret ";
+            close(")");
+            if (ret->value) push(ret->value.get());
+        } else if (auto exprStmt = dynamic_cast<const ExpressionStatement*>(node)) {
+            out += "(e ";
+            close(")");
+            push(exprStmt->expression.get());
+        } else if (dynamic_cast<const BreakStatement*>(node)) {
+            out += "break ";
+        } else if (dynamic_cast<const ContinueStatement*>(node)) {
+            out += "continue ";
+        } else {
+            out += "? ";
+        }
+    }
+}
+
+std::string signatureOf(const FunctionDefinition& func) {
+    std::string sig = func.name + "(" + std::to_string(func.returnType);
+    for (const auto& param : func.parameters) {
+        sig += " " + std::to_string(param.type);
+    }
+    return sig + ")";
+}
+
+} // namespace
+
+std::vector<std::string> FunctionCache::computeKeys(const CompilationUnit& unit, const std::string& config,
+                                                    const PurityAnalyzer* purity) {
+    struct Summary {
+        std::string signature;
+        Hash128 body;
+        std::set<std::string> callees;
+    };
+    std::vector<Summary> summaries(unit.functions.size());
+    std::unordered_map<std::string, size_t> byName;
+
+    for (size_t i = 0; i < unit.functions.size(); ++i) {
+        const FunctionDefinition& func = *unit.functions[i];
+        Summary& summary = summaries[i];
+        summary.signature = signatureOf(func);
+        std::string text = summary.signature;
+        for (const auto& param : func.parameters) {
+            text += " " + param.name;
+        }
+        serializeTree(*func.body, text, summary.callees);
+        summary.body = hash128(text);
+        byName.emplace(func.name, i);
+    }
+
+    Hash128 seed = hash128(CompileCache::compilerIdentity() + '\0' + config);
+    std::vector<std::string> keys;
+    keys.reserve(summaries.size());
+    for (const Summary& summary : summaries) {
+        std::string text = summary.body.hex();
+        for (const auto& callee : summary.callees) {
+            auto it = byName.find(callee);
+            text += "\n" + (it == byName.end() ? callee + " undefined" : summaries[it->second].signature);
+            if (it == byName.end() || !purity || !purity->isPure(callee)) continue;
+
+            // 纯函数只调用纯函数，闭包内任何函数体的变化都可能改变折叠结果
+            std::set<std::string> closure{callee};
+            std::vector<std::string> work{callee};
+            while (!work.empty()) {
+                std::string name = work.back();
+                work.pop_back();
+                auto found = byName.find(name);
+                if (found == byName.end()) continue;
+                for (const auto& next : summaries[found->second].callees) {
+                    if (closure.insert(next).second) work.push_back(next);
+                }
+            }
+            text += " pure";
+            for (const auto& name : closure) {
+                auto found = byName.find(name);
+                if (found != byName.end()) text += " " + summaries[found->second].body.hex();
+            }
+        }
+        keys.push_back(hash128(text, seed).hex());
+    }
+    return keys;
+}
+
+bool FunctionCache::load() {
+    previous.clear();
+    std::string data;
+    if (!readWholeFile(path, data)) return true;
+
+    const size_t headerLength = sizeof(fileHeader) - 1;
+    if (data.compare(0, headerLength, fileHeader) != 0) return true;
+
+    size_t pos = headerLength;
+    while (pos < data.size()) {
+        size_t end = data.find('\n', pos);
+        if (end == std::string::npos) break;
+        std::string line = data.substr(pos, end - pos);
+        size_t space = line.find(' ');
+        if (space == std::string::npos) break;
+        size_t length = std::strtoull(line.c_str() + space + 1, nullptr, 10);
+        pos = end + 1;
+        if (length > data.size() - pos) break;
+        previous[line.substr(0, space)] = data.substr(pos, length);
+        pos += length;
+    }
+    return true;
+}
+
+bool FunctionCache::find(const std::string& key, std::string& text) const {
+    auto it = previous.find(key);
+    if (it == previous.end()) return false;
+    text = it->second;
+    return true;
+}
+
+void FunctionCache::record(const std::string& key, const std::string& text) {
+    current.emplace_back(key, text);
+}
+
+bool FunctionCache::save() {
+    std::string data = fileHeader;
+    for (const auto& entry : current) {
+        data += entry.first + " " + std::to_string(entry.second.size()) + "\n" + entry.second;
+    }
+
+    std::string temp = path + ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream file(temp, std::ios::binary);
+        if (!file.is_open() || !(file << data) || !file.flush()) {
+            std::remove(temp.c_str());
+            error = "Cannot write incremental cache: " + temp;
+            return false;
+        }
+    }
+    if (std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        error = "Cannot write incremental cache: " + path;
+        return false;
+    }
+    return true;
+}
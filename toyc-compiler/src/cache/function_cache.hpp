@@ -0,0 +1,34 @@
+#pragma once
+#include "ast/ast.hpp"
+#include "opt/purity.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 逐函数的增量编译缓存，保存在输出文件旁的 <output>.fncache 中
+// 键是函数子树、被调函数签名和编译配置的哈希；-O1 下纯函数调用可能在编译期求值，
+// 因此被调的纯函数连同它的整个调用闭包的函数体也计入键中。
+// 文件格式：首行 "toyc-fncache 1"，之后每个条目为 "<键> <长度>\n<汇编文本>"
+class FunctionCache {
+private:
+    std::string path;
+    std::unordered_map<std::string, std::string> previous;  // 上次保存的条目
+    std::vector<std::pair<std::string, std::string>> current;  // 本次编译的全部函数
+    std::string error;
+
+public:
+    explicit FunctionCache(const std::string& path) : path(path) {}
+
+    // 在任何改写AST的优化之前调用；purity为空表示不做纯函数折叠（-O0）
+    static std::vector<std::string> computeKeys(const CompilationUnit& unit, const std::string& config,
+                                                const PurityAnalyzer* purity);
+
+    // 文件不存在视为空缓存；格式不符时丢弃旧内容
+    bool load();
+    bool find(const std::string& key, std::string& text) const;
+    void record(const std::string& key, const std::string& text);
+    // 只保留本次记录的条目，先写临时文件再 rename
+    bool save();
+
+    const std::string& getError() const { return error; }
+};
@@ -0,0 +1,136 @@
+#include "cache/hash.hpp"
+#include <cstring>
+
+namespace {
+
+const uint64_t P1 = 11400714785074694791ULL;
+const uint64_t P2 = 14029467366897019727ULL;
+const uint64_t P3 = 1609587929392839161ULL;
+const uint64_t P4 = 9650029242287828579ULL;
+const uint64_t P5 = 2870177450012600261ULL;
+
+inline uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t read64(const unsigned char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+inline uint32_t read32(const unsigned char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+inline uint64_t round(uint64_t acc, uint64_t input) {
+    acc += input * P2;
+    acc = rotl(acc, 31);
+    return acc * P1;
+}
+
+inline uint64_t mergeRound(uint64_t acc, uint64_t val) {
+    acc ^= round(0, val);
+    return acc * P1 + P4;
+}
+
+struct Lanes {
+    uint64_t v1, v2, v3, v4;
+
+    explicit Lanes(uint64_t seed) : v1(seed + P1 + P2), v2(seed + P2), v3(seed), v4(seed - P1) {}
+
+    void stripe(const unsigned char* p) {
+        v1 = round(v1, read64(p));
+        v2 = round(v2, read64(p + 8));
+        v3 = round(v3, read64(p + 16));
+        v4 = round(v4, read64(p + 24));
+    }
+
+    uint64_t merge() const {
+        uint64_t h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = mergeRound(h, v1);
+        h = mergeRound(h, v2);
+        h = mergeRound(h, v3);
+        return mergeRound(h, v4);
+    }
+};
+
+// 不足32字节的尾部与最终雪崩
+uint64_t finish(uint64_t h, const unsigned char* p, size_t remaining) {
+    while (remaining >= 8) {
+        h ^= round(0, read64(p));
+        h = rotl(h, 27) * P1 + P4;
+        p += 8;
+        remaining -= 8;
+    }
+    if (remaining >= 4) {
+        h ^= static_cast<uint64_t>(read32(p)) * P1;
+        h = rotl(h, 23) * P2 + P3;
+        p += 4;
+        remaining -= 4;
+    }
+    while (remaining > 0) {
+        h ^= *p * P5;
+        h = rotl(h, 11) * P1;
+        ++p;
+        --remaining;
+    }
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+    return h;
+}
+
+} // namespace
+
+uint64_t xxh64(const void* data, size_t size, uint64_t seed) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const unsigned char* end = p + size;
+    uint64_t h;
+    if (size >= 32) {
+        Lanes lanes(seed);
+        for (; p + 32 <= end; p += 32) lanes.stripe(p);
+        h = lanes.merge();
+    } else {
+        h = seed + P5;
+    }
+    return finish(h + size, p, end - p);
+}
+
+Hash128 hash128(const void* data, size_t size, const Hash128& seed) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const unsigned char* end = p + size;
+    // 第二路种子取反，保证零种子时两半也不相同
+    uint64_t seedHi = ~seed.hi;
+    uint64_t lo, hi;
+    if (size >= 32) {
+        Lanes a(seed.lo), b(seedHi);
+        for (; p + 32 <= end; p += 32) {
+            a.stripe(p);
+            b.stripe(p);
+        }
+        lo = a.merge();
+        hi = b.merge();
+    } else {
+        lo = seed.lo + P5;
+        hi = seedHi + P5;
+    }
+    Hash128 result;
+    result.lo = finish(lo + size, p, end - p);
+    result.hi = finish(hi + size, p, end - p);
+    return result;
+}
+
+std::string Hash128::hex() const {
+    static const char digits[] = "0123456789abcdef";
+    std::string text(32, '0');
+    for (int i = 0; i < 16; ++i) {
+        text[15 - i] = digits[(hi >> (4 * i)) & 0xf];
+        text[31 - i] = digits[(lo >> (4 * i)) & 0xf];
+    }
+    return text;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 128位内容哈希：两路不同种子的 XXH64 在同一遍扫描中计算
+struct Hash128 {
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+
+    bool operator==(const Hash128& other) const { return lo == other.lo && hi == other.hi; }
+    bool operator!=(const Hash128& other) const { return !(*this == other); }
+
+    // 32个小写十六进制字符
+    std::string hex() const;
+};
+
+uint64_t xxh64(const void* data, size_t size, uint64_t seed = 0);
+Hash128 hash128(const void* data, size_t size, const Hash128& seed = Hash128());
+
+inline Hash128 hash128(const std::string& text, const Hash128& seed = Hash128()) {
+    return hash128(text.data(), text.size(), seed);
+}
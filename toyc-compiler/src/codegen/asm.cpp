@@ -0,0 +1,273 @@
+#include "codegen/asm.hpp"
+#include "utils/utils.hpp"
+#include <unordered_map>
+#include <cstdlib>
+#include <cctype>
+#include <climits>
+
+namespace {
+
+const std::unordered_map<std::string, AsmFormat>& formatTable() {
+    static const std::unordered_map<std::string, AsmFormat> table = {
+        {"add", AsmFormat::R},   {"sub", AsmFormat::R},   {"mul", AsmFormat::R},
+        {"mulh", AsmFormat::R},  {"div", AsmFormat::R},   {"divu", AsmFormat::R},
+        {"rem", AsmFormat::R},   {"remu", AsmFormat::R},  {"slt", AsmFormat::R},
+        {"sltu", AsmFormat::R},  {"and", AsmFormat::R},   {"or", AsmFormat::R},
+        {"xor", AsmFormat::R},   {"sll", AsmFormat::R},   {"srl", AsmFormat::R},
+        {"sra", AsmFormat::R},
+        {"addi", AsmFormat::I},  {"xori", AsmFormat::I},  {"andi", AsmFormat::I},
+        {"ori", AsmFormat::I},   {"slti", AsmFormat::I},  {"sltiu", AsmFormat::I},
+        {"slli", AsmFormat::I},  {"srli", AsmFormat::I},  {"srai", AsmFormat::I},
+        {"lui", AsmFormat::U},   {"auipc", AsmFormat::U},
+        {"lw", AsmFormat::LOAD}, {"lh", AsmFormat::LOAD}, {"lb", AsmFormat::LOAD},
+        {"lhu", AsmFormat::LOAD},{"lbu", AsmFormat::LOAD},
+        {"sw", AsmFormat::STORE},{"sh", AsmFormat::STORE},{"sb", AsmFormat::STORE},
+        {"beq", AsmFormat::BRANCH}, {"bne", AsmFormat::BRANCH}, {"blt", AsmFormat::BRANCH},
+        {"bge", AsmFormat::BRANCH}, {"bltu", AsmFormat::BRANCH},{"bgeu", AsmFormat::BRANCH},
+        {"beqz", AsmFormat::BRANCH_Z}, {"bnez", AsmFormat::BRANCH_Z},
+        {"mv", AsmFormat::UNARY},   {"seqz", AsmFormat::UNARY}, {"snez", AsmFormat::UNARY},
+        {"neg", AsmFormat::UNARY},  {"not", AsmFormat::UNARY},
+        {"li", AsmFormat::LI},
+        {"j", AsmFormat::JUMP},
+        {"call", AsmFormat::CALL},
+        {"jr", AsmFormat::JR},
+        {"ret", AsmFormat::RET}
+    };
+    return table;
+}
+
+bool isRegister(const std::string& operand) {
+    return !operand.empty() && operand != "zero" && !std::isdigit(static_cast<unsigned char>(operand[0])) &&
+           operand[0] != '-';
+}
+
+} // namespace
+
+AsmLine AsmLine::instruction(const std::string& op, const std::vector<std::string>& ops) {
+    AsmLine line(INSTRUCTION);
+    line.opcode = op;
+    line.operands = ops;
+    return line;
+}
+
+AsmLine AsmLine::label(const std::string& name) {
+    AsmLine line(LABEL);
+    line.opcode = name;
+    return line;
+}
+
+AsmFormat AsmLine::format() const {
+    if (kind != INSTRUCTION) return AsmFormat::UNKNOWN;
+    auto it = formatTable().find(opcode);
+    return it == formatTable().end() ? AsmFormat::UNKNOWN : it->second;
+}
+
+bool AsmLine::isBranch() const {
+    AsmFormat f = format();
+    return f == AsmFormat::BRANCH || f == AsmFormat::BRANCH_Z;
+}
+
+bool AsmLine::isJump() const {
+    AsmFormat f = format();
+    return f == AsmFormat::JUMP || f == AsmFormat::JR || f == AsmFormat::RET;
+}
+
+std::string AsmLine::branchTarget() const {
+    switch (format()) {
+        case AsmFormat::BRANCH:   return operands.size() > 2 ? operands[2] : "";
+        case AsmFormat::BRANCH_Z: return operands.size() > 1 ? operands[1] : "";
+        case AsmFormat::JUMP:
+        case AsmFormat::CALL:     return operands.empty() ? "" : operands[0];
+        default:                  return "";
+    }
+}
+
+std::string AsmLine::definedRegister() const {
+    std::string rd;
+    switch (format()) {
+        case AsmFormat::R:
+        case AsmFormat::I:
+        case AsmFormat::U:
+        case AsmFormat::LOAD:
+        case AsmFormat::UNARY:
+        case AsmFormat::LI:
+            rd = operands.empty() ? "" : operands[0];
+            break;
+        case AsmFormat::CALL:
+            rd = "a0";
+            break;
+        default:
+            break;
+    }
+    return rd == "zero" ? "" : rd;
+}
+
+std::vector<std::string> AsmLine::usedRegisters() const {
+    std::vector<std::string> regs;
+    auto add = [&regs](const std::string& r) {
+        if (isRegister(r)) regs.push_back(r);
+    };
+    int offset;
+    std::string base;
+
+    switch (format()) {
+        case AsmFormat::R:
+            if (operands.size() > 2) { add(operands[1]); add(operands[2]); }
+            break;
+        case AsmFormat::I:
+        case AsmFormat::UNARY:
+            if (operands.size() > 1) add(operands[1]);
+            break;
+        case AsmFormat::LOAD:
+            if (operands.size() > 1 && parseMemoryOperand(operands[1], offset, base)) add(base);
+            break;
+        case AsmFormat::STORE:
+            if (operands.size() > 1) {
+                add(operands[0]);
+                if (parseMemoryOperand(operands[1], offset, base)) add(base);
+            }
+            break;
+        case AsmFormat::BRANCH:
+            if (operands.size() > 1) { add(operands[0]); add(operands[1]); }
+            break;
+        case AsmFormat::BRANCH_Z:
+        case AsmFormat::JR:
+            if (!operands.empty()) add(operands[0]);
+            break;
+        case AsmFormat::CALL:
+            for (int i = 0; i < 8; ++i) regs.push_back("a" + std::to_string(i));
+            break;
+        case AsmFormat::RET:
+            regs.push_back("ra");
+            regs.push_back("a0");
+            break;
+        default:
+            break;
+    }
+    return regs;
+}
+
+bool AsmLine::reads(const std::string& reg) const {
+    for (const auto& r : usedRegisters()) {
+        if (r == reg) return true;
+    }
+    return false;
+}
+
+std::string AsmLine::toString() const {
+    switch (kind) {
+        case INSTRUCTION: {
+            std::string result = "    " + opcode;
+            for (size_t i = 0; i < operands.size(); ++i) {
+                result += (i == 0 ? " " : ", ") + operands[i];
+            }
+            return result;
+        }
+        case LABEL:
+            return opcode + ":";
+        case DIRECTIVE:
+            return "    " + opcode + (text.empty() ? "" : " " + text);
+        case COMMENT:
+            return "    # " + text;
+        case BLANK:
+        default:
+            return text;
+    }
+}
+
+bool parseMemoryOperand(const std::string& operand, int& offset, std::string& base) {
+    size_t lparen = operand.find('(');
+    size_t rparen = operand.find(')');
+    if (lparen == std::string::npos || rparen == std::string::npos || rparen < lparen) {
+        return false;
+    }
+
+    std::string offsetStr = operand.substr(0, lparen);
+    if (!offsetStr.empty() && !Utils::isNumber(offsetStr)) {
+        return false;
+    }
+    offset = offsetStr.empty() ? 0 : std::atoi(offsetStr.c_str());
+    base = operand.substr(lparen + 1, rparen - lparen - 1);
+    return true;
+}
+
+int registerNumber(const std::string& name) {
+    static const std::unordered_map<std::string, int> abi = {
+        {"zero", 0}, {"ra", 1}, {"sp", 2}, {"gp", 3}, {"tp", 4},
+        {"t0", 5}, {"t1", 6}, {"t2", 7}, {"s0", 8}, {"fp", 8}, {"s1", 9},
+        {"a0", 10}, {"a1", 11}, {"a2", 12}, {"a3", 13}, {"a4", 14}, {"a5", 15},
+        {"a6", 16}, {"a7", 17}, {"s2", 18}, {"s3", 19}, {"s4", 20}, {"s5", 21},
+        {"s6", 22}, {"s7", 23}, {"s8", 24}, {"s9", 25}, {"s10", 26}, {"s11", 27},
+        {"t3", 28}, {"t4", 29}, {"t5", 30}, {"t6", 31}
+    };
+    auto it = abi.find(name);
+    if (it != abi.end()) return it->second;
+
+    // x0 - x31
+    if (name.size() >= 2 && name[0] == 'x' && Utils::isNumber(name.substr(1))) {
+        int n = std::atoi(name.c_str() + 1);
+        if (n >= 0 && n < 32) return n;
+    }
+    return -1;
+}
+
+bool parseImmediate(const std::string& text, int32_t& value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    long long v = std::strtoll(text.c_str(), &end, 0);
+    if (*end != '\0' || v < INT32_MIN || v > UINT32_MAX) return false;
+    value = static_cast<int32_t>(static_cast<uint32_t>(v));
+    return true;
+}
+
+std::vector<AsmLine> parseAssembly(const std::string& text) {
+    std::vector<AsmLine> lines;
+    std::istringstream input(text);
+    std::string raw;
+
+    while (std::getline(input, raw)) {
+        std::string line = Utils::trim(raw);
+
+        if (line.empty()) {
+            AsmLine blank(AsmLine::BLANK);
+            blank.text = raw;
+            lines.push_back(blank);
+        } else if (line[0] == '#') {
+            AsmLine comment(AsmLine::COMMENT);
+            comment.text = Utils::trim(line.substr(1));
+            lines.push_back(comment);
+        } else if (line.back() == ':') {
+            lines.push_back(AsmLine::label(line.substr(0, line.size() - 1)));
+        } else if (line[0] == '.') {
+            AsmLine directive(AsmLine::DIRECTIVE);
+            size_t space = line.find_first_of(" \t");
+            directive.opcode = line.substr(0, space);
+            if (space != std::string::npos) {
+                directive.text = Utils::trim(line.substr(space));
+            }
+            lines.push_back(directive);
+        } else {
+            size_t space = line.find_first_of(" \t");
+            AsmLine inst(AsmLine::INSTRUCTION);
+            inst.opcode = line.substr(0, space);
+            if (space != std::string::npos) {
+                for (const auto& op : Utils::split(line.substr(space), ',')) {
+                    std::string operand = Utils::trim(op);
+                    if (!operand.empty()) inst.operands.push_back(operand);
+                }
+            }
+            lines.push_back(inst);
+        }
+    }
+
+    return lines;
+}
+
+std::string printAssembly(const std::vector<AsmLine>& lines) {
+    std::string result;
+    for (const auto& line : lines) {
+        result += line.toString();
+        result += '\n';
+    }
+    return result;
+}
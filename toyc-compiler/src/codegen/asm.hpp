@@ -0,0 +1,67 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// 汇编指令格式（决定操作数中哪些是定义/使用的寄存器）
+enum class AsmFormat {
+    UNKNOWN,
+    R,          // op rd, rs1, rs2
+    I,          // op rd, rs1, imm
+    U,          // op rd, imm
+    LOAD,       // op rd, off(base)
+    STORE,      // op rs2, off(base)
+    BRANCH,     // op rs1, rs2, label
+    BRANCH_Z,   // op rs, label
+    UNARY,      // op rd, rs   （mv / seqz / snez / neg / not）
+    LI,         // li rd, imm
+    JUMP,       // j label
+    CALL,       // call label
+    JR,         // jr rs
+    RET         // ret
+};
+
+// 一行汇编：指令、标签、伪指令、注释或空行
+struct AsmLine {
+    enum Kind { INSTRUCTION, LABEL, DIRECTIVE, COMMENT, BLANK };
+
+    Kind kind;
+    std::string opcode;                 // 指令助记符 / 标签名 / 伪指令名
+    std::vector<std::string> operands;
+    std::string text;                   // 注释内容或伪指令参数
+
+    AsmLine(Kind k = BLANK) : kind(k) {}
+
+    static AsmLine instruction(const std::string& op, const std::vector<std::string>& ops);
+    static AsmLine label(const std::string& name);
+
+    bool isInstruction() const { return kind == INSTRUCTION; }
+    bool isLabel() const { return kind == LABEL; }
+
+    AsmFormat format() const;
+    bool isBranch() const;              // 条件分支
+    bool isJump() const;                // 无条件跳转（j / jr / ret）
+    bool isCall() const { return kind == INSTRUCTION && opcode == "call"; }
+    bool endsBlock() const { return isBranch() || isJump() || isCall(); }
+    std::string branchTarget() const;   // 分支/跳转/调用目标标签，无则为空
+
+    // 寄存器定义与使用（不含 zero）
+    std::string definedRegister() const;
+    std::vector<std::string> usedRegisters() const;
+    bool reads(const std::string& reg) const;
+    bool writes(const std::string& reg) const { return !reg.empty() && definedRegister() == reg; }
+
+    std::string toString() const;
+};
+
+// 解析 off(base) 形式的访存操作数
+bool parseMemoryOperand(const std::string& operand, int& offset, std::string& base);
+
+// 寄存器名（ABI 名或 x0-x31）转编号，未知返回 -1
+int registerNumber(const std::string& name);
+// 解析十进制/十六进制立即数，允许 32 位有符号或无符号范围
+bool parseImmediate(const std::string& text, int32_t& value);
+
+// 文本汇编与行序列互转
+std::vector<AsmLine> parseAssembly(const std::string& text);
+std::string printAssembly(const std::vector<AsmLine>& lines);
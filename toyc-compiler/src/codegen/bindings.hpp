@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// 按作用域嵌套的名字绑定：每个名字一个绑定栈，栈顶是最内层的声明，查找与嵌套深度无关。
+// RISC-V 的栈帧布局和 x86-64 后端都用它处理变量遮蔽
+template <typename T>
+class NameBindings {
+private:
+    std::unordered_map<std::string, std::vector<T>> stacks;
+    std::vector<std::vector<std::string>> declared;    // 各层作用域中声明的名字，退出时弹出绑定
+
+public:
+    void clear() {
+        stacks.clear();
+        declared.clear();
+    }
+
+    void enterScope() { declared.emplace_back(); }
+
+    void exitScope() {
+        for (const auto& name : declared.back()) {
+            auto it = stacks.find(name);
+            it->second.pop_back();
+            if (it->second.empty()) stacks.erase(it);
+        }
+        declared.pop_back();
+    }
+
+    void bind(const std::string& name, const T& value) {
+        stacks[name].push_back(value);
+        declared.back().push_back(name);
+    }
+
+    const T* lookup(const std::string& name) const {
+        auto it = stacks.find(name);
+        return it == stacks.end() ? nullptr : &it->second.back();
+    }
+};
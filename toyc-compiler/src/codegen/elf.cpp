@@ -0,0 +1,159 @@
+#include "codegen/elf.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+const uint16_t ET_REL = 1;
+const uint16_t EM_RISCV = 243;
+const uint32_t SHT_PROGBITS = 1, SHT_SYMTAB = 2, SHT_STRTAB = 3, SHT_RELA = 4;
+const uint32_t SHF_ALLOC = 0x2, SHF_EXECINSTR = 0x4, SHF_INFO_LINK = 0x40;
+const uint8_t STB_LOCAL = 0, STB_GLOBAL = 1;
+const uint8_t STT_NOTYPE = 0, STT_FUNC = 2;
+const uint32_t EHDR_SIZE = 52, SHDR_SIZE = 40, SYM_SIZE = 16, RELA_SIZE = 12;
+
+// 节下标
+enum { SEC_NULL, SEC_TEXT, SEC_RELA, SEC_SYMTAB, SEC_STRTAB, SEC_SHSTRTAB, SEC_COUNT };
+
+class ByteWriter {
+public:
+    std::string bytes;
+
+    void u8(uint8_t v) { bytes.push_back(static_cast<char>(v)); }
+    void u16(uint16_t v) { u8(v & 0xff); u8(v >> 8); }
+    void u32(uint32_t v) { u16(v & 0xffff); u16(v >> 16); }
+    void align(size_t n) { while (bytes.size() % n) u8(0); }
+    uint32_t size() const { return static_cast<uint32_t>(bytes.size()); }
+};
+
+// 以 \0 分隔的字符串表，返回名字的偏移
+class StringTable {
+public:
+    std::string data = std::string(1, '\0');
+
+    uint32_t add(const std::string& name) {
+        uint32_t offset = static_cast<uint32_t>(data.size());
+        data += name;
+        data.push_back('\0');
+        return offset;
+    }
+};
+
+struct SectionHeader {
+    uint32_t name = 0, type = 0, flags = 0, offset = 0, size = 0;
+    uint32_t link = 0, info = 0, align = 0, entsize = 0;
+};
+
+} // namespace
+
+std::string writeElfObject(const ObjectCode& object) {
+    // 符号表要求局部符号在前
+    std::vector<const ObjectSymbol*> ordered;
+    for (const auto& sym : object.symbols) {
+        if (!sym.global) ordered.push_back(&sym);
+    }
+    uint32_t firstGlobal = static_cast<uint32_t>(ordered.size()) + 1;
+    for (const auto& sym : object.symbols) {
+        if (sym.global) ordered.push_back(&sym);
+    }
+
+    StringTable strtab;
+    ByteWriter symtab;
+    symtab.bytes.assign(SYM_SIZE, '\0');
+    std::unordered_map<std::string, uint32_t> symbolIndex;
+    for (const ObjectSymbol* sym : ordered) {
+        symbolIndex[sym->name] = symtab.size() / SYM_SIZE;
+        symtab.u32(strtab.add(sym->name));
+        symtab.u32(sym->value);
+        symtab.u32(sym->size);
+        symtab.u8(static_cast<uint8_t>((sym->global ? STB_GLOBAL : STB_LOCAL) << 4 |
+                                       (sym->function ? STT_FUNC : STT_NOTYPE)));
+        symtab.u8(0);
+        symtab.u16(sym->defined ? SEC_TEXT : 0);
+    }
+
+    ByteWriter rela;
+    for (const auto& reloc : object.relocations) {
+        rela.u32(reloc.offset);
+        rela.u32(symbolIndex.at(reloc.symbol) << 8 | reloc.type);
+        rela.u32(static_cast<uint32_t>(reloc.addend));
+    }
+
+    StringTable shstrtab;
+    SectionHeader headers[SEC_COUNT];
+    headers[SEC_TEXT].name = shstrtab.add(".text");
+    headers[SEC_RELA].name = shstrtab.add(".rela.text");
+    headers[SEC_SYMTAB].name = shstrtab.add(".symtab");
+    headers[SEC_STRTAB].name = shstrtab.add(".strtab");
+    headers[SEC_SHSTRTAB].name = shstrtab.add(".shstrtab");
+
+    // ELF 头之后依次放各节内容，最后是节头表
+    ByteWriter out;
+    out.bytes.assign(EHDR_SIZE, '\0');
+    auto place = [&out](SectionHeader& header, const std::string& data, uint32_t align) {
+        out.align(align);
+        header.offset = out.size();
+        header.size = static_cast<uint32_t>(data.size());
+        header.align = align;
+        out.bytes += data;
+    };
+
+    place(headers[SEC_TEXT], std::string(object.text.begin(), object.text.end()), 4);
+    headers[SEC_TEXT].type = SHT_PROGBITS;
+    headers[SEC_TEXT].flags = SHF_ALLOC | SHF_EXECINSTR;
+
+    place(headers[SEC_RELA], rela.bytes, 4);
+    headers[SEC_RELA].type = SHT_RELA;
+    headers[SEC_RELA].flags = SHF_INFO_LINK;
+    headers[SEC_RELA].link = SEC_SYMTAB;
+    headers[SEC_RELA].info = SEC_TEXT;
+    headers[SEC_RELA].entsize = RELA_SIZE;
+
+    place(headers[SEC_SYMTAB], symtab.bytes, 4);
+    headers[SEC_SYMTAB].type = SHT_SYMTAB;
+    headers[SEC_SYMTAB].link = SEC_STRTAB;
+    headers[SEC_SYMTAB].info = firstGlobal;
+    headers[SEC_SYMTAB].entsize = SYM_SIZE;
+
+    place(headers[SEC_STRTAB], strtab.data, 1);
+    headers[SEC_STRTAB].type = SHT_STRTAB;
+
+    place(headers[SEC_SHSTRTAB], shstrtab.data, 1);
+    headers[SEC_SHSTRTAB].type = SHT_STRTAB;
+
+    out.align(4);
+    uint32_t sectionHeaderOffset = out.size();
+    for (const auto& header : headers) {
+        out.u32(header.name);
+        out.u32(header.type);
+        out.u32(header.flags);
+        out.u32(0);             // sh_addr
+        out.u32(header.offset);
+        out.u32(header.size);
+        out.u32(header.link);
+        out.u32(header.info);
+        out.u32(header.align);
+        out.u32(header.entsize);
+    }
+
+    // 回填 ELF 头
+    ByteWriter ehdr;
+    const uint8_t ident[16] = {0x7f, 'E', 'L', 'F', 1 /* ELFCLASS32 */, 1 /* ELFDATA2LSB */, 1 /* EV_CURRENT */};
+    for (uint8_t b : ident) ehdr.u8(b);
+    ehdr.u16(ET_REL);
+    ehdr.u16(EM_RISCV);
+    ehdr.u32(1);                // e_version
+    ehdr.u32(0);                // e_entry
+    ehdr.u32(0);                // e_phoff
+    ehdr.u32(sectionHeaderOffset);
+    ehdr.u32(0);                // e_flags：软浮点 ABI，无压缩指令
+    ehdr.u16(EHDR_SIZE);
+    ehdr.u16(0);                // e_phentsize
+    ehdr.u16(0);                // e_phnum
+    ehdr.u16(SHDR_SIZE);
+    ehdr.u16(SEC_COUNT);
+    ehdr.u16(SEC_SHSTRTAB);
+    out.bytes.replace(0, EHDR_SIZE, ehdr.bytes);
+
+    return out.bytes;
+}
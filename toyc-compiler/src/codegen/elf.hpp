@@ -0,0 +1,7 @@
+#pragma once
+#include "codegen/encoder.hpp"
+#include <string>
+
+// 把编码结果写成 ELF32 小端 RISC-V 可重定位目标文件（ET_REL）
+// 节：.text, .rela.text, .symtab, .strtab, .shstrtab
+std::string writeElfObject(const ObjectCode& object);
@@ -0,0 +1,483 @@
+#include "codegen/encoder.hpp"
+#include "utils/utils.hpp"
+#include <algorithm>
+
+namespace {
+
+// 指令格式编码
+uint32_t encodeR(uint32_t funct7, int rs2, int rs1, uint32_t funct3, int rd, uint32_t opcode) {
+    return funct7 << 25 | rs2 << 20 | rs1 << 15 | funct3 << 12 | rd << 7 | opcode;
+}
+
+uint32_t encodeI(int32_t imm, int rs1, uint32_t funct3, int rd, uint32_t opcode) {
+    return (static_cast<uint32_t>(imm) & 0xfff) << 20 | rs1 << 15 | funct3 << 12 | rd << 7 | opcode;
+}
+
+uint32_t encodeS(int32_t imm, int rs2, int rs1, uint32_t funct3) {
+    uint32_t u = static_cast<uint32_t>(imm);
+    return ((u >> 5) & 0x7f) << 25 | rs2 << 20 | rs1 << 15 | funct3 << 12 | (u & 0x1f) << 7 | 0x23;
+}
+
+uint32_t encodeB(int32_t imm, int rs2, int rs1, uint32_t funct3) {
+    uint32_t u = static_cast<uint32_t>(imm);
+    return ((u >> 12) & 1) << 31 | ((u >> 5) & 0x3f) << 25 | rs2 << 20 | rs1 << 15 |
+           funct3 << 12 | ((u >> 1) & 0xf) << 8 | ((u >> 11) & 1) << 7 | 0x63;
+}
+
+uint32_t encodeU(uint32_t imm20, int rd, uint32_t opcode) {
+    return (imm20 & 0xfffff) << 12 | rd << 7 | opcode;
+}
+
+uint32_t encodeJ(int32_t imm, int rd) {
+    uint32_t u = static_cast<uint32_t>(imm);
+    return ((u >> 20) & 1) << 31 | ((u >> 1) & 0x3ff) << 21 | ((u >> 11) & 1) << 20 |
+           ((u >> 12) & 0xff) << 12 | rd << 7 | 0x6f;
+}
+
+const uint32_t OP = 0x33, OP_IMM = 0x13, LOAD = 0x03, LUI = 0x37, AUIPC = 0x17, JALR = 0x67;
+const int RA = 1, T1 = 6;
+
+bool fitsSigned(int32_t value, int bits) {
+    return value >= -(1 << (bits - 1)) && value < (1 << (bits - 1));
+}
+
+// R 型：funct7, funct3
+const std::unordered_map<std::string, std::pair<uint32_t, uint32_t>>& rTypeOps() {
+    static const std::unordered_map<std::string, std::pair<uint32_t, uint32_t>> table = {
+        {"add", {0x00, 0}},  {"sub", {0x20, 0}},  {"sll", {0x00, 1}},  {"slt", {0x00, 2}},
+        {"sltu", {0x00, 3}}, {"xor", {0x00, 4}},  {"srl", {0x00, 5}},  {"sra", {0x20, 5}},
+        {"or", {0x00, 6}},   {"and", {0x00, 7}},
+        {"mul", {0x01, 0}},  {"mulh", {0x01, 1}}, {"mulhsu", {0x01, 2}}, {"mulhu", {0x01, 3}},
+        {"div", {0x01, 4}},  {"divu", {0x01, 5}}, {"rem", {0x01, 6}},  {"remu", {0x01, 7}}
+    };
+    return table;
+}
+
+// I 型算术：funct3
+const std::unordered_map<std::string, uint32_t>& iTypeOps() {
+    static const std::unordered_map<std::string, uint32_t> table = {
+        {"addi", 0}, {"slti", 2}, {"sltiu", 3}, {"xori", 4}, {"ori", 6}, {"andi", 7}
+    };
+    return table;
+}
+
+// 移位立即数：funct3, imm[11:5]
+const std::unordered_map<std::string, std::pair<uint32_t, uint32_t>>& shiftOps() {
+    static const std::unordered_map<std::string, std::pair<uint32_t, uint32_t>> table = {
+        {"slli", {1, 0x00}}, {"srli", {5, 0x00}}, {"srai", {5, 0x20}}
+    };
+    return table;
+}
+
+const std::unordered_map<std::string, uint32_t>& loadOps() {
+    static const std::unordered_map<std::string, uint32_t> table = {
+        {"lb", 0}, {"lh", 1}, {"lw", 2}, {"lbu", 4}, {"lhu", 5}
+    };
+    return table;
+}
+
+const std::unordered_map<std::string, uint32_t>& storeOps() {
+    static const std::unordered_map<std::string, uint32_t> table = {
+        {"sb", 0}, {"sh", 1}, {"sw", 2}
+    };
+    return table;
+}
+
+// 分支 funct3；低位取反即得到相反条件
+const std::unordered_map<std::string, uint32_t>& branchOps() {
+    static const std::unordered_map<std::string, uint32_t> table = {
+        {"beq", 0}, {"bne", 1}, {"blt", 4}, {"bge", 5}, {"bltu", 6}, {"bgeu", 7}
+    };
+    return table;
+}
+
+} // namespace
+
+bool RV32Encoder::fail(const std::string& message) {
+    error = message;
+    return false;
+}
+
+bool RV32Encoder::encode(const std::string& assembly, ObjectCode& object) {
+    items.clear();
+    labels.clear();
+    labelOrder.clear();
+    globals.clear();
+    functions.clear();
+    sizeMarks.clear();
+    error.clear();
+    relaxedBranches = 0;
+    object = ObjectCode();
+
+    for (const auto& line : parseAssembly(assembly)) {
+        if (line.isLabel()) {
+            if (labels.count(line.opcode)) return fail("label '" + line.opcode + "' redefined");
+            labels[line.opcode] = items.size();
+            labelOrder.push_back(line.opcode);
+        } else if (line.isInstruction()) {
+            if (!addInstruction(line)) {
+                error = "'" + Utils::trim(line.toString()) + "': " + error;
+                return false;
+            }
+        } else if (line.kind == AsmLine::DIRECTIVE && !addDirective(line)) {
+            return false;
+        }
+    }
+
+    layout();
+
+    for (const auto& item : items) {
+        if (!emitItem(item, object)) {
+            error = "'" + item.source + "': " + error;
+            return false;
+        }
+    }
+
+    // 符号表：.L 开头的本地标签不导出
+    std::unordered_set<std::string> known;
+    for (const auto& name : labelOrder) {
+        if (name.compare(0, 2, ".L") == 0) continue;
+        ObjectSymbol sym;
+        sym.name = name;
+        sym.value = addressOf(name);
+        sym.global = globals.count(name) > 0;
+        sym.defined = true;
+        sym.function = functions.count(name) > 0;
+        auto mark = sizeMarks.find(name);
+        if (mark != sizeMarks.end()) {
+            uint32_t end = mark->second < items.size() ? items[mark->second].address
+                                                       : static_cast<uint32_t>(object.text.size());
+            sym.size = end - sym.value;
+        }
+        object.symbols.push_back(sym);
+        known.insert(name);
+    }
+    // 外部符号按首次引用的顺序加入
+    auto addUndefined = [&](const std::string& name) {
+        if (known.insert(name).second) {
+            ObjectSymbol sym;
+            sym.name = name;
+            sym.global = true;
+            sym.function = functions.count(name) > 0;
+            object.symbols.push_back(sym);
+        }
+    };
+    for (const auto& reloc : object.relocations) addUndefined(reloc.symbol);
+    std::vector<std::string> declared(globals.begin(), globals.end());
+    std::sort(declared.begin(), declared.end());
+    for (const auto& name : declared) addUndefined(name);
+    return true;
+}
+
+bool RV32Encoder::addDirective(const AsmLine& line) {
+    const std::string& name = line.opcode;
+    std::vector<std::string> args;
+    for (const auto& part : Utils::split(line.text, ',')) {
+        std::string arg = Utils::trim(part);
+        if (!arg.empty()) args.push_back(arg);
+    }
+
+    if (name == ".text") {
+        return true;
+    }
+    if (name == ".globl" || name == ".global") {
+        for (const auto& sym : args) globals.insert(sym);
+        return true;
+    }
+    if (name == ".type") {
+        if (args.size() == 2 && (args[1] == "@function" || args[1] == "%function")) {
+            functions.insert(args[0]);
+        }
+        return true;
+    }
+    if (name == ".size") {
+        if (args.size() != 2 || args[1] != ".-" + args[0]) {
+            return fail("unsupported .size expression '" + line.text + "'");
+        }
+        sizeMarks[args[0]] = items.size();
+        return true;
+    }
+    if (name == ".section" && !args.empty() && args[0] == ".note.GNU-stack") {
+        return true;
+    }
+    return fail("unsupported directive '" + name + "'");
+}
+
+bool RV32Encoder::addInstruction(const AsmLine& line) {
+    const std::string& op = line.opcode;
+    const auto& ops = line.operands;
+
+    Item item;
+    item.source = Utils::trim(line.toString());
+
+    auto expect = [&](size_t n) {
+        return ops.size() == n || fail("expected " + std::to_string(n) + " operands");
+    };
+    auto reg = [&](size_t i, int& r) {
+        r = registerNumber(ops[i]);
+        return r >= 0 || fail("unknown register '" + ops[i] + "'");
+    };
+    auto imm = [&](size_t i, int32_t& v) {
+        return parseImmediate(ops[i], v) || fail("bad immediate '" + ops[i] + "'");
+    };
+    auto imm12 = [&](size_t i, int32_t& v) {
+        return imm(i, v) && (fitsSigned(v, 12) || fail("immediate out of range '" + ops[i] + "'"));
+    };
+    auto mem = [&](size_t i, int& base, int32_t& offset) {
+        int off;
+        std::string baseName;
+        if (!parseMemoryOperand(ops[i], off, baseName)) return fail("bad memory operand '" + ops[i] + "'");
+        base = registerNumber(baseName);
+        offset = off;
+        if (base < 0) return fail("unknown register '" + baseName + "'");
+        return fitsSigned(offset, 12) || fail("offset out of range '" + ops[i] + "'");
+    };
+    auto fixed = [&](uint32_t word) {
+        item.words.push_back(word);
+    };
+    auto branch = [&](uint32_t funct3, int rs1, int rs2, const std::string& target) {
+        item.kind = Item::BRANCH;
+        item.funct3 = funct3;
+        item.rs1 = rs1;
+        item.rs2 = rs2;
+        item.target = target;
+    };
+    auto jump = [&](int rd, const std::string& target) {
+        item.kind = Item::JUMP;
+        item.rd = rd;
+        item.target = target;
+    };
+    auto call = [&](int rd, int scratch, const std::string& target) {
+        item.kind = Item::CALL;
+        item.rd = rd;
+        item.rs1 = scratch;
+        item.target = target;
+    };
+
+    int rd, rs1, rs2;
+    int32_t value;
+
+    if (auto r = rTypeOps().find(op); r != rTypeOps().end()) {
+        if (!expect(3) || !reg(0, rd) || !reg(1, rs1) || !reg(2, rs2)) return false;
+        fixed(encodeR(r->second.first, rs2, rs1, r->second.second, rd, OP));
+    } else if (auto i = iTypeOps().find(op); i != iTypeOps().end()) {
+        if (!expect(3) || !reg(0, rd) || !reg(1, rs1) || !imm12(2, value)) return false;
+        fixed(encodeI(value, rs1, i->second, rd, OP_IMM));
+    } else if (auto s = shiftOps().find(op); s != shiftOps().end()) {
+        if (!expect(3) || !reg(0, rd) || !reg(1, rs1) || !imm(2, value)) return false;
+        if (value < 0 || value > 31) return fail("shift amount out of range");
+        fixed(encodeR(s->second.second, value, rs1, s->second.first, rd, OP_IMM));
+    } else if (auto l = loadOps().find(op); l != loadOps().end()) {
+        if (!expect(2) || !reg(0, rd) || !mem(1, rs1, value)) return false;
+        fixed(encodeI(value, rs1, l->second, rd, LOAD));
+    } else if (auto st = storeOps().find(op); st != storeOps().end()) {
+        if (!expect(2) || !reg(0, rs2) || !mem(1, rs1, value)) return false;
+        fixed(encodeS(value, rs2, rs1, st->second));
+    } else if (auto b = branchOps().find(op); b != branchOps().end()) {
+        if (!expect(3) || !reg(0, rs1) || !reg(1, rs2)) return false;
+        branch(b->second, rs1, rs2, ops[2]);
+    } else if (op == "beqz" || op == "bnez" || op == "bltz" || op == "bgez") {
+        if (!expect(2) || !reg(0, rs1)) return false;
+        branch(branchOps().at(op.substr(0, 3)), rs1, 0, ops[1]);
+    } else if (op == "bgtz" || op == "blez") {
+        if (!expect(2) || !reg(0, rs2)) return false;
+        branch(op == "bgtz" ? 4 : 5, 0, rs2, ops[1]);
+    } else if (op == "bgt" || op == "ble" || op == "bgtu" || op == "bleu") {
+        // 交换操作数
+        static const std::unordered_map<std::string, std::string> swapped = {
+            {"bgt", "blt"}, {"ble", "bge"}, {"bgtu", "bltu"}, {"bleu", "bgeu"}
+        };
+        if (!expect(3) || !reg(0, rs1) || !reg(1, rs2)) return false;
+        branch(branchOps().at(swapped.at(op)), rs2, rs1, ops[2]);
+    } else if (op == "li") {
+        if (!expect(2) || !reg(0, rd) || !imm(1, value)) return false;
+        if (fitsSigned(value, 12)) {
+            fixed(encodeI(value, 0, 0, rd, OP_IMM));
+        } else {
+            uint32_t hi = (static_cast<uint32_t>(value) + 0x800) >> 12;
+            int32_t lo = static_cast<int32_t>(static_cast<uint32_t>(value) - (hi << 12));
+            fixed(encodeU(hi, rd, LUI));
+            if (lo != 0) fixed(encodeI(lo, rd, 0, rd, OP_IMM));
+        }
+    } else if (op == "lui" || op == "auipc") {
+        if (!expect(2) || !reg(0, rd) || !imm(1, value)) return false;
+        if (value < -(1 << 19) || value > 0xfffff) return fail("immediate out of range '" + ops[1] + "'");
+        fixed(encodeU(static_cast<uint32_t>(value), rd, op == "lui" ? LUI : AUIPC));
+    } else if (op == "mv") {
+        if (!expect(2) || !reg(0, rd) || !reg(1, rs1)) return false;
+        fixed(encodeI(0, rs1, 0, rd, OP_IMM));
+    } else if (op == "not") {
+        if (!expect(2) || !reg(0, rd) || !reg(1, rs1)) return false;
+        fixed(encodeI(-1, rs1, 4, rd, OP_IMM));
+    } else if (op == "neg") {
+        if (!expect(2) || !reg(0, rd) || !reg(1, rs2)) return false;
+        fixed(encodeR(0x20, rs2, 0, 0, rd, OP));
+    } else if (op == "seqz") {
+        if (!expect(2) || !reg(0, rd) || !reg(1, rs1)) return false;
+        fixed(encodeI(1, rs1, 3, rd, OP_IMM));
+    } else if (op == "snez") {
+        if (!expect(2) || !reg(0, rd) || !reg(1, rs2)) return false;
+        fixed(encodeR(0, rs2, 0, 3, rd, OP));
+    } else if (op == "sltz") {
+        if (!expect(2) || !reg(0, rd) || !reg(1, rs1)) return false;
+        fixed(encodeR(0, 0, rs1, 2, rd, OP));
+    } else if (op == "sgtz") {
+        if (!expect(2) || !reg(0, rd) || !reg(1, rs2)) return false;
+        fixed(encodeR(0, rs2, 0, 2, rd, OP));
+    } else if (op == "nop") {
+        if (!expect(0)) return false;
+        fixed(encodeI(0, 0, 0, 0, OP_IMM));
+    } else if (op == "j") {
+        if (!expect(1)) return false;
+        jump(0, ops[0]);
+    } else if (op == "jal") {
+        if (ops.size() == 1) {
+            jump(RA, ops[0]);
+        } else {
+            if (!expect(2) || !reg(0, rd)) return false;
+            jump(rd, ops[1]);
+        }
+    } else if (op == "call") {
+        if (!expect(1)) return false;
+        call(RA, RA, ops[0]);
+    } else if (op == "tail") {
+        if (!expect(1)) return false;
+        call(0, T1, ops[0]);
+    } else if (op == "jr") {
+        if (!expect(1) || !reg(0, rs1)) return false;
+        fixed(encodeI(0, rs1, 0, 0, JALR));
+    } else if (op == "ret") {
+        if (!expect(0)) return false;
+        fixed(encodeI(0, RA, 0, 0, JALR));
+    } else if (op == "jalr") {
+        // jalr rs / jalr rd, off(rs) / jalr rd, rs, imm
+        if (ops.size() == 1) {
+            if (!reg(0, rs1)) return false;
+            fixed(encodeI(0, rs1, 0, RA, JALR));
+        } else if (ops.size() == 2) {
+            if (!reg(0, rd) || !mem(1, rs1, value)) return false;
+            fixed(encodeI(value, rs1, 0, rd, JALR));
+        } else {
+            if (!expect(3) || !reg(0, rd) || !reg(1, rs1) || !imm12(2, value)) return false;
+            fixed(encodeI(value, rs1, 0, rd, JALR));
+        }
+    } else if (op == "ecall") {
+        if (!expect(0)) return false;
+        fixed(0x00000073);
+    } else {
+        return fail("unsupported instruction");
+    }
+
+    items.push_back(std::move(item));
+    return true;
+}
+
+uint32_t RV32Encoder::addressOf(const std::string& label) const {
+    size_t index = labels.at(label);
+    if (index < items.size()) return items[index].address;
+    if (items.empty()) return 0;
+    const Item& last = items.back();
+    switch (last.kind) {
+        case Item::FIXED:  return last.address + 4 * last.words.size();
+        case Item::BRANCH: return last.address + (last.relaxed ? 8 : 4);
+        case Item::JUMP:   return last.address + 4;
+        default:           return last.address + 8;
+    }
+}
+
+bool RV32Encoder::isLocalTarget(const std::string& label) const {
+    return labels.count(label) > 0;
+}
+
+void RV32Encoder::layout() {
+    // 分支只会变长，迭代必然收敛
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        uint32_t address = 0;
+        for (auto& item : items) {
+            item.address = address;
+            switch (item.kind) {
+                case Item::FIXED:  address += 4 * item.words.size(); break;
+                case Item::BRANCH: address += item.relaxed ? 8 : 4; break;
+                case Item::JUMP:   address += 4; break;
+                case Item::CALL:   address += 8; break;
+            }
+        }
+        for (auto& item : items) {
+            if (item.kind != Item::BRANCH || item.relaxed || !isLocalTarget(item.target)) continue;
+            int64_t offset = static_cast<int64_t>(addressOf(item.target)) - item.address;
+            if (offset < -4096 || offset > 4094) {
+                item.relaxed = true;
+                relaxedBranches++;
+                changed = true;
+            }
+        }
+    }
+}
+
+bool RV32Encoder::emitItem(const Item& item, ObjectCode& object) {
+    auto put = [&object](uint32_t word) {
+        for (int i = 0; i < 4; ++i) object.text.push_back(static_cast<uint8_t>(word >> (8 * i)));
+    };
+    auto relocate = [&object](uint32_t offset, RV32RelocType type, const std::string& symbol) {
+        object.relocations.push_back({offset, type, symbol, 0});
+    };
+    // 未定义的 .L 标签不能交给链接器
+    if (item.kind != Item::FIXED && !isLocalTarget(item.target) && item.target.compare(0, 2, ".L") == 0) {
+        return fail("undefined label '" + item.target + "'");
+    }
+
+    switch (item.kind) {
+        case Item::FIXED:
+            for (uint32_t word : item.words) put(word);
+            return true;
+
+        case Item::BRANCH: {
+            if (!isLocalTarget(item.target)) {
+                relocate(item.address, R_RISCV_BRANCH, item.target);
+                put(encodeB(0, item.rs2, item.rs1, item.funct3));
+                return true;
+            }
+            int64_t offset = static_cast<int64_t>(addressOf(item.target)) - item.address;
+            if (!item.relaxed) {
+                put(encodeB(static_cast<int32_t>(offset), item.rs2, item.rs1, item.funct3));
+                return true;
+            }
+            // 反转条件跳过紧随其后的 jal
+            offset -= 4;
+            if (offset < -(1 << 20) || offset >= (1 << 20)) return fail("branch target out of range");
+            put(encodeB(8, item.rs2, item.rs1, item.funct3 ^ 1));
+            put(encodeJ(static_cast<int32_t>(offset), 0));
+            return true;
+        }
+
+        case Item::JUMP: {
+            if (!isLocalTarget(item.target)) {
+                relocate(item.address, R_RISCV_JAL, item.target);
+                put(encodeJ(0, item.rd));
+                return true;
+            }
+            int64_t offset = static_cast<int64_t>(addressOf(item.target)) - item.address;
+            if (offset < -(1 << 20) || offset >= (1 << 20)) return fail("jump target out of range");
+            put(encodeJ(static_cast<int32_t>(offset), item.rd));
+            return true;
+        }
+
+        case Item::CALL: {
+            // 全局符号可能被替换，交给链接器；本文件内的局部函数直接回填
+            if (!isLocalTarget(item.target) || globals.count(item.target)) {
+                relocate(item.address, R_RISCV_CALL_PLT, item.target);
+                put(encodeU(0, item.rs1, AUIPC));
+                put(encodeI(0, item.rs1, 0, item.rd, JALR));
+                return true;
+            }
+            uint32_t offset = addressOf(item.target) - item.address;
+            uint32_t hi = (offset + 0x800) >> 12;
+            put(encodeU(hi, item.rs1, AUIPC));
+            put(encodeI(static_cast<int32_t>(offset - (hi << 12)), item.rs1, 0, item.rd, JALR));
+            return true;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "codegen/asm.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+// RISC-V ELF 重定位类型（psABI）
+enum RV32RelocType : uint32_t {
+    R_RISCV_BRANCH   = 16,
+    R_RISCV_JAL      = 17,
+    R_RISCV_CALL_PLT = 19
+};
+
+struct ObjectSymbol {
+    std::string name;
+    uint32_t value = 0;
+    uint32_t size = 0;
+    bool global = false;
+    bool defined = false;
+    bool function = false;
+};
+
+struct ObjectRelocation {
+    uint32_t offset;
+    RV32RelocType type;
+    std::string symbol;
+    int32_t addend;
+};
+
+// 编码结果：单个 .text 节的机器码、符号与重定位
+struct ObjectCode {
+    std::vector<uint8_t> text;
+    std::vector<ObjectSymbol> symbols;
+    std::vector<ObjectRelocation> relocations;
+};
+
+// RV32IM 汇编器：把代码生成输出的汇编文本编码为机器码
+//   - 本文件内的分支/跳转直接回填；条件分支超出 ±4KiB 时松弛为反转分支 + jal
+//   - call/tail 编码为 auipc + jalr；全局或外部符号生成 R_RISCV_CALL_PLT 重定位
+//   - 不生成 R_RISCV_RELAX，链接器不会移动已回填的分支
+class RV32Encoder {
+private:
+    // 待定长度的指令项
+    struct Item {
+        enum Kind { FIXED, BRANCH, JUMP, CALL };
+
+        Kind kind = FIXED;
+        std::vector<uint32_t> words;    // FIXED 的编码
+        uint32_t funct3 = 0;            // BRANCH
+        int rs1 = 0, rs2 = 0;           // BRANCH；CALL 时 rs1 为 auipc 的临时寄存器
+        int rd = 0;                     // JUMP / CALL 的链接寄存器
+        std::string target;
+        bool relaxed = false;           // BRANCH 是否已展开为两条指令
+        uint32_t address = 0;
+        std::string source;             // 出错时报告的原始行
+    };
+
+    std::vector<Item> items;
+    std::unordered_map<std::string, size_t> labels;    // 标签 -> 其后第一项的下标
+    std::vector<std::string> labelOrder;
+    std::unordered_set<std::string> globals;
+    std::unordered_set<std::string> functions;
+    std::unordered_map<std::string, size_t> sizeMarks;  // .size sym, .-sym 出现时的项下标
+    std::string error;
+    int relaxedBranches = 0;
+
+public:
+    // 编码失败（未知指令、立即数越界、未定义的本地标签、跳转超出范围）时返回false
+    bool encode(const std::string& assembly, ObjectCode& object);
+
+    const std::string& getError() const { return error; }
+    int getRelaxedBranches() const { return relaxedBranches; }
+
+private:
+    bool fail(const std::string& message);
+    bool addInstruction(const AsmLine& line);
+    bool addDirective(const AsmLine& line);
+    // 迭代增大越界分支直到地址不再变化
+    void layout();
+    bool emitItem(const Item& item, ObjectCode& object);
+    uint32_t addressOf(const std::string& label) const;
+    bool isLocalTarget(const std::string& label) const;
+};
@@ -0,0 +1,241 @@
+#include "codegen/frame.hpp"
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+namespace {
+
+// 循环里的访问按每层8次估计
+long accessWeight(size_t loopDepth) {
+    return 1L << (3 * std::min<size_t>(loopDepth, 4));
+}
+
+} // namespace
+
+void FrameLayout::compute(FunctionDefinition& func, bool promote) {
+    variables.clear();
+    references.clear();
+    bindings.clear();
+    loops.clear();
+    registerPool.clear();
+    calleeSaved.clear();
+    savedRegisters.clear();
+    hasCalls = false;
+    position = 0;
+    slotCount = 0;
+    promotedCount = 0;
+
+    // 参数作用域：寄存器传入的参数在入口处全部存入栈帧
+    bindings.enterScope();
+    for (size_t i = 0; i < func.parameters.size(); ++i) {
+        int v = declare(func.parameters[i].name);
+        variables[v].start = 0;
+        variables[v].end = 0;
+        variables[v].parameter = true;
+        if (i >= 8) {
+            variables[v].fixed = true;
+            variables[v].home.offset = 4 * static_cast<int>(i - 8);
+        }
+    }
+    position = 1;
+
+    // 按执行顺序的显式栈遍历；作用域和循环在子语句之后结束
+    enum Action { VISIT, EXIT_SCOPE, EXIT_LOOP };
+    std::vector<std::pair<Action, Statement*>> work{{VISIT, func.body.get()}};
+    while (!work.empty()) {
+        auto [action, stmt] = work.back();
+        work.pop_back();
+        if (action == EXIT_SCOPE) {
+            bindings.exitScope();
+            continue;
+        }
+        if (action == EXIT_LOOP) {
+            exitLoop();
+            continue;
+        }
+
+        if (auto block = dynamic_cast<Block*>(stmt)) {
+            bindings.enterScope();
+            work.push_back({EXIT_SCOPE, nullptr});
+            for (auto it = block->statements.rbegin(); it != block->statements.rend(); ++it) {
+                work.push_back({VISIT, it->get()});
+            }
+        } else if (auto decl = dynamic_cast<VariableDeclaration*>(stmt)) {
+            // 初值先求值，其中的同名引用仍指向外层变量
+            accessExpression(decl->initializer.get());
+            declare(decl->name);
+            access(*decl, decl->name);
+        } else if (auto assign = dynamic_cast<AssignmentStatement*>(stmt)) {
+            accessExpression(assign->value.get());
+            access(*assign, assign->variable);
+        } else if (auto ifStmt = dynamic_cast<IfStatement*>(stmt)) {
+            accessExpression(ifStmt->condition.get());
+            if (ifStmt->elseStatement) work.push_back({VISIT, ifStmt->elseStatement.get()});
+            work.push_back({VISIT, ifStmt->thenStatement.get()});
+        } else if (auto whileStmt = dynamic_cast<WhileStatement*>(stmt)) {
+            loops.push_back({position++, {}});
+            accessExpression(whileStmt->condition.get());
+            work.push_back({EXIT_LOOP, nullptr});
+            work.push_back({VISIT, whileStmt->body.get()});
+        } else if (auto ret = dynamic_cast<ReturnStatement*>(stmt)) {
+            accessExpression(ret->value.get());
+        } else if (auto exprStmt = dynamic_cast<ExpressionStatement*>(stmt)) {
+            accessExpression(exprStmt->expression.get());
+        }
+    }
+    bindings.clear();
+
+    if (promote) assignRegisters(func.parameters.size());
+    assignSlots();
+
+    // 保存区在栈槽之上，栈槽偏移要等用到的 s 寄存器确定之后才能算
+    std::vector<bool> used(registerPool.size(), false);
+    for (const auto& var : variables) {
+        if (var.reg >= 0) used[var.reg] = true;
+    }
+    for (size_t r = 0; r < registerPool.size(); ++r) {
+        if (used[r] && calleeSaved[r]) savedRegisters.push_back(registerPool[r]);
+    }
+    for (auto& var : variables) {
+        if (var.reg >= 0) {
+            var.home.reg = registerPool[var.reg];
+            promotedCount++;
+        } else if (!var.fixed) {
+            var.home.offset = savedOffset(savedRegisters.size() + var.slot);
+        }
+    }
+}
+
+const VariableHome* FrameLayout::lookup(const ASTNode& ref) const {
+    auto it = references.find(&ref);
+    if (it == references.end()) return nullptr;
+    return &variables[it->second].home;
+}
+
+int FrameLayout::declare(const std::string& name) {
+    int v = static_cast<int>(variables.size());
+    variables.emplace_back();
+    bindings.bind(name, v);
+    return v;
+}
+
+void FrameLayout::access(const ASTNode& ref, const std::string& name) {
+    const int* binding = bindings.lookup(name);
+    if (!binding) return;
+    int v = *binding;
+    references[&ref] = v;
+
+    Variable& var = variables[v];
+    if (var.start < 0) var.start = position;
+    var.end = position++;
+    var.weight += accessWeight(loops.size());
+
+    // 下一轮迭代还会读到它：登记到访问之前开始的最外层循环，在循环末尾延伸区间
+    auto loop = std::partition_point(loops.begin(), loops.end(),
+                                     [&](const Loop& l) { return l.start < var.start; });
+    if (loop != loops.end() && var.loopMarked != loop->start) {
+        var.loopMarked = loop->start;
+        loop->extended.push_back(v);
+    }
+}
+
+void FrameLayout::accessExpression(Expression* expr) {
+    if (!expr) return;
+    walkTree(*expr, [&](ASTNode& node) {
+        if (auto id = dynamic_cast<Identifier*>(&node)) {
+            access(*id, id->name);
+        } else if (dynamic_cast<FunctionCall*>(&node)) {
+            hasCalls = true;
+        }
+        return true;
+    });
+}
+
+void FrameLayout::exitLoop() {
+    for (int v : loops.back().extended) {
+        variables[v].end = std::max(variables[v].end, position);
+    }
+    loops.pop_back();
+    position++;
+}
+
+void FrameLayout::assignRegisters(size_t parameterCount) {
+    // 叶函数里调用约定不再需要的 a 寄存器（a0 留给返回值）
+    if (!hasCalls) {
+        for (size_t i = std::max<size_t>(parameterCount, 1); i < 8; ++i) {
+            registerPool.push_back("a" + std::to_string(i));
+            calleeSaved.push_back(false);
+        }
+    }
+    for (int i = 2; i <= 11; ++i) {
+        registerPool.push_back("s" + std::to_string(i));
+        calleeSaved.push_back(true);
+    }
+
+    std::vector<int> order(variables.size());
+    for (size_t v = 0; v < variables.size(); ++v) order[v] = static_cast<int>(v);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](int a, int b) { return variables[a].start < variables[b].start; });
+
+    // 线性扫描：s 寄存器要在序言/尾声各存取一次，只给至少省下三次访存的变量；
+    // 寄存器用尽时换下权重更低的占用者，它整个区间改放栈上
+    std::vector<int> holder(registerPool.size(), -1);
+    for (int v : order) {
+        Variable& var = variables[v];
+        for (auto& h : holder) {
+            if (h >= 0 && variables[h].end < var.start) h = -1;
+        }
+
+        // 栈上传入的参数在入口处装入寄存器，多一次访存
+        long benefit = var.weight - (var.fixed ? 1 : 0);
+        bool worthSaving = benefit >= 3;
+        int choice = -1;
+        for (size_t r = 0; r < registerPool.size() && choice < 0; ++r) {
+            if (holder[r] < 0 && (!calleeSaved[r] || worthSaving)) choice = static_cast<int>(r);
+        }
+        if (choice < 0 && worthSaving) {
+            int victim = -1;
+            for (size_t r = 0; r < registerPool.size(); ++r) {
+                if (victim < 0 || variables[holder[r]].weight < variables[holder[victim]].weight) {
+                    victim = static_cast<int>(r);
+                }
+            }
+            if (victim >= 0 && variables[holder[victim]].weight < var.weight) {
+                variables[holder[victim]].reg = -1;
+                choice = victim;
+            }
+        }
+        if (choice >= 0 && benefit > 0) {
+            var.reg = choice;
+            holder[choice] = v;
+        }
+    }
+}
+
+void FrameLayout::assignSlots() {
+    // 线性扫描：按区间起点分配，复用编号最小的已结束槽
+    std::vector<int> order;
+    for (size_t v = 0; v < variables.size(); ++v) {
+        if (!variables[v].fixed && variables[v].reg < 0) order.push_back(static_cast<int>(v));
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&](int a, int b) { return variables[a].start < variables[b].start; });
+
+    using Active = std::pair<int, int>;     // (区间终点, 槽)
+    std::priority_queue<Active, std::vector<Active>, std::greater<Active>> active;
+    std::priority_queue<int, std::vector<int>, std::greater<int>> freeSlots;
+    for (int v : order) {
+        Variable& var = variables[v];
+        while (!active.empty() && active.top().first < var.start) {
+            freeSlots.push(active.top().second);
+            active.pop();
+        }
+        if (freeSlots.empty()) {
+            var.slot = slotCount++;
+        } else {
+            var.slot = freeSlots.top();
+            freeSlots.pop();
+        }
+        active.push({var.end, var.slot});
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "ast/ast.hpp"
+#include "codegen/bindings.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// 局部变量的存放位置：寄存器，或者 fp 相对的栈槽
+struct VariableHome {
+    std::string reg;        // 为空时在栈上
+    int offset = 0;
+};
+
+// 栈帧布局与局部变量提升：按作用域解析每个变量引用，在源码顺序上计算变量的活跃区间
+// （首次访问到最后一次访问；循环外声明、循环内访问的变量延伸到循环末尾）。
+// 线性扫描把访问频繁的变量提升到寄存器，整个区间占用同一个寄存器，
+// 控制流汇合处各路径的值已经在同一寄存器里；其余变量按区间着色共用栈槽。
+//   - fp-4/fp-8 保存 ra 和旧 fp，其下是用到的 s 寄存器的保存区，再往下是栈槽
+//   - 寄存器传入的参数从入口起活跃；第9个及以后的参数由调用者放在 fp 之上
+//   - 叶函数可以使用未承载参数的 a1-a7，不需要保存；其余使用被调用者保存的 s2-s11
+//     （s1 留给大栈帧的基址）
+class FrameLayout {
+private:
+    struct Variable {
+        int start = -1;                 // 区间起点，-1 表示还没有访问
+        int end = -1;
+        long weight = 0;                // 按循环深度加权的访问次数
+        int reg = -1;                   // 寄存器池下标
+        int slot = -1;
+        bool fixed = false;             // 栈上传入的参数，内存位置由调用约定决定
+        bool parameter = false;
+        int loopMarked = -1;            // 已登记延伸到的循环
+        VariableHome home;
+    };
+
+    struct Loop {
+        int start;
+        std::vector<int> extended;      // 在循环外声明、循环内访问的变量
+    };
+
+    std::vector<Variable> variables;
+    std::unordered_map<const ASTNode*, int> references;     // 引用/赋值/声明 -> 变量
+    NameBindings<int> bindings;                             // 变量名 -> 变量
+    std::vector<Loop> loops;
+    std::vector<std::string> registerPool;
+    std::vector<bool> calleeSaved;                          // 与 registerPool 对应
+    std::vector<std::string> savedRegisters;
+    bool hasCalls;
+    int position;
+    int slotCount;
+    int promotedCount;
+
+public:
+    FrameLayout() : hasCalls(false), position(0), slotCount(0), promotedCount(0) {}
+
+    // promote为假时所有变量都留在栈上
+    void compute(FunctionDefinition& func, bool promote);
+
+    // 引用所指变量的位置；不认识的引用返回nullptr
+    const VariableHome* lookup(const ASTNode& ref) const;
+    const VariableHome& getParameter(size_t index) const { return variables[index].home; }
+
+    // 需要在序言中保存的 s 寄存器及其保存位置
+    const std::vector<std::string>& getSavedRegisters() const { return savedRegisters; }
+    static int savedOffset(size_t index) { return -12 - 4 * static_cast<int>(index); }
+
+    int getSlotCount() const { return slotCount; }
+    int getVariableCount() const { return static_cast<int>(variables.size()); }
+    int getPromotedCount() const { return promotedCount; }
+    // 局部区（不含 ra/fp）的字节数，以及每个变量独占一个槽时的字节数
+    int getLocalBytes() const { return 4 * static_cast<int>(savedRegisters.size() + slotCount); }
+    int getUnsharedBytes() const { return 4 * static_cast<int>(variables.size()); }
+
+private:
+    int declare(const std::string& name);
+    void access(const ASTNode& ref, const std::string& name);
+    void accessExpression(Expression* expr);
+    void exitLoop();
+    void assignRegisters(size_t parameterCount);
+    void assignSlots();
+};
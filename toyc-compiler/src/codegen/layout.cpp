@@ -0,0 +1,323 @@
+#include "codegen/layout.hpp"
+#include <unordered_set>
+#include <algorithm>
+#include <cmath>
+
+std::string BlockPlacement::invertBranch(const std::string& opcode) {
+    static const std::unordered_map<std::string, std::string> inverse = {
+        {"beqz", "bnez"}, {"bnez", "beqz"},
+        {"beq", "bne"},   {"bne", "beq"},
+        {"blt", "bge"},   {"bge", "blt"},
+        {"bltu", "bgeu"}, {"bgeu", "bltu"}
+    };
+    auto it = inverse.find(opcode);
+    return it == inverse.end() ? "" : it->second;
+}
+
+std::string BlockPlacement::place(const std::string& assembly) {
+    std::vector<AsmLine> code = parseAssembly(assembly);
+    place(code);
+    return printAssembly(code);
+}
+
+void BlockPlacement::place(std::vector<AsmLine>& code) {
+    // 函数入口：被call或.globl引用的标签，或者没有任何分支跳转到的标签
+    std::unordered_set<std::string> targeted;
+    std::unordered_set<std::string> entries;
+    for (const auto& line : code) {
+        if (line.isCall()) {
+            entries.insert(line.branchTarget());
+        } else if (line.isBranch() || line.format() == AsmFormat::JUMP) {
+            targeted.insert(line.branchTarget());
+        } else if (line.kind == AsmLine::DIRECTIVE && line.opcode == ".globl") {
+            entries.insert(line.text);
+        }
+    }
+    auto isEntry = [&](const AsmLine& line) {
+        return line.isLabel() && (entries.count(line.opcode) || !targeted.count(line.opcode));
+    };
+
+    std::vector<AsmLine> out;
+    size_t i = 0;
+    while (i < code.size() && !isEntry(code[i])) {
+        out.push_back(std::move(code[i++]));
+    }
+
+    while (i < code.size()) {
+        size_t end = i + 1;
+        while (end < code.size() && !isEntry(code[end])) end++;
+
+        // 函数末尾的空行不参与布局
+        size_t bodyEnd = end;
+        while (bodyEnd > i + 1 && code[bodyEnd - 1].kind == AsmLine::BLANK) bodyEnd--;
+
+        std::vector<AsmLine> body(std::make_move_iterator(code.begin() + i),
+                                  std::make_move_iterator(code.begin() + bodyEnd));
+        placeFunction(out, std::move(body));
+        for (size_t k = bodyEnd; k < end; ++k) out.push_back(std::move(code[k]));
+        i = end;
+    }
+
+    code = std::move(out);
+}
+
+void BlockPlacement::buildBlocks(std::vector<AsmLine> body) {
+    blocks.clear();
+    loops.clear();
+    blocks.emplace_back();
+
+    for (auto& line : body) {
+        BasicBlock* current = &blocks.back();
+        bool hasInstruction = std::any_of(current->lines.begin(), current->lines.end(),
+                                          [](const AsmLine& l) { return l.isInstruction(); });
+
+        if (line.isLabel() && hasInstruction) {
+            blocks.emplace_back();
+            current = &blocks.back();
+        }
+        if (line.isLabel() && current->label.empty()) {
+            current->label = line.opcode;
+        }
+
+        bool endsBlock = line.isBranch() || line.isJump();
+        current->lines.push_back(std::move(line));
+        if (endsBlock) blocks.emplace_back();
+    }
+
+    if (blocks.size() > 1 && blocks.back().lines.empty()) {
+        blocks.pop_back();
+    }
+}
+
+AsmLine* BlockPlacement::terminator(int block) {
+    auto& lines = blocks[block].lines;
+    for (auto it = lines.rbegin(); it != lines.rend(); ++it) {
+        if (!it->isInstruction()) continue;
+        if (it->isBranch() || it->isJump()) return &*it;
+        return nullptr;
+    }
+    return nullptr;
+}
+
+// 从该块出发、不经过条件分支就到达函数返回
+bool BlockPlacement::returnsSoon(int block) const {
+    int current = block;
+    for (int steps = 0; current >= 0 && steps < 8; ++steps) {
+        const BasicBlock& bb = blocks[current];
+        const AsmLine* last = nullptr;
+        for (auto it = bb.lines.rbegin(); it != bb.lines.rend(); ++it) {
+            if (it->isInstruction()) { last = &*it; break; }
+        }
+        if (last && (last->format() == AsmFormat::JR || last->format() == AsmFormat::RET)) return true;
+        if (last && last->isBranch()) return false;
+        current = (last && last->format() == AsmFormat::JUMP) ? bb.taken : bb.fallthrough;
+    }
+    return false;
+}
+
+double BlockPlacement::takenProbability(int block) const {
+    const BasicBlock& bb = blocks[block];
+    int t = bb.taken, f = bb.fallthrough;
+
+    // 回边：循环继续
+    if (t <= block) return 0.88;
+
+    // 离开最内层循环的分支
+    const std::pair<int, int>* inner = nullptr;
+    for (const auto& loop : loops) {
+        if (loop.first <= block && block <= loop.second &&
+            (!inner || loop.second - loop.first < inner->second - inner->first)) {
+            inner = &loop;
+        }
+    }
+    if (inner) {
+        bool takenInside = inner->first <= t && t <= inner->second;
+        bool fallInside = inner->first <= f && f <= inner->second;
+        if (!takenInside && fallInside) return 0.12;
+        if (takenInside && !fallInside) return 0.88;
+    }
+
+    // 提前返回的路径较冷
+    bool takenReturns = returnsSoon(t);
+    bool fallReturns = returnsSoon(f);
+    if (takenReturns && !fallReturns) return 0.28;
+    if (fallReturns && !takenReturns) return 0.72;
+
+    return 0.5;
+}
+
+std::vector<int> BlockPlacement::computeOrder() {
+    int n = blocks.size();
+
+    // 估计边权：局部概率 × 循环深度放大的块频率
+    std::vector<Edge> edges;
+    std::vector<double> maxInProb(n, 0.0);
+    for (int b = 0; b < n; ++b) {
+        double freq = std::pow(8.0, blocks[b].loopDepth);
+        AsmLine* term = terminator(b);
+        // 权重相同时偏向保持原来的直落
+        const double bias = 1e-6;
+
+        if (term && term->isBranch()) {
+            double p = takenProbability(b);
+            edges.push_back({b, blocks[b].taken, p * freq});
+            edges.push_back({b, blocks[b].fallthrough, (1 - p) * freq + bias});
+            maxInProb[blocks[b].taken] = std::max(maxInProb[blocks[b].taken], p);
+            maxInProb[blocks[b].fallthrough] = std::max(maxInProb[blocks[b].fallthrough], 1 - p);
+        } else if (blocks[b].taken >= 0) {
+            edges.push_back({b, blocks[b].taken, freq});
+            maxInProb[blocks[b].taken] = 1.0;
+        } else if (blocks[b].fallthrough >= 0) {
+            edges.push_back({b, blocks[b].fallthrough, freq + bias});
+            maxInProb[blocks[b].fallthrough] = 1.0;
+        }
+    }
+    // 冷块：只经由低概率边进入的提前返回块，以及不可达块
+    for (int b = 1; b < n; ++b) {
+        blocks[b].cold = maxInProb[b] == 0.0 || (maxInProb[b] < 0.5 && returnsSoon(b));
+    }
+
+    // 贪心合并链：尾接头
+    std::vector<std::vector<int>> chains(n);
+    std::vector<int> chainOf(n);
+    for (int b = 0; b < n; ++b) {
+        chains[b] = {b};
+        chainOf[b] = b;
+    }
+
+    std::stable_sort(edges.begin(), edges.end(),
+                     [](const Edge& a, const Edge& b) { return a.weight > b.weight; });
+    for (const auto& e : edges) {
+        int cu = chainOf[e.from], cv = chainOf[e.to];
+        if (cu == cv || e.to == 0) continue;
+        if (chains[cu].back() != e.from || chains[cv].front() != e.to) continue;
+
+        for (int b : chains[cv]) {
+            chains[cu].push_back(b);
+            chainOf[b] = cu;
+        }
+        chains[cv].clear();
+    }
+
+    // 入口链在前，其余按原顺序，冷链放到最后
+    std::vector<int> heads;
+    for (int c = 0; c < n; ++c) {
+        if (!chains[c].empty() && c != chainOf[0]) heads.push_back(c);
+    }
+    std::stable_sort(heads.begin(), heads.end(), [this, &chains](int a, int b) {
+        bool coldA = blocks[chains[a].front()].cold;
+        bool coldB = blocks[chains[b].front()].cold;
+        if (coldA != coldB) return !coldA;
+        return chains[a].front() < chains[b].front();
+    });
+
+    std::vector<int> order = chains[chainOf[0]];
+    for (int c : heads) {
+        order.insert(order.end(), chains[c].begin(), chains[c].end());
+    }
+    return order;
+}
+
+std::string BlockPlacement::ensureLabel(int block) {
+    BasicBlock& bb = blocks[block];
+    if (bb.label.empty()) {
+        // 以函数入口标签为命名空间，逐函数布局时也不会重名
+        const std::string& entry = blocks[0].label;
+        std::string base = entry.compare(0, 2, ".L") == 0 ? entry : ".L" + entry;
+        bb.label = base + "_bb" + std::to_string(labelCounter++);
+        bb.lines.insert(bb.lines.begin(), AsmLine::label(bb.label));
+    }
+    return bb.label;
+}
+
+void BlockPlacement::emitInOrder(std::vector<AsmLine>& out, const std::vector<int>& order) {
+    int n = order.size();
+
+    // 先补齐需要的标签，再改写控制转移
+    for (int k = 0; k < n; ++k) {
+        int b = order[k];
+        int next = k + 1 < n ? order[k + 1] : -1;
+        if (blocks[b].fallthrough >= 0 && blocks[b].fallthrough != next) {
+            ensureLabel(blocks[b].fallthrough);
+        }
+    }
+
+    for (int k = 0; k < n; ++k) {
+        int b = order[k];
+        int next = k + 1 < n ? order[k + 1] : -1;
+        BasicBlock& bb = blocks[b];
+        AsmLine* term = terminator(b);
+
+        if (term && term->isBranch()) {
+            if (bb.fallthrough != next) {
+                if (bb.taken == next) {
+                    // 目标块紧随其后：反转条件，原直落块变为跳转目标
+                    term->opcode = invertBranch(term->opcode);
+                    term->operands.back() = blocks[bb.fallthrough].label;
+                    branchesInverted++;
+                } else {
+                    bb.lines.push_back(AsmLine::instruction("j", {blocks[bb.fallthrough].label}));
+                }
+            }
+        } else if (term && term->format() == AsmFormat::JUMP) {
+            if (bb.taken == next) {
+                bb.lines.erase(bb.lines.begin() + (term - bb.lines.data()));
+                jumpsRemoved++;
+            }
+        } else if (!term && bb.fallthrough >= 0 && bb.fallthrough != next) {
+            bb.lines.push_back(AsmLine::instruction("j", {blocks[bb.fallthrough].label}));
+        }
+
+        for (auto& line : bb.lines) out.push_back(std::move(line));
+    }
+}
+
+void BlockPlacement::placeFunction(std::vector<AsmLine>& out, std::vector<AsmLine> body) {
+    std::vector<AsmLine> original = body;
+    buildBlocks(std::move(body));
+    labelCounter = 0;
+    int n = blocks.size();
+
+    std::unordered_map<std::string, int> labelToBlock;
+    for (int b = 0; b < n; ++b) {
+        for (const auto& line : blocks[b].lines) {
+            if (line.isLabel()) labelToBlock[line.opcode] = b;
+        }
+    }
+
+    // 解析后继；目标不在本函数内或末块直落出函数时保持原样
+    bool ok = true;
+    for (int b = 0; b < n && ok; ++b) {
+        AsmLine* term = terminator(b);
+        if (term && (term->isBranch() || term->format() == AsmFormat::JUMP)) {
+            auto it = labelToBlock.find(term->branchTarget());
+            if (it == labelToBlock.end() || (term->isBranch() && invertBranch(term->opcode).empty())) {
+                ok = false;
+                break;
+            }
+            blocks[b].taken = it->second;
+        }
+        bool fallsThrough = !term || term->isBranch();
+        if (fallsThrough) {
+            if (b + 1 >= n) ok = false;
+            else blocks[b].fallthrough = b + 1;
+        }
+    }
+
+    if (!ok) {
+        out.insert(out.end(), std::make_move_iterator(original.begin()),
+                   std::make_move_iterator(original.end()));
+        return;
+    }
+
+    for (int b = 0; b < n; ++b) {
+        int t = blocks[b].taken;
+        if (t >= 0 && t <= b) {
+            loops.emplace_back(t, b);
+            for (int k = t; k <= b; ++k) blocks[k].loopDepth++;
+        }
+    }
+
+    emitInOrder(out, computeOrder());
+    functionsLaidOut++;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "codegen/asm.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// 无profile的基本块布局：用静态启发式估计分支概率，
+// 按边权合并基本块链，使可能路径成为直落（fallthrough），冷块放到函数末尾
+//   - 循环回边视为跳转成立
+//   - 离开循环的分支视为不成立
+//   - 很快到达返回的后继（提前退出）视为冷路径
+class BlockPlacement {
+private:
+    struct BasicBlock {
+        std::vector<AsmLine> lines;     // 标签、指令与注释
+        std::string label;              // 块首标签（可能为空）
+        int taken = -1;                 // 分支/跳转目标块
+        int fallthrough = -1;           // 直落后继块
+        int loopDepth = 0;
+        bool cold = false;
+    };
+
+    struct Edge {
+        int from;
+        int to;
+        double weight;
+    };
+
+    std::vector<BasicBlock> blocks;
+    std::vector<std::pair<int, int>> loops;     // 回边确定的循环区间 [头, 尾]
+    int labelCounter;
+    int functionsLaidOut;
+    int jumpsRemoved;
+    int branchesInverted;
+
+public:
+    BlockPlacement() : labelCounter(0), functionsLaidOut(0), jumpsRemoved(0), branchesInverted(0) {}
+
+    std::string place(const std::string& assembly);
+    void place(std::vector<AsmLine>& code);
+
+    int getFunctionsLaidOut() const { return functionsLaidOut; }
+    int getJumpsRemoved() const { return jumpsRemoved; }
+    int getBranchesInverted() const { return branchesInverted; }
+
+    static std::string invertBranch(const std::string& opcode);
+
+private:
+    void placeFunction(std::vector<AsmLine>& out, std::vector<AsmLine> body);
+    void buildBlocks(std::vector<AsmLine> body);
+    bool returnsSoon(int block) const;
+    double takenProbability(int block) const;
+    std::vector<int> computeOrder();
+    void emitInOrder(std::vector<AsmLine>& out, const std::vector<int>& order);
+    std::string ensureLabel(int block);
+    AsmLine* terminator(int block);
+};
@@ -0,0 +1,155 @@
+#include "codegen/machine.hpp"
+#include "utils/utils.hpp"
+#include <unordered_map>
+#include <algorithm>
+#include <cstdlib>
+
+#ifndef TOYC_MTUNE_DIR
+#define TOYC_MTUNE_DIR "mtune"
+#endif
+
+namespace {
+
+const std::unordered_map<std::string, InstrClass>& classNames() {
+    static const std::unordered_map<std::string, InstrClass> names = {
+        {"alu", InstrClass::ALU},       {"load", InstrClass::LOAD},
+        {"store", InstrClass::STORE},   {"mul", InstrClass::MUL},
+        {"div", InstrClass::DIV},       {"branch", InstrClass::BRANCH},
+        {"jump", InstrClass::JUMP},     {"call", InstrClass::CALL},
+        {"other", InstrClass::OTHER}
+    };
+    return names;
+}
+
+} // namespace
+
+MachineModel::MachineModel() : name("generic"), issueWidth(1), takenBranchPenalty(2) {
+    for (int& l : latencies) l = 1;
+    latencies[static_cast<int>(InstrClass::LOAD)] = 2;
+    latencies[static_cast<int>(InstrClass::MUL)] = 3;
+    latencies[static_cast<int>(InstrClass::DIV)] = 20;
+}
+
+MachineModel MachineModel::generic() {
+    return MachineModel();
+}
+
+std::string MachineModel::signature() const {
+    std::string text = name + " " + std::to_string(issueWidth) + " " + std::to_string(takenBranchPenalty);
+    for (int l : latencies) {
+        text += " " + std::to_string(l);
+    }
+    return text;
+}
+
+bool MachineModel::load(const std::string& nameOrPath, MachineModel& model, std::string& error) {
+    if (nameOrPath.empty() || nameOrPath == "generic") {
+        model = generic();
+        return true;
+    }
+
+    // 先按路径查找，再到机器描述目录中按名字查找
+    std::string path = nameOrPath;
+    if (!Utils::fileExists(path)) {
+        path = Utils::joinPath(TOYC_MTUNE_DIR, nameOrPath + ".mtune");
+    }
+    if (!Utils::fileExists(path)) {
+        error = "Unknown -mtune target: " + nameOrPath;
+        return false;
+    }
+
+    MachineModel parsed;
+    parsed.name = Utils::getBaseName(path);
+    if (!parse(Utils::readFile(path), parsed, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    model = parsed;
+    return true;
+}
+
+bool MachineModel::parse(const std::string& text, MachineModel& model, std::string& error) {
+    std::istringstream input(text);
+    std::string raw;
+    int lineNo = 0;
+
+    while (std::getline(input, raw)) {
+        lineNo++;
+        std::string line = Utils::trim(raw.substr(0, raw.find('#')));
+        if (line.empty()) continue;
+
+        std::vector<std::string> fields = Utils::split(line, ' ');
+        const std::string& key = fields[0];
+
+        if (key == "name" && fields.size() == 2) {
+            model.name = fields[1];
+        } else if (key == "issue-width" && fields.size() == 2 && Utils::isNumber(fields[1])) {
+            model.issueWidth = std::max(1, std::atoi(fields[1].c_str()));
+        } else if (key == "taken-branch-penalty" && fields.size() == 2 && Utils::isNumber(fields[1])) {
+            model.takenBranchPenalty = std::max(0, std::atoi(fields[1].c_str()));
+        } else if (key == "latency" && fields.size() == 3 && Utils::isNumber(fields[2])) {
+            auto it = classNames().find(fields[1]);
+            if (it == classNames().end()) {
+                error = "line " + std::to_string(lineNo) + ": unknown instruction class '" + fields[1] + "'";
+                return false;
+            }
+            model.latencies[static_cast<int>(it->second)] = std::max(0, std::atoi(fields[2].c_str()));
+        } else {
+            error = "line " + std::to_string(lineNo) + ": cannot parse '" + line + "'";
+            return false;
+        }
+    }
+    return true;
+}
+
+InstrClass MachineModel::classify(const AsmLine& inst) {
+    const std::string& op = inst.opcode;
+    switch (inst.format()) {
+        case AsmFormat::LOAD:     return InstrClass::LOAD;
+        case AsmFormat::STORE:    return InstrClass::STORE;
+        case AsmFormat::BRANCH:
+        case AsmFormat::BRANCH_Z: return InstrClass::BRANCH;
+        case AsmFormat::JUMP:
+        case AsmFormat::JR:
+        case AsmFormat::RET:      return InstrClass::JUMP;
+        case AsmFormat::CALL:     return InstrClass::CALL;
+        case AsmFormat::R:
+            if (op == "mul" || op == "mulh") return InstrClass::MUL;
+            if (op == "div" || op == "divu" || op == "rem" || op == "remu") return InstrClass::DIV;
+            return InstrClass::ALU;
+        case AsmFormat::I:
+        case AsmFormat::U:
+        case AsmFormat::UNARY:
+        case AsmFormat::LI:       return InstrClass::ALU;
+        default:                  return InstrClass::OTHER;
+    }
+}
+
+int MachineModel::estimateCycles(const std::vector<AsmLine>& code) const {
+    std::unordered_map<std::string, int> readyAt;
+    int cycle = 0;
+    int issuedThisCycle = 0;
+    int count = 0;
+
+    for (const auto& inst : code) {
+        if (!inst.isInstruction()) continue;
+        count++;
+
+        int earliest = cycle;
+        for (const auto& reg : inst.usedRegisters()) {
+            auto it = readyAt.find(reg);
+            if (it != readyAt.end()) earliest = std::max(earliest, it->second);
+        }
+
+        if (earliest > cycle || issuedThisCycle >= issueWidth) {
+            cycle = std::max(earliest, cycle + 1);
+            issuedThisCycle = 0;
+        }
+        issuedThisCycle++;
+
+        std::string def = inst.definedRegister();
+        if (!def.empty()) readyAt[def] = cycle + latency(inst);
+    }
+
+    return count == 0 ? 0 : cycle + 1;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "codegen/asm.hpp"
+#include <string>
+#include <vector>
+
+// 指令类别（延迟模型的粒度）
+enum class InstrClass {
+    ALU, LOAD, STORE, MUL, DIV, BRANCH, JUMP, CALL, OTHER
+};
+
+// 按核心划分的流水线机器模型，由 -mtune 选择的机器描述文件提供
+// 文件格式（每行一项，# 开头为注释）：
+//   name <核心名>
+//   issue-width <每周期发射数>
+//   latency <alu|load|store|mul|div|branch|jump|call|other> <周期数>
+//   taken-branch-penalty <周期数>
+class MachineModel {
+private:
+    std::string name;
+    int issueWidth;
+    int takenBranchPenalty;
+    int latencies[static_cast<int>(InstrClass::OTHER) + 1];
+
+public:
+    MachineModel();
+
+    // 内置的通用顺序单发射模型
+    static MachineModel generic();
+    // 按名字或路径加载机器描述文件；失败时返回false并给出错误信息
+    static bool load(const std::string& nameOrPath, MachineModel& model, std::string& error);
+    static bool parse(const std::string& text, MachineModel& model, std::string& error);
+
+    const std::string& getName() const { return name; }
+    int getIssueWidth() const { return issueWidth; }
+    int getTakenBranchPenalty() const { return takenBranchPenalty; }
+    // 模型参数的文本表示（编译缓存的键用它区分不同的 -mtune）
+    std::string signature() const;
+
+    static InstrClass classify(const AsmLine& inst);
+    int latency(InstrClass cls) const { return latencies[static_cast<int>(cls)]; }
+    int latency(const AsmLine& inst) const { return latency(classify(inst)); }
+
+    // 估计一段直线代码在顺序流水线上的执行周期（含数据相关停顿）
+    int estimateCycles(const std::vector<AsmLine>& code) const;
+};
@@ -0,0 +1,275 @@
+#include "codegen/peephole.hpp"
+#include <unordered_set>
+
+// 规则表：按顺序在每个窗口位置尝试
+const std::vector<PeepholeOptimizer::Rule> PeepholeOptimizer::rules = {
+    {"store-load-forward", 2, &PeepholeOptimizer::storeLoadForward},
+    {"self-move",          1, &PeepholeOptimizer::selfMove},
+    {"zero-add",           2, &PeepholeOptimizer::zeroAdd},
+    {"copy-coalesce",      2, &PeepholeOptimizer::copyCoalesce},
+    {"compare-branch",     3, &PeepholeOptimizer::compareBranch},
+    {"slt-branch",         2, &PeepholeOptimizer::sltBranch},
+    {"jump-to-next",       1, &PeepholeOptimizer::jumpToNext},
+};
+
+namespace {
+
+bool isTempRegister(const std::string& reg) {
+    return reg.size() == 2 && reg[0] == 't' && reg[1] >= '0' && reg[1] <= '6';
+}
+
+} // namespace
+
+std::string PeepholeOptimizer::optimize(const std::string& assembly) {
+    std::vector<AsmLine> code = parseAssembly(assembly);
+    optimize(code);
+    return printAssembly(code);
+}
+
+void PeepholeOptimizer::optimize(std::vector<AsmLine>& code) {
+    lines = std::move(code);
+    removed.assign(lines.size(), false);
+    labelIndex.clear();
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (lines[i].isLabel()) labelIndex[lines[i].opcode] = i;
+    }
+
+    // 反复扫描直到不动点（改写可能暴露出更早位置的新模式）
+    bool changed = true;
+    for (int pass = 0; changed && pass < 8; ++pass) {
+        changed = false;
+        for (size_t i = 0; i < lines.size(); ++i) {
+            if (removed[i] || !lines[i].isInstruction()) continue;
+
+            bool applied = true;
+            while (applied && !removed[i]) {
+                applied = false;
+                for (size_t r = 0; r < rules.size(); ++r) {
+                    std::vector<size_t> window = collectWindow(i, rules[r].window);
+                    if (window.size() < rules[r].window) continue;
+                    if ((this->*rules[r].apply)(window)) {
+                        hits[r]++;
+                        applied = changed = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    code.clear();
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (!removed[i]) code.push_back(std::move(lines[i]));
+    }
+    lines.clear();
+    removed.clear();
+}
+
+std::vector<std::pair<std::string, int>> PeepholeOptimizer::getRuleHits() const {
+    std::vector<std::pair<std::string, int>> result;
+    for (size_t r = 0; r < rules.size(); ++r) {
+        result.emplace_back(rules[r].name, hits[r]);
+    }
+    return result;
+}
+
+int PeepholeOptimizer::getTotalHits() const {
+    int total = 0;
+    for (int h : hits) total += h;
+    return total;
+}
+
+// 收集从start开始的连续指令（跳过注释和已删除行，遇到标签停止）
+std::vector<size_t> PeepholeOptimizer::collectWindow(size_t start, size_t size) const {
+    std::vector<size_t> window;
+    for (size_t i = start; i < lines.size() && window.size() < size; ++i) {
+        if (removed[i]) continue;
+        const AsmLine& line = lines[i];
+        if (line.isLabel() || line.kind == AsmLine::DIRECTIVE) break;
+        if (!line.isInstruction()) continue;
+        window.push_back(i);
+        if (line.endsBlock()) break;
+    }
+    return window;
+}
+
+// 从给定位置出发的所有路径上，reg在被读之前都被覆盖或失效
+bool PeepholeOptimizer::isDeadAfter(const std::string& reg, std::vector<size_t> starts) const {
+    std::unordered_set<size_t> visited;
+    int budget = 256;
+
+    while (!starts.empty()) {
+        size_t pos = starts.back();
+        starts.pop_back();
+        if (!visited.insert(pos).second) continue;
+
+        for (size_t i = pos; i < lines.size(); ++i) {
+            if (--budget <= 0) return false;
+            if (removed[i] || !lines[i].isInstruction()) continue;
+
+            const AsmLine& line = lines[i];
+            if (line.reads(reg)) return false;
+            if (line.writes(reg)) break;
+
+            // 调用和返回会破坏临时寄存器，其余寄存器保守地视为活跃
+            if (line.isCall() || line.format() == AsmFormat::JR || line.format() == AsmFormat::RET) {
+                if (isTempRegister(reg)) break;
+                return false;
+            }
+
+            std::string target = line.branchTarget();
+            if (line.isBranch() || line.format() == AsmFormat::JUMP) {
+                auto it = labelIndex.find(target);
+                if (it == labelIndex.end()) return false;
+                starts.push_back(it->second);
+                if (line.format() == AsmFormat::JUMP) break;
+            }
+        }
+    }
+    return true;
+}
+
+// sw rs, M ; lw rd, M  =>  sw rs, M ; mv rd, rs
+bool PeepholeOptimizer::storeLoadForward(const std::vector<size_t>& w) {
+    AsmLine& store = lines[w[0]];
+    AsmLine& load = lines[w[1]];
+    if (store.opcode != "sw" || load.opcode != "lw") return false;
+    if (store.operands.size() != 2 || load.operands.size() != 2) return false;
+
+    int storeOff, loadOff;
+    std::string storeBase, loadBase;
+    if (!parseMemoryOperand(store.operands[1], storeOff, storeBase) ||
+        !parseMemoryOperand(load.operands[1], loadOff, loadBase)) {
+        return false;
+    }
+    if (storeOff != loadOff || storeBase != loadBase) return false;
+
+    const std::string& src = store.operands[0];
+    const std::string& dst = load.operands[0];
+    if (src == dst) {
+        remove(w[1]);
+    } else {
+        load = AsmLine::instruction("mv", {dst, src});
+    }
+    return true;
+}
+
+// mv rx, rx  =>  （删除）
+bool PeepholeOptimizer::selfMove(const std::vector<size_t>& w) {
+    const AsmLine& mv = lines[w[0]];
+    if (mv.opcode != "mv" || mv.operands.size() != 2 || mv.operands[0] != mv.operands[1]) return false;
+    remove(w[0]);
+    return true;
+}
+
+// addi rx, zero, 0 ; add rd, ra, rx  =>  mv rd, ra
+bool PeepholeOptimizer::zeroAdd(const std::vector<size_t>& w) {
+    const AsmLine& zero = lines[w[0]];
+    AsmLine& add = lines[w[1]];
+    if (zero.opcode != "addi" || zero.operands.size() != 3 ||
+        zero.operands[1] != "zero" || zero.operands[2] != "0") {
+        return false;
+    }
+    if (add.opcode != "add" || add.operands.size() != 3) return false;
+
+    const std::string reg = zero.operands[0];
+    std::string other;
+    if (add.operands[2] == reg) {
+        other = add.operands[1];
+    } else if (add.operands[1] == reg) {
+        other = add.operands[2];
+    } else {
+        return false;
+    }
+    if (other == reg) other = "zero";
+
+    std::string dst = add.operands[0];
+    add = AsmLine::instruction("mv", {dst, other});
+    if (dst == reg || isDeadAfter(reg, {w[1] + 1})) {
+        remove(w[0]);
+    }
+    return true;
+}
+
+// op tx, ... ; mv rd, tx  =>  op rd, ...   （tx 之后不再被读；写回提升变量的寄存器）
+bool PeepholeOptimizer::copyCoalesce(const std::vector<size_t>& w) {
+    AsmLine& def = lines[w[0]];
+    const AsmLine& mv = lines[w[1]];
+    if (mv.opcode != "mv" || mv.operands.size() != 2) return false;
+
+    const std::string& temp = mv.operands[1];
+    if (!isTempRegister(temp) || def.definedRegister() != temp || def.operands.empty()) return false;
+    AsmFormat f = def.format();
+    if (f != AsmFormat::R && f != AsmFormat::I && f != AsmFormat::U && f != AsmFormat::LOAD &&
+        f != AsmFormat::UNARY && f != AsmFormat::LI) {
+        return false;
+    }
+    if (!isDeadAfter(temp, {w[1] + 1})) return false;
+
+    def.operands[0] = mv.operands[0];
+    remove(w[1]);
+    return true;
+}
+
+// sub rd, ra, rb ; seqz/snez rd, rd ; beqz/bnez rd, L  =>  beq/bne ra, rb, L
+bool PeepholeOptimizer::compareBranch(const std::vector<size_t>& w) {
+    const AsmLine& sub = lines[w[0]];
+    const AsmLine& test = lines[w[1]];
+    AsmLine& branch = lines[w[2]];
+    if (sub.opcode != "sub" || sub.operands.size() != 3) return false;
+    if ((test.opcode != "seqz" && test.opcode != "snez") || test.operands.size() != 2) return false;
+    if ((branch.opcode != "beqz" && branch.opcode != "bnez") || branch.operands.size() != 2) return false;
+
+    const std::string& rd = sub.operands[0];
+    if (test.operands[0] != rd || test.operands[1] != rd || branch.operands[0] != rd) return false;
+
+    auto target = labelIndex.find(branch.operands[1]);
+    if (target == labelIndex.end() || !isDeadAfter(rd, {w[2] + 1, target->second})) return false;
+
+    // seqz后beqz：不相等时跳转；其余组合依此类推
+    bool equalTest = test.opcode == "seqz";
+    bool jumpIfZero = branch.opcode == "beqz";
+    std::string op = (equalTest == jumpIfZero) ? "bne" : "beq";
+
+    branch = AsmLine::instruction(op, {sub.operands[1], sub.operands[2], branch.operands[1]});
+    remove(w[0]);
+    remove(w[1]);
+    return true;
+}
+
+// slt rd, ra, rb ; beqz/bnez rd, L  =>  bge/blt ra, rb, L
+bool PeepholeOptimizer::sltBranch(const std::vector<size_t>& w) {
+    const AsmLine& slt = lines[w[0]];
+    AsmLine& branch = lines[w[1]];
+    if (slt.opcode != "slt" || slt.operands.size() != 3) return false;
+    if ((branch.opcode != "beqz" && branch.opcode != "bnez") || branch.operands.size() != 2) return false;
+
+    const std::string& rd = slt.operands[0];
+    if (branch.operands[0] != rd) return false;
+
+    auto target = labelIndex.find(branch.operands[1]);
+    if (target == labelIndex.end() || !isDeadAfter(rd, {w[1] + 1, target->second})) return false;
+
+    std::string op = branch.opcode == "beqz" ? "bge" : "blt";
+    branch = AsmLine::instruction(op, {slt.operands[1], slt.operands[2], branch.operands[1]});
+    remove(w[0]);
+    return true;
+}
+
+// j L ; L:  =>  L:
+bool PeepholeOptimizer::jumpToNext(const std::vector<size_t>& w) {
+    const AsmLine& jump = lines[w[0]];
+    if (jump.opcode != "j" || jump.operands.size() != 1) return false;
+
+    for (size_t i = w[0] + 1; i < lines.size(); ++i) {
+        if (removed[i]) continue;
+        const AsmLine& line = lines[i];
+        if (line.kind == AsmLine::COMMENT || line.kind == AsmLine::BLANK) continue;
+        if (!line.isLabel()) return false;
+        if (line.opcode == jump.operands[0]) {
+            remove(w[0]);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "codegen/asm.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+
+// 窥孔优化器：在生成的RISC-V指令流上滑动窗口，按规则表改写局部冗余
+class PeepholeOptimizer {
+public:
+    using RuleFn = bool (PeepholeOptimizer::*)(const std::vector<size_t>& window);
+
+    struct Rule {
+        const char* name;
+        size_t window;      // 规则需要的连续指令数
+        RuleFn apply;
+    };
+
+private:
+    static const std::vector<Rule> rules;
+
+    std::vector<AsmLine> lines;
+    std::vector<bool> removed;
+    std::unordered_map<std::string, size_t> labelIndex;
+    std::vector<int> hits;
+
+public:
+    PeepholeOptimizer() : hits(rules.size(), 0) {}
+
+    std::string optimize(const std::string& assembly);
+    void optimize(std::vector<AsmLine>& code);
+
+    // 每条规则的命中次数（按规则表顺序）
+    std::vector<std::pair<std::string, int>> getRuleHits() const;
+    int getTotalHits() const;
+
+private:
+    std::vector<size_t> collectWindow(size_t start, size_t size) const;
+    void remove(size_t index) { removed[index] = true; }
+    bool isDeadAfter(const std::string& reg, std::vector<size_t> starts) const;
+
+    // 规则实现
+    bool storeLoadForward(const std::vector<size_t>& w);
+    bool selfMove(const std::vector<size_t>& w);
+    bool zeroAdd(const std::vector<size_t>& w);
+    bool copyCoalesce(const std::vector<size_t>& w);
+    bool compareBranch(const std::vector<size_t>& w);
+    bool sltBranch(const std::vector<size_t>& w);
+    bool jumpToNext(const std::vector<size_t>& w);
+};
@@ -1,466 +1,633 @@
-#include "codegen/riscv.hpp"
-#include <iostream>
-#include <algorithm>
-
-// RegisterManager实现
-const std::vector<std::string> RegisterManager::tempRegs = {
-    "t0", "t1", "t2", "t3", "t4", "t5", "t6"
-};
-
-const std::vector<std::string> RegisterManager::savedRegs = {
-    "s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11"
-};
-
-RegisterManager::RegisterManager() : used(tempRegs.size() + savedRegs.size(), false) {}
-
-std::string RegisterManager::allocateTemp() {
-    for (size_t i = 0; i < tempRegs.size(); ++i) {
-        if (!used[i]) {
-            used[i] = true;
-            return tempRegs[i];
-        }
-    }
-    return ""; // 无可用寄存器
-}
-
-std::string RegisterManager::allocateSaved() {
-    for (size_t i = 0; i < savedRegs.size(); ++i) {
-        size_t idx = tempRegs.size() + i;
-        if (!used[idx]) {
-            used[idx] = true;
-            return savedRegs[i];
-        }
-    }
-    return ""; // 无可用寄存器
-}
-
-void RegisterManager::releaseRegister(const std::string& reg) {
-    int idx = getRegisterIndex(reg);
-    if (idx >= 0) {
-        used[idx] = false;
-    }
-}
-
-void RegisterManager::releaseAllTemp() {
-    for (size_t i = 0; i < tempRegs.size(); ++i) {
-        used[i] = false;
-    }
-}
-
-int RegisterManager::getRegisterIndex(const std::string& reg) const {
-    auto it = std::find(tempRegs.begin(), tempRegs.end(), reg);
-    if (it != tempRegs.end()) {
-        return it - tempRegs.begin();
-    }
-    
-    it = std::find(savedRegs.begin(), savedRegs.end(), reg);
-    if (it != savedRegs.end()) {
-        return tempRegs.size() + (it - savedRegs.begin());
-    }
-    
-    return -1;
-}
-
-// RISCVCodeGenerator实现
-std::string RISCVCodeGenerator::generate(CompilationUnit& unit, 
-                                        const std::unordered_map<std::string, FunctionInfo>& functions) {
-    functionTable = functions;
-    output.str("");
-    output.clear();
-    
-    // 生成汇编文件头部
-    emit(".text");
-    emit(".globl main");
-    emitComment("ToyC Compiler Generated Code");
-    
-    // 访问编译单元
-    unit.accept(*this);
-    
-    return output.str();
-}
-
-std::string RISCVCodeGenerator::newLabel(const std::string& prefix) {
-    return prefix + std::to_string(labelCounter++);
-}
-
-void RISCVCodeGenerator::emit(const std::string& instruction) {
-    output << "    " << instruction << "\n";
-}
-
-void RISCVCodeGenerator::emitLabel(const std::string& label) {
-    output << label << ":\n";
-}
-
-void RISCVCodeGenerator::emitComment(const std::string& comment) {
-    output << "    # " << comment << "\n";
-}
-
-std::string RISCVCodeGenerator::loadImmediate(int value, const std::string& reg) {
-    if (value >= -2048 && value <= 2047) {
-        emit("addi " + reg + ", zero, " + std::to_string(value));
-    } else {
-        // 对于大立即数，需要使用lui + addi
-        int upper = (value + 0x800) >> 12;
-        int lower = value & 0xfff;
-        if (lower >= 2048) lower -= 4096;
-        
-        emit("lui " + reg + ", " + std::to_string(upper));
-        if (lower != 0) {
-            emit("addi " + reg + ", " + reg + ", " + std::to_string(lower));
-        }
-    }
-    return reg;
-}
-
-void RISCVCodeGenerator::generateFunctionPrologue(const std::string& funcName, int frameSize) {
-    emitComment("Function: " + funcName);
-    emit("addi sp, sp, -" + std::to_string(frameSize));
-    emit("sw ra, " + std::to_string(frameSize - 4) + "(sp)");
-    emit("sw fp, " + std::to_string(frameSize - 8) + "(sp)");
-    emit("addi fp, sp, " + std::to_string(frameSize));
-}
-
-void RISCVCodeGenerator::generateFunctionEpilogue() {
-    emit("lw ra, " + std::to_string(currentFrameSize - 4) + "(sp)");
-    emit("lw fp, " + std::to_string(currentFrameSize - 8) + "(sp)");
-    emit("addi sp, sp, " + std::to_string(currentFrameSize));
-    emit("jr ra");
-}
-
-std::string RISCVCodeGenerator::evaluateExpression(Expression& expr) {
-    expr.accept(*this);
-    // 表达式的结果应该在某个寄存器中，这里简化处理
-    return "t0"; // 假设结果在t0中
-}
-
-int RISCVCodeGenerator::calculateFrameSize(const std::vector<Parameter>& params, Block& body) {
-    std::unordered_map<std::string, int> locals;
-    int offset = 0;
-    collectLocalVariables(body, locals, offset);
-    
-    // 8字节对齐，包括ra和fp的空间
-    int size = 8 + (-offset);
-    return (size + 7) & ~7;
-}
-
-void RISCVCodeGenerator::collectLocalVariables(Block& body, 
-                                             std::unordered_map<std::string, int>& locals, 
-                                             int& offset) {
-    for (auto& stmt : body.statements) {
-        if (auto varDecl = dynamic_cast<VariableDeclaration*>(stmt.get())) {
-            offset -= 4;
-            locals[varDecl->name] = offset;
-            symbolTable[varDecl->name] = Symbol(varDecl->name, Expression::INT, offset);
-        } else if (auto block = dynamic_cast<Block*>(stmt.get())) {
-            collectLocalVariables(*block, locals, offset);
-        }
-    }
-}
-
-// Visitor实现
-void RISCVCodeGenerator::visit(CompilationUnit& node) {
-    for (auto& func : node.functions) {
-        func->accept(*this);
-    }
-}
-
-void RISCVCodeGenerator::visit(FunctionDefinition& node) {
-    currentFunction = node.name;
-    symbolTable.clear();
-    
-    // 计算栈帧大小
-    currentFrameSize = calculateFrameSize(node.parameters, *node.body);
-    
-    // 生成函数标签
-    emitLabel(node.name);
-    
-    // 生成函数序言
-    generateFunctionPrologue(node.name, currentFrameSize);
-    
-    // 添加参数到符号表
-    int paramOffset = 8;
-    for (const auto& param : node.parameters) {
-        symbolTable[param.name] = Symbol(param.name, param.type, paramOffset, true);
-        paramOffset += 4;
-    }
-    
-    // 生成函数体代码
-    node.body->accept(*this);
-    
-    // 如果是void函数且没有显式return，添加默认return
-    if (node.returnType == Expression::VOID) {
-        generateFunctionEpilogue();
-    }
-    
-    emit(""); // 空行分隔
-}
-
-void RISCVCodeGenerator::visit(Block& node) {
-    for (auto& stmt : node.statements) {
-        stmt->accept(*this);
-    }
-}
-
-void RISCVCodeGenerator::visit(NumberLiteral& node) {
-    std::string reg = regManager.allocateTemp();
-    loadImmediate(node.value, reg);
-    // 结果存储在reg中，调用者需要知道这个寄存器
-}
-
-void RISCVCodeGenerator::visit(Identifier& node) {
-    auto it = symbolTable.find(node.name);
-    if (it != symbolTable.end()) {
-        std::string reg = regManager.allocateTemp();
-        const Symbol& symbol = it->second;
-        
-        if (symbol.isParameter) {
-            emit("lw " + reg + ", " + std::to_string(symbol.offset) + "(fp)");
-        } else {
-            emit("lw " + reg + ", " + std::to_string(symbol.offset) + "(fp)");
-        }
-    }
-}
-
-void RISCVCodeGenerator::visit(BinaryExpression& node) {
-    // 计算左操作数
-    node.left->accept(*this);
-    std::string leftReg = "t0"; // 假设结果在t0
-    
-    // 计算右操作数
-    node.right->accept(*this);
-    std::string rightReg = "t1"; // 假设结果在t1
-    
-    std::string resultReg = regManager.allocateTemp();
-    
-    switch (node.op) {
-        case BinaryExpression::ADD:
-            emit("add " + resultReg + ", " + leftReg + ", " + rightReg);
-            break;
-        case BinaryExpression::SUB:
-            emit("sub " + resultReg + ", " + leftReg + ", " + rightReg);
-            break;
-        case BinaryExpression::MUL:
-            emit("mul " + resultReg + ", " + leftReg + ", " + rightReg);
-            break;
-        case BinaryExpression::DIV:
-            emit("div " + resultReg + ", " + leftReg + ", " + rightReg);
-            break;
-        case BinaryExpression::MOD:
-            emit("rem " + resultReg + ", " + leftReg + ", " + rightReg);
-            break;
-        case BinaryExpression::LT:
-            emit("slt " + resultReg + ", " + leftReg + ", " + rightReg);
-            break;
-        case BinaryExpression::LE:
-            emit("slt " + resultReg + ", " + rightReg + ", " + leftReg);
-            emit("xori " + resultReg + ", " + resultReg + ", 1");
-            break;
-        case BinaryExpression::GT:
-            emit("slt " + resultReg + ", " + rightReg + ", " + leftReg);
-            break;
-        case BinaryExpression::GE:
-            emit("slt " + resultReg + ", " + leftReg + ", " + rightReg);
-            emit("xori " + resultReg + ", " + resultReg + ", 1");
-            break;
-        case BinaryExpression::EQ:
-            emit("sub " + resultReg + ", " + leftReg + ", " + rightReg);
-            emit("seqz " + resultReg + ", " + resultReg);
-            break;
-        case BinaryExpression::NE:
-            emit("sub " + resultReg + ", " + leftReg + ", " + rightReg);
-            emit("snez " + resultReg + ", " + resultReg);
-            break;
-        case BinaryExpression::AND: {
-            std::string falseLabel = newLabel("and_false");
-            std::string endLabel = newLabel("and_end");
-            
-            emit("beqz " + leftReg + ", " + falseLabel);
-            emit("beqz " + rightReg + ", " + falseLabel);
-            loadImmediate(1, resultReg);
-            emit("j " + endLabel);
-            emitLabel(falseLabel);
-            loadImmediate(0, resultReg);
-            emitLabel(endLabel);
-            break;
-        }
-        case BinaryExpression::OR: {
-            std::string trueLabel = newLabel("or_true");
-            std::string endLabel = newLabel("or_end");
-            
-            emit("bnez " + leftReg + ", " + trueLabel);
-            emit("bnez " + rightReg + ", " + trueLabel);
-            loadImmediate(0, resultReg);
-            emit("j " + endLabel);
-            emitLabel(trueLabel);
-            loadImmediate(1, resultReg);
-            emitLabel(endLabel);
-            break;
-        }
-    }
-    
-    regManager.releaseRegister(leftReg);
-    regManager.releaseRegister(rightReg);
-}
-
-void RISCVCodeGenerator::visit(UnaryExpression& node) {
-    node.operand->accept(*this);
-    std::string operandReg = "t0"; // 假设操作数在t0
-    std::string resultReg = regManager.allocateTemp();
-    
-    switch (node.op) {
-        case UnaryExpression::PLUS:
-            emit("mv " + resultReg + ", " + operandReg);
-            break;
-        case UnaryExpression::MINUS:
-            emit("sub " + resultReg + ", zero, " + operandReg);
-            break;
-        case UnaryExpression::NOT:
-            emit("seqz " + resultReg + ", " + operandReg);
-            break;
-    }
-    
-    regManager.releaseRegister(operandReg);
-}
-
-void RISCVCodeGenerator::visit(AssignmentStatement& node) {
-    // 计算右值
-    node.value->accept(*this);
-    std::string valueReg = "t0"; // 假设结果在t0
-    
-    // 存储到变量
-    auto it = symbolTable.find(node.variable);
-    if (it != symbolTable.end()) {
-        const Symbol& symbol = it->second;
-        emit("sw " + valueReg + ", " + std::to_string(symbol.offset) + "(fp)");
-    }
-    
-    regManager.releaseRegister(valueReg);
-}
-
-void RISCVCodeGenerator::visit(VariableDeclaration& node) {
-    if (node.initializer) {
-        node.initializer->accept(*this);
-        std::string valueReg = "t0"; // 假设结果在t0
-        
-        auto it = symbolTable.find(node.name);
-        if (it != symbolTable.end()) {
-            const Symbol& symbol = it->second;
-            emit("sw " + valueReg + ", " + std::to_string(symbol.offset) + "(fp)");
-        }
-        
-        regManager.releaseRegister(valueReg);
-    }
-}
-
-void RISCVCodeGenerator::visit(IfStatement& node) {
-    std::string elseLabel = newLabel("if_else");
-    std::string endLabel = newLabel("if_end");
-    
-    // 计算条件
-    node.condition->accept(*this);
-    std::string condReg = "t0"; // 假设条件结果在t0
-    
-    emit("beqz " + condReg + ", " + (node.elseStatement ? elseLabel : endLabel));
-    regManager.releaseRegister(condReg);
-    
-    // then分支
-    node.thenStatement->accept(*this);
-    
-    if (node.elseStatement) {
-        emit("j " + endLabel);
-        emitLabel(elseLabel);
-        node.elseStatement->accept(*this);
-    }
-    
-    emitLabel(endLabel);
-}
-
-void RISCVCodeGenerator::visit(WhileStatement& node) {
-    std::string loopLabel = newLabel("while_loop");
-    std::string endLabel = newLabel("while_end");
-    
-    breakLabels.push_back(endLabel);
-    continueLabels.push_back(loopLabel);
-    
-    emitLabel(loopLabel);
-    
-    // 计算条件
-    node.condition->accept(*this);
-    std::string condReg = "t0"; // 假设条件结果在t0
-    
-    emit("beqz " + condReg + ", " + endLabel);
-    regManager.releaseRegister(condReg);
-    
-    // 循环体
-    node.body->accept(*this);
-    
-    emit("j " + loopLabel);
-    emitLabel(endLabel);
-    
-    breakLabels.pop_back();
-    continueLabels.pop_back();
-}
-
-void RISCVCodeGenerator::visit(BreakStatement& node) {
-    if (!breakLabels.empty()) {
-        emit("j " + breakLabels.back());
-    }
-}
-
-void RISCVCodeGenerator::visit(ContinueStatement& node) {
-    if (!continueLabels.empty()) {
-        emit("j " + continueLabels.back());
-    }
-}
-
-void RISCVCodeGenerator::visit(ReturnStatement& node) {
-    if (node.value) {
-        node.value->accept(*this);
-        emit("mv a0, t0"); // 返回值放在a0寄存器
-    }
-    
-    generateFunctionEpilogue();
-}
-
-void RISCVCodeGenerator::visit(ExpressionStatement& node) {
-    node.expression->accept(*this);
-    regManager.releaseAllTemp(); // 表达式语句结束后释放所有临时寄存器
-}
-
-void RISCVCodeGenerator::visit(FunctionCall& node) {
-    // 保存调用者保存的寄存器
-    std::vector<std::string> callerSaved = {"t0", "t1", "t2", "t3", "t4", "t5", "t6"};
-    saveRegisters(callerSaved);
-    
-    // 准备参数（RISC-V调用约定：前8个参数通过a0-a7传递）
-    for (size_t i = 0; i < node.arguments.size() && i < 8; ++i) {
-        node.arguments[i]->accept(*this);
-        emit("mv a" + std::to_string(i) + ", t0");
-    }
-    
-    // 调用函数
-    emit("call " + node.functionName);
-    
-    // 恢复调用者保存的寄存器
-    restoreRegisters(callerSaved);
-    
-    // 如果函数有返回值，将其移动到临时寄存器
-    if (node.returnType == Expression::INT) {
-        std::string resultReg = regManager.allocateTemp();
-        emit("mv " + resultReg + ", a0");
-    }
-}
-
-void RISCVCodeGenerator::saveRegisters(const std::vector<std::string>& regs) {
-    for (const auto& reg : regs) {
-        emit("addi sp, sp, -4");
-        emit("sw " + reg + ", 0(sp)");
-    }
-}
-
-void RISCVCodeGenerator::restoreRegisters(const std::vector<std::string>& regs) {
-    for (auto it = regs.rbegin(); it != regs.rend(); ++it) {
-        emit("lw " + *it + ", 0(sp)");
-        emit("addi sp, sp, 4");
-    }
+#include "codegen/riscv.hpp"
+#include <iostream>
+#include <algorithm>
+
+// RegisterManager实现
+const std::vector<std::string> RegisterManager::tempRegs = {
+    "t0", "t1", "t2", "t3", "t4", "t5", "t6"
+};
+
+const std::vector<std::string> RegisterManager::savedRegs = {
+    "s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11"
+};
+
+RegisterManager::RegisterManager() : used(tempRegs.size() + savedRegs.size(), false) {}
+
+std::string RegisterManager::allocateTemp() {
+    for (size_t i = 0; i < tempRegs.size(); ++i) {
+        if (!used[i]) {
+            used[i] = true;
+            return tempRegs[i];
+        }
+    }
+    return ""; // 无可用寄存器
+}
+
+std::string RegisterManager::allocateSaved() {
+    for (size_t i = 0; i < savedRegs.size(); ++i) {
+        size_t idx = tempRegs.size() + i;
+        if (!used[idx]) {
+            used[idx] = true;
+            return savedRegs[i];
+        }
+    }
+    return ""; // 无可用寄存器
+}
+
+void RegisterManager::releaseRegister(const std::string& reg) {
+    int idx = getRegisterIndex(reg);
+    if (idx >= 0) {
+        used[idx] = false;
+    }
+}
+
+void RegisterManager::releaseAllTemp() {
+    for (size_t i = 0; i < tempRegs.size(); ++i) {
+        used[i] = false;
+    }
+}
+
+void RegisterManager::reserve(const std::string& reg) {
+    int idx = getRegisterIndex(reg);
+    if (idx >= 0) {
+        used[idx] = true;
+    }
+}
+
+bool RegisterManager::isTemp(const std::string& reg) {
+    return std::find(tempRegs.begin(), tempRegs.end(), reg) != tempRegs.end();
+}
+
+bool RegisterManager::isRegisterUsed(const std::string& reg) const {
+    int idx = getRegisterIndex(reg);
+    return idx >= 0 && used[idx];
+}
+
+int RegisterManager::freeTempCount() const {
+    int count = 0;
+    for (size_t i = 0; i < tempRegs.size(); ++i) {
+        if (!used[i]) count++;
+    }
+    return count;
+}
+
+std::vector<std::string> RegisterManager::usedTemps() const {
+    std::vector<std::string> result;
+    for (size_t i = 0; i < tempRegs.size(); ++i) {
+        if (used[i]) result.push_back(tempRegs[i]);
+    }
+    return result;
+}
+
+int RegisterManager::getRegisterIndex(const std::string& reg) const {
+    auto it = std::find(tempRegs.begin(), tempRegs.end(), reg);
+    if (it != tempRegs.end()) {
+        return it - tempRegs.begin();
+    }
+    
+    it = std::find(savedRegs.begin(), savedRegs.end(), reg);
+    if (it != savedRegs.end()) {
+        return tempRegs.size() + (it - savedRegs.begin());
+    }
+    
+    return -1;
+}
+
+// RISCVCodeGenerator实现
+std::string RISCVCodeGenerator::generate(CompilationUnit& unit, 
+                                        const std::unordered_map<std::string, FunctionInfo>& functions) {
+    functionTable = functions;
+    std::string result = generateHeader();
+    for (auto& func : unit.functions) {
+        result += generateFunction(*func);
+    }
+    return result;
+}
+
+std::string RISCVCodeGenerator::generateHeader() {
+    output.str("");
+    output.clear();
+    
+    // 生成汇编文件头部
+    emit(".text");
+    emit(".globl main");
+    emitComment("ToyC Compiler Generated Code");
+    
+    return output.str();
+}
+
+std::string RISCVCodeGenerator::generateFunction(FunctionDefinition& func) {
+    output.str("");
+    output.clear();
+    Walk::run(func.accept(*this));
+    return output.str();
+}
+
+std::string RISCVCodeGenerator::newLabel(const std::string& prefix) {
+    return ".L" + currentFunction + "_" + prefix + std::to_string(labelCounter++);
+}
+
+void RISCVCodeGenerator::emit(const std::string& instruction) {
+    output << "    " << instruction << "\n";
+}
+
+void RISCVCodeGenerator::emitLabel(const std::string& label) {
+    // 标签可能有多个前驱，s1里的帧基址不再可信
+    frameBaseValid = false;
+    output << label << ":\n";
+}
+
+void RISCVCodeGenerator::emitComment(const std::string& comment) {
+    output << "    # " << comment << "\n";
+}
+
+std::string RISCVCodeGenerator::loadImmediate(int value, const std::string& reg) {
+    if (value >= -2048 && value <= 2047) {
+        emit("addi " + reg + ", zero, " + std::to_string(value));
+    } else {
+        // 对于大立即数，需要使用lui + addi（lui立即数按20位无符号书写）
+        uint32_t upper = ((static_cast<uint32_t>(value) + 0x800) >> 12) & 0xfffff;
+        int lower = static_cast<int>(static_cast<uint32_t>(value) & 0xfff);
+        if (lower >= 2048) lower -= 4096;
+        
+        emit("lui " + reg + ", " + std::to_string(upper));
+        if (lower != 0) {
+            emit("addi " + reg + ", " + reg + ", " + std::to_string(lower));
+        }
+    }
+    return reg;
+}
+
+std::string RISCVCodeGenerator::frameAddress(int offset) {
+    if (offset >= -2048 && offset <= 2047) {
+        return std::to_string(offset) + "(fp)";
+    }
+    // 取最近的4096倍数作基址，余下部分落在12位偏移内；相邻的大偏移访问共用同一个基址
+    int base = (offset + 2048) & ~0xfff;
+    if (!frameBaseValid || frameBase != base) {
+        emit("lui s1, " + std::to_string((static_cast<uint32_t>(base) >> 12) & 0xfffff));
+        emit("add s1, s1, fp");
+        frameBase = base;
+        frameBaseValid = true;
+    }
+    return std::to_string(offset - base) + "(s1)";
+}
+
+std::string RISCVCodeGenerator::stackAddress(int offset, const std::string& scratch) {
+    if (offset <= 2047) {
+        return std::to_string(offset) + "(sp)";
+    }
+    loadImmediate(offset, scratch);
+    emit("add " + scratch + ", " + scratch + ", sp");
+    return "0(" + scratch + ")";
+}
+
+void RISCVCodeGenerator::adjustStack(int delta, const std::string& scratch) {
+    if (delta >= -2048 && delta <= 2047) {
+        emit("addi sp, sp, " + std::to_string(delta));
+    } else {
+        emit("add sp, sp, " + loadImmediate(delta, scratch));
+    }
+}
+
+void RISCVCodeGenerator::generateFunctionPrologue(const std::string& funcName, int frameSize) {
+    emitComment("Function: " + funcName);
+    if (frameSize <= 2047) {
+        emit("addi sp, sp, -" + std::to_string(frameSize));
+        emit("sw ra, " + std::to_string(frameSize - 4) + "(sp)");
+        emit("sw fp, " + std::to_string(frameSize - 8) + "(sp)");
+        emit("addi fp, sp, " + std::to_string(frameSize));
+    } else {
+        // 帧大小超出addi的立即数范围，经t0计算（此时还没有分配临时寄存器）
+        loadImmediate(frameSize, "t0");
+        emit("sub sp, sp, t0");
+        emit("add t0, sp, t0");
+        emit("sw ra, -4(t0)");
+        emit("sw fp, -8(t0)");
+        emit("mv fp, t0");
+    }
+    // s1是被调用者保存寄存器，保存在帧底；提升变量用到的s寄存器保存在ra/fp之下
+    if (useFrameBase) {
+        emit("sw s1, 0(sp)");
+    }
+    const auto& saved = frame.getSavedRegisters();
+    for (size_t i = 0; i < saved.size(); ++i) {
+        emit("sw " + saved[i] + ", " + std::to_string(FrameLayout::savedOffset(i)) + "(fp)");
+    }
+    frameBaseValid = false;
+}
+
+void RISCVCodeGenerator::generateFunctionEpilogue() {
+    const auto& saved = frame.getSavedRegisters();
+    for (size_t i = 0; i < saved.size(); ++i) {
+        emit("lw " + saved[i] + ", " + std::to_string(FrameLayout::savedOffset(i)) + "(fp)");
+    }
+    if (useFrameBase) {
+        emit("lw s1, 0(sp)");
+    }
+    if (currentFrameSize <= 2047) {
+        emit("lw ra, " + std::to_string(currentFrameSize - 4) + "(sp)");
+        emit("lw fp, " + std::to_string(currentFrameSize - 8) + "(sp)");
+        emit("addi sp, sp, " + std::to_string(currentFrameSize));
+    } else {
+        emit("lw ra, -4(fp)");
+        emit("mv sp, fp");
+        emit("lw fp, -8(sp)");
+    }
+    emit("jr ra");
+}
+
+Walk RISCVCodeGenerator::evaluateExpression(Expression& expr) {
+    resultReg.clear();
+    return expr.accept(*this);
+}
+
+std::string RISCVCodeGenerator::writableResult(const std::string& reg) {
+    if (RegisterManager::isTemp(reg)) return reg;
+    std::string temp = regManager.allocateTemp();
+    emit("mv " + temp + ", " + reg);
+    return temp;
+}
+
+void RISCVCodeGenerator::storeVariable(const VariableHome& home, const std::string& valueReg) {
+    if (home.reg.empty()) {
+        emit("sw " + valueReg + ", " + frameAddress(home.offset));
+    } else {
+        emit("mv " + home.reg + ", " + valueReg);
+    }
+}
+
+int RISCVCodeGenerator::calculateFrameSize(FunctionDefinition& func) {
+    frame.compute(func, promoteLocals);
+    frameBytesSaved = frame.getUnsharedBytes() - frame.getLocalBytes();
+    
+    // fp-4和fp-8保存ra和旧fp
+    // 局部变量或栈上传入的参数超出12位偏移时需要s1作基址，帧底多留一个槽保存s1
+    int size = 8 + frame.getLocalBytes();
+    useFrameBase = size > 2048 || func.parameters.size() > 8 + 512;
+    if (useFrameBase) size += 4;
+    
+    // 16字节对齐
+    return (size + 15) & ~15;
+}
+
+// Visitor实现
+Walk RISCVCodeGenerator::visit(CompilationUnit& node) {
+    for (auto& func : node.functions) {
+        co_await func->accept(*this);
+    }
+}
+
+Walk RISCVCodeGenerator::visit(FunctionDefinition& node) {
+    currentFunction = node.name;
+    labelCounter = 0;
+    
+    // 计算栈帧大小
+    currentFrameSize = calculateFrameSize(node);
+    
+    // 生成函数标签
+    emitLabel(node.name);
+    
+    // 生成函数序言
+    generateFunctionPrologue(node.name, currentFrameSize);
+    
+    // 前8个参数从a0-a7存入栈帧或所在寄存器，其余由调用者放在fp之上（提升的在此装入）
+    for (size_t i = 0; i < node.parameters.size(); ++i) {
+        const VariableHome& home = frame.getParameter(i);
+        if (i < 8) {
+            storeVariable(home, "a" + std::to_string(i));
+        } else if (!home.reg.empty()) {
+            emit("lw " + home.reg + ", " + frameAddress(home.offset));
+        }
+    }
+    
+    // 生成函数体代码
+    regManager.releaseAllTemp();
+    co_await node.body->accept(*this);
+    
+    // 直落到函数末尾（void函数或缺少return）时返回0
+    if (node.body->statements.empty() ||
+        !dynamic_cast<ReturnStatement*>(node.body->statements.back().get())) {
+        if (node.returnType != Expression::VOID) {
+            loadImmediate(0, "a0");
+        }
+        generateFunctionEpilogue();
+    }
+    
+    emit(""); // 空行分隔
+}
+
+Walk RISCVCodeGenerator::visit(Block& node) {
+    for (auto& stmt : node.statements) {
+        co_await stmt->accept(*this);
+    }
+}
+
+Walk RISCVCodeGenerator::visit(NumberLiteral& node) {
+    resultReg = regManager.allocateTemp();
+    loadImmediate(node.value, resultReg);
+    co_return;
+}
+
+Walk RISCVCodeGenerator::visit(Identifier& node) {
+    // 提升到寄存器的变量直接作为操作数
+    const VariableHome* home = frame.lookup(node);
+    if (home && !home->reg.empty()) {
+        resultReg = home->reg;
+        co_return;
+    }
+    resultReg = regManager.allocateTemp();
+    if (home) {
+        emit("lw " + resultReg + ", " + frameAddress(home->offset));
+    }
+    co_return;
+}
+
+Walk RISCVCodeGenerator::visit(BinaryExpression& node) {
+    // 短路求值：左值决定结果时不计算右操作数
+    if (node.op == BinaryExpression::AND || node.op == BinaryExpression::OR) {
+        std::string endLabel = newLabel(node.op == BinaryExpression::AND ? "and_end" : "or_end");
+        co_await evaluateExpression(*node.left);
+        std::string leftReg = writableResult(resultReg);
+        if (node.op == BinaryExpression::AND) {
+            emit("beqz " + leftReg + ", " + endLabel);
+        } else {
+            emit("snez " + leftReg + ", " + leftReg);
+            emit("bnez " + leftReg + ", " + endLabel);
+        }
+        // 两条路径的结果都要落在leftReg里
+        regManager.releaseRegister(leftReg);
+        co_await evaluateExpression(*node.right);
+        std::string rightReg = resultReg;
+        emit("snez " + leftReg + ", " + rightReg);
+        regManager.releaseRegister(rightReg);
+        regManager.reserve(leftReg);
+        emitLabel(endLabel);
+        resultReg = leftReg;
+        co_return;
+    }
+    
+    // 计算左操作数；求值开始时保证至少两个空闲临时寄存器，不足时把左值压栈
+    co_await evaluateExpression(*node.left);
+    std::string leftReg = resultReg;
+    bool spilled = RegisterManager::isTemp(leftReg) && regManager.freeTempCount() < 2;
+    if (spilled) {
+        saveRegisters({leftReg});
+        regManager.releaseRegister(leftReg);
+    }
+    
+    // 计算右操作数
+    co_await evaluateExpression(*node.right);
+    std::string rightReg = resultReg;
+    if (spilled) {
+        leftReg = regManager.allocateTemp();
+        restoreRegisters({leftReg});
+    }
+    
+    // 结果写回左操作数的寄存器；左操作数是变量的寄存器时改用右操作数的或新的临时寄存器
+    std::string resultReg = leftReg;
+    if (!RegisterManager::isTemp(leftReg)) {
+        resultReg = RegisterManager::isTemp(rightReg) ? rightReg : regManager.allocateTemp();
+    }
+    
+    switch (node.op) {
+        case BinaryExpression::ADD:
+            emit("add " + resultReg + ", " + leftReg + ", " + rightReg);
+            break;
+        case BinaryExpression::SUB:
+            emit("sub " + resultReg + ", " + leftReg + ", " + rightReg);
+            break;
+        case BinaryExpression::MUL:
+            emit("mul " + resultReg + ", " + leftReg + ", " + rightReg);
+            break;
+        case BinaryExpression::DIV:
+            emit("div " + resultReg + ", " + leftReg + ", " + rightReg);
+            break;
+        case BinaryExpression::MOD:
+            emit("rem " + resultReg + ", " + leftReg + ", " + rightReg);
+            break;
+        case BinaryExpression::LT:
+            emit("slt " + resultReg + ", " + leftReg + ", " + rightReg);
+            break;
+        case BinaryExpression::LE:
+            emit("slt " + resultReg + ", " + rightReg + ", " + leftReg);
+            emit("xori " + resultReg + ", " + resultReg + ", 1");
+            break;
+        case BinaryExpression::GT:
+            emit("slt " + resultReg + ", " + rightReg + ", " + leftReg);
+            break;
+        case BinaryExpression::GE:
+            emit("slt " + resultReg + ", " + leftReg + ", " + rightReg);
+            emit("xori " + resultReg + ", " + resultReg + ", 1");
+            break;
+        case BinaryExpression::EQ:
+            emit("sub " + resultReg + ", " + leftReg + ", " + rightReg);
+            emit("seqz " + resultReg + ", " + resultReg);
+            break;
+        case BinaryExpression::NE:
+            emit("sub " + resultReg + ", " + leftReg + ", " + rightReg);
+            emit("snez " + resultReg + ", " + resultReg);
+            break;
+        default:
+            break;
+    }
+    
+    if (rightReg != resultReg) regManager.releaseRegister(rightReg);
+    this->resultReg = resultReg;
+}
+
+Walk RISCVCodeGenerator::visit(UnaryExpression& node) {
+    co_await evaluateExpression(*node.operand);
+    std::string operandReg = resultReg;
+    std::string resultReg = operandReg;
+    if (node.op != UnaryExpression::PLUS && !RegisterManager::isTemp(operandReg)) {
+        resultReg = regManager.allocateTemp();
+    }
+    
+    switch (node.op) {
+        case UnaryExpression::PLUS:
+            break;
+        case UnaryExpression::MINUS:
+            emit("sub " + resultReg + ", zero, " + operandReg);
+            break;
+        case UnaryExpression::NOT:
+            emit("seqz " + resultReg + ", " + operandReg);
+            break;
+    }
+    
+    this->resultReg = resultReg;
+}
+
+Walk RISCVCodeGenerator::visit(AssignmentStatement& node) {
+    // 计算右值
+    co_await evaluateExpression(*node.value);
+    std::string valueReg = resultReg;
+    
+    // 存储到变量
+    if (const VariableHome* home = frame.lookup(node)) {
+        storeVariable(*home, valueReg);
+    }
+    
+    regManager.releaseRegister(valueReg);
+}
+
+Walk RISCVCodeGenerator::visit(VariableDeclaration& node) {
+    if (node.initializer) {
+        co_await evaluateExpression(*node.initializer);
+        std::string valueReg = resultReg;
+        
+        if (const VariableHome* home = frame.lookup(node)) {
+            storeVariable(*home, valueReg);
+        }
+        
+        regManager.releaseRegister(valueReg);
+    }
+}
+
+Walk RISCVCodeGenerator::visit(IfStatement& node) {
+    std::string elseLabel = newLabel("if_else");
+    std::string endLabel = newLabel("if_end");
+    
+    // 计算条件
+    co_await evaluateExpression(*node.condition);
+    std::string condReg = resultReg;
+    
+    emit("beqz " + condReg + ", " + (node.elseStatement ? elseLabel : endLabel));
+    regManager.releaseRegister(condReg);
+    
+    // then分支
+    co_await node.thenStatement->accept(*this);
+    
+    if (node.elseStatement) {
+        emit("j " + endLabel);
+        emitLabel(elseLabel);
+        co_await node.elseStatement->accept(*this);
+    }
+    
+    emitLabel(endLabel);
+}
+
+Walk RISCVCodeGenerator::visit(WhileStatement& node) {
+    std::string loopLabel = newLabel("while_loop");
+    std::string endLabel = newLabel("while_end");
+    
+    breakLabels.push_back(endLabel);
+    continueLabels.push_back(loopLabel);
+    
+    emitLabel(loopLabel);
+    
+    // 计算条件
+    co_await evaluateExpression(*node.condition);
+    std::string condReg = resultReg;
+    
+    emit("beqz " + condReg + ", " + endLabel);
+    regManager.releaseRegister(condReg);
+    
+    // 循环体
+    co_await node.body->accept(*this);
+    
+    emit("j " + loopLabel);
+    emitLabel(endLabel);
+    
+    breakLabels.pop_back();
+    continueLabels.pop_back();
+}
+
+Walk RISCVCodeGenerator::visit(BreakStatement& node) {
+    if (!breakLabels.empty()) {
+        emit("j " + breakLabels.back());
+    }
+    co_return;
+}
+
+Walk RISCVCodeGenerator::visit(ContinueStatement& node) {
+    if (!continueLabels.empty()) {
+        emit("j " + continueLabels.back());
+    }
+    co_return;
+}
+
+Walk RISCVCodeGenerator::visit(ReturnStatement& node) {
+    if (node.value) {
+        co_await evaluateExpression(*node.value);
+        std::string valueReg = resultReg;
+        emit("mv a0, " + valueReg); // 返回值放在a0寄存器
+        regManager.releaseRegister(valueReg);
+    }
+    
+    generateFunctionEpilogue();
+}
+
+Walk RISCVCodeGenerator::visit(ExpressionStatement& node) {
+    co_await evaluateExpression(*node.expression);
+    std::string valueReg = resultReg;
+    regManager.releaseRegister(valueReg);
+}
+
+Walk RISCVCodeGenerator::visit(FunctionCall& node) {
+    // 只保存调用时仍然活跃的临时寄存器
+    std::vector<std::string> callerSaved = regManager.usedTemps();
+    saveRegisters(callerSaved);
+    
+    // 实参依次求值后存入出参区（后面的实参可能含调用，不能直接放在a寄存器里）
+    // 出参区底部是第9个及以后的实参，调用时正好位于0(sp)起
+    int count = static_cast<int>(node.arguments.size());
+    int stackArgs = std::max(count - 8, 0);
+    int areaSize = (4 * count + 15) & ~15;
+    auto slotOffset = [&](int i) { return 4 * (i < 8 ? stackArgs + i : i - 8); };
+    
+    // 出参区过大时a寄存器兼作地址计算的临时寄存器（实参求值期间它们不承载值）
+    if (areaSize > 0) {
+        adjustStack(-areaSize, "a7");
+    }
+    for (int i = 0; i < count; ++i) {
+        co_await evaluateExpression(*node.arguments[i]);
+        std::string argReg = resultReg;
+        emit("sw " + argReg + ", " + stackAddress(slotOffset(i), "a7"));
+        regManager.releaseRegister(argReg);
+    }
+    
+    // RISC-V调用约定：前8个参数通过a0-a7传递
+    if (count > 0 && slotOffset(std::min(count, 8) - 1) > 2047) {
+        // 寄存器实参的槽在出参区顶部：a7指向a0的槽，最后才装入a7自己
+        emit("add a7, sp, " + loadImmediate(slotOffset(0), "a7"));
+        for (int i = 0; i < count && i < 8; ++i) {
+            emit("lw a" + std::to_string(i) + ", " + std::to_string(4 * i) + "(a7)");
+        }
+    } else {
+        for (int i = 0; i < count && i < 8; ++i) {
+            emit("lw a" + std::to_string(i) + ", " + std::to_string(slotOffset(i)) + "(sp)");
+        }
+    }
+    
+    // 调用函数
+    emit("call " + node.functionName);
+    
+    if (areaSize > 0) {
+        adjustStack(areaSize, "a1");
+    }
+    
+    // 恢复调用者保存的寄存器
+    restoreRegisters(callerSaved);
+    
+    // 如果函数有返回值，将其移动到临时寄存器
+    resultReg.clear();
+    if (node.returnType == Expression::INT) {
+        resultReg = regManager.allocateTemp();
+        emit("mv " + resultReg + ", a0");
+    }
+}
+
+void RISCVCodeGenerator::saveRegisters(const std::vector<std::string>& regs) {
+    for (const auto& reg : regs) {
+        emit("addi sp, sp, -4");
+        emit("sw " + reg + ", 0(sp)");
+    }
+}
+
+void RISCVCodeGenerator::restoreRegisters(const std::vector<std::string>& regs) {
+    for (auto it = regs.rbegin(); it != regs.rend(); ++it) {
+        emit("lw " + *it + ", 0(sp)");
+        emit("addi sp, sp, 4");
+    }
 }
\ No newline at end of file
@@ -1,85 +1,116 @@
-#pragma once
-#include "ast/ast.hpp"
-#include "semantic/analyzer.hpp"
-#include <string>
-#include <vector>
-#include <unordered_map>
-#include <sstream>
-
-// 寄存器管理
-class RegisterManager {
-private:
-    std::vector<bool> used;  // t0-t6, s0-s11
-    static const std::vector<std::string> tempRegs;
-    static const std::vector<std::string> savedRegs;
-    
-public:
-    RegisterManager();
-    
-    std::string allocateTemp();
-    std::string allocateSaved();
-    void releaseRegister(const std::string& reg);
-    void releaseAllTemp();
-    bool isRegisterUsed(const std::string& reg) const;
-    
-private:
-    int getRegisterIndex(const std::string& reg) const;
-};
-
-// 代码生成器
-class RISCVCodeGenerator : public Visitor {
-private:
-    std::ostringstream output;
-    RegisterManager regManager;
-    std::unordered_map<std::string, Symbol> symbolTable;
-    std::unordered_map<std::string, FunctionInfo> functionTable;
-    int labelCounter;
-    int currentFrameSize;
-    std::string currentFunction;
-    std::vector<std::string> breakLabels;
-    std::vector<std::string> continueLabels;
-    
-public:
-    RISCVCodeGenerator() : labelCounter(0), currentFrameSize(0) {}
-    
-    std::string generate(CompilationUnit& unit, const std::unordered_map<std::string, FunctionInfo>& functions);
-    
-    // Visitor接口实现
-    void visit(BinaryExpression& node) override;
-    void visit(UnaryExpression& node) override;
-    void visit(NumberLiteral& node) override;
-    void visit(Identifier& node) override;
-    void visit(FunctionCall& node) override;
-    void visit(AssignmentStatement& node) override;
-    void visit(VariableDeclaration& node) override;
-    void visit(Block& node) override;
-    void visit(IfStatement& node) override;
-    void visit(WhileStatement& node) override;
-    void visit(BreakStatement& node) override;
-    void visit(ContinueStatement& node) override;
-    void visit(ReturnStatement& node) override;
-    void visit(ExpressionStatement& node) override;
-    void visit(FunctionDefinition& node) override;
-    void visit(CompilationUnit& node) override;
-    
-private:
-    std::string newLabel(const std::string& prefix = "L");
-    void emit(const std::string& instruction);
-    void emitLabel(const std::string& label);
-    void emitComment(const std::string& comment);
-    
-    // 辅助函数
-    std::string loadImmediate(int value, const std::string& reg);
-    std::string getVariableAddress(const std::string& varName);
-    void generateFunctionPrologue(const std::string& funcName, int frameSize);
-    void generateFunctionEpilogue();
-    void saveRegisters(const std::vector<std::string>& regs);
-    void restoreRegisters(const std::vector<std::string>& regs);
-    
-    // 表达式求值，返回包含结果的寄存器
-    std::string evaluateExpression(Expression& expr);
-    
-    // 计算栈帧大小
-    int calculateFrameSize(const std::vector<Parameter>& params, Block& body);
-    void collectLocalVariables(Block& body, std::unordered_map<std::string, int>& locals, int& offset);
+#pragma once
+#include "ast/ast.hpp"
+#include "semantic/analyzer.hpp"
+#include "codegen/frame.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <sstream>
+
+// 寄存器管理
+class RegisterManager {
+private:
+    std::vector<bool> used;  // t0-t6, s0-s11
+    static const std::vector<std::string> tempRegs;
+    static const std::vector<std::string> savedRegs;
+    
+public:
+    RegisterManager();
+    
+    std::string allocateTemp();
+    std::string allocateSaved();
+    void releaseRegister(const std::string& reg);
+    void releaseAllTemp();
+    void reserve(const std::string& reg);
+    bool isRegisterUsed(const std::string& reg) const;
+    static bool isTemp(const std::string& reg);
+    int freeTempCount() const;
+    std::vector<std::string> usedTemps() const;
+    
+private:
+    int getRegisterIndex(const std::string& reg) const;
+};
+
+// 代码生成器
+class RISCVCodeGenerator : public Visitor {
+private:
+    std::ostringstream output;
+    RegisterManager regManager;
+    FrameLayout frame;          // 当前函数的栈槽分配
+    std::unordered_map<std::string, FunctionInfo> functionTable;
+    int labelCounter;
+    int currentFrameSize;
+    std::string currentFunction;
+    std::vector<std::string> breakLabels;
+    std::vector<std::string> continueLabels;
+    std::string resultReg;      // 最近一次表达式求值的结果寄存器（void调用为空）
+    // 超出12位偏移的栈帧访问经由 s1 = fp + frameBase；标签处失效（汇合点的值不确定）
+    bool useFrameBase;
+    bool frameBaseValid;
+    int frameBase;
+    int frameBytesSaved;        // 栈槽共用比每变量一槽省下的字节数
+    bool promoteLocals;         // 把局部变量提升到寄存器（-O1）
+    
+public:
+    RISCVCodeGenerator()
+        : labelCounter(0), currentFrameSize(0), useFrameBase(false), frameBaseValid(false), frameBase(0),
+          frameBytesSaved(0), promoteLocals(false) {}
+    
+    std::string generate(CompilationUnit& unit, const std::unordered_map<std::string, FunctionInfo>& functions);
+    
+    // 分开生成文件头和单个函数，供逐函数的增量编译使用；
+    // 标签以函数名为命名空间，单个函数的输出与它在文件中的位置无关
+    std::string generateHeader();
+    std::string generateFunction(FunctionDefinition& func);
+    void setFunctionTable(const std::unordered_map<std::string, FunctionInfo>& functions) { functionTable = functions; }
+    void setPromoteLocals(bool enabled) { promoteLocals = enabled; }
+    // 最近生成的函数的栈帧节省与提升到寄存器的变量数
+    int getFrameBytesSaved() const { return frameBytesSaved; }
+    int getPromotedLocals() const { return frame.getPromotedCount(); }
+    int getMemoryLocals() const { return frame.getVariableCount() - frame.getPromotedCount(); }
+    
+    // Visitor接口实现
+    Walk visit(BinaryExpression& node) override;
+    Walk visit(UnaryExpression& node) override;
+    Walk visit(NumberLiteral& node) override;
+    Walk visit(Identifier& node) override;
+    Walk visit(FunctionCall& node) override;
+    Walk visit(AssignmentStatement& node) override;
+    Walk visit(VariableDeclaration& node) override;
+    Walk visit(Block& node) override;
+    Walk visit(IfStatement& node) override;
+    Walk visit(WhileStatement& node) override;
+    Walk visit(BreakStatement& node) override;
+    Walk visit(ContinueStatement& node) override;
+    Walk visit(ReturnStatement& node) override;
+    Walk visit(ExpressionStatement& node) override;
+    Walk visit(FunctionDefinition& node) override;
+    Walk visit(CompilationUnit& node) override;
+    
+private:
+    std::string newLabel(const std::string& prefix = "L");
+    void emit(const std::string& instruction);
+    void emitLabel(const std::string& label);
+    void emitComment(const std::string& comment);
+    
+    // 辅助函数
+    std::string loadImmediate(int value, const std::string& reg);
+    std::string getVariableAddress(const std::string& varName);
+    // 访存操作数 off(fp) / off(sp)，偏移超出12位时先物化基址
+    std::string frameAddress(int offset);
+    std::string stackAddress(int offset, const std::string& scratch);
+    void adjustStack(int delta, const std::string& scratch);
+    void generateFunctionPrologue(const std::string& funcName, int frameSize);
+    void generateFunctionEpilogue();
+    void saveRegisters(const std::vector<std::string>& regs);
+    void restoreRegisters(const std::vector<std::string>& regs);
+    
+    // 表达式求值，co_await 之后结果寄存器在 resultReg 中；
+    // 结果可能是提升后变量自己的寄存器，要改写时先换成临时寄存器
+    Walk evaluateExpression(Expression& expr);
+    std::string writableResult(const std::string& reg);
+    void storeVariable(const VariableHome& home, const std::string& valueReg);
+    
+    // 分配栈槽并计算栈帧大小
+    int calculateFrameSize(FunctionDefinition& func);
 };
\ No newline at end of file
@@ -0,0 +1,199 @@
+#include "codegen/scheduler.hpp"
+#include <unordered_map>
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// 调度区域上限，避免超长直线代码的依赖图过大
+const size_t MAX_REGION = 256;
+
+int accessWidth(const std::string& opcode) {
+    if (opcode == "lb" || opcode == "lbu" || opcode == "sb") return 1;
+    if (opcode == "lh" || opcode == "lhu" || opcode == "sh") return 2;
+    return 4;
+}
+
+bool isMemory(const AsmLine& inst) {
+    AsmFormat f = inst.format();
+    return f == AsmFormat::LOAD || f == AsmFormat::STORE;
+}
+
+} // namespace
+
+std::string InstructionScheduler::schedule(const std::string& assembly) {
+    std::vector<AsmLine> code = parseAssembly(assembly);
+    schedule(code);
+    return printAssembly(code);
+}
+
+void InstructionScheduler::schedule(std::vector<AsmLine>& code) {
+    size_t i = 0;
+    while (i < code.size()) {
+        // 基本块：连续的已知格式指令，以分支/跳转/调用结束
+        if (!code[i].isInstruction() || code[i].format() == AsmFormat::UNKNOWN) {
+            i++;
+            continue;
+        }
+
+        size_t begin = i;
+        while (i < code.size() && code[i].isInstruction() &&
+               code[i].format() != AsmFormat::UNKNOWN && i - begin < MAX_REGION) {
+            bool terminator = code[i].endsBlock();
+            i++;
+            if (terminator) break;
+        }
+
+        if (i - begin >= 3) {
+            scheduleBlock(code, begin, i);
+        }
+    }
+}
+
+// 两个访存操作是否可能访问重叠的内存：基址寄存器不同或版本不同时偏移不可比较
+bool InstructionScheduler::mayAlias(const MemoryRef& a, const MemoryRef& b) {
+    if (!a.known || !b.known || a.base != b.base || a.version != b.version) return true;
+    return a.offset < b.offset + b.width && b.offset < a.offset + a.width;
+}
+
+void InstructionScheduler::scheduleBlock(std::vector<AsmLine>& code, size_t begin, size_t end) {
+    size_t n = end - begin;
+    std::vector<Node> nodes(n);
+    for (size_t k = 0; k < n; ++k) nodes[k].line = begin + k;
+
+    auto addEdge = [&nodes](size_t from, size_t to, int lat) {
+        nodes[from].succs.push_back(to);
+        nodes[from].succLatency.push_back(lat);
+        nodes[to].predCount++;
+    };
+
+    // 构建依赖图
+    std::unordered_map<std::string, size_t> lastDef;
+    std::unordered_map<std::string, std::vector<size_t>> usesSinceDef;
+    std::vector<size_t> loads, stores;
+    // 基址版本：块内每改写一次寄存器版本加一，访存记录访问时基址的版本
+    std::unordered_map<std::string, int> writeCount;
+    std::vector<MemoryRef> refs(n);
+
+    for (size_t k = 0; k < n; ++k) {
+        const AsmLine& inst = code[begin + k];
+        std::vector<std::string> uses = inst.usedRegisters();
+        std::string def = inst.definedRegister();
+
+        // RAW
+        for (const auto& reg : uses) {
+            auto it = lastDef.find(reg);
+            if (it != lastDef.end()) {
+                addEdge(it->second, k, model.latency(code[begin + it->second]));
+            }
+        }
+
+        if (!def.empty()) {
+            // WAR
+            for (size_t u : usesSinceDef[def]) {
+                if (u != k) addEdge(u, k, 0);
+            }
+            // WAW
+            auto it = lastDef.find(def);
+            if (it != lastDef.end()) addEdge(it->second, k, 1);
+
+            lastDef[def] = k;
+            usesSinceDef[def].clear();
+        }
+        for (const auto& reg : uses) {
+            if (reg != def) usesSinceDef[reg].push_back(k);
+        }
+
+        // 访存顺序
+        if (isMemory(inst)) {
+            MemoryRef& ref = refs[k];
+            ref.known = parseMemoryOperand(inst.operands.back(), ref.offset, ref.base);
+            if (ref.known) {
+                auto it = writeCount.find(ref.base);
+                ref.version = it == writeCount.end() ? 0 : it->second;
+                ref.width = accessWidth(inst.opcode);
+            }
+
+            bool isStore = inst.format() == AsmFormat::STORE;
+            for (size_t s : stores) {
+                if (mayAlias(refs[s], ref)) addEdge(s, k, 1);
+            }
+            if (isStore) {
+                for (size_t l : loads) {
+                    if (mayAlias(refs[l], ref)) addEdge(l, k, 0);
+                }
+                stores.push_back(k);
+            } else {
+                loads.push_back(k);
+            }
+        }
+        // 本条指令的地址用的是改写前的值，之后的访存才看到新版本
+        if (!def.empty()) writeCount[def]++;
+    }
+
+    // 块尾的控制转移必须最后发射
+    if (code[end - 1].endsBlock()) {
+        for (size_t k = 0; k + 1 < n; ++k) addEdge(k, n - 1, 0);
+    }
+
+    // 关键路径优先级（边总是从前指向后，逆序计算即可）
+    for (size_t k = n; k-- > 0; ) {
+        int prio = model.latency(code[begin + k]);
+        for (size_t e = 0; e < nodes[k].succs.size(); ++e) {
+            prio = std::max(prio, nodes[k].succLatency[e] + nodes[nodes[k].succs[e]].priority);
+        }
+        nodes[k].priority = prio;
+    }
+
+    // 按周期推进的表调度
+    std::vector<size_t> order;
+    std::vector<size_t> ready;
+    for (size_t k = 0; k < n; ++k) {
+        if (nodes[k].predCount == 0) ready.push_back(k);
+    }
+
+    int cycle = 0;
+    while (order.size() < n) {
+        int issued = 0;
+        while (issued < model.getIssueWidth()) {
+            size_t best = n;
+            for (size_t r : ready) {
+                if (nodes[r].earliest > cycle) continue;
+                if (best == n || nodes[r].priority > nodes[best].priority ||
+                    (nodes[r].priority == nodes[best].priority && r < best)) {
+                    best = r;
+                }
+            }
+            if (best == n) break;
+
+            ready.erase(std::find(ready.begin(), ready.end(), best));
+            order.push_back(best);
+            issued++;
+
+            for (size_t e = 0; e < nodes[best].succs.size(); ++e) {
+                Node& succ = nodes[nodes[best].succs[e]];
+                succ.earliest = std::max(succ.earliest, cycle + nodes[best].succLatency[e]);
+                if (--succ.predCount == 0) ready.push_back(nodes[best].succs[e]);
+            }
+        }
+        cycle++;
+    }
+
+    std::vector<AsmLine> original(code.begin() + begin, code.begin() + end);
+    std::vector<AsmLine> scheduled;
+    scheduled.reserve(n);
+    for (size_t k : order) scheduled.push_back(original[k]);
+
+    int before = model.estimateCycles(original);
+    int after = model.estimateCycles(scheduled);
+    cyclesBefore += before;
+
+    // 只接受不变差的调度结果
+    if (after < before) {
+        std::copy(scheduled.begin(), scheduled.end(), code.begin() + begin);
+        cyclesAfter += after;
+        blocksScheduled++;
+    } else {
+        cyclesAfter += before;
+    }
+}
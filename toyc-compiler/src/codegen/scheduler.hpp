@@ -0,0 +1,48 @@
+#pragma once
+#include "codegen/asm.hpp"
+#include "codegen/machine.hpp"
+#include <string>
+#include <vector>
+
+// 基本块内的表调度器：按机器模型的延迟重排指令，隐藏load-use和乘除法延迟
+// 依赖关系：寄存器RAW/WAR/WAW、可能别名的访存、块尾的分支/跳转/调用
+class InstructionScheduler {
+private:
+    const MachineModel& model;
+    int blocksScheduled;
+    int cyclesBefore;
+    int cyclesAfter;
+
+    struct Node {
+        size_t line;                    // 在原指令流中的位置
+        std::vector<size_t> succs;
+        std::vector<int> succLatency;
+        int predCount = 0;
+        int priority = 0;               // 到块尾的关键路径长度
+        int earliest = 0;
+    };
+
+    // 访存地址：基址寄存器、块内基址版本、偏移和访问宽度
+    struct MemoryRef {
+        bool known = false;             // 地址不是 offset(base) 形式时为假
+        std::string base;
+        int version = 0;
+        int offset = 0;
+        int width = 0;
+    };
+
+public:
+    explicit InstructionScheduler(const MachineModel& m)
+        : model(m), blocksScheduled(0), cyclesBefore(0), cyclesAfter(0) {}
+
+    std::string schedule(const std::string& assembly);
+    void schedule(std::vector<AsmLine>& code);
+
+    int getBlocksScheduled() const { return blocksScheduled; }
+    int getCyclesBefore() const { return cyclesBefore; }
+    int getCyclesAfter() const { return cyclesAfter; }
+
+private:
+    void scheduleBlock(std::vector<AsmLine>& code, size_t begin, size_t end);
+    static bool mayAlias(const MemoryRef& a, const MemoryRef& b);
+};
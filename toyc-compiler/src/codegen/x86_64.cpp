@@ -0,0 +1,819 @@
+#include "codegen/x86_64.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// 临时寄存器池：调用者保存且不参与 idiv（eax/edx 保留）
+const std::vector<std::string> tempRegs = {
+    "%ecx", "%esi", "%edi", "%r8d", "%r9d", "%r10d", "%r11d"
+};
+// 被调用者保存寄存器，用于存放局部变量
+const std::vector<std::string> calleeSavedRegs = {
+    "%ebx", "%r12d", "%r13d", "%r14d", "%r15d"
+};
+// System V 整数参数寄存器
+const std::vector<std::string> argRegs = {
+    "%edi", "%esi", "%edx", "%ecx", "%r8d", "%r9d"
+};
+
+std::string reg64(const std::string& reg32) {
+    static const std::unordered_map<std::string, std::string> names = {
+        {"%eax", "%rax"}, {"%ebx", "%rbx"}, {"%ecx", "%rcx"}, {"%edx", "%rdx"},
+        {"%esi", "%rsi"}, {"%edi", "%rdi"}, {"%r8d", "%r8"},  {"%r9d", "%r9"},
+        {"%r10d", "%r10"}, {"%r11d", "%r11"}, {"%r12d", "%r12"}, {"%r13d", "%r13"},
+        {"%r14d", "%r14"}, {"%r15d", "%r15"}
+    };
+    return names.at(reg32);
+}
+
+std::string reg8(const std::string& reg32) {
+    static const std::unordered_map<std::string, std::string> names = {
+        {"%eax", "%al"}, {"%ecx", "%cl"}, {"%esi", "%sil"}, {"%edi", "%dil"},
+        {"%r8d", "%r8b"}, {"%r9d", "%r9b"}, {"%r10d", "%r10b"}, {"%r11d", "%r11b"}
+    };
+    return names.at(reg32);
+}
+
+std::string conditionCode(BinaryExpression::Operator op) {
+    switch (op) {
+        case BinaryExpression::LT: return "l";
+        case BinaryExpression::LE: return "le";
+        case BinaryExpression::GT: return "g";
+        case BinaryExpression::GE: return "ge";
+        case BinaryExpression::EQ: return "e";
+        default:                   return "ne";
+    }
+}
+
+std::string invertCondition(const std::string& cc) {
+    static const std::unordered_map<std::string, std::string> inverse = {
+        {"l", "ge"}, {"ge", "l"}, {"le", "g"}, {"g", "le"}, {"e", "ne"}, {"ne", "e"}
+    };
+    return inverse.at(cc);
+}
+
+// 交换比较操作数后的条件码
+std::string swapCondition(const std::string& cc) {
+    static const std::unordered_map<std::string, std::string> swapped = {
+        {"l", "g"}, {"g", "l"}, {"le", "ge"}, {"ge", "le"}, {"e", "e"}, {"ne", "ne"}
+    };
+    return swapped.at(cc);
+}
+
+bool isComparison(BinaryExpression::Operator op) {
+    return op >= BinaryExpression::LT && op <= BinaryExpression::NE;
+}
+
+// 字面量或对字面量取负
+bool constantValue(const Expression& expr, int& value) {
+    // 沿取负链走到底，取负的次数决定符号
+    const Expression* inner = &expr;
+    bool negate = false;
+    while (auto un = dynamic_cast<const UnaryExpression*>(inner)) {
+        if (un->op != UnaryExpression::MINUS) return false;
+        negate = !negate;
+        inner = un->operand.get();
+    }
+    auto num = dynamic_cast<const NumberLiteral*>(inner);
+    if (!num) return false;
+    value = negate ? static_cast<int>(0u - static_cast<unsigned>(num->value)) : num->value;
+    return true;
+}
+
+// 不需要临时寄存器就能求值的叶子
+bool isLeaf(const Expression& expr) {
+    int value;
+    return constantValue(expr, value) || dynamic_cast<const Identifier*>(&expr);
+}
+
+} // namespace
+
+std::string X86CodeGenerator::generate(CompilationUnit& unit) {
+    output.str("");
+    output.clear();
+    returnTypes.clear();
+    for (const auto& func : unit.functions) {
+        returnTypes[func->name] = func->returnType;
+    }
+
+    emit(".text");
+    output << "    # ToyC Compiler Generated Code (x86-64 System V)\n";
+
+    Walk::run(unit.accept(*this));
+
+    emit(".section .note.GNU-stack,\"\",@progbits");
+    return output.str();
+}
+
+std::string X86CodeGenerator::newLabel() {
+    return ".L" + std::to_string(labelCounter++);
+}
+
+void X86CodeGenerator::emit(const std::string& instruction) {
+    output << "    " << instruction << "\n";
+}
+
+void X86CodeGenerator::emitLabel(const std::string& label) {
+    output << label << ":\n";
+}
+
+std::string X86CodeGenerator::allocTemp() {
+    for (size_t i = 0; i < tempRegs.size(); ++i) {
+        if (!tempUsed[i]) {
+            tempUsed[i] = true;
+            return tempRegs[i];
+        }
+    }
+    // evaluatePair 保证不会走到这里
+    throw std::runtime_error("x86-64 backend ran out of temporary registers in " + currentFunction);
+}
+
+void X86CodeGenerator::release(const X86Value& value) {
+    if (value.kind != X86Value::REG || !value.temp) return;
+    auto it = std::find(tempRegs.begin(), tempRegs.end(), value.location);
+    if (it != tempRegs.end()) tempUsed[it - tempRegs.begin()] = false;
+}
+
+int X86CodeGenerator::freeTemps() const {
+    return std::count(tempUsed.begin(), tempUsed.end(), false);
+}
+
+std::vector<std::string> X86CodeGenerator::liveTemps() const {
+    std::vector<std::string> live;
+    for (size_t i = 0; i < tempRegs.size(); ++i) {
+        if (tempUsed[i]) live.push_back(tempRegs[i]);
+    }
+    return live;
+}
+
+Walk X86CodeGenerator::evaluate(Expression& expr) {
+    return expr.accept(*this);
+}
+
+X86Value X86CodeGenerator::toTemp(const X86Value& value) {
+    if (value.kind == X86Value::REG && value.temp) return value;
+    std::string reg = allocTemp();
+    move(value, reg);
+    return X86Value::reg(reg, true);
+}
+
+void X86CodeGenerator::move(const X86Value& src, const std::string& dst) {
+    if (src.kind == X86Value::REG && src.location == dst) return;
+    emit("movl " + src.operand() + ", " + dst);
+}
+
+std::string X86CodeGenerator::lookup(const std::string& name) const {
+    const std::string* home = scopes.lookup(name);
+    return home ? *home : "%eax";
+}
+
+Walk X86CodeGenerator::evaluatePair(Expression& left, Expression& right, X86Value& l, X86Value& r) {
+    co_await evaluate(left);
+    l = current;
+    bool spill = l.temp && !isLeaf(right) && freeTemps() < 3;
+    if (spill) {
+        emit("pushq " + reg64(l.location));
+        release(l);
+        pushDepth++;
+    }
+    co_await evaluate(right);
+    r = current;
+    if (spill) {
+        std::string reg = allocTemp();
+        emit("popq " + reg64(reg));
+        pushDepth--;
+        l = X86Value::reg(reg, true);
+    }
+}
+
+Walk X86CodeGenerator::compare(Expression& left, Expression& right, BinaryExpression::Operator op, std::string& cc) {
+    X86Value l = X86Value::immediate(0), r = X86Value::immediate(0);
+    co_await evaluatePair(left, right, l, r);
+    cc = conditionCode(op);
+
+    if (l.kind == X86Value::IMM && r.kind != X86Value::IMM) {
+        std::swap(l, r);
+        cc = swapCondition(cc);
+    }
+    if (l.kind == X86Value::IMM || (l.kind == X86Value::MEM && r.kind == X86Value::MEM)) {
+        l = toTemp(l);
+    }
+
+    if (r.kind == X86Value::IMM && r.imm == 0 && l.kind == X86Value::REG) {
+        emit("testl " + l.location + ", " + l.location);
+    } else {
+        emit("cmpl " + r.operand() + ", " + l.operand());
+    }
+    release(l);
+    release(r);
+}
+
+Walk X86CodeGenerator::branchOn(Expression& expr, bool when, const std::string& label) {
+    int value;
+    if (constantValue(expr, value)) {
+        if ((value != 0) == when) emit("jmp " + label);
+        co_return;
+    }
+
+    if (auto bin = dynamic_cast<BinaryExpression*>(&expr)) {
+        if (bin->op == BinaryExpression::AND || bin->op == BinaryExpression::OR) {
+            bool absorbing = bin->op == BinaryExpression::OR;
+            if (when == absorbing) {
+                co_await branchOn(*bin->left, when, label);
+                co_await branchOn(*bin->right, when, label);
+            } else {
+                std::string skip = newLabel();
+                co_await branchOn(*bin->left, !when, skip);
+                co_await branchOn(*bin->right, when, label);
+                emitLabel(skip);
+            }
+            co_return;
+        }
+        if (isComparison(bin->op)) {
+            std::string cc;
+            co_await compare(*bin->left, *bin->right, bin->op, cc);
+            emit("j" + (when ? cc : invertCondition(cc)) + " " + label);
+            co_return;
+        }
+    }
+
+    if (auto un = dynamic_cast<UnaryExpression*>(&expr)) {
+        if (un->op == UnaryExpression::NOT) {
+            co_await branchOn(*un->operand, !when, label);
+            co_return;
+        }
+    }
+
+    co_await evaluate(expr);
+    X86Value v = current;
+    if (v.kind == X86Value::IMM) {
+        if ((v.imm != 0) == when) emit("jmp " + label);
+        co_return;
+    }
+    if (v.kind == X86Value::REG) {
+        emit("testl " + v.location + ", " + v.location);
+    } else {
+        emit("cmpl $0, " + v.operand());
+    }
+    release(v);
+    emit(std::string(when ? "jne " : "je ") + label);
+}
+
+void X86CodeGenerator::divide(const X86Value& dividend, const X86Value& divisor, bool remainder, const std::string& dst) {
+    X86Value d = divisor;
+
+    // 除数为常量 -1 时直接求负（idiv 在 INT_MIN / -1 时会陷入，RV32 语义是回绕）
+    if (d.kind == X86Value::IMM && d.imm == -1) {
+        move(dividend, dst);
+        emit(remainder ? "movl $0, " + dst : "negl " + dst);
+        return;
+    }
+    if (d.kind == X86Value::IMM) {
+        d = toTemp(d);
+    }
+
+    move(dividend, "%eax");
+    if (divisor.kind == X86Value::IMM) {
+        emit("cltd");
+        emit("idivl " + d.location);
+    } else {
+        std::string normal = newLabel();
+        std::string done = newLabel();
+        emit("cmpl $-1, " + d.operand());
+        emit("jne " + normal);
+        emit(remainder ? "xorl %edx, %edx" : "negl %eax");
+        emit("jmp " + done);
+        emitLabel(normal);
+        emit("cltd");
+        emit("idivl " + d.operand());
+        emitLabel(done);
+    }
+    release(d);
+    emit("movl " + std::string(remainder ? "%edx" : "%eax") + ", " + dst);
+}
+
+// 寄存器分配预处理
+void X86CodeGenerator::countUses(Statement& stmt, long weight, NameScopes& names,
+                                 std::unordered_map<const void*, long>& uses, std::vector<const void*>& order) {
+    // 显式栈按源码顺序处理语句；stmt 为空的项表示离开一个语句块
+    struct Pending { Statement* stmt; long weight; };
+    std::vector<Pending> stack{{&stmt, weight}};
+    while (!stack.empty()) {
+        Pending item = stack.back();
+        stack.pop_back();
+        if (!item.stmt) {
+            names.exitScope();
+            continue;
+        }
+        if (auto block = dynamic_cast<Block*>(item.stmt)) {
+            names.enterScope();
+            stack.push_back({nullptr, 0});
+            for (auto it = block->statements.rbegin(); it != block->statements.rend(); ++it) {
+                stack.push_back({it->get(), item.weight});
+            }
+        } else if (auto decl = dynamic_cast<VariableDeclaration*>(item.stmt)) {
+            if (decl->initializer) countUses(*decl->initializer, item.weight, names, uses);
+            names.bind(decl->name, decl);
+            uses[decl] += item.weight;
+            order.push_back(decl);
+        } else if (auto assign = dynamic_cast<AssignmentStatement*>(item.stmt)) {
+            countUses(*assign->value, item.weight, names, uses);
+            if (const void* const* var = names.lookup(assign->variable)) uses[*var] += item.weight;
+        } else if (auto ifStmt = dynamic_cast<IfStatement*>(item.stmt)) {
+            countUses(*ifStmt->condition, item.weight, names, uses);
+            if (ifStmt->elseStatement) stack.push_back({ifStmt->elseStatement.get(), item.weight});
+            stack.push_back({ifStmt->thenStatement.get(), item.weight});
+        } else if (auto whileStmt = dynamic_cast<WhileStatement*>(item.stmt)) {
+            long inner = std::min(item.weight * 8, 1L << 40);
+            countUses(*whileStmt->condition, inner, names, uses);
+            stack.push_back({whileStmt->body.get(), inner});
+        } else if (auto ret = dynamic_cast<ReturnStatement*>(item.stmt)) {
+            if (ret->value) countUses(*ret->value, item.weight, names, uses);
+        } else if (auto expr = dynamic_cast<ExpressionStatement*>(item.stmt)) {
+            countUses(*expr->expression, item.weight, names, uses);
+        }
+    }
+}
+
+void X86CodeGenerator::countUses(Expression& expr, long weight, NameScopes& names,
+                                 std::unordered_map<const void*, long>& uses) {
+    walkTree(expr, [&](ASTNode& node) {
+        if (auto id = dynamic_cast<Identifier*>(&node)) {
+            if (const void* const* var = names.lookup(id->name)) uses[*var] += weight;
+        }
+        return true;
+    });
+}
+
+void X86CodeGenerator::assignHomes(FunctionDefinition& node, int& stackSlots) {
+    homes.clear();
+    savedRegs.clear();
+
+    NameScopes names;
+    names.enterScope();
+    std::unordered_map<const void*, long> uses;
+    std::vector<const void*> order;
+    for (const auto& param : node.parameters) {
+        names.bind(param.name, &param);
+        uses[&param] += 1;
+        order.push_back(&param);
+    }
+    countUses(*node.body, 1, names, uses, order);
+
+    // 使用最频繁的变量进入被调用者保存寄存器
+    std::vector<const void*> ranked = order;
+    std::stable_sort(ranked.begin(), ranked.end(),
+                     [&uses](const void* a, const void* b) { return uses[a] > uses[b]; });
+    for (size_t i = 0; i < ranked.size() && i < calleeSavedRegs.size(); ++i) {
+        homes[ranked[i]] = calleeSavedRegs[i];
+        savedRegs.push_back(reg64(calleeSavedRegs[i]));
+    }
+
+    // 其余放栈上：第7个及以后的参数直接使用调用者传入的栈槽
+    int frameBase = 8 * savedRegs.size();
+    stackSlots = 0;
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (homes.count(order[i])) continue;
+        if (i >= argRegs.size() && i < node.parameters.size()) {
+            homes[order[i]] = std::to_string(16 + 8 * (i - argRegs.size())) + "(%rbp)";
+        } else {
+            stackSlots++;
+            homes[order[i]] = "-" + std::to_string(frameBase + 4 * stackSlots) + "(%rbp)";
+        }
+    }
+}
+
+// Visitor实现
+Walk X86CodeGenerator::visit(CompilationUnit& node) {
+    for (auto& func : node.functions) {
+        co_await func->accept(*this);
+    }
+}
+
+Walk X86CodeGenerator::visit(FunctionDefinition& node) {
+    currentFunction = node.name;
+    returnLabel = newLabel();
+    tempUsed.assign(tempRegs.size(), false);
+    pushDepth = 0;
+    scopes.clear();
+    scopes.enterScope();
+
+    int stackSlots;
+    assignHomes(node, stackSlots);
+
+    output << "\n";
+    if (node.name == "main") emit(".globl main");
+    emit(".type " + node.name + ", @function");
+    emitLabel(node.name);
+
+    // 序言：函数体内 rsp 保持16字节对齐
+    emit("pushq %rbp");
+    emit("movq %rsp, %rbp");
+    for (const auto& reg : savedRegs) {
+        emit("pushq " + reg);
+    }
+    int saved = 8 * savedRegs.size();
+    int frameSize = ((saved + 4 * stackSlots + 15) & ~15) - saved;
+    if (frameSize > 0) {
+        emit("subq $" + std::to_string(frameSize) + ", %rsp");
+    }
+
+    for (size_t i = 0; i < node.parameters.size(); ++i) {
+        const std::string& home = homes[&node.parameters[i]];
+        if (i < argRegs.size()) {
+            emit("movl " + argRegs[i] + ", " + home);
+        } else if (home[0] == '%') {
+            emit("movl " + std::to_string(16 + 8 * (i - argRegs.size())) + "(%rbp), " + home);
+        }
+        scopes.bind(node.parameters[i].name, home);
+    }
+
+    co_await node.body->accept(*this);
+
+    // 直落到函数末尾时返回0
+    emit("xorl %eax, %eax");
+    emitLabel(returnLabel);
+    if (savedRegs.empty()) {
+        emit("leave");
+    } else {
+        emit("leaq -" + std::to_string(saved) + "(%rbp), %rsp");
+        for (auto it = savedRegs.rbegin(); it != savedRegs.rend(); ++it) {
+            emit("popq " + *it);
+        }
+        emit("popq %rbp");
+    }
+    emit("ret");
+    emit(".size " + node.name + ", .-" + node.name);
+}
+
+Walk X86CodeGenerator::visit(Block& node) {
+    scopes.enterScope();
+    for (auto& stmt : node.statements) {
+        co_await stmt->accept(*this);
+    }
+    scopes.exitScope();
+}
+
+Walk X86CodeGenerator::visit(NumberLiteral& node) {
+    current = X86Value::immediate(node.value);
+    co_return;
+}
+
+Walk X86CodeGenerator::visit(Identifier& node) {
+    std::string home = lookup(node.name);
+    current = home[0] == '%' ? X86Value::reg(home, false) : X86Value::mem(home);
+    co_return;
+}
+
+Walk X86CodeGenerator::visit(BinaryExpression& node) {
+    if (node.op == BinaryExpression::AND || node.op == BinaryExpression::OR) {
+        std::string falseLabel = newLabel();
+        std::string endLabel = newLabel();
+        co_await branchOn(node, false, falseLabel);
+        std::string dst = allocTemp();
+        emit("movl $1, " + dst);
+        emit("jmp " + endLabel);
+        emitLabel(falseLabel);
+        emit("movl $0, " + dst);
+        emitLabel(endLabel);
+        current = X86Value::reg(dst, true);
+        co_return;
+    }
+
+    if (isComparison(node.op)) {
+        std::string cc;
+        co_await compare(*node.left, *node.right, node.op, cc);
+        std::string dst = allocTemp();
+        emit("set" + cc + " " + reg8(dst));
+        emit("movzbl " + reg8(dst) + ", " + dst);
+        current = X86Value::reg(dst, true);
+        co_return;
+    }
+
+    X86Value l = X86Value::immediate(0), r = X86Value::immediate(0);
+    co_await evaluatePair(*node.left, *node.right, l, r);
+
+    if (node.op == BinaryExpression::DIV || node.op == BinaryExpression::MOD) {
+        std::string dst = l.temp ? l.location : allocTemp();
+        divide(l, r, node.op == BinaryExpression::MOD, dst);
+        release(r);
+        current = X86Value::reg(dst, true);
+        co_return;
+    }
+
+    // 可交换运算优先在已有的临时寄存器上计算
+    bool commutative = node.op == BinaryExpression::ADD || node.op == BinaryExpression::MUL;
+    if (commutative && !l.temp && r.temp) std::swap(l, r);
+
+    X86Value d = toTemp(l);
+    switch (node.op) {
+        case BinaryExpression::ADD:
+            emit("addl " + r.operand() + ", " + d.location);
+            break;
+        case BinaryExpression::SUB:
+            emit("subl " + r.operand() + ", " + d.location);
+            break;
+        default:
+            if (r.kind == X86Value::IMM) {
+                emit("imull " + r.operand() + ", " + d.location + ", " + d.location);
+            } else {
+                emit("imull " + r.operand() + ", " + d.location);
+            }
+            break;
+    }
+    release(r);
+    current = d;
+}
+
+Walk X86CodeGenerator::visit(UnaryExpression& node) {
+    if (node.op == UnaryExpression::MINUS) {
+        // 连续的取负一次走完，两两抵消；逐层调用 constantValue 在长链上是平方的
+        Expression* inner = &node;
+        bool negate = false;
+        while (auto un = dynamic_cast<UnaryExpression*>(inner)) {
+            if (un->op != UnaryExpression::MINUS) break;
+            negate = !negate;
+            inner = un->operand.get();
+        }
+        if (auto num = dynamic_cast<NumberLiteral*>(inner)) {
+            current = X86Value::immediate(negate ? static_cast<int>(0u - static_cast<unsigned>(num->value))
+                                                 : num->value);
+            co_return;
+        }
+        co_await evaluate(*inner);
+        if (negate) {
+            X86Value d = toTemp(current);
+            emit("negl " + d.location);
+            current = d;
+        }
+        co_return;
+    }
+
+    co_await evaluate(*node.operand);
+    X86Value v = current;
+    switch (node.op) {
+        case UnaryExpression::PLUS:
+            current = v;
+            break;
+        case UnaryExpression::MINUS: {
+            X86Value d = toTemp(v);
+            emit("negl " + d.location);
+            current = d;
+            break;
+        }
+        case UnaryExpression::NOT: {
+            if (v.kind == X86Value::IMM) {
+                current = X86Value::immediate(v.imm == 0);
+                break;
+            }
+            if (v.kind == X86Value::REG) {
+                emit("testl " + v.location + ", " + v.location);
+            } else {
+                emit("cmpl $0, " + v.operand());
+            }
+            release(v);
+            std::string dst = allocTemp();
+            emit("sete " + reg8(dst));
+            emit("movzbl " + reg8(dst) + ", " + dst);
+            current = X86Value::reg(dst, true);
+            break;
+        }
+    }
+}
+
+Walk X86CodeGenerator::visit(FunctionCall& node) {
+    size_t argc = node.arguments.size();
+    size_t complexArgs = std::count_if(node.arguments.begin(), node.arguments.end(),
+                                       [](const std::unique_ptr<Expression>& arg) { return !isLeaf(*arg); });
+    // 参数多于6个或临时寄存器不够时，实参逐个压栈再弹入参数寄存器
+    bool viaStack = argc > argRegs.size() || static_cast<int>(complexArgs) + 1 > freeTemps();
+
+    std::vector<X86Value> values;
+    if (!viaStack) {
+        for (auto& arg : node.arguments) {
+            co_await evaluate(*arg);
+            values.push_back(current);
+        }
+    }
+
+    // 保存仍然活跃的临时值（不包括作为实参消耗掉的）
+    std::vector<std::string> saved;
+    for (const auto& reg : liveTemps()) {
+        bool isArg = std::any_of(values.begin(), values.end(),
+                                 [&reg](const X86Value& v) { return v.temp && v.location == reg; });
+        if (!isArg) saved.push_back(reg);
+    }
+    for (const auto& reg : saved) {
+        emit("pushq " + reg64(reg));
+    }
+    pushDepth += saved.size();
+
+    size_t stackArgs = argc > argRegs.size() ? argc - argRegs.size() : 0;
+    bool pad = (pushDepth + stackArgs) % 2 != 0;
+    if (pad) {
+        emit("subq $8, %rsp");
+        pushDepth++;
+    }
+
+    if (viaStack) {
+        for (size_t i = argc; i-- > 0; ) {
+            co_await evaluate(*node.arguments[i]);
+            X86Value v = current;
+            if (v.kind == X86Value::REG) {
+                emit("pushq " + reg64(v.location));
+            } else if (v.kind == X86Value::IMM) {
+                emit("pushq $" + std::to_string(v.imm));
+            } else {
+                emit("movl " + v.location + ", %eax");
+                emit("pushq %rax");
+            }
+            release(v);
+            pushDepth++;
+        }
+        for (size_t i = 0; i < argc && i < argRegs.size(); ++i) {
+            emit("popq " + reg64(argRegs[i]));
+            pushDepth--;
+        }
+    } else {
+        // 并行传送到参数寄存器；出现环时经 eax 中转
+        struct Move { X86Value src; std::string dst; };
+        std::vector<Move> pending;
+        for (size_t i = 0; i < argc; ++i) {
+            if (!(values[i].kind == X86Value::REG && values[i].location == argRegs[i])) {
+                pending.push_back({values[i], argRegs[i]});
+            }
+        }
+        while (!pending.empty()) {
+            bool progress = false;
+            for (size_t i = 0; i < pending.size() && !progress; ++i) {
+                bool blocked = false;
+                for (size_t j = 0; j < pending.size(); ++j) {
+                    if (j != i && pending[j].src.kind == X86Value::REG && pending[j].src.location == pending[i].dst) {
+                        blocked = true;
+                        break;
+                    }
+                }
+                if (!blocked) {
+                    move(pending[i].src, pending[i].dst);
+                    pending.erase(pending.begin() + i);
+                    progress = true;
+                }
+            }
+            if (!progress) {
+                move(pending[0].src, "%eax");
+                pending[0].src = X86Value::reg("%eax", false);
+            }
+        }
+        for (const auto& v : values) release(v);
+    }
+
+    emit("call " + node.functionName);
+
+    size_t cleanup = stackArgs + (pad ? 1 : 0);
+    if (cleanup > 0) {
+        emit("addq $" + std::to_string(8 * cleanup) + ", %rsp");
+        pushDepth -= cleanup;
+    }
+    for (auto it = saved.rbegin(); it != saved.rend(); ++it) {
+        emit("popq " + reg64(*it));
+    }
+    pushDepth -= saved.size();
+
+    auto ret = returnTypes.find(node.functionName);
+    if (ret != returnTypes.end() && ret->second == Expression::INT) {
+        std::string dst = allocTemp();
+        emit("movl %eax, " + dst);
+        current = X86Value::reg(dst, true);
+    } else {
+        current = X86Value::immediate(0);
+    }
+}
+
+Walk X86CodeGenerator::visit(AssignmentStatement& node) {
+    std::string home = lookup(node.variable);
+    bool homeIsReg = home[0] == '%';
+
+    // x = x op y 直接在变量位置上运算
+    auto bin = dynamic_cast<BinaryExpression*>(node.value.get());
+    auto self = bin ? dynamic_cast<Identifier*>(bin->left.get()) : nullptr;
+    if (self && lookup(self->name) == home && isLeaf(*bin->right) &&
+        (bin->op == BinaryExpression::ADD || bin->op == BinaryExpression::SUB ||
+         (bin->op == BinaryExpression::MUL && homeIsReg))) {
+        co_await evaluate(*bin->right);
+        X86Value r = current;
+        if (r.kind == X86Value::MEM && !homeIsReg) {
+            emit("movl " + r.location + ", %eax");
+            r = X86Value::reg("%eax", false);
+        }
+        if (bin->op == BinaryExpression::ADD) {
+            emit("addl " + r.operand() + ", " + home);
+        } else if (bin->op == BinaryExpression::SUB) {
+            emit("subl " + r.operand() + ", " + home);
+        } else if (r.kind == X86Value::IMM) {
+            emit("imull " + r.operand() + ", " + home + ", " + home);
+        } else {
+            emit("imull " + r.operand() + ", " + home);
+        }
+        co_return;
+    }
+
+    co_await evaluate(*node.value);
+    X86Value v = current;
+    if (!homeIsReg && v.kind == X86Value::MEM) {
+        move(v, "%eax");
+        v = X86Value::reg("%eax", false);
+    }
+    if (homeIsReg) {
+        move(v, home);
+    } else if (!(v.kind == X86Value::MEM && v.location == home)) {
+        emit("movl " + v.operand() + ", " + home);
+    }
+    release(v);
+}
+
+Walk X86CodeGenerator::visit(VariableDeclaration& node) {
+    std::string home = homes[&node];
+    X86Value v = X86Value::immediate(0);
+    if (node.initializer) {
+        co_await evaluate(*node.initializer);
+        v = current;
+    }
+    if (home[0] != '%' && v.kind == X86Value::MEM) {
+        move(v, "%eax");
+        v = X86Value::reg("%eax", false);
+    }
+    if (home[0] == '%') {
+        move(v, home);
+    } else {
+        emit("movl " + v.operand() + ", " + home);
+    }
+    release(v);
+    scopes.bind(node.name, home);
+}
+
+Walk X86CodeGenerator::visit(IfStatement& node) {
+    std::string elseLabel = newLabel();
+    std::string endLabel = node.elseStatement ? newLabel() : elseLabel;
+
+    co_await branchOn(*node.condition, false, elseLabel);
+    co_await node.thenStatement->accept(*this);
+
+    if (node.elseStatement) {
+        emit("jmp " + endLabel);
+        emitLabel(elseLabel);
+        co_await node.elseStatement->accept(*this);
+    }
+    emitLabel(endLabel);
+}
+
+Walk X86CodeGenerator::visit(WhileStatement& node) {
+    // 条件放在循环体之后，每次迭代只执行一次条件跳转
+    std::string bodyLabel = newLabel();
+    std::string condLabel = newLabel();
+    std::string endLabel = newLabel();
+
+    emit("jmp " + condLabel);
+    emitLabel(bodyLabel);
+
+    breakLabels.push_back(endLabel);
+    continueLabels.push_back(condLabel);
+    co_await node.body->accept(*this);
+    breakLabels.pop_back();
+    continueLabels.pop_back();
+
+    emitLabel(condLabel);
+    co_await branchOn(*node.condition, true, bodyLabel);
+    emitLabel(endLabel);
+}
+
+Walk X86CodeGenerator::visit(BreakStatement&) {
+    if (!breakLabels.empty()) {
+        emit("jmp " + breakLabels.back());
+    }
+    co_return;
+}
+
+Walk X86CodeGenerator::visit(ContinueStatement&) {
+    if (!continueLabels.empty()) {
+        emit("jmp " + continueLabels.back());
+    }
+    co_return;
+}
+
+Walk X86CodeGenerator::visit(ReturnStatement& node) {
+    if (node.value) {
+        co_await evaluate(*node.value);
+        X86Value v = current;
+        move(v, "%eax");
+        release(v);
+    } else {
+        emit("xorl %eax, %eax");
+    }
+    emit("jmp " + returnLabel);
+}
+
+Walk X86CodeGenerator::visit(ExpressionStatement& node) {
+    co_await evaluate(*node.expression);
+    release(current);
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include "ast/ast.hpp"
+#include "codegen/bindings.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <sstream>
+
+// x86-64 表达式求值结果：立即数、寄存器或内存操作数
+struct X86Value {
+    enum Kind { IMM, REG, MEM };
+
+    Kind kind;
+    int imm;
+    std::string location;   // 32位寄存器名（%ecx）或内存操作数（-12(%rbp)）
+    bool temp;              // 是否占用临时寄存器池
+
+    static X86Value immediate(int v) { return {IMM, v, "", false}; }
+    static X86Value reg(const std::string& r, bool isTemp) { return {REG, 0, r, isTemp}; }
+    static X86Value mem(const std::string& m) { return {MEM, 0, m, false}; }
+
+    std::string operand() const { return kind == IMM ? "$" + std::to_string(imm) : location; }
+};
+
+// x86-64 System V 后端，输出 GAS（AT&T 语法）汇编，可直接用宿主 cc 汇编链接
+// 寄存器分配：
+//   - 局部变量和参数按循环深度加权的使用次数排序，前5个放在被调用者保存寄存器
+//     （rbx, r12-r15），其余放在栈帧
+//   - 表达式临时值使用调用者保存寄存器池，跨调用时只保存仍然活跃的临时值
+//   - 条件直接编译为 cmp + jcc
+class X86CodeGenerator : public Visitor {
+private:
+    std::ostringstream output;
+    int labelCounter;
+
+    // 当前函数
+    std::string currentFunction;
+    std::string returnLabel;
+    std::vector<std::string> savedRegs;         // 本函数使用的被调用者保存寄存器
+    NameBindings<std::string> scopes;                                 // 变量名 -> 位置
+    std::unordered_map<const void*, std::string> homes;               // 声明/参数 -> 位置
+    std::unordered_map<std::string, Expression::Type> returnTypes;
+    std::vector<bool> tempUsed;
+    int pushDepth;              // 函数体内额外压栈的8字节数（用于调用前对齐）
+    std::vector<std::string> breakLabels;
+    std::vector<std::string> continueLabels;
+
+    X86Value current;           // 最近一次表达式求值的结果
+
+public:
+    X86CodeGenerator() : labelCounter(0), pushDepth(0), current(X86Value::immediate(0)) {}
+
+    std::string generate(CompilationUnit& unit);
+
+    // Visitor接口实现
+    Walk visit(BinaryExpression& node) override;
+    Walk visit(UnaryExpression& node) override;
+    Walk visit(NumberLiteral& node) override;
+    Walk visit(Identifier& node) override;
+    Walk visit(FunctionCall& node) override;
+    Walk visit(AssignmentStatement& node) override;
+    Walk visit(VariableDeclaration& node) override;
+    Walk visit(Block& node) override;
+    Walk visit(IfStatement& node) override;
+    Walk visit(WhileStatement& node) override;
+    Walk visit(BreakStatement& node) override;
+    Walk visit(ContinueStatement& node) override;
+    Walk visit(ReturnStatement& node) override;
+    Walk visit(ExpressionStatement& node) override;
+    Walk visit(FunctionDefinition& node) override;
+    Walk visit(CompilationUnit& node) override;
+
+private:
+    std::string newLabel();
+    void emit(const std::string& instruction);
+    void emitLabel(const std::string& label);
+
+    // 临时寄存器池
+    std::string allocTemp();
+    void release(const X86Value& value);
+    int freeTemps() const;
+    std::vector<std::string> liveTemps() const;
+
+    // 表达式求值，co_await 之后结果在 current 中
+    Walk evaluate(Expression& expr);
+    // 把值放进可写的临时寄存器（已是临时寄存器则原样返回）
+    X86Value toTemp(const X86Value& value);
+    void move(const X86Value& src, const std::string& dst);
+    std::string lookup(const std::string& name) const;
+
+    // 比较 left 与 right，cc 得到对应的条件码（操作数交换时已相应调整）
+    Walk compare(Expression& left, Expression& right, BinaryExpression::Operator op, std::string& cc);
+    // 求值两个操作数；临时寄存器紧张时先把左值压栈，保证池不会耗尽
+    Walk evaluatePair(Expression& left, Expression& right, X86Value& l, X86Value& r);
+    // 表达式真值等于 when 时跳转到 label
+    Walk branchOn(Expression& expr, bool when, const std::string& label);
+    void divide(const X86Value& dividend, const X86Value& divisor, bool remainder, const std::string& dst);
+
+    // 寄存器分配预处理：统计变量加权使用次数
+    void assignHomes(FunctionDefinition& node, int& stackSlots);
+    using NameScopes = NameBindings<const void*>;
+    void countUses(Statement& stmt, long weight, NameScopes& names,
+                   std::unordered_map<const void*, long>& uses, std::vector<const void*>& order);
+    void countUses(Expression& expr, long weight, NameScopes& names,
+                   std::unordered_map<const void*, long>& uses);
+};
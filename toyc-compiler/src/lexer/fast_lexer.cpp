@@ -0,0 +1,328 @@
+#include "lexer/fast_lexer.hpp"
+#include "ast/ast.hpp"
+#include "parser.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// 末尾补零的字节数，不小于一次向量比较的宽度，越界读取总是落在补零区
+const size_t padding = 64;
+
+// 字节掩码：第 i 位对应 p[i]
+#if defined(__AVX2__)
+const int lane = 32;
+typedef __m256i Vec;
+
+inline Vec load(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+inline uint32_t toMask(Vec v) { return static_cast<uint32_t>(_mm256_movemask_epi8(v)); }
+inline Vec equal(Vec v, char c) { return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c)); }
+inline Vec either(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+// 有符号比较：0x80 以上的字节是负数，不会落进任何 ASCII 区间
+inline Vec inRange(Vec v, char lo, char hi) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(lo - 1)),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), v));
+}
+#elif defined(__SSE2__)
+const int lane = 16;
+typedef __m128i Vec;
+
+inline Vec load(const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+inline uint32_t toMask(Vec v) { return static_cast<uint32_t>(_mm_movemask_epi8(v)); }
+inline Vec equal(Vec v, char c) { return _mm_cmpeq_epi8(v, _mm_set1_epi8(c)); }
+inline Vec either(Vec a, Vec b) { return _mm_or_si128(a, b); }
+inline Vec inRange(Vec v, char lo, char hi) {
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)), _mm_cmpgt_epi8(_mm_set1_epi8(hi + 1), v));
+}
+#else
+// 标量实现：同样按16字节一组逐字节产生掩码
+const int lane = 16;
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__)
+inline uint32_t newlineMask(const char* p) {
+    return toMask(equal(load(p), '\n'));
+}
+
+inline uint32_t charMask(const char* p, char c) {
+    return toMask(equal(load(p), c));
+}
+
+inline uint32_t whitespaceMask(const char* p, uint32_t& newlines) {
+    Vec v = load(p);
+    Vec nl = equal(v, '\n');
+    newlines = toMask(nl);
+    return toMask(either(either(nl, equal(v, ' ')), either(equal(v, '\t'), equal(v, '\r'))));
+}
+
+inline uint32_t identifierMask(const char* p) {
+    Vec v = load(p);
+    Vec letters = either(inRange(v, 'a', 'z'), inRange(v, 'A', 'Z'));
+    return toMask(either(either(letters, inRange(v, '0', '9')), equal(v, '_')));
+}
+#else
+inline uint32_t charMask(const char* p, char c) {
+    uint32_t mask = 0;
+    for (int i = 0; i < lane; ++i) mask |= static_cast<uint32_t>(p[i] == c) << i;
+    return mask;
+}
+
+inline uint32_t newlineMask(const char* p) {
+    return charMask(p, '\n');
+}
+
+inline uint32_t whitespaceMask(const char* p, uint32_t& newlines) {
+    uint32_t mask = 0;
+    newlines = 0;
+    for (int i = 0; i < lane; ++i) {
+        char c = p[i];
+        newlines |= static_cast<uint32_t>(c == '\n') << i;
+        mask |= static_cast<uint32_t>(c == ' ' || c == '\t' || c == '\r' || c == '\n') << i;
+    }
+    return mask;
+}
+
+inline uint32_t identifierMask(const char* p) {
+    uint32_t mask = 0;
+    for (int i = 0; i < lane; ++i) {
+        char c = p[i];
+        bool ident = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        mask |= static_cast<uint32_t>(ident) << i;
+    }
+    return mask;
+}
+#endif
+
+const uint32_t fullMask = lane == 32 ? 0xffffffffu : (1u << lane) - 1;
+
+inline uint32_t lowBits(uint32_t count) {
+    return count >= 32 ? 0xffffffffu : (1u << count) - 1;
+}
+
+inline int countBits(uint32_t mask) {
+    return __builtin_popcount(mask);
+}
+
+inline uint32_t firstBit(uint32_t mask) {
+    return static_cast<uint32_t>(__builtin_ctz(mask));
+}
+
+inline bool isIdentifierStart(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// 跳过 [ \t\r\n]*，累加其中的换行数；补零区不是空白，所以一定会停下
+const char* skipWhitespace(const char* p, int& line) {
+    while (true) {
+        uint32_t newlines;
+        uint32_t spaces = whitespaceMask(p, newlines);
+        if (spaces == fullMask) {
+            line += countBits(newlines);
+            p += lane;
+            continue;
+        }
+        uint32_t stop = firstBit(~spaces);
+        line += countBits(newlines & lowBits(stop));
+        return p + stop;
+    }
+}
+
+// 标识符的后续字符 [a-zA-Z0-9_]*
+const char* scanIdentifier(const char* p) {
+    while (true) {
+        uint32_t ident = identifierMask(p);
+        if (ident != fullMask) return p + firstBit(~ident);
+        p += lane;
+    }
+}
+
+// "//".* ：停在换行符上（换行由下一次跳过空白计数）
+const char* skipLineComment(const char* p, const char* end) {
+    while (p < end) {
+        uint32_t newlines = newlineMask(p);
+        if (newlines) {
+            const char* stop = p + firstBit(newlines);
+            return stop < end ? stop : end;
+        }
+        p += lane;
+    }
+    return end;
+}
+
+// 关键字完美哈希：(s[0] + 6*s[1] + 长度) & 15 对八个关键字两两不同
+struct Keyword {
+    const char* text;
+    uint32_t length;
+    int token;
+};
+
+inline uint32_t keywordSlot(const char* s, uint32_t length) {
+    return (static_cast<unsigned char>(s[0]) + 6u * static_cast<unsigned char>(s[1]) + length) & 15;
+}
+
+struct KeywordTable {
+    Keyword slots[16];
+
+    KeywordTable() {
+        std::memset(slots, 0, sizeof(slots));
+        const Keyword keywords[] = {
+            {"int", 3, INT}, {"void", 4, VOID}, {"if", 2, IF}, {"else", 4, ELSE},
+            {"while", 5, WHILE}, {"break", 5, BREAK}, {"continue", 8, CONTINUE}, {"return", 6, RETURN},
+        };
+        for (const Keyword& kw : keywords) {
+            slots[keywordSlot(kw.text, kw.length)] = kw;
+        }
+    }
+};
+
+const KeywordTable keywordTable;
+
+} // namespace
+
+FastLexer::FastLexer(const std::string& source)
+    : line(1), tokenStart(nullptr), tokenLength(0), tokenValue(0), tokenUnknown(false) {
+    buffer.reserve(source.size() + padding);
+    buffer = source;
+    buffer.append(padding, '\0');
+    cursor = buffer.data();
+    end = buffer.data() + source.size();
+    tokenStart = cursor;
+}
+
+void FastLexer::reportUnknown(char c, int line) {
+    std::cerr << "Unknown character: " << (c ? std::string(1, c) : std::string()) << " at line " << line << std::endl;
+}
+
+int FastLexer::keyword(const char* start, uint32_t length) const {
+    if (length < 2 || length > 8) return 0;
+    const Keyword& kw = keywordTable.slots[keywordSlot(start, length)];
+    if (kw.length == length && std::memcmp(kw.text, start, length) == 0) return kw.token;
+    return 0;
+}
+
+// 从 "/*" 之后找第一个 "*/"。和 lexer.l 的 yyinput 循环一样：
+// 读到 '\0' 时注释在它之后结束，未闭合时吃到文件末尾
+void FastLexer::skipBlockComment() {
+    const char* p = cursor;
+    while (p < end) {
+        uint32_t stops = charMask(p, '*') | charMask(p, '\0');
+        uint32_t newlines = newlineMask(p);
+        while (stops) {
+            uint32_t i = firstBit(stops);
+            if (p + i >= end) break;
+            if (p[i] == '\0' || (p[i + 1] == '/' && p + i + 1 < end)) {
+                line += countBits(newlines & lowBits(i));
+                cursor = p + i + (p[i] == '\0' ? 1 : 2);
+                return;
+            }
+            stops &= stops - 1;
+        }
+        line += countBits(newlines);
+        p += lane;
+    }
+    cursor = end;
+}
+
+int FastLexer::next() {
+    // 空白和注释
+    while (true) {
+        cursor = skipWhitespace(cursor, line);
+        if (cursor[0] == '/' && cursor[1] == '/' && cursor + 1 < end) {
+            cursor = skipLineComment(cursor + 2, end);
+        } else if (cursor[0] == '/' && cursor[1] == '*' && cursor + 1 < end) {
+            cursor += 2;
+            skipBlockComment();
+        } else {
+            break;
+        }
+    }
+
+    tokenStart = cursor;
+    tokenUnknown = false;
+    if (cursor >= end) {
+        tokenLength = 0;
+        return 0;
+    }
+
+    char c = cursor[0];
+    if (isIdentifierStart(c)) {
+        cursor = scanIdentifier(cursor + 1);
+        tokenLength = static_cast<uint32_t>(cursor - tokenStart);
+        int token = keyword(tokenStart, tokenLength);
+        return token ? token : IDENTIFIER;
+    }
+
+    // NUMBER: -?(0|[1-9][0-9]*)，'-' 后紧跟数字时整体是一个带符号的数
+    if (isDigit(c) || (c == '-' && isDigit(cursor[1]) && cursor + 1 < end)) {
+        const char* p = c == '-' ? cursor + 1 : cursor;
+        if (*p == '0') {
+            p++;
+        } else {
+            while (isDigit(*p) && p < end) p++;
+        }
+        cursor = p;
+        tokenLength = static_cast<uint32_t>(cursor - tokenStart);
+        // 与 atoi 的溢出行为保持一致
+        char digits[32];
+        if (tokenLength < sizeof(digits)) {
+            std::memcpy(digits, tokenStart, tokenLength);
+            digits[tokenLength] = '\0';
+            tokenValue = std::atoi(digits);
+        } else {
+            tokenValue = std::atoi(std::string(tokenStart, tokenLength).c_str());
+        }
+        return NUMBER;
+    }
+
+    char n = cursor + 1 < end ? cursor[1] : '\0';
+    cursor++;
+    tokenLength = 1;
+    switch (c) {
+        case '+': return PLUS;
+        case '-': return MINUS;
+        case '*': return MULTIPLY;
+        case '/': return DIVIDE;
+        case '%': return MOD;
+        case '(': return LPAREN;
+        case ')': return RPAREN;
+        case '{': return LBRACE;
+        case '}': return RBRACE;
+        case ',': return COMMA;
+        case ';': return SEMICOLON;
+        case '=':
+            if (n == '=') { cursor++; tokenLength = 2; return EQ; }
+            return ASSIGN;
+        case '!':
+            if (n == '=') { cursor++; tokenLength = 2; return NE; }
+            return NOT;
+        case '<':
+            if (n == '=') { cursor++; tokenLength = 2; return LE; }
+            return LT;
+        case '>':
+            if (n == '=') { cursor++; tokenLength = 2; return GE; }
+            return GT;
+        case '&':
+            if (n == '&') { cursor++; tokenLength = 2; return AND; }
+            break;
+        case '|':
+            if (n == '|') { cursor++; tokenLength = 2; return OR; }
+            break;
+        default:
+            break;
+    }
+
+    // 未知字符：和 lexer.l 一样把字符本身作为词法单元返回
+    tokenUnknown = true;
+    return c;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// 手写的词法分析器，与 lexer.l 生成的 Flex 扫描器产生完全相同的词法单元序列
+// （包括 "-1" 这样带符号的数字、前导零拆分和未知字符的处理），但：
+//   - 整个输入一次读入并在末尾补零，热循环里不需要检查缓冲区边界；
+//   - 空白、// 和 /* */ 注释、标识符的连续字符用 SSE2/AVX2 一次比较 16/32 字节，
+//     换行数用掩码的 popcount 累加；
+//   - 关键字用完美哈希表查找，只比较一次字符串。
+// 没有 SIMD 的平台退回逐字节的标量实现，结果相同。
+// 通常不直接使用，而是由 TokenBuffer 一次扫描整个输入。
+class FastLexer {
+private:
+    std::string buffer;     // 源码加补零的尾部
+    const char* cursor;
+    const char* end;
+    int line;
+
+    // 最近一个词法单元
+    const char* tokenStart;
+    uint32_t tokenLength;
+    int tokenValue;
+    bool tokenUnknown;
+
+public:
+    explicit FastLexer(const std::string& source);
+
+    // 返回 parser.hpp 中的词法单元编号，输入结束返回0；
+    // 无法识别的字符返回字符本身（与 lexer.l 相同），提示由调用者输出
+    int next();
+
+    // 最近一个词法单元的位置、文本和数字的值
+    uint32_t offset() const { return static_cast<uint32_t>(tokenStart - buffer.data()); }
+    uint32_t length() const { return tokenLength; }
+    std::string text() const { return std::string(tokenStart, tokenLength); }
+    int value() const { return tokenValue; }
+    bool unknown() const { return tokenUnknown; }
+    // 当前行号，与 Flex 的 yylineno 含义相同：已消耗的换行数加一
+    int getLine() const { return line; }
+
+    // lexer.l 对无法识别的字符的提示
+    static void reportUnknown(char c, int line);
+
+private:
+    void skipBlockComment();
+    int keyword(const char* start, uint32_t length) const;
+};
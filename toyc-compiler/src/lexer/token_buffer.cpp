@@ -0,0 +1,151 @@
+#include "lexer/token_buffer.hpp"
+#include "lexer/fast_lexer.hpp"
+#include "ast/ast.hpp"
+#include "parser.hpp"
+
+extern int yylineno;
+// lexer.l 通过 YY_DECL 把 Flex 生成的扫描函数改名为 flexLex
+int flexLex();
+
+namespace {
+
+TokenBuffer* activeTokens = nullptr;
+
+} // namespace
+
+TokenBuffer::TokenBuffer() : position(0), nextValue(0) {}
+
+void TokenBuffer::lex(const std::string& source) {
+    text = source;
+    kinds.clear();
+    offsets.clear();
+    lengths.clear();
+    lines.clear();
+    values.clear();
+    rewind();
+
+    // 平均每4字节约一个词法单元，预留后扫描过程中不再扩容
+    size_t estimate = source.size() / 4 + 1;
+    kinds.reserve(estimate);
+    offsets.reserve(estimate);
+    lengths.reserve(estimate);
+    lines.reserve(estimate);
+
+    FastLexer lexer(text);
+    while (true) {
+        int code = lexer.next();
+        kinds.push_back(static_cast<int16_t>(lexer.unknown() ? UNKNOWN : code));
+        offsets.push_back(lexer.offset());
+        lengths.push_back(lexer.length());
+        lines.push_back(static_cast<uint32_t>(lexer.getLine()));
+        if (code == NUMBER) values.push_back(lexer.value());
+        // '\0' 是未知字符，同时和 Flex 一样结束输入
+        if (code == 0) break;
+    }
+    kinds.shrink_to_fit();
+    offsets.shrink_to_fit();
+    lengths.shrink_to_fit();
+    lines.shrink_to_fit();
+}
+
+void TokenBuffer::rewind() {
+    position = 0;
+    nextValue = 0;
+}
+
+int TokenBuffer::consume() {
+    if (position >= kinds.size()) return 0;
+    size_t i = position;
+    int code = kinds[i];
+    yylineno = static_cast<int>(lines[i]);
+    if (code == UNKNOWN) {
+        // 未知字符的提示在语法分析器取到它时才输出，和 Flex 的顺序一致
+        char c = text[offsets[i]];
+        FastLexer::reportUnknown(c, yylineno);
+        position++;
+        return c;
+    }
+    if (code == 0) return 0;
+    if (code == IDENTIFIER) {
+        yylval.string_val = new std::string(text, offsets[i], lengths[i]);
+    } else if (code == NUMBER) {
+        yylval.int_val = values[nextValue++];
+    }
+    position++;
+    return code;
+}
+
+void TokenBuffer::setActive(TokenBuffer* tokens) {
+    activeTokens = tokens;
+}
+
+const char* TokenBuffer::kindName(int kind) {
+    switch (kind) {
+        case 0: return "END";
+        case UNKNOWN: return "UNKNOWN";
+        case NUMBER: return "NUMBER";
+        case IDENTIFIER: return "IDENTIFIER";
+        case INT: return "INT";
+        case VOID: return "VOID";
+        case IF: return "IF";
+        case ELSE: return "ELSE";
+        case WHILE: return "WHILE";
+        case BREAK: return "BREAK";
+        case CONTINUE: return "CONTINUE";
+        case RETURN: return "RETURN";
+        case PLUS: return "PLUS";
+        case MINUS: return "MINUS";
+        case MULTIPLY: return "MULTIPLY";
+        case DIVIDE: return "DIVIDE";
+        case MOD: return "MOD";
+        case ASSIGN: return "ASSIGN";
+        case EQ: return "EQ";
+        case NE: return "NE";
+        case LT: return "LT";
+        case LE: return "LE";
+        case GT: return "GT";
+        case GE: return "GE";
+        case AND: return "AND";
+        case OR: return "OR";
+        case NOT: return "NOT";
+        case LPAREN: return "LPAREN";
+        case RPAREN: return "RPAREN";
+        case LBRACE: return "LBRACE";
+        case RBRACE: return "RBRACE";
+        case COMMA: return "COMMA";
+        case SEMICOLON: return "SEMICOLON";
+        default: return "?";
+    }
+}
+
+size_t TokenBuffer::memoryBytes() const {
+    return text.capacity() + kinds.capacity() * sizeof(int16_t) +
+           (offsets.capacity() + lengths.capacity() + lines.capacity()) * sizeof(uint32_t) +
+           values.capacity() * sizeof(int);
+}
+
+void TokenBuffer::dump(std::ostream& out) const {
+    // 顺序输出，行首位置随行号推进，列号从1开始
+    uint32_t currentLine = 1;
+    size_t lineStart = 0;
+    size_t value = 0;
+    for (size_t i = 0; i < kinds.size(); ++i) {
+        while (currentLine < lines[i]) {
+            lineStart = text.find('\n', lineStart) + 1;
+            currentLine++;
+        }
+        out << lines[i] << ":" << (offsets[i] - lineStart + 1) << "\t" << kindName(kinds[i]);
+        if (kinds[i] == NUMBER) {
+            out << "\t" << values[value++];
+        } else if (kinds[i] != 0) {
+            out << "\t" << text.substr(offsets[i], lengths[i]);
+        }
+        out << "\n";
+    }
+}
+
+// 语法分析器调用的 yylex：有活动的词法单元数组时从它取，否则用 Flex 扫描器
+int yylex() {
+    if (!activeTokens) return flexLex();
+    return activeTokens->consume();
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 整个输入一次扫描成的紧凑词法单元数组（结构体数组拆成若干并列数组）：
+// 种类、源码偏移、长度、行号各占一个连续数组，数字字面量的值按出现顺序另存。
+// 标识符的文本不单独分配，需要时从源码切片取出。
+// 语法分析器通过 yylex 顺序消费这个数组；词法分析因此可以单独计时，
+// 重新分析或按位置查询词法单元也不需要再扫描源码。
+class TokenBuffer {
+public:
+    // 无法识别的字符；字符本身在 source()[offset(i)]
+    static constexpr int16_t UNKNOWN = -1;
+
+private:
+    std::string text;
+    std::vector<int16_t> kinds;         // parser.hpp 中的编号，结束为0
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> lengths;
+    std::vector<uint32_t> lines;
+    std::vector<int> values;            // 第 k 个 NUMBER 的值
+
+    // yylex 的读取位置
+    size_t position;
+    size_t nextValue;
+
+public:
+    TokenBuffer();
+
+    // 扫描 source，最后总有一个种类为0的结束词法单元
+    void lex(const std::string& source);
+
+    size_t size() const { return kinds.size(); }
+    int kind(size_t i) const { return kinds[i]; }
+    uint32_t offset(size_t i) const { return offsets[i]; }
+    uint32_t length(size_t i) const { return lengths[i]; }
+    uint32_t line(size_t i) const { return lines[i]; }
+    std::string tokenText(size_t i) const { return text.substr(offsets[i], lengths[i]); }
+    const std::string& source() const { return text; }
+    // 第 k 个 NUMBER 的值
+    int literal(size_t k) const { return values[k]; }
+    size_t literalCount() const { return values.size(); }
+    // 源码副本和各数组占用的字节数（--mem-report）
+    size_t memoryBytes() const;
+
+    // 按 "行:列 种类 文本" 逐行输出（--tokens）
+    void dump(std::ostream& out) const;
+
+    // 下一次 yylex 从第一个词法单元开始
+    void rewind();
+    // 取下一个词法单元并设置 yylval / yylineno，供 yylex 调用
+    int consume();
+
+    // 设置后 yylex() 从这个数组取词法单元，为空时使用 Flex 扫描器
+    static void setActive(TokenBuffer* tokens);
+
+    static const char* kindName(int kind);
+};
@@ -1,201 +1,792 @@
-#include <iostream>
-#include <memory>
-#include <fstream>
-#include "ast/ast.hpp"
-#include "semantic/analyzer.hpp"
-#include "codegen/riscv.hpp"
-#include "utils/utils.hpp"
-
-// 外部函数声明（由flex/bison生成）
-extern FILE* yyin;
-extern int yyparse();
-extern std::unique_ptr<CompilationUnit> root;
-extern int yylineno;
-
-void printUsage(const char* programName) {
-    std::cout << "ToyC Compiler v1.0\n"
-              << "Usage: " << programName << " [options] <input.tc>\n\n"
-              << "Options:\n"
-              << "  -o <output>  Output file (default: input.s)\n"
-              << "  -v           Verbose output\n"
-              << "  --ast        Print Abstract Syntax Tree\n"
-              << "  --tokens     Print tokens (lexical analysis only)\n"
-              << "  --parse-only Only perform parsing\n"
-              << "  --help       Show this help\n\n"
-              << "Examples:\n"
-              << "  " << programName << " hello.tc\n"
-              << "  " << programName << " -v --ast factorial.tc -o factorial.s\n";
-}
-
-int main(int argc, char* argv[]) {
-    std::string inputFile;
-    std::string outputFile;
-    bool verbose = false;
-    bool printAST = false;
-    bool parseOnly = false;
-    
-    // 简单的参数解析
-    for (int i = 1; i < argc; i++) {
-        std::string arg = argv[i];
-        
-        if (arg == "-v" || arg == "--verbose") {
-            verbose = true;
-        } else if (arg == "--ast") {
-            printAST = true;
-        } else if (arg == "--parse-only") {
-            parseOnly = true;
-        } else if (arg == "--help" || arg == "-h") {
-            printUsage(argv[0]);
-            return 0;
-        } else if (arg == "-o" && i + 1 < argc) {
-            outputFile = argv[++i];
-        } else if (arg[0] != '-') {
-            if (inputFile.empty()) {
-                inputFile = arg;
-            } else {
-                std::cerr << "Error: Multiple input files specified" << std::endl;
-                return 1;
-            }
-        } else {
-            std::cerr << "Error: Unknown option: " << arg << std::endl;
-            printUsage(argv[0]);
-            return 1;
-        }
-    }
-    
-    if (inputFile.empty()) {
-        std::cerr << "Error: No input file specified" << std::endl;
-        printUsage(argv[0]);
-        return 1;
-    }
-    
-    // 检查输入文件扩展名
-    if (Utils::getFileExtension(inputFile) != ".tc") {
-        std::cerr << "Warning: Input file should have .tc extension" << std::endl;
-    }
-    
-    // 设置默认输出文件名
-    if (outputFile.empty()) {
-        outputFile = Utils::getBaseName(inputFile) + ".s";
-    }
-    
-    try {
-        if (verbose) {
-            std::cout << "ToyC Compiler v1.0" << std::endl;
-            std::cout << "Input file: " << inputFile << std::endl;
-            std::cout << "Output file: " << outputFile << std::endl;
-            std::cout << "===================" << std::endl;
-        }
-        
-        // 1. 词法和语法分析
-        if (verbose) std::cout << "Phase 1: Parsing..." << std::endl;
-        
-        FILE* inputFp = fopen(inputFile.c_str(), "r");
-        if (!inputFp) {
-            std::cerr << "Error: Cannot open input file: " << inputFile << std::endl;
-            return 1;
-        }
-        
-        yyin = inputFp;
-        yylineno = 1;
-        root.reset(); // 确保之前的AST被清理
-        
-        int parseResult = yyparse();
-        fclose(inputFp);
-        
-        if (parseResult != 0) {
-            std::cerr << "Error: Parsing failed" << std::endl;
-            return 1;
-        }
-        
-        if (!root) {
-            std::cerr << "Error: No AST generated" << std::endl;
-            return 1;
-        }
-        
-        if (verbose) std::cout << "  Parsing completed successfully" << std::endl;
-        
-        // 打印AST（如果需要）
-        if (printAST) {
-            std::cout << "\n=== Abstract Syntax Tree ===" << std::endl;
-            root->print();
-            std::cout << "============================\n" << std::endl;
-        }
-        
-        // 如果只需要解析，则在此结束
-        if (parseOnly) {
-            std::cout << "Parse-only mode: Parsing successful!" << std::endl;
-            return 0;
-        }
-        
-        // 2. 语义分析
-        if (verbose) std::cout << "Phase 2: Semantic analysis..." << std::endl;
-        
-        SemanticAnalyzer analyzer;
-        if (!analyzer.analyze(*root)) {
-            std::cerr << "Semantic analysis failed:" << std::endl;
-            const auto& errors = analyzer.getErrors();
-            for (size_t i = 0; i < errors.size(); ++i) {
-                std::cerr << "  Error " << (i+1) << ": " << errors[i] << std::endl;
-            }
-            return 1;
-        }
-        
-        if (verbose) std::cout << "  Semantic analysis completed successfully" << std::endl;
-        
-        // 3. 代码生成
-        if (verbose) std::cout << "Phase 3: Code generation..." << std::endl;
-        
-        RISCVCodeGenerator generator;
-        
-        // 构建函数表（从AST中提取）
-        std::unordered_map<std::string, FunctionInfo> functionTable;
-        for (const auto& func : root->functions) {
-            std::vector<Expression::Type> paramTypes;
-            for (const auto& param : func->parameters) {
-                paramTypes.push_back(param.type);
-            }
-            functionTable[func->name] = FunctionInfo(func->name, func->returnType, paramTypes, true);
-        }
-        
-        std::string assemblyCode = generator.generate(*root, functionTable);
-        
-        if (verbose) std::cout << "  Code generation completed" << std::endl;
-        
-        // 4. 写入输出文件
-        if (verbose) std::cout << "Phase 4: Writing output..." << std::endl;
-        
-        if (!Utils::writeFile(outputFile, assemblyCode)) {
-            std::cerr << "Error: Cannot write to output file: " << outputFile << std::endl;
-            return 1;
-        }
-        
-        if (verbose) {
-            std::cout << "  Output written to: " << outputFile << std::endl;
-            std::cout << "===================" << std::endl;
-        }
-        
-        std::cout << "Compilation successful!" << std::endl;
-        
-        // 显示统计信息
-        if (verbose) {
-            std::cout << "\nStatistics:" << std::endl;
-            std::cout << "  Functions: " << root->functions.size() << std::endl;
-            
-            // 计算总行数
-            std::string sourceCode = Utils::readFile(inputFile);
-            int lineCount = std::count(sourceCode.begin(), sourceCode.end(), '\n') + 1;
-            std::cout << "  Source lines: " << lineCount << std::endl;
-            std::cout << "  Assembly lines: " << std::count(assemblyCode.begin(), assemblyCode.end(), '\n') << std::endl;
-        }
-        
-        return 0;
-        
-    } catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        return 1;
-    } catch (...) {
-        std::cerr << "Error: Unknown error occurred" << std::endl;
-        return 1;
-    }
-}
\ No newline at end of file
+#include <iostream>
+#include <memory>
+#include <fstream>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <unistd.h>
+#include "ast/ast.hpp"
+#include "semantic/analyzer.hpp"
+#include "codegen/riscv.hpp"
+#include "codegen/x86_64.hpp"
+#include "codegen/encoder.hpp"
+#include "codegen/elf.hpp"
+#include "codegen/peephole.hpp"
+#include "codegen/machine.hpp"
+#include "codegen/scheduler.hpp"
+#include "codegen/layout.hpp"
+#include "opt/cse.hpp"
+#include "opt/purity.hpp"
+#include "opt/consteval.hpp"
+#include "vm/bytecode.hpp"
+#include "vm/vm.hpp"
+#include "cache/cache.hpp"
+#include "cache/function_cache.hpp"
+#include "server/server.hpp"
+#include "lexer/token_buffer.hpp"
+#include "parser/pratt_parser.hpp"
+#include "utils/utils.hpp"
+#include "utils/source_manager.hpp"
+#include "utils/memory.hpp"
+#include "utils/thread_pool.hpp"
+
+// 外部函数声明（由flex/bison生成）
+extern FILE* yyin;
+extern int yyparse();
+extern std::unique_ptr<CompilationUnit> root;
+extern int yylineno;
+extern void yyrestart(FILE* file);
+
+void printUsage(const char* programName) {
+    std::cout << "ToyC Compiler v1.0\n"
+              << "Usage: " << programName << " [options] <input.tc>\n\n"
+              << "Options:\n"
+              << "  -o <output>  Output file (default: input.s, or input.o with -c; stdout when reading stdin)\n"
+              << "  -c           Write an ELF32 relocatable object instead of assembly (riscv32)\n"
+              << "  -v           Verbose output\n"
+              << "  -O<level>    Optimization level (0-1, default: 1)\n"
+              << "  -j<n>        Threads for semantic analysis and code generation (default: CPU count)\n"
+              << "  -mtune=<cpu> Schedule for a machine description (name or .mtune file)\n"
+              << "  --target=<t> Target architecture: riscv32 (default) or x86_64\n"
+              << "  --lexer=<l>  Lexer: fast (hand-written, default) or flex\n"
+              << "  --parser=<p> Parser: pratt (hand-written, default) or bison (always used with --lexer=flex)\n"
+              << "  --ast        Print Abstract Syntax Tree\n"
+              << "  --tokens     Print the token buffer (lexical analysis only)\n"
+              << "  --parse-only Only perform parsing\n"
+              << "  --stats      Print compilation statistics\n"
+              << "  --mem-report[=<file>]  Write peak RSS, per-phase allocations and data structure sizes as JSON\n"
+              << "  --run        Execute main on the bytecode VM (exit status = return value)\n"
+              << "  --bytecode   Print the VM bytecode (with --run)\n"
+              << "  --cache      Reuse outputs from the compilation cache (also enabled by $TOYC_CACHE_DIR)\n"
+              << "  --cache-dir=<dir>   Cache directory (default: $TOYC_CACHE_DIR or ~/.cache/toyc)\n"
+              << "  --cache-size=<MiB>  Evict least recently used entries above this size (default: 256)\n"
+              << "  --no-cache   Disable the compilation cache\n"
+              << "  --incremental  Reuse unchanged functions from <output>.fncache (riscv32)\n"
+              << "  --server <socket>   Serve compile requests on a Unix domain socket\n"
+              << "  --workers=<n>       Worker processes for --server (default: CPU count)\n"
+              << "  --connect <socket>  Send the remaining options to a running server\n"
+              << "  --help       Show this help\n\n"
+              << "Examples:\n"
+              << "  " << programName << " hello.tc\n"
+              << "  " << programName << " -v --ast factorial.tc -o factorial.s\n"
+              << "  " << programName << " - < factorial.tc > factorial.s\n"
+              << "  " << programName << " --connect /tmp/toyc.sock -O1 factorial.tc\n";
+}
+
+// 一次完整的编译；--server 的工作进程在同一进程内反复调用，io 不为空时 "-" 的输入输出走内存
+int compile(int argc, char* argv[], const CompileIO* io = nullptr) {
+    std::string inputFile;
+    std::string outputFile;
+    bool verbose = false;
+    bool printAST = false;
+    bool parseOnly = false;
+    bool printTokens = false;
+    int optLevel = 1;
+    bool printStats = false;
+    bool runMode = false;
+    bool printBytecode = false;
+    bool objectMode = false;
+    std::string mtune = "generic";
+    std::string target = "riscv32";
+    bool useCache = std::getenv("TOYC_CACHE_DIR") != nullptr;
+    std::string cacheDir;
+    uint64_t cacheSizeMiB = 256;
+    bool incremental = false;
+    int jobs = WorkStealingPool::defaultThreads();
+    std::string lexer = "fast";
+    std::string parser = "pratt";
+    bool memReport = false;
+    std::string memReportFile;
+    
+    // 简单的参数解析
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        
+        if (arg == "-v" || arg == "--verbose") {
+            verbose = true;
+        } else if (arg == "--ast") {
+            printAST = true;
+        } else if (arg == "--tokens") {
+            printTokens = true;
+        } else if (arg == "--parse-only") {
+            parseOnly = true;
+        } else if (arg.compare(0, 7, "-mtune=") == 0) {
+            mtune = arg.substr(7);
+        } else if (arg.compare(0, 9, "--target=") == 0) {
+            target = arg.substr(9);
+        } else if (arg.compare(0, 8, "--lexer=") == 0) {
+            lexer = arg.substr(8);
+        } else if (arg.compare(0, 9, "--parser=") == 0) {
+            parser = arg.substr(9);
+        } else if (arg == "--stats") {
+            printStats = true;
+        } else if (arg == "--mem-report") {
+            memReport = true;
+        } else if (arg.compare(0, 13, "--mem-report=") == 0) {
+            memReport = true;
+            memReportFile = arg.substr(13);
+        } else if (arg == "--run") {
+            runMode = true;
+        } else if (arg == "--bytecode") {
+            printBytecode = true;
+        } else if (arg == "-c") {
+            objectMode = true;
+        } else if (arg == "--cache") {
+            useCache = true;
+        } else if (arg.compare(0, 12, "--cache-dir=") == 0) {
+            useCache = true;
+            cacheDir = arg.substr(12);
+        } else if (arg.compare(0, 13, "--cache-size=") == 0) {
+            cacheSizeMiB = std::max(1LL, std::atoll(arg.c_str() + 13));
+        } else if (arg == "--no-cache") {
+            useCache = false;
+        } else if (arg == "--incremental") {
+            incremental = true;
+        } else if (arg.size() > 2 && arg.compare(0, 2, "-j") == 0 && std::isdigit(arg[2])) {
+            jobs = std::max(1, std::atoi(arg.c_str() + 2));
+        } else if (arg.size() == 3 && arg.compare(0, 2, "-O") == 0 && std::isdigit(arg[2])) {
+            optLevel = arg[2] - '0';
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg == "-o" && i + 1 < argc) {
+            outputFile = argv[++i];
+        } else if (arg[0] != '-' || arg == "-") {
+            if (inputFile.empty()) {
+                inputFile = arg;
+            } else {
+                std::cerr << "Error: Multiple input files specified" << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "Error: Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    
+    if (inputFile.empty()) {
+        std::cerr << "Error: No input file specified" << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+    
+    // 输入文件为 "-" 时从标准输入（或请求带来的源码）编译，诊断里显示为 <stdin>
+    bool fromStdin = inputFile == "-";
+    std::string stdinSource;
+    if (fromStdin) {
+        if (io && io->source) {
+            stdinSource = *io->source;
+        } else {
+            stdinSource.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+        }
+    }
+    const std::string inputName = fromStdin ? "<stdin>" : inputFile;
+    
+    // 检查输入文件扩展名
+    if (!fromStdin && Utils::getFileExtension(inputFile) != ".tc") {
+        std::cerr << "Warning: Input file should have .tc extension" << std::endl;
+    }
+    
+    if (objectMode && target != "riscv32") {
+        std::cerr << "Error: -c is only supported for the riscv32 target" << std::endl;
+        return 1;
+    }
+    
+    if (incremental && target != "riscv32") {
+        std::cerr << "Error: --incremental is only supported for the riscv32 target" << std::endl;
+        return 1;
+    }
+    
+    // 设置默认输出文件名；从标准输入编译时输出到标准输出
+    if (outputFile.empty()) {
+        outputFile = fromStdin ? "-" : Utils::getBaseName(inputFile) + (objectMode ? ".o" : ".s");
+    }
+    
+    if (incremental && outputFile == "-") {
+        std::cerr << "Error: --incremental needs an output file" << std::endl;
+        return 1;
+    }
+    
+    if (lexer != "fast" && lexer != "flex") {
+        std::cerr << "Error: Unknown lexer: " << lexer << " (expected fast or flex)" << std::endl;
+        return 1;
+    }
+    
+    if (parser != "pratt" && parser != "bison") {
+        std::cerr << "Error: Unknown parser: " << parser << " (expected pratt or bison)" << std::endl;
+        return 1;
+    }
+    
+    if (target != "riscv32" && target != "x86_64") {
+        std::cerr << "Error: Unknown target: " << target << " (expected riscv32 or x86_64)" << std::endl;
+        return 1;
+    }
+    
+    MachineModel machine;
+    std::string machineError;
+    if (!MachineModel::load(mtune, machine, machineError)) {
+        std::cerr << "Error: " << machineError << std::endl;
+        return 1;
+    }
+    
+    try {
+        if (verbose) {
+            std::cout << "ToyC Compiler v1.0" << std::endl;
+            std::cout << "Input file: " << inputName << std::endl;
+            std::cout << "Output file: " << outputFile << std::endl;
+            std::cout << "===================" << std::endl;
+        }
+        
+        Utils::CompilerStats stats;
+        Utils::Timer totalTimer;
+        Utils::Timer phaseTimer;
+        
+        // --mem-report：开启分配计数，各阶段用 memory.begin/end 括起来
+        Memory::setEnabled(memReport);
+        MemoryReport memory;
+        auto writeMemReport = [&]() {
+            if (!memReport) return;
+            if (memReportFile.empty()) {
+                memory.write(std::cout, inputName);
+                return;
+            }
+            std::ofstream out(memReportFile);
+            if (!out) {
+                std::cerr << "Warning: Cannot write memory report: " << memReportFile << std::endl;
+                return;
+            }
+            memory.write(out, inputName);
+        };
+        
+        // 输出文件为 "-" 时写到标准输出；服务端的请求写进应答
+        std::ostream& status = outputFile == "-" && !(io && io->output) ? std::cerr : std::cout;
+        auto writeOutput = [&](const std::string& data) {
+            if (outputFile != "-") return Utils::writeFile(outputFile, data);
+            if (io && io->output) {
+                *io->output = data;
+                return true;
+            }
+            std::cout.write(data.data(), data.size());
+            return static_cast<bool>(std::cout.flush());
+        };
+        
+        // 0. 编译缓存：源码、编译器和影响输出的选项都没变时直接复用上次的输出
+        std::unique_ptr<CompileCache> cache;
+        std::string cacheKey;
+        if (useCache && !printTokens && !printAST && !parseOnly && !runMode && !memReport) {
+            std::string source;
+            if (fromStdin) source = stdinSource;
+            if (fromStdin || readWholeFile(inputFile, source)) {
+                cache = std::make_unique<CompileCache>(cacheDir.empty() ? CompileCache::defaultDirectory() : cacheDir,
+                                                       cacheSizeMiB << 20);
+                std::string config = "target=" + target + " -O" + std::to_string(optLevel) +
+                                     (objectMode ? " -c" : "") + " mtune=" + machine.signature();
+                cacheKey = CompileCache::makeKey(source, config);
+                
+                std::string cached;
+                if (cache->lookup(cacheKey, cached)) {
+                    if (verbose) std::cout << "Cache hit: " << cacheKey << std::endl;
+                    if (!writeOutput(cached)) {
+                        std::cerr << "Error: Cannot write to output file: " << outputFile << std::endl;
+                        return 1;
+                    }
+                    status << "Compilation successful!" << std::endl;
+                    if (printStats) {
+                        stats.totalLines = std::count(source.begin(), source.end(), '\n') + 1;
+                        cache->refreshTotals();
+                        const CompileCache::Counters& totals = cache->getTotals();
+                        stats.addCounter("cache-hits", totals.hits);
+                        stats.addCounter("cache-misses", totals.misses);
+                        stats.addCounter("cache-bytes", totals.bytes);
+                        stats.addCounter("cache-evictions", totals.evictions);
+                        stats.totalTime = totalTimer.elapsedMilliseconds();
+                        stats.print();
+                    }
+                    return 0;
+                }
+                if (verbose) std::cout << "Cache miss: " << cacheKey << std::endl;
+            }
+        }
+        
+        // 1. 词法和语法分析
+        if (verbose) std::cout << "Phase 1: Parsing..." << std::endl;
+        
+        root.reset(); // 确保之前的AST被清理
+        yylineno = 1;
+        phaseTimer.start();
+        // 源码留在 SourceManager 中，诊断时按节点偏移查行列号；Flex 路径的节点没有偏移
+        SourceManager sources;
+        int parseResult;
+        if (lexer == "fast" || printTokens) {
+            // 手写扫描器先把整个文件扫描成词法单元数组，语法分析器再顺序消费
+            memory.begin("lex");
+            if (fromStdin) {
+                sources.setBuffer(inputName, stdinSource);
+            } else if (!sources.load(inputFile)) {
+                std::cerr << "Error: Cannot open input file: " << inputFile << std::endl;
+                return 1;
+            }
+            TokenBuffer tokens;
+            tokens.lex(sources.getBuffer());
+            memory.end();
+            memory.addSize("source_bytes", sources.getBuffer().capacity());
+            memory.addSize("token_buffer_bytes", tokens.memoryBytes());
+            stats.lexTime = phaseTimer.elapsedMilliseconds();
+            stats.totalTokens = static_cast<int>(tokens.size()) - 1;
+            
+            if (printTokens) {
+                tokens.dump(std::cout);
+                return 0;
+            }
+            
+            phaseTimer.start();
+            memory.begin("parse");
+            if (parser == "pratt") {
+                PrattParser prattParser(tokens);
+                parseResult = prattParser.parse(root) ? 0 : 1;
+                if (parseResult != 0) std::cerr << prattParser.getError() << std::endl;
+            } else {
+                TokenBuffer::setActive(&tokens);
+                parseResult = yyparse();
+                TokenBuffer::setActive(nullptr);
+            }
+            memory.end();
+        } else {
+            FILE* inputFp = fromStdin ? fmemopen(stdinSource.data(), stdinSource.size(), "r")
+                                      : fopen(inputFile.c_str(), "r");
+            if (!inputFp) {
+                std::cerr << "Error: Cannot open input file: " << inputFile << std::endl;
+                return 1;
+            }
+            
+            TokenBuffer::setActive(nullptr);
+            yyin = inputFp;
+            yyrestart(inputFp);  // 丢弃上一次编译（可能因语法错误中断）残留的缓冲
+            memory.begin("parse");  // 词法分析与语法分析交替进行，一起计入
+            parseResult = yyparse();
+            memory.end();
+            fclose(inputFp);
+        }
+        
+        if (parseResult != 0) {
+            std::cerr << "Error: Parsing failed" << std::endl;
+            return 1;
+        }
+        
+        if (!root) {
+            std::cerr << "Error: No AST generated" << std::endl;
+            return 1;
+        }
+        
+        stats.parseTime = phaseTimer.elapsedMilliseconds();
+        if (verbose) std::cout << "  Parsing completed successfully" << std::endl;
+        // 分析结束时比开始时多存活的内存就是AST
+        memory.addSize("ast_bytes", memory.find("parse")->retainedBytes);
+        
+        // 打印AST（如果需要）
+        if (printAST) {
+            std::cout << "\n=== Abstract Syntax Tree ===" << std::endl;
+            root->print();
+            std::cout << "============================\n" << std::endl;
+        }
+        
+        // 如果只需要解析，则在此结束
+        if (parseOnly) {
+            std::cout << "Parse-only mode: Parsing successful!" << std::endl;
+            writeMemReport();
+            return 0;
+        }
+        
+        // 增量编译：在任何改写AST的优化之前计算每个函数的键，
+        // 上次结果中键相同的函数跳过语义分析、AST优化和代码生成
+        std::unique_ptr<FunctionCache> functionCache;
+        std::vector<std::string> functionKeys;
+        std::vector<std::string> reusedCode(root->functions.size());
+        std::vector<bool> reused(root->functions.size(), false);
+        if (incremental && !runMode) {
+            PurityAnalyzer purity;
+            if (optLevel > 0) purity.analyze(*root);
+            std::string config = "target=" + target + " -O" + std::to_string(optLevel) +
+                                 " mtune=" + machine.signature();
+            functionKeys = FunctionCache::computeKeys(*root, config, optLevel > 0 ? &purity : nullptr);
+            
+            functionCache = std::make_unique<FunctionCache>(outputFile + ".fncache");
+            functionCache->load();
+            for (size_t i = 0; i < root->functions.size(); ++i) {
+                reused[i] = functionCache->find(functionKeys[i], reusedCode[i]);
+            }
+            long reusedCount = std::count(reused.begin(), reused.end(), true);
+            stats.addCounter("incremental-reused", reusedCount);
+            stats.addCounter("incremental-compiled", reused.size() - reusedCount);
+            if (verbose) {
+                std::cout << "  Incremental: " << reusedCount << " of " << reused.size()
+                          << " functions unchanged" << std::endl;
+            }
+        }
+        
+        // 2. 语义分析
+        if (verbose) std::cout << "Phase 2: Semantic analysis..." << std::endl;
+        
+        phaseTimer.start();
+        memory.begin("sema");
+        SemanticAnalyzer analyzer;
+        analyzer.setThreads(jobs);
+        bool semanticOk = analyzer.analyze(*root, reused);
+        memory.end();
+        if (!semanticOk) {
+            std::cerr << "Semantic analysis failed:" << std::endl;
+            const auto& errors = analyzer.getErrors();
+            const auto& offsets = analyzer.getErrorOffsets();
+            for (size_t i = 0; i < errors.size(); ++i) {
+                if (offsets[i] == ASTNode::NO_OFFSET) {
+                    std::cerr << "  Error " << (i+1) << ": " << errors[i] << std::endl;
+                    continue;
+                }
+                std::cerr << "  Error " << (i+1) << ": " << sources.format(offsets[i], errors[i]) << std::endl;
+                sources.printContext(std::cerr, offsets[i]);
+            }
+            return 1;
+        }
+        
+        stats.semanticTime = phaseTimer.elapsedMilliseconds();
+        if (verbose) std::cout << "  Semantic analysis completed successfully" << std::endl;
+        // 函数体的作用域检查完就释放，留下来的是函数签名表
+        memory.addSize("symbol_table_bytes", memory.find("sema")->retainedBytes);
+        
+        // AST级优化
+        if (optLevel > 0) {
+            if (verbose) std::cout << "Phase 2.5: AST optimization..." << std::endl;
+            phaseTimer.start();
+            memory.begin("opt");
+            
+            // 常量实参的纯函数调用在编译期求值
+            PurityAnalyzer purity;
+            purity.analyze(*root);
+            PureCallFolder folder;
+            folder.run(*root, purity, reused);
+            stats.addCounter("pure-functions", purity.getPureCount());
+            stats.addCounter("pure-calls-folded", folder.getFoldedCount());
+            
+            CommonSubexpressionEliminator cse;
+            cse.run(*root, reused);
+            stats.addCounter("cse-temporaries", cse.getTempCount());
+            stats.addCounter("cse-reused", cse.getEliminatedCount());
+            
+            if (verbose) {
+                std::cout << "  Pure calls folded: " << folder.getFoldedCount() << std::endl;
+                std::cout << "  CSE: " << cse.getTempCount() << " temporaries, "
+                          << cse.getEliminatedCount() << " expressions reused" << std::endl;
+            }
+            memory.end();
+            stats.optTime = phaseTimer.elapsedMilliseconds();
+        }
+        
+        // 直接执行：降低为寄存器字节码并在虚拟机上运行 main
+        if (runMode) {
+            if (verbose) std::cout << "Phase 3: Bytecode execution..." << std::endl;
+            
+            phaseTimer.start();
+            memory.begin("bytecode");
+            BytecodeProgram program;
+            BytecodeCompiler bytecode;
+            if (!bytecode.compile(*root, program)) {
+                std::cerr << "Error: " << bytecode.getError() << std::endl;
+                return 1;
+            }
+            memory.end();
+            stats.codegenTime = phaseTimer.elapsedMilliseconds();
+            
+            if (printBytecode) {
+                std::cout << "\n=== Bytecode ===" << std::endl;
+                program.dump(std::cout);
+                std::cout << "================\n" << std::endl;
+            }
+            
+            Utils::Timer runTimer;
+            memory.begin("vm");
+            VirtualMachine vm;
+            int exitValue = 0;
+            bool ok = vm.run(program, "main", exitValue);
+            memory.end();
+            double runTime = runTimer.elapsedMilliseconds();
+            
+            stats.addCounter("vm-bytecode-instructions", program.code.size());
+            stats.addCounter("vm-calls", vm.getCallsExecuted());
+            stats.addCounter("vm-peak-call-depth", vm.getPeakDepth());
+            
+            if (verbose) {
+                std::cout << "  " << program.code.size() << " bytecode instructions, ran in "
+                          << runTime << " ms" << std::endl;
+                if (ok) std::cout << "  main returned " << exitValue << std::endl;
+            }
+            if (printStats) {
+                std::string sourceCode = fromStdin ? stdinSource : Utils::readFile(inputFile);
+                stats.totalLines = std::count(sourceCode.begin(), sourceCode.end(), '\n') + 1;
+                stats.totalFunctions = root->functions.size();
+                stats.totalTime = totalTimer.elapsedMilliseconds();
+                stats.print();
+            }
+            memory.addSize("bytecode_bytes", program.code.capacity() * sizeof(program.code[0]));
+            writeMemReport();
+            if (!ok) {
+                std::cerr << "Runtime error: " << vm.getError() << std::endl;
+                return 1;
+            }
+            return exitValue;
+        }
+        
+        // 3. 代码生成
+        if (verbose) std::cout << "Phase 3: Code generation..." << std::endl;
+        
+        phaseTimer.start();
+        memory.begin("codegen");
+        std::string assemblyCode;
+        if (target == "x86_64") {
+            // 宿主原生代码：RISC-V 的窥孔、布局和调度不适用
+            X86CodeGenerator x86Generator;
+            assemblyCode = x86Generator.generate(*root);
+        } else {
+            // 构建函数表（从AST中提取）
+            std::unordered_map<std::string, FunctionInfo> functionTable;
+            for (const auto& func : root->functions) {
+                std::vector<Expression::Type> paramTypes;
+                for (const auto& param : func->parameters) {
+                    paramTypes.push_back(param.type);
+                }
+                functionTable.insert_or_assign(func->name, FunctionInfo(func->name, func->returnType, paramTypes, true));
+            }
+        
+            // 逐函数生成并优化：窥孔、布局和调度都不跨函数，标签也以函数名为命名空间，
+            // 所以各函数可以并行处理，按源码顺序拼接后与串行编译、增量编译的输出一致。
+            // 每个线程一套生成器和优化遍（函数间的状态在visit(FunctionDefinition)中重置）
+            struct CodegenWorker {
+                RISCVCodeGenerator generator;
+                PeepholeOptimizer peephole;
+                BlockPlacement placement;
+                InstructionScheduler scheduler;
+                explicit CodegenWorker(const MachineModel& machine) : scheduler(machine) {}
+            };
+            
+            WorkStealingPool pool(std::min<size_t>(jobs, root->functions.size()));
+            std::vector<std::unique_ptr<CodegenWorker>> workers;
+            for (int t = 0; t < pool.size(); ++t) {
+                workers.push_back(std::make_unique<CodegenWorker>(machine));
+                workers.back()->generator.setFunctionTable(functionTable);
+                workers.back()->generator.setPromoteLocals(optLevel > 0);
+            }
+            
+            std::vector<std::string> functionCode(root->functions.size());
+            std::vector<int> frameBytesSaved(root->functions.size(), 0);
+            std::vector<std::pair<int, int>> localHomes(root->functions.size(), {0, 0});
+            pool.run(root->functions.size(), [&](size_t i, int t) {
+                if (reused[i]) {
+                    functionCode[i] = std::move(reusedCode[i]);
+                    return;
+                }
+                CodegenWorker& worker = *workers[t];
+                std::string code = worker.generator.generateFunction(*root->functions[i]);
+                frameBytesSaved[i] = worker.generator.getFrameBytesSaved();
+                localHomes[i] = {worker.generator.getPromotedLocals(), worker.generator.getMemoryLocals()};
+                if (optLevel > 0) {
+                    code = worker.peephole.optimize(code);
+                    code = worker.placement.place(code);
+                    code = worker.scheduler.schedule(code);
+                }
+                functionCode[i] = std::move(code);
+            });
+            
+            assemblyCode = workers[0]->generator.generateHeader();
+            for (size_t i = 0; i < functionCode.size(); ++i) {
+                if (functionCache) functionCache->record(functionKeys[i], functionCode[i]);
+                assemblyCode += functionCode[i];
+            }
+        
+            if (optLevel > 0) {
+                // 各线程的计数按规则名汇总
+                std::vector<std::pair<std::string, int>> ruleHits = workers[0]->peephole.getRuleHits();
+                long rewrites = 0, jumpsRemoved = 0, branchesInverted = 0;
+                long blocks = 0, cyclesBefore = 0, cyclesAfter = 0;
+                for (size_t t = 0; t < workers.size(); ++t) {
+                    const CodegenWorker& worker = *workers[t];
+                    if (t > 0) {
+                        auto hits = worker.peephole.getRuleHits();
+                        for (size_t r = 0; r < hits.size(); ++r) ruleHits[r].second += hits[r].second;
+                    }
+                    rewrites += worker.peephole.getTotalHits();
+                    jumpsRemoved += worker.placement.getJumpsRemoved();
+                    branchesInverted += worker.placement.getBranchesInverted();
+                    blocks += worker.scheduler.getBlocksScheduled();
+                    cyclesBefore += worker.scheduler.getCyclesBefore();
+                    cyclesAfter += worker.scheduler.getCyclesAfter();
+                }
+                
+                for (const auto& hit : ruleHits) {
+                    stats.addCounter("peephole " + hit.first, hit.second);
+                }
+                stats.addCounter("layout-jumps-removed", jumpsRemoved);
+                stats.addCounter("layout-branches-inverted", branchesInverted);
+                stats.addCounter("sched-blocks", blocks);
+                stats.addCounter("sched-cycles-before", cyclesBefore);
+                stats.addCounter("sched-cycles-after", cyclesAfter);
+                if (verbose) {
+                    std::cout << "  Peephole: " << rewrites << " rewrites" << std::endl;
+                    std::cout << "  Scheduling (" << machine.getName() << "): " 
+                              << cyclesBefore << " -> " << cyclesAfter
+                              << " estimated cycles" << std::endl;
+                }
+            }
+            // 栈槽共用省下的栈帧字节（复用缓存的函数没有重新布局，不计入）
+            long frameBytesTotal = 0;
+            for (size_t i = 0; i < frameBytesSaved.size(); ++i) {
+                if (frameBytesSaved[i] == 0) continue;
+                stats.addCounter("frame-bytes-saved " + root->functions[i]->name, frameBytesSaved[i]);
+                frameBytesTotal += frameBytesSaved[i];
+            }
+            stats.addCounter("frame-bytes-saved", frameBytesTotal);
+            long promotedLocals = 0, memoryLocals = 0;
+            for (const auto& homes : localHomes) {
+                promotedLocals += homes.first;
+                memoryLocals += homes.second;
+            }
+            stats.addCounter("locals-promoted", promotedLocals);
+            stats.addCounter("locals-in-memory", memoryLocals);
+            stats.addCounter("codegen-threads", pool.size());
+            if (verbose) std::cout << "  " << pool.size() << " code generation threads" << std::endl;
+        }
+        
+        memory.end();
+        stats.codegenTime = phaseTimer.elapsedMilliseconds();
+        if (verbose) std::cout << "  Code generation completed" << std::endl;
+        
+        // 3.5 直接编码为目标文件，省去外部汇编器
+        std::string outputData = assemblyCode;
+        if (objectMode) {
+            if (verbose) std::cout << "Phase 3.5: Encoding object file..." << std::endl;
+            memory.begin("encode");
+            
+            RV32Encoder encoder;
+            ObjectCode object;
+            if (!encoder.encode(assemblyCode, object)) {
+                std::cerr << "Error: Encoding failed: " << encoder.getError() << std::endl;
+                return 1;
+            }
+            outputData = writeElfObject(object);
+            memory.end();
+            stats.addCounter("object-text-bytes", object.text.size());
+            stats.addCounter("object-relocations", object.relocations.size());
+            stats.addCounter("object-relaxed-branches", encoder.getRelaxedBranches());
+            if (verbose) {
+                std::cout << "  " << object.text.size() << " bytes of code, "
+                          << object.relocations.size() << " relocations, "
+                          << encoder.getRelaxedBranches() << " branches relaxed" << std::endl;
+            }
+        }
+        
+        // 4. 写入输出文件
+        if (verbose) std::cout << "Phase 4: Writing output..." << std::endl;
+        
+        memory.begin("write");
+        if (!writeOutput(outputData)) {
+            std::cerr << "Error: Cannot write to output file: " << outputFile << std::endl;
+            return 1;
+        }
+        memory.end();
+        memory.addSize("assembly_bytes", assemblyCode.capacity());
+        memory.addSize("output_bytes", outputData.capacity());
+        
+        if (verbose) {
+            std::cout << "  Output written to: " << outputFile << std::endl;
+            std::cout << "===================" << std::endl;
+        }
+        
+        // 写缓存失败不影响本次编译
+        if (functionCache && !functionCache->save()) {
+            std::cerr << "Warning: " << functionCache->getError() << std::endl;
+        }
+        
+        // 只缓存成功的编译结果
+        if (cache) {
+            if (!cache->store(cacheKey, outputData)) {
+                std::cerr << "Warning: " << cache->getError() << std::endl;
+            }
+            const CompileCache::Counters& totals = cache->getTotals();
+            stats.addCounter("cache-hits", totals.hits);
+            stats.addCounter("cache-misses", totals.misses);
+            stats.addCounter("cache-bytes", totals.bytes);
+            stats.addCounter("cache-evictions", totals.evictions);
+        }
+        
+        status << "Compilation successful!" << std::endl;
+        
+        if (printStats) {
+            std::string sourceCode = fromStdin ? stdinSource : Utils::readFile(inputFile);
+            stats.totalLines = std::count(sourceCode.begin(), sourceCode.end(), '\n') + 1;
+            stats.totalFunctions = root->functions.size();
+            stats.totalTime = totalTimer.elapsedMilliseconds();
+            stats.print();
+        }
+        
+        writeMemReport();
+        
+        // 显示统计信息
+        if (verbose) {
+            std::cout << "\nStatistics:" << std::endl;
+            std::cout << "  Functions: " << root->functions.size() << std::endl;
+            
+            // 计算总行数
+            std::string sourceCode = fromStdin ? stdinSource : Utils::readFile(inputFile);
+            int lineCount = std::count(sourceCode.begin(), sourceCode.end(), '\n') + 1;
+            std::cout << "  Source lines: " << lineCount << std::endl;
+            std::cout << "  Assembly lines: " << std::count(assemblyCode.begin(), assemblyCode.end(), '\n') << std::endl;
+        }
+        
+        return 0;
+        
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "Error: Unknown error occurred" << std::endl;
+        return 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    
+    // 常驻服务和客户端模式：--server/--connect 必须是第一个参数
+    if (mode == "--server" || mode == "--connect") {
+        if (argc < 3) {
+            std::cerr << "Error: " << mode << " requires a socket path" << std::endl;
+            return 1;
+        }
+        std::string socketPath = argv[2];
+        
+        if (mode == "--connect") {
+            return runClient(socketPath, std::vector<std::string>(argv + 3, argv + argc));
+        }
+        
+        int workers = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+        for (int i = 3; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg.compare(0, 10, "--workers=") == 0) {
+                workers = std::atoi(arg.c_str() + 10);
+            } else {
+                std::cerr << "Error: Unknown server option: " << arg << std::endl;
+                return 1;
+            }
+        }
+        
+        CompileServer server(socketPath, workers, compile);
+        if (!server.run()) {
+            std::cerr << "Error: " << server.getError() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    
+    return compile(argc, argv);
+}
@@ -0,0 +1,348 @@
+#include "opt/consteval.hpp"
+#include <cstdint>
+#include <climits>
+#include <algorithm>
+
+namespace {
+
+// 求值中止（超出预算、除零等），只在解释器内部使用
+struct EvaluationAborted {};
+
+// 32位补码回绕运算，与RV32目标上的结果一致
+int wrap(int64_t v) {
+    return static_cast<int32_t>(static_cast<uint32_t>(v));
+}
+
+} // namespace
+
+bool CompileTimeEvaluator::evaluateCall(const std::string& name, const std::vector<int>& args, int& result) {
+    steps = 0;
+    depth = 0;
+    try {
+        Walk::run(callFunction(name, args));
+        result = value;
+        return true;
+    } catch (const EvaluationAborted&) {
+        return false;
+    }
+}
+
+bool CompileTimeEvaluator::evaluateConstant(Expression& expr, int& result) {
+    steps = 0;
+    depth = 0;
+    scopes.clear();
+    try {
+        // 没有作用域时任何变量引用都会中止求值
+        Walk::run(eval(expr));
+        result = value;
+        return true;
+    } catch (const EvaluationAborted&) {
+        return false;
+    }
+}
+
+void CompileTimeEvaluator::step() {
+    if (++steps > stepBudget) throw EvaluationAborted();
+}
+
+Walk CompileTimeEvaluator::eval(Expression& expr) {
+    return expr.accept(*this);
+}
+
+int* CompileTimeEvaluator::lookup(const std::string& name) {
+    for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
+        auto found = it->find(name);
+        if (found != it->end()) return &found->second;
+    }
+    return nullptr;
+}
+
+Walk CompileTimeEvaluator::callFunction(const std::string& name, const std::vector<int>& args) {
+    auto it = functions.find(name);
+    if (it == functions.end() || !purity.isPure(name) || depth >= maxDepth) {
+        throw EvaluationAborted();
+    }
+    FunctionDefinition& func = *it->second;
+    if (func.parameters.size() != args.size()) throw EvaluationAborted();
+
+    // 新的调用帧
+    auto savedScopes = std::move(scopes);
+    scopes.clear();
+    scopes.emplace_back();
+    for (size_t i = 0; i < args.size(); ++i) {
+        scopes.back()[func.parameters[i].name] = args[i];
+    }
+
+    depth++;
+    control = NORMAL;
+    value = 0;
+    co_await func.body->accept(*this);
+    depth--;
+
+    if (control != RETURN && func.returnType == Expression::INT) {
+        throw EvaluationAborted();
+    }
+    if (func.returnType != Expression::INT) value = 0;
+
+    scopes = std::move(savedScopes);
+    control = NORMAL;
+}
+
+// Visitor实现
+Walk CompileTimeEvaluator::visit(NumberLiteral& node) {
+    step();
+    value = node.value;
+    co_return;
+}
+
+Walk CompileTimeEvaluator::visit(Identifier& node) {
+    step();
+    int* slot = lookup(node.name);
+    if (!slot) throw EvaluationAborted();
+    value = *slot;
+    co_return;
+}
+
+Walk CompileTimeEvaluator::visit(BinaryExpression& node) {
+    step();
+
+    // 短路求值
+    if (node.op == BinaryExpression::AND || node.op == BinaryExpression::OR) {
+        co_await eval(*node.left);
+        if ((value != 0) == (node.op == BinaryExpression::AND)) {
+            co_await eval(*node.right);
+        }
+        value = value != 0;
+        co_return;
+    }
+
+    co_await eval(*node.left);
+    int64_t l = value;
+    co_await eval(*node.right);
+    int64_t r = value;
+
+    switch (node.op) {
+        case BinaryExpression::ADD: value = wrap(l + r); break;
+        case BinaryExpression::SUB: value = wrap(l - r); break;
+        case BinaryExpression::MUL: value = wrap(l * r); break;
+        case BinaryExpression::DIV:
+            if (r == 0) throw EvaluationAborted();
+            value = (l == INT_MIN && r == -1) ? INT_MIN : static_cast<int>(l / r);
+            break;
+        case BinaryExpression::MOD:
+            if (r == 0) throw EvaluationAborted();
+            value = (l == INT_MIN && r == -1) ? 0 : static_cast<int>(l % r);
+            break;
+        case BinaryExpression::LT: value = l < r; break;
+        case BinaryExpression::LE: value = l <= r; break;
+        case BinaryExpression::GT: value = l > r; break;
+        case BinaryExpression::GE: value = l >= r; break;
+        case BinaryExpression::EQ: value = l == r; break;
+        case BinaryExpression::NE: value = l != r; break;
+        default: break;
+    }
+}
+
+Walk CompileTimeEvaluator::visit(UnaryExpression& node) {
+    step();
+    co_await eval(*node.operand);
+    int v = value;
+    switch (node.op) {
+        case UnaryExpression::PLUS:  value = v; break;
+        case UnaryExpression::MINUS: value = wrap(-static_cast<int64_t>(v)); break;
+        case UnaryExpression::NOT:   value = !v; break;
+    }
+}
+
+Walk CompileTimeEvaluator::visit(FunctionCall& node) {
+    step();
+    std::vector<int> args;
+    for (auto& arg : node.arguments) {
+        co_await eval(*arg);
+        args.push_back(value);
+    }
+    co_await callFunction(node.functionName, args);
+}
+
+Walk CompileTimeEvaluator::visit(AssignmentStatement& node) {
+    step();
+    co_await eval(*node.value);
+    int v = value;
+    int* slot = lookup(node.variable);
+    if (!slot) throw EvaluationAborted();
+    *slot = v;
+}
+
+Walk CompileTimeEvaluator::visit(VariableDeclaration& node) {
+    step();
+    int v = 0;
+    if (node.initializer) {
+        co_await eval(*node.initializer);
+        v = value;
+    }
+    scopes.back()[node.name] = v;
+}
+
+Walk CompileTimeEvaluator::visit(Block& node) {
+    step();
+    scopes.emplace_back();
+    for (auto& stmt : node.statements) {
+        co_await stmt->accept(*this);
+        if (control != NORMAL) break;
+    }
+    scopes.pop_back();
+}
+
+Walk CompileTimeEvaluator::visit(IfStatement& node) {
+    step();
+    co_await eval(*node.condition);
+    if (value) {
+        co_await node.thenStatement->accept(*this);
+    } else if (node.elseStatement) {
+        co_await node.elseStatement->accept(*this);
+    }
+}
+
+Walk CompileTimeEvaluator::visit(WhileStatement& node) {
+    step();
+    while (true) {
+        co_await eval(*node.condition);
+        if (!value) break;
+        co_await node.body->accept(*this);
+        if (control == BREAK) {
+            control = NORMAL;
+            break;
+        }
+        if (control == CONTINUE) control = NORMAL;
+        if (control == RETURN) break;
+    }
+}
+
+Walk CompileTimeEvaluator::visit(BreakStatement&) {
+    step();
+    control = BREAK;
+    co_return;
+}
+
+Walk CompileTimeEvaluator::visit(ContinueStatement&) {
+    step();
+    control = CONTINUE;
+    co_return;
+}
+
+Walk CompileTimeEvaluator::visit(ReturnStatement& node) {
+    step();
+    value = 0;
+    if (node.value) co_await eval(*node.value);
+    control = RETURN;
+}
+
+Walk CompileTimeEvaluator::visit(ExpressionStatement& node) {
+    step();
+    co_await eval(*node.expression);
+}
+
+Walk CompileTimeEvaluator::visit(FunctionDefinition&) {
+    // 函数通过 callFunction 进入
+    co_return;
+}
+
+Walk CompileTimeEvaluator::visit(CompilationUnit&) {
+    co_return;
+}
+
+// PureCallFolder实现
+void PureCallFolder::run(CompilationUnit& unit, const PurityAnalyzer& pure, long budget) {
+    run(unit, pure, std::vector<bool>(unit.functions.size(), false), budget);
+}
+
+void PureCallFolder::run(CompilationUnit& unit, const PurityAnalyzer& pure, const std::vector<bool>& skip,
+                         long budget) {
+    purity = &pure;
+    totalBudget = budget;
+    folded = 0;
+    functions.clear();
+    for (auto& func : unit.functions) {
+        functions[func->name] = func.get();
+    }
+
+    for (size_t i = 0; i < unit.functions.size(); ++i) {
+        if (i < skip.size() && skip[i]) continue;
+        foldStatement(*unit.functions[i]->body);
+    }
+}
+
+void PureCallFolder::foldStatement(Statement& body) {
+    // 按源码顺序收集语句中的表达式，再逐个折叠
+    std::vector<std::unique_ptr<Expression>*> slots;
+    walkTree(body, [&](ASTNode& node) {
+        if (auto decl = dynamic_cast<VariableDeclaration*>(&node)) {
+            slots.push_back(&decl->initializer);
+        } else if (auto assign = dynamic_cast<AssignmentStatement*>(&node)) {
+            slots.push_back(&assign->value);
+        } else if (auto ifStmt = dynamic_cast<IfStatement*>(&node)) {
+            slots.push_back(&ifStmt->condition);
+        } else if (auto whileStmt = dynamic_cast<WhileStatement*>(&node)) {
+            slots.push_back(&whileStmt->condition);
+        } else if (auto ret = dynamic_cast<ReturnStatement*>(&node)) {
+            slots.push_back(&ret->value);
+        } else if (auto expr = dynamic_cast<ExpressionStatement*>(&node)) {
+            slots.push_back(&expr->expression);
+        }
+        return dynamic_cast<Expression*>(&node) == nullptr;
+    });
+    for (auto slot : slots) {
+        foldExpression(*slot);
+    }
+}
+
+void PureCallFolder::foldExpression(std::unique_ptr<Expression>& root) {
+    // 显式栈后序遍历：子表达式（调用的实参）先折叠，再尝试折叠调用本身
+    struct Pending { std::unique_ptr<Expression>* slot; bool expanded; };
+    std::vector<Pending> stack{{&root, false}};
+    while (!stack.empty()) {
+        std::unique_ptr<Expression>* slot = stack.back().slot;
+        Expression* expr = slot->get();
+        if (!expr || stack.back().expanded) {
+            stack.pop_back();
+            if (expr) foldCall(*slot);
+            continue;
+        }
+        stack.back().expanded = true;
+        if (auto bin = dynamic_cast<BinaryExpression*>(expr)) {
+            stack.push_back({&bin->right, false});
+            stack.push_back({&bin->left, false});
+        } else if (auto un = dynamic_cast<UnaryExpression*>(expr)) {
+            stack.push_back({&un->operand, false});
+        } else if (auto call = dynamic_cast<FunctionCall*>(expr)) {
+            for (auto it = call->arguments.rbegin(); it != call->arguments.rend(); ++it) {
+                stack.push_back({&*it, false});
+            }
+        }
+    }
+}
+
+void PureCallFolder::foldCall(std::unique_ptr<Expression>& expr) {
+    auto call = dynamic_cast<FunctionCall*>(expr.get());
+    if (!call) return;
+    if (call->returnType != Expression::INT || !purity->isPure(call->functionName) || totalBudget <= 0) {
+        return;
+    }
+
+    // 实参必须都是编译期常量
+    CompileTimeEvaluator evaluator(functions, *purity, std::min(totalBudget, CALL_BUDGET));
+    std::vector<int> args;
+    for (auto& arg : call->arguments) {
+        int v;
+        if (!evaluator.evaluateConstant(*arg, v)) return;
+        args.push_back(v);
+    }
+
+    int result;
+    bool ok = evaluator.evaluateCall(call->functionName, args, result);
+    totalBudget -= evaluator.getStepsUsed();
+    if (ok) {
+        expr = std::make_unique<NumberLiteral>(result);
+        folded++;
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include "ast/ast.hpp"
+#include "opt/purity.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// 有界步数的编译期解释器：在AST上直接求值纯函数调用
+// 超出步数/递归深度、除零或缺少返回值时放弃求值，调用保留到运行时
+class CompileTimeEvaluator : public Visitor {
+private:
+    enum Control { NORMAL, BREAK, CONTINUE, RETURN };
+
+    const std::unordered_map<std::string, FunctionDefinition*>& functions;
+    const PurityAnalyzer& purity;
+    long stepBudget;
+    long steps;
+    int maxDepth;
+    int depth;
+
+    std::vector<std::unordered_map<std::string, int>> scopes;
+    int value;
+    Control control;
+
+public:
+    CompileTimeEvaluator(const std::unordered_map<std::string, FunctionDefinition*>& funcs,
+                         const PurityAnalyzer& pure, long budget = 10000, int maxCallDepth = 512)
+        : functions(funcs), purity(pure), stepBudget(budget), steps(0),
+          maxDepth(maxCallDepth), depth(0), value(0), control(NORMAL) {}
+
+    // 以常量实参求值一次函数调用
+    bool evaluateCall(const std::string& name, const std::vector<int>& args, int& result);
+    // 求值不含变量的常量表达式
+    bool evaluateConstant(Expression& expr, int& result);
+    long getStepsUsed() const { return steps; }
+
+    // Visitor接口实现
+    Walk visit(BinaryExpression& node) override;
+    Walk visit(UnaryExpression& node) override;
+    Walk visit(NumberLiteral& node) override;
+    Walk visit(Identifier& node) override;
+    Walk visit(FunctionCall& node) override;
+    Walk visit(AssignmentStatement& node) override;
+    Walk visit(VariableDeclaration& node) override;
+    Walk visit(Block& node) override;
+    Walk visit(IfStatement& node) override;
+    Walk visit(WhileStatement& node) override;
+    Walk visit(BreakStatement& node) override;
+    Walk visit(ContinueStatement& node) override;
+    Walk visit(ReturnStatement& node) override;
+    Walk visit(ExpressionStatement& node) override;
+    Walk visit(FunctionDefinition& node) override;
+    Walk visit(CompilationUnit& node) override;
+
+private:
+    void step();
+    // 求值表达式或调用函数，co_await 之后结果在 value 中
+    Walk eval(Expression& expr);
+    Walk callFunction(const std::string& name, const std::vector<int>& args);
+    int* lookup(const std::string& name);
+};
+
+// 把实参全为常量的纯函数调用替换为 NumberLiteral
+// 解释器每秒只有约两百万步，预算要小：死循环或长时间运行的调用很快放弃，不拖慢编译
+class PureCallFolder {
+public:
+    static constexpr long CALL_BUDGET = 10000;      // 单次调用的步数上限
+    static constexpr long TOTAL_BUDGET = 100000;    // 整个编译单元的步数上限
+
+private:
+    std::unordered_map<std::string, FunctionDefinition*> functions;
+    const PurityAnalyzer* purity;
+    long totalBudget;
+    int folded;
+
+public:
+    PureCallFolder() : purity(nullptr), totalBudget(0), folded(0) {}
+
+    void run(CompilationUnit& unit, const PurityAnalyzer& pure, long budget = TOTAL_BUDGET);
+    // 只折叠skip[i]为假的函数体（被调用的纯函数仍按整个编译单元查找）
+    void run(CompilationUnit& unit, const PurityAnalyzer& pure, const std::vector<bool>& skip,
+             long budget = TOTAL_BUDGET);
+    int getFoldedCount() const { return folded; }
+
+private:
+    void foldStatement(Statement& body);
+    void foldExpression(std::unique_ptr<Expression>& root);
+    // 实参已折叠完的纯函数调用，能在编译期求值就替换为字面量
+    void foldCall(std::unique_ptr<Expression>& expr);
+};
@@ -0,0 +1,468 @@
+#include "opt/cse.hpp"
+#include <algorithm>
+
+namespace {
+
+enum ShapeKind { NUMBER, NAME, BINARY, UNARY };
+
+// 按求值顺序访问表达式中无条件求值位置上的节点（&& / || 的右侧不访问）
+template <typename F>
+void forEachCounted(const Expression& root, F&& visit) {
+    std::vector<const Expression*> stack{&root};
+    while (!stack.empty()) {
+        const Expression* expr = stack.back();
+        stack.pop_back();
+        visit(*expr);
+        if (auto bin = dynamic_cast<const BinaryExpression*>(expr)) {
+            if (bin->op != BinaryExpression::AND && bin->op != BinaryExpression::OR) {
+                stack.push_back(bin->right.get());
+            }
+            stack.push_back(bin->left.get());
+        } else if (auto un = dynamic_cast<const UnaryExpression*>(expr)) {
+            stack.push_back(un->operand.get());
+        } else if (auto call = dynamic_cast<const FunctionCall*>(expr)) {
+            for (auto it = call->arguments.rbegin(); it != call->arguments.rend(); ++it) {
+                stack.push_back(it->get());
+            }
+        }
+    }
+}
+
+} // namespace
+
+size_t CommonSubexpressionEliminator::ShapeHash::operator()(const Shape& s) const {
+    size_t h = static_cast<size_t>(s.kind);
+    h = h * 31 + static_cast<size_t>(s.op);
+    h = h * 1000003 + static_cast<size_t>(static_cast<unsigned>(s.a));
+    h = h * 1000003 + static_cast<size_t>(static_cast<unsigned>(s.b));
+    return h;
+}
+
+void CommonSubexpressionEliminator::run(CompilationUnit& unit) {
+    tempCounter = 0;
+    eliminated = 0;
+    Walk::run(unit.accept(*this));
+}
+
+void CommonSubexpressionEliminator::run(CompilationUnit& unit, const std::vector<bool>& skip) {
+    tempCounter = 0;
+    eliminated = 0;
+    for (size_t i = 0; i < unit.functions.size(); ++i) {
+        if (i < skip.size() && skip[i]) continue;
+        Walk::run(unit.functions[i]->accept(*this));
+    }
+}
+
+int CommonSubexpressionEliminator::intern(const Shape& shape) {
+    auto it = shapes.find(shape);
+    if (it != shapes.end()) return it->second;
+    int id = static_cast<int>(shapes.size()) + 1;
+    shapes.emplace(shape, id);
+    return id;
+}
+
+// 值编号：显式栈后序计算尚未编号的子表达式
+// 只有进入函数时已存在的节点会被编号，改写中新建的节点不再查询，所以被释放节点的旧条目无需清理
+int CommonSubexpressionEliminator::valueNumber(const Expression& root) {
+    auto found = numbers.find(&root);
+    if (found != numbers.end()) return found->second;
+
+    std::vector<std::pair<const Expression*, bool>> stack{{&root, false}};
+    while (!stack.empty()) {
+        auto [expr, expanded] = stack.back();
+        if (numbers.count(expr)) {
+            stack.pop_back();
+            continue;
+        }
+        auto bin = dynamic_cast<const BinaryExpression*>(expr);
+        auto un = dynamic_cast<const UnaryExpression*>(expr);
+        if (!expanded && (bin || un)) {
+            stack.back().second = true;
+            if (bin) {
+                stack.push_back({bin->right.get(), false});
+                stack.push_back({bin->left.get(), false});
+            } else {
+                stack.push_back({un->operand.get(), false});
+            }
+            continue;
+        }
+        stack.pop_back();
+
+        int id = 0;
+        if (auto num = dynamic_cast<const NumberLiteral*>(expr)) {
+            id = intern({NUMBER, 0, num->value, 0});
+        } else if (auto ident = dynamic_cast<const Identifier*>(expr)) {
+            auto name = names.emplace(ident->name, static_cast<int>(names.size())).first;
+            id = intern({NAME, 0, name->second, 0});
+        } else if (bin) {
+            int l = numbers[bin->left.get()];
+            int r = numbers[bin->right.get()];
+            if (l && r) {
+                // 可交换运算符规范化操作数顺序，使 a*b 与 b*a 得到同一编号
+                bool commutative = bin->op == BinaryExpression::ADD || bin->op == BinaryExpression::MUL ||
+                                   bin->op == BinaryExpression::EQ || bin->op == BinaryExpression::NE;
+                if (commutative && r < l) std::swap(l, r);
+                id = intern({BINARY, bin->op, l, r});
+            }
+        } else if (un) {
+            int operand = numbers[un->operand.get()];
+            if (operand) id = intern({UNARY, un->op, operand, 0});
+        }
+        // 函数调用可能有副作用，不参与CSE
+        numbers[expr] = id;
+    }
+    return numbers[&root];
+}
+
+// 进入函数时按先序给语句编号，记录各值编号出现的位置和各变量被写的位置
+void CommonSubexpressionEliminator::numberStatements(Block& body) {
+    numbers.clear();
+    shapes.clear();
+    names.clear();
+    ranges.clear();
+    writePositions.clear();
+    occurrences.clear();
+
+    int position = 0;
+    // 第二项为真表示子树已编号完，记录区间终点
+    std::vector<std::pair<const Statement*, bool>> stack{{&body, false}};
+    while (!stack.empty()) {
+        auto [stmt, done] = stack.back();
+        stack.pop_back();
+        if (done) {
+            ranges[stmt].second = position;
+            continue;
+        }
+        int pos = position++;
+        ranges[stmt] = {pos, pos};
+        stack.push_back({stmt, true});
+
+        auto record = [&](const Expression* expr) {
+            if (!expr) return;
+            forEachCounted(*expr, [&](const Expression& e) {
+                int id = isCandidate(e) ? valueNumber(e) : 0;
+                if (id) occurrences[id].push_back(pos);
+            });
+        };
+        if (auto block = dynamic_cast<const Block*>(stmt)) {
+            for (auto it = block->statements.rbegin(); it != block->statements.rend(); ++it) {
+                stack.push_back({it->get(), false});
+            }
+        } else if (auto decl = dynamic_cast<const VariableDeclaration*>(stmt)) {
+            record(decl->initializer.get());
+            writePositions[decl->name].push_back(pos);
+        } else if (auto assign = dynamic_cast<const AssignmentStatement*>(stmt)) {
+            record(assign->value.get());
+            writePositions[assign->variable].push_back(pos);
+        } else if (auto ifStmt = dynamic_cast<const IfStatement*>(stmt)) {
+            record(ifStmt->condition.get());
+            if (ifStmt->elseStatement) stack.push_back({ifStmt->elseStatement.get(), false});
+            stack.push_back({ifStmt->thenStatement.get(), false});
+        } else if (auto whileStmt = dynamic_cast<const WhileStatement*>(stmt)) {
+            record(whileStmt->condition.get());
+            stack.push_back({whileStmt->body.get(), false});
+        } else if (auto ret = dynamic_cast<const ReturnStatement*>(stmt)) {
+            record(ret->value.get());
+        } else if (auto expr = dynamic_cast<const ExpressionStatement*>(stmt)) {
+            record(expr->expression.get());
+        }
+    }
+}
+
+bool CommonSubexpressionEliminator::isCandidate(const Expression& expr) {
+    return dynamic_cast<const BinaryExpression*>(&expr) != nullptr ||
+           dynamic_cast<const UnaryExpression*>(&expr) != nullptr;
+}
+
+void CommonSubexpressionEliminator::collectOperands(const Expression& expr,
+                                                    std::unordered_set<std::string>& operands) {
+    walkTree(const_cast<Expression&>(expr), [&](ASTNode& node) {
+        if (auto id = dynamic_cast<Identifier*>(&node)) operands.insert(id->name);
+        return true;
+    });
+}
+
+void CommonSubexpressionEliminator::addCounts(const Expression& expr, CountMap& counts, int delta) {
+    forEachCounted(expr, [&](const Expression& e) {
+        int id = isCandidate(e) ? valueNumber(e) : 0;
+        if (id) counts[id] += delta;
+    });
+}
+
+// 语句自身表达式中的出现次数；当前语句用随改写扣减的计数，其余语句查位置表
+int CommonSubexpressionEliminator::countAt(const Statement& stmt, const Scan& scan) const {
+    if (&stmt == scan.current) {
+        auto it = currentCounts.find(scan.id);
+        return it == currentCounts.end() ? 0 : it->second;
+    }
+    auto range = ranges.find(&stmt);
+    auto positions = occurrences.find(scan.id);
+    if (range == ranges.end() || positions == occurrences.end()) return 0;
+    auto bounds = std::equal_range(positions->second.begin(), positions->second.end(), range->second.first);
+    return static_cast<int>(bounds.second - bounds.first);
+}
+
+Walk CommonSubexpressionEliminator::countInStatements(const std::vector<std::unique_ptr<Statement>>& stmts,
+                                                      size_t start, const Scan& scan, int& count,
+                                                      bool& passed) {
+    passed = true;
+    for (size_t i = start; i < stmts.size() && passed; ++i) {
+        co_await countInStatement(*stmts[i], scan, count, passed);
+        // 已经够提升的次数，不必再往后找
+        if (count >= 2) passed = false;
+    }
+}
+
+// passed 为扫描能否越过该语句继续进行
+Walk CommonSubexpressionEliminator::countInStatement(const Statement& stmt, const Scan& scan, int& count,
+                                                     bool& passed) {
+    passed = false;
+    if (dynamic_cast<const ExpressionStatement*>(&stmt)) {
+        count += countAt(stmt, scan);
+        passed = true;
+    } else if (auto assign = dynamic_cast<const AssignmentStatement*>(&stmt)) {
+        count += countAt(stmt, scan);
+        passed = !scan.operands->count(assign->variable);
+    } else if (auto decl = dynamic_cast<const VariableDeclaration*>(&stmt)) {
+        count += countAt(stmt, scan);
+        passed = !scan.operands->count(decl->name);
+    } else if (dynamic_cast<const ReturnStatement*>(&stmt)) {
+        count += countAt(stmt, scan);
+    } else if (auto block = dynamic_cast<const Block*>(&stmt)) {
+        co_await countInStatements(block->statements, 0, scan, count, passed);
+    } else if (auto ifStmt = dynamic_cast<const IfStatement*>(&stmt)) {
+        // 条件支配两个分支，分支内的使用取较多的一侧
+        count += countAt(stmt, scan);
+        int thenCount = 0, elseCount = 0;
+        bool ignored;
+        co_await countInStatement(*ifStmt->thenStatement, scan, thenCount, ignored);
+        if (ifStmt->elseStatement) {
+            co_await countInStatement(*ifStmt->elseStatement, scan, elseCount, ignored);
+        }
+        count += std::max(thenCount, elseCount);
+    }
+}
+
+// 从当前语句开始向后统计出现次数，至少两次才值得提升
+bool CommonSubexpressionEliminator::shouldHoist(int id, const Expression& expr,
+                                                std::unordered_set<std::string>& operands) {
+    const Statement* current = (*currentStatements)[currentIndex].get();
+    auto it = currentCounts.find(id);
+    int count = it == currentCounts.end() ? 0 : it->second;
+    bool collected = false;
+
+    if (count < 2) {
+        // 位置表是上界：当前语句之后、本块结束之前都没有出现就不必扫描
+        auto range = ranges.find(current);
+        auto positions = occurrences.find(id);
+        if (range == ranges.end() || positions == occurrences.end()) return false;
+        auto next = std::upper_bound(positions->second.begin(), positions->second.end(), range->second.first);
+        if (next == positions->second.end() || *next >= blockEnd) return false;
+
+        collectOperands(expr, operands);
+        collected = true;
+        count = 0;
+        bool passed;
+        Walk::run(countInStatements(*currentStatements, currentIndex, Scan{id, &operands, current}, count, passed));
+        if (count < 2) return false;
+    }
+    if (!collected) collectOperands(expr, operands);
+    return true;
+}
+
+void CommonSubexpressionEliminator::killVariable(const std::string& name) {
+    for (auto it = available.begin(); it != available.end(); ) {
+        if (it->second.operands.count(name)) {
+            it = available.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// 语句子树的先序区间内写过某个操作数的可用表达式失效
+void CommonSubexpressionEliminator::killWrittenIn(const Statement& stmt) {
+    auto range = ranges.find(&stmt);
+    if (range == ranges.end()) return;
+    auto [first, last] = range->second;
+    auto written = [&](const std::string& name) {
+        auto writes = writePositions.find(name);
+        if (writes == writePositions.end()) return false;
+        auto it = std::lower_bound(writes->second.begin(), writes->second.end(), first);
+        return it != writes->second.end() && *it < last;
+    };
+    for (auto it = available.begin(); it != available.end(); ) {
+        if (std::any_of(it->second.operands.begin(), it->second.operands.end(), written)) {
+            it = available.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// 显式栈先序改写；hoist 同时表示该位置是否计入当前语句的出现次数
+void CommonSubexpressionEliminator::rewriteExpression(std::unique_ptr<Expression>& root, bool allowHoist) {
+    if (!root) return;
+    bool hoisting = allowHoist && currentStatements;
+    if (hoisting) {
+        currentCounts.clear();
+        addCounts(*root, currentCounts, 1);
+    }
+
+    std::vector<std::pair<std::unique_ptr<Expression>*, bool>> stack{{&root, hoisting}};
+    while (!stack.empty()) {
+        auto [slot, hoist] = stack.back();
+        stack.pop_back();
+        std::unique_ptr<Expression>& expr = *slot;
+
+        int id = isCandidate(*expr) ? valueNumber(*expr) : 0;
+        if (id) {
+            // 已有可用值：直接复用临时变量
+            auto it = available.find(id);
+            if (it != available.end()) {
+                if (hoist) addCounts(*expr, currentCounts, -1);
+                expr = std::make_unique<Identifier>(it->second.temp);
+                eliminated++;
+                continue;
+            }
+
+            // 后续还会用到：提升为临时变量
+            std::unordered_set<std::string> operands;
+            if (hoist && shouldHoist(id, *expr, operands)) {
+                addCounts(*expr, currentCounts, -1);
+                std::string temp = ".cse" + std::to_string(tempCounter++);
+                pendingDecls.push_back(std::make_unique<VariableDeclaration>(temp, std::move(expr)));
+                expr = std::make_unique<Identifier>(temp);
+                available[id] = AvailableExpr{temp, std::move(operands)};
+                continue;
+            }
+        }
+
+        if (auto bin = dynamic_cast<BinaryExpression*>(expr.get())) {
+            // 短路运算的右侧是条件求值的，只做替换不做提升
+            bool shortCircuit = bin->op == BinaryExpression::AND || bin->op == BinaryExpression::OR;
+            stack.push_back({&bin->right, hoist && !shortCircuit});
+            stack.push_back({&bin->left, hoist});
+        } else if (auto un = dynamic_cast<UnaryExpression*>(expr.get())) {
+            stack.push_back({&un->operand, hoist});
+        } else if (auto call = dynamic_cast<FunctionCall*>(expr.get())) {
+            for (auto it = call->arguments.rbegin(); it != call->arguments.rend(); ++it) {
+                stack.push_back({&*it, hoist});
+            }
+        }
+    }
+}
+
+// Visitor实现
+Walk CommonSubexpressionEliminator::visit(CompilationUnit& node) {
+    for (auto& func : node.functions) {
+        co_await func->accept(*this);
+    }
+}
+
+Walk CommonSubexpressionEliminator::visit(FunctionDefinition& node) {
+    available.clear();
+    pendingDecls.clear();
+    currentStatements = nullptr;
+    numberStatements(*node.body);
+    co_await node.body->accept(*this);
+}
+
+Walk CommonSubexpressionEliminator::visit(Block& node) {
+    // 子块继承外层的可用表达式，退出时恢复（块内声明的临时变量不再可见）
+    ExprTable outer = available;
+    auto* savedStatements = currentStatements;
+    size_t savedIndex = currentIndex;
+    int savedEnd = blockEnd;
+    auto savedPending = std::move(pendingDecls);
+    pendingDecls.clear();
+
+    currentStatements = &node.statements;
+    auto range = ranges.find(&node);
+    blockEnd = range == ranges.end() ? 0 : range->second.second;
+    for (size_t i = 0; i < node.statements.size(); ++i) {
+        currentIndex = i;
+        co_await node.statements[i]->accept(*this);
+
+        if (!pendingDecls.empty()) {
+            size_t count = pendingDecls.size();
+            node.statements.insert(node.statements.begin() + i,
+                                   std::make_move_iterator(pendingDecls.begin()),
+                                   std::make_move_iterator(pendingDecls.end()));
+            pendingDecls.clear();
+            i += count;
+        }
+    }
+
+    currentStatements = savedStatements;
+    currentIndex = savedIndex;
+    blockEnd = savedEnd;
+    pendingDecls = std::move(savedPending);
+    available = std::move(outer);
+    killWrittenIn(node);
+}
+
+Walk CommonSubexpressionEliminator::visit(ExpressionStatement& node) {
+    rewriteExpression(node.expression, true);
+    co_return;
+}
+
+Walk CommonSubexpressionEliminator::visit(AssignmentStatement& node) {
+    // 先求右值再写变量
+    rewriteExpression(node.value, true);
+    killVariable(node.variable);
+    co_return;
+}
+
+Walk CommonSubexpressionEliminator::visit(VariableDeclaration& node) {
+    rewriteExpression(node.initializer, true);
+    killVariable(node.name);
+    co_return;
+}
+
+Walk CommonSubexpressionEliminator::visit(ReturnStatement& node) {
+    rewriteExpression(node.value, true);
+    co_return;
+}
+
+Walk CommonSubexpressionEliminator::visit(IfStatement& node) {
+    rewriteExpression(node.condition, true);
+
+    // 分支只继承条件之前的可用表达式，分支内不向外提升
+    ExprTable before = available;
+    auto* savedStatements = currentStatements;
+    currentStatements = nullptr;
+
+    co_await node.thenStatement->accept(*this);
+    available = before;
+    if (node.elseStatement) {
+        co_await node.elseStatement->accept(*this);
+        available = std::move(before);
+    }
+
+    currentStatements = savedStatements;
+    killWrittenIn(node);
+}
+
+Walk CommonSubexpressionEliminator::visit(WhileStatement& node) {
+    // 回边：循环体中写过的变量在进入循环时即失效
+    killWrittenIn(node);
+
+    auto* savedStatements = currentStatements;
+    currentStatements = nullptr;
+    rewriteExpression(node.condition, false);
+
+    ExprTable before = available;
+    co_await node.body->accept(*this);
+    available = std::move(before);
+
+    currentStatements = savedStatements;
+}
+
+Walk CommonSubexpressionEliminator::visit(BinaryExpression&) { co_return; }
+Walk CommonSubexpressionEliminator::visit(UnaryExpression&) { co_return; }
+Walk CommonSubexpressionEliminator::visit(NumberLiteral&) { co_return; }
+Walk CommonSubexpressionEliminator::visit(Identifier&) { co_return; }
+Walk CommonSubexpressionEliminator::visit(FunctionCall&) { co_return; }
+Walk CommonSubexpressionEliminator::visit(BreakStatement&) { co_return; }
+Walk CommonSubexpressionEliminator::visit(ContinueStatement&) { co_return; }
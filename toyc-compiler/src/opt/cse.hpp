@@ -0,0 +1,114 @@
+#pragma once
+#include "ast/ast.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+// 基于值编号的局部公共子表达式消除（AST级别）
+// 在语句块内按支配关系维护可用表达式表：
+//   - 第一次出现且后续会重复使用的表达式被提升为临时变量 .cseN
+//   - 后续出现直接替换为对临时变量的引用
+//   - AssignmentStatement / VariableDeclaration 写入操作数时使相关表达式失效
+// 结构相同的表达式（可交换运算忽略操作数顺序）有相同的整数值编号，
+// 编号自底向上计算一次；进入函数时预先按先序给语句编号并记录各编号出现的位置，
+// 判断"后面还会不会用到"和"子树里写了哪些变量"都不必重新扫描语句，整个过程与表达式规模成线性
+class CommonSubexpressionEliminator : public Visitor {
+private:
+    // 可用表达式：值编号 -> 临时变量名
+    struct AvailableExpr {
+        std::string temp;
+        std::unordered_set<std::string> operands;
+    };
+    using ExprTable = std::unordered_map<int, AvailableExpr>;
+    using CountMap = std::unordered_map<int, int>;
+
+    // 值编号表：节点形状（种类、运算符、子节点编号）-> 编号，0 表示不参与CSE（含函数调用）
+    struct Shape {
+        int kind;
+        int op;
+        int a;
+        int b;
+        bool operator==(const Shape& other) const {
+            return kind == other.kind && op == other.op && a == other.a && b == other.b;
+        }
+    };
+    struct ShapeHash {
+        size_t operator()(const Shape& s) const;
+    };
+    std::unordered_map<Shape, int, ShapeHash> shapes;
+    std::unordered_map<std::string, int> names;
+    std::unordered_map<const Expression*, int> numbers;
+
+    // 语句的先序编号区间 [first, second)，各变量被写的语句编号和各值编号出现的语句编号（均升序）
+    std::unordered_map<const Statement*, std::pair<int, int>> ranges;
+    std::unordered_map<std::string, std::vector<int>> writePositions;
+    std::unordered_map<int, std::vector<int>> occurrences;
+
+    ExprTable available;
+    int tempCounter;
+    int eliminated;
+
+    // 当前语句之前需要插入的临时变量声明
+    std::vector<std::unique_ptr<Statement>> pendingDecls;
+    // 当前语句块中尚未处理的后续语句（用于统计重复次数）
+    std::vector<std::unique_ptr<Statement>>* currentStatements;
+    size_t currentIndex;
+    int blockEnd;               // 当前语句块先序编号区间的终点
+    // 正在改写的表达式中各值编号的出现次数，子树被替换或提升时扣除
+    CountMap currentCounts;
+
+    // 向后统计出现次数时的查询
+    struct Scan {
+        int id;
+        const std::unordered_set<std::string>* operands;
+        const Statement* current;
+    };
+
+public:
+    CommonSubexpressionEliminator()
+        : tempCounter(0), eliminated(0), currentStatements(nullptr), currentIndex(0), blockEnd(0) {}
+
+    void run(CompilationUnit& unit);
+    // 跳过skip[i]为真的函数（增量编译中复用的函数）
+    void run(CompilationUnit& unit, const std::vector<bool>& skip);
+    int getEliminatedCount() const { return eliminated; }
+    int getTempCount() const { return tempCounter; }
+
+    // Visitor接口实现
+    Walk visit(BinaryExpression& node) override;
+    Walk visit(UnaryExpression& node) override;
+    Walk visit(NumberLiteral& node) override;
+    Walk visit(Identifier& node) override;
+    Walk visit(FunctionCall& node) override;
+    Walk visit(AssignmentStatement& node) override;
+    Walk visit(VariableDeclaration& node) override;
+    Walk visit(Block& node) override;
+    Walk visit(IfStatement& node) override;
+    Walk visit(WhileStatement& node) override;
+    Walk visit(BreakStatement& node) override;
+    Walk visit(ContinueStatement& node) override;
+    Walk visit(ReturnStatement& node) override;
+    Walk visit(ExpressionStatement& node) override;
+    Walk visit(FunctionDefinition& node) override;
+    Walk visit(CompilationUnit& node) override;
+
+private:
+    void numberStatements(Block& body);
+    int valueNumber(const Expression& expr);
+    int intern(const Shape& shape);
+
+    void rewriteExpression(std::unique_ptr<Expression>& expr, bool allowHoist);
+    bool shouldHoist(int id, const Expression& expr, std::unordered_set<std::string>& operands);
+    void killVariable(const std::string& name);
+    void killWrittenIn(const Statement& stmt);
+
+    // 从当前语句开始向后扫描直线代码，遇到写操作数或控制流即停止
+    Walk countInStatements(const std::vector<std::unique_ptr<Statement>>& stmts, size_t start,
+                           const Scan& scan, int& count, bool& passed);
+    Walk countInStatement(const Statement& stmt, const Scan& scan, int& count, bool& passed);
+    int countAt(const Statement& stmt, const Scan& scan) const;
+    void addCounts(const Expression& expr, CountMap& counts, int delta);
+    static void collectOperands(const Expression& expr, std::unordered_set<std::string>& operands);
+    static bool isCandidate(const Expression& expr);
+};
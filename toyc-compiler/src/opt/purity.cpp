@@ -0,0 +1,67 @@
+#include "opt/purity.hpp"
+
+void PurityAnalyzer::analyze(CompilationUnit& unit) {
+    callGraph.clear();
+    pureFunctions.clear();
+
+    // 构建调用图；函数体中出现非局部访问的直接判为非纯
+    for (const auto& func : unit.functions) {
+        std::unordered_set<std::string> callees;
+        if (bodyIsLocal(*func->body, callees)) {
+            pureFunctions.insert(func->name);
+        }
+        callGraph[func->name] = std::move(callees);
+    }
+
+    // 调用非纯函数或未定义函数的函数也是非纯的，迭代到不动点
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto it = pureFunctions.begin(); it != pureFunctions.end(); ) {
+            bool pure = true;
+            for (const auto& callee : callGraph[*it]) {
+                if (!pureFunctions.count(callee)) {
+                    pure = false;
+                    break;
+                }
+            }
+            if (pure) {
+                ++it;
+            } else {
+                it = pureFunctions.erase(it);
+                changed = true;
+            }
+        }
+    }
+}
+
+const std::unordered_set<std::string>& PurityAnalyzer::getCallees(const std::string& function) const {
+    static const std::unordered_set<std::string> empty;
+    auto it = callGraph.find(function);
+    return it == callGraph.end() ? empty : it->second;
+}
+
+bool PurityAnalyzer::bodyIsLocal(Statement& body, std::unordered_set<std::string>& callees) {
+    // 显式栈遍历整个函数体，同时收集被调用的函数。
+    // ToyC没有全局变量，赋值目标必然是局部变量或参数，已知的语句和表达式都只访问局部状态
+    bool local = true;
+    walkTree(body, [&](ASTNode& node) {
+        if (auto call = dynamic_cast<const FunctionCall*>(&node)) {
+            callees.insert(call->functionName);
+        } else if (!isLocalNode(node)) {
+            local = false;
+        }
+        return true;
+    });
+    return local;
+}
+
+bool PurityAnalyzer::isLocalNode(const ASTNode& node) {
+    return dynamic_cast<const NumberLiteral*>(&node) || dynamic_cast<const Identifier*>(&node) ||
+           dynamic_cast<const BinaryExpression*>(&node) || dynamic_cast<const UnaryExpression*>(&node) ||
+           dynamic_cast<const Block*>(&node) || dynamic_cast<const VariableDeclaration*>(&node) ||
+           dynamic_cast<const AssignmentStatement*>(&node) || dynamic_cast<const IfStatement*>(&node) ||
+           dynamic_cast<const WhileStatement*>(&node) || dynamic_cast<const ReturnStatement*>(&node) ||
+           dynamic_cast<const ExpressionStatement*>(&node) || dynamic_cast<const BreakStatement*>(&node) ||
+           dynamic_cast<const ContinueStatement*>(&node);
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "ast/ast.hpp"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// 调用图上的纯函数分析
+// 纯函数：没有副作用，只读写自己的局部变量和参数，且只调用纯函数
+// 递归按乐观假设处理（先假定全部为纯，再迭代剔除到不动点）
+class PurityAnalyzer {
+private:
+    std::unordered_map<std::string, std::unordered_set<std::string>> callGraph;
+    std::unordered_set<std::string> pureFunctions;
+
+public:
+    void analyze(CompilationUnit& unit);
+
+    bool isPure(const std::string& function) const { return pureFunctions.count(function) > 0; }
+    size_t getPureCount() const { return pureFunctions.size(); }
+    const std::unordered_set<std::string>& getCallees(const std::string& function) const;
+
+private:
+    static bool bodyIsLocal(Statement& body, std::unordered_set<std::string>& callees);
+    // 只访问局部变量和参数的节点（调用另行记入调用图）；未知节点保守处理
+    static bool isLocalNode(const ASTNode& node);
+};
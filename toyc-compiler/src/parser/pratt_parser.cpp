@@ -0,0 +1,420 @@
+#include "parser/pratt_parser.hpp"
+#include "lexer/fast_lexer.hpp"
+#include "parser.hpp"
+#include <algorithm>
+
+namespace {
+
+// 二元运算符的优先级，与 parser.y 的 LOrExpr/LAndExpr/RelExpr/AddExpr/MulExpr 层次对应；
+// 非二元运算符返回0
+int binaryPrecedence(int kind) {
+    switch (kind) {
+        case OR: return 1;
+        case AND: return 2;
+        case LT: case LE: case GT: case GE: case EQ: case NE: return 3;
+        case PLUS: case MINUS: return 4;
+        case MULTIPLY: case DIVIDE: case MOD: return 5;
+        default: return 0;
+    }
+}
+
+// 含子语句的语句：语句块、if、while
+bool isCompound(int kind) {
+    return kind == LBRACE || kind == IF || kind == WHILE;
+}
+
+BinaryExpression::Operator binaryOperator(int kind) {
+    switch (kind) {
+        case OR: return BinaryExpression::OR;
+        case AND: return BinaryExpression::AND;
+        case LT: return BinaryExpression::LT;
+        case LE: return BinaryExpression::LE;
+        case GT: return BinaryExpression::GT;
+        case GE: return BinaryExpression::GE;
+        case EQ: return BinaryExpression::EQ;
+        case NE: return BinaryExpression::NE;
+        case PLUS: return BinaryExpression::ADD;
+        case MINUS: return BinaryExpression::SUB;
+        case MULTIPLY: return BinaryExpression::MUL;
+        case DIVIDE: return BinaryExpression::DIV;
+        default: return BinaryExpression::MOD;
+    }
+}
+
+} // namespace
+
+PrattParser::PrattParser(const TokenBuffer& tokens)
+    : tokens(tokens), position(0), nextValue(0), reported(0), failed(false) {}
+
+uint32_t PrattParser::here() const {
+    return tokens.offset(std::min(position, tokens.size() - 1));
+}
+
+int PrattParser::peek(size_t ahead) const {
+    size_t i = position + ahead;
+    if (i >= tokens.size()) return 0;
+    int kind = tokens.kind(i);
+    // '\0' 是未知字符，但和 Flex 一样同时表示输入结束
+    if (kind == TokenBuffer::UNKNOWN && tokens.source()[tokens.offset(i)] == '\0') return 0;
+    return kind;
+}
+
+// Bison 取到未知字符作为向前看符号时才输出提示，这里在游标到达时输出
+void PrattParser::reportUnknown() {
+    if (position < reported || position >= tokens.size()) return;
+    reported = position + 1;
+    if (tokens.kind(position) == TokenBuffer::UNKNOWN) {
+        FastLexer::reportUnknown(tokens.source()[tokens.offset(position)], static_cast<int>(tokens.line(position)));
+    }
+}
+
+void PrattParser::advance() {
+    if (peek() == NUMBER) nextValue++;
+    position++;
+    reportUnknown();
+}
+
+bool PrattParser::fail() {
+    if (!failed) {
+        failed = true;
+        size_t i = std::min(position, tokens.size() - 1);
+        error = "Parse error at line " + std::to_string(tokens.line(i)) + ": syntax error";
+    }
+    return false;
+}
+
+bool PrattParser::expect(int kind) {
+    if (failed) return false;
+    if (peek() != kind) return fail();
+    advance();
+    return true;
+}
+
+std::string PrattParser::identifier() const {
+    return tokens.tokenText(position);
+}
+
+bool PrattParser::parse(std::unique_ptr<CompilationUnit>& unit) {
+    position = 0;
+    nextValue = 0;
+    reported = 0;
+    failed = false;
+    error.clear();
+    reportUnknown();
+
+    // CompUnit: FuncDef+
+    auto result = std::make_unique<CompilationUnit>();
+    do {
+        auto function = parseFunction();
+        if (!function) return false;
+        result->addFunction(std::move(function));
+    } while (peek() != 0);
+
+    unit = std::move(result);
+    return true;
+}
+
+// FuncDef: Type IDENTIFIER '(' [INT IDENTIFIER {',' INT IDENTIFIER}] ')' Block
+std::unique_ptr<FunctionDefinition> PrattParser::parseFunction() {
+    Expression::Type returnType;
+    if (peek() == INT) {
+        returnType = Expression::INT;
+    } else if (peek() == VOID) {
+        returnType = Expression::VOID;
+    } else {
+        fail();
+        return nullptr;
+    }
+    advance();
+
+    if (peek() != IDENTIFIER) {
+        fail();
+        return nullptr;
+    }
+    uint32_t nameOffset = here();
+    std::string name = identifier();
+    advance();
+    if (!expect(LPAREN)) return nullptr;
+
+    std::vector<Parameter> parameters;
+    if (peek() != RPAREN) {
+        while (true) {
+            if (!expect(INT)) return nullptr;
+            if (peek() != IDENTIFIER) {
+                fail();
+                return nullptr;
+            }
+            parameters.emplace_back(identifier(), Expression::INT);
+            advance();
+            if (peek() != COMMA) break;
+            advance();
+        }
+    }
+    if (!expect(RPAREN)) return nullptr;
+
+    std::unique_ptr<Block> body;
+    Walk::run(parseBlock(body));
+    if (!body) return nullptr;
+    auto function = std::make_unique<FunctionDefinition>(name, returnType, std::move(parameters), std::move(body));
+    function->offset = nameOffset;
+    return function;
+}
+
+// Block: '{' Stmt* '}'
+Walk PrattParser::parseBlock(std::unique_ptr<Block>& out) {
+    uint32_t start = here();
+    if (!expect(LBRACE)) co_return;
+    auto block = std::make_unique<Block>();
+    block->offset = start;
+    while (peek() != RBRACE) {
+        std::unique_ptr<Statement> statement;
+        if (isCompound(peek())) {
+            co_await parseStatement(statement);
+        } else {
+            statement = parseSimpleStatement();
+        }
+        if (!statement) co_return;
+        block->addStatement(std::move(statement));
+    }
+    advance();
+    out = std::move(block);
+}
+
+// 语句的位置是它的第一个词法单元
+Walk PrattParser::parseStatement(std::unique_ptr<Statement>& out) {
+    uint32_t start = here();
+    switch (peek()) {
+        case LBRACE: {
+            std::unique_ptr<Block> block;
+            co_await parseBlock(block);
+            out = std::move(block);
+            break;
+        }
+        case IF: {
+            advance();
+            if (!expect(LPAREN)) co_return;
+            auto condition = parseExpression();
+            if (!condition || !expect(RPAREN)) co_return;
+            std::unique_ptr<Statement> thenStatement;
+            co_await parseStatement(thenStatement);
+            if (!thenStatement) co_return;
+            // 悬空的 else 归最近的 if，与 Bison 默认的移进一致
+            std::unique_ptr<Statement> elseStatement;
+            if (peek() == ELSE) {
+                advance();
+                co_await parseStatement(elseStatement);
+                if (!elseStatement) co_return;
+            }
+            out = std::make_unique<IfStatement>(std::move(condition), std::move(thenStatement),
+                                                std::move(elseStatement));
+            break;
+        }
+        case WHILE: {
+            advance();
+            if (!expect(LPAREN)) co_return;
+            auto condition = parseExpression();
+            if (!condition || !expect(RPAREN)) co_return;
+            std::unique_ptr<Statement> body;
+            co_await parseStatement(body);
+            if (!body) co_return;
+            out = std::make_unique<WhileStatement>(std::move(condition), std::move(body));
+            break;
+        }
+        default:
+            out = parseSimpleStatement();
+            co_return;
+    }
+    if (out) out->offset = start;
+}
+
+// 不含子语句的语句直接分析，不需要协程帧
+std::unique_ptr<Statement> PrattParser::parseSimpleStatement() {
+    uint32_t start = here();
+    auto statement = parseSimpleStatementBody();
+    if (statement) statement->offset = start;
+    return statement;
+}
+
+std::unique_ptr<Statement> PrattParser::parseSimpleStatementBody() {
+    switch (peek()) {
+        case SEMICOLON:
+            advance();
+            return std::make_unique<Block>();
+        case INT: {
+            // 声明必须带初始化：INT IDENTIFIER '=' Expr ';'
+            advance();
+            if (peek() != IDENTIFIER) {
+                fail();
+                return nullptr;
+            }
+            std::string name = identifier();
+            advance();
+            if (!expect(ASSIGN)) return nullptr;
+            auto initializer = parseExpression();
+            if (!initializer || !expect(SEMICOLON)) return nullptr;
+            return std::make_unique<VariableDeclaration>(name, std::move(initializer));
+        }
+        case BREAK:
+            advance();
+            if (!expect(SEMICOLON)) return nullptr;
+            return std::make_unique<BreakStatement>();
+        case CONTINUE:
+            advance();
+            if (!expect(SEMICOLON)) return nullptr;
+            return std::make_unique<ContinueStatement>();
+        case RETURN: {
+            advance();
+            if (peek() == SEMICOLON) {
+                advance();
+                return std::make_unique<ReturnStatement>();
+            }
+            auto value = parseExpression();
+            if (!value || !expect(SEMICOLON)) return nullptr;
+            return std::make_unique<ReturnStatement>(std::move(value));
+        }
+        case IDENTIFIER:
+            // IDENTIFIER '=' 是赋值语句，否则是以标识符开头的表达式语句
+            if (peek(1) == ASSIGN) {
+                std::string name = identifier();
+                advance();
+                advance();
+                auto value = parseExpression();
+                if (!value || !expect(SEMICOLON)) return nullptr;
+                return std::make_unique<AssignmentStatement>(name, std::move(value));
+            }
+            break;
+        default:
+            break;
+    }
+
+    auto expression = parseExpression();
+    if (!expression || !expect(SEMICOLON)) return nullptr;
+    return std::make_unique<ExpressionStatement>(std::move(expression));
+}
+
+// Expr：Pratt 的显式栈形式。运算符栈上除了待归约的二元运算，还有前缀运算、左括号和
+// 函数调用的标记，括号和实参可以任意深地嵌套而不占用调用栈。
+// 二元运算全部左结合：新运算符先归约栈顶优先级不低于它的运算，与按优先级爬升得到相同的树；
+// 前缀运算只作用于紧随其后的基本表达式（含括号和调用），操作数一完成就归约。
+std::unique_ptr<Expression> PrattParser::parseExpression() {
+    // 两个栈是成员，各表达式之间复用已分配的空间
+    pending.clear();
+    operands.clear();
+
+    auto reduceBinary = [&](int minPrecedence) {
+        while (!pending.empty() && pending.back().kind == Pending::BINARY &&
+               pending.back().precedence >= minPrecedence) {
+            auto right = std::move(operands.back());
+            operands.pop_back();
+            auto left = std::move(operands.back());
+            operands.pop_back();
+            // 二元表达式的位置是运算符
+            auto binary = std::make_unique<BinaryExpression>(std::move(left), binaryOperator(pending.back().op),
+                                                             std::move(right));
+            binary->offset = pending.back().offset;
+            operands.push_back(std::move(binary));
+            pending.pop_back();
+        }
+    };
+    auto reducePrefixes = [&]() {
+        while (!pending.empty() && pending.back().kind == Pending::PREFIX) {
+            auto unary = std::make_unique<UnaryExpression>(
+                static_cast<UnaryExpression::Operator>(pending.back().op), std::move(operands.back()));
+            unary->offset = pending.back().offset;
+            operands.back() = std::move(unary);
+            pending.pop_back();
+        }
+    };
+
+    while (true) {
+        // UnaryExpr: {'+' | '-' | '!'} PrimaryExpr
+        while (true) {
+            int kind = peek();
+            int op;
+            if (kind == PLUS) {
+                op = UnaryExpression::PLUS;
+            } else if (kind == MINUS) {
+                op = UnaryExpression::MINUS;
+            } else if (kind == NOT) {
+                op = UnaryExpression::NOT;
+            } else {
+                break;
+            }
+            pending.push_back({Pending::PREFIX, op, 0, here(), 0, {}});
+            advance();
+        }
+
+        // PrimaryExpr: IDENTIFIER | IDENTIFIER '(' [Expr {',' Expr}] ')' | NUMBER | '(' Expr ')'
+        uint32_t start = here();
+        int kind = peek();
+        if (kind == NUMBER) {
+            int value = tokens.literal(nextValue);
+            advance();
+            operands.push_back(std::make_unique<NumberLiteral>(value));
+            operands.back()->offset = start;
+        } else if (kind == IDENTIFIER) {
+            std::string name = identifier();
+            advance();
+            if (peek() != LPAREN) {
+                operands.push_back(std::make_unique<Identifier>(name));
+                operands.back()->offset = start;
+            } else {
+                advance();
+                if (peek() != RPAREN) {
+                    pending.push_back({Pending::CALL, 0, 0, start, operands.size(), std::move(name)});
+                    continue;
+                }
+                advance();
+                operands.push_back(std::make_unique<FunctionCall>(
+                    name, std::vector<std::unique_ptr<Expression>>(), Expression::INT));
+                operands.back()->offset = start;
+            }
+        } else if (kind == LPAREN) {
+            advance();
+            pending.push_back({Pending::PAREN, 0, 0, start, 0, {}});
+            continue;
+        } else {
+            fail();
+            return nullptr;
+        }
+
+        // 操作数之后：二元运算符入栈后接着读操作数；')' 和 ',' 结束最近的括号或调用；
+        // 其他词法单元在没有未闭合的括号和调用时结束整个表达式
+        while (true) {
+            reducePrefixes();
+            kind = peek();
+            int precedence = binaryPrecedence(kind);
+            if (precedence != 0) {
+                reduceBinary(precedence);
+                pending.push_back({Pending::BINARY, kind, precedence, here(), 0, {}});
+                advance();
+                break;
+            }
+            reduceBinary(1);
+            if (pending.empty()) {
+                auto result = std::move(operands.back());
+                operands.pop_back();
+                return result;
+            }
+            Pending& open = pending.back();
+            if (kind == RPAREN && open.kind == Pending::PAREN) {
+                advance();
+                pending.pop_back();
+            } else if (kind == RPAREN && open.kind == Pending::CALL) {
+                advance();
+                std::vector<std::unique_ptr<Expression>> arguments(
+                    std::make_move_iterator(operands.begin() + open.base), std::make_move_iterator(operands.end()));
+                operands.resize(open.base);
+                operands.push_back(std::make_unique<FunctionCall>(open.name, std::move(arguments), Expression::INT));
+                operands.back()->offset = open.offset;
+                pending.pop_back();
+            } else if (kind == COMMA && open.kind == Pending::CALL) {
+                advance();
+                break;
+            } else {
+                fail();
+                return nullptr;
+            }
+        }
+    }
+}
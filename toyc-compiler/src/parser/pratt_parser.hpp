@@ -0,0 +1,62 @@
+#pragma once
+#include "ast/ast.hpp"
+#include "lexer/token_buffer.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+// 手写的语法分析器：语句用递归下降，表达式用 Pratt（按优先级爬升）。
+// 复合语句的各函数是 Walk 协程，结果通过 out 参数返回（失败时为空）；表达式用显式栈，
+// 语句块和括号的嵌套深度都只受堆内存限制。
+// 直接从 TokenBuffer 读词法单元并构造与 parser.y 完全相同的 AST，
+// 不经过 LALR 表，也没有参数表、实参表、语句块这些中间堆对象。
+// 出错位置与 Bison 相同：第一个无法继续的词法单元所在的行。
+// 节点的 offset 记录对应词法单元在源码中的偏移，供语义错误定位。
+class PrattParser {
+private:
+    const TokenBuffer& tokens;
+    size_t position;
+    size_t nextValue;       // 下一个 NUMBER 在 TokenBuffer 字面量数组中的下标
+    size_t reported;        // 已输出提示的未知字符之后的位置
+    bool failed;
+    std::string error;
+
+    // 表达式分析的运算符栈：待归约的二元运算、前缀运算，以及未闭合的括号和调用
+    struct Pending {
+        enum Kind { BINARY, PREFIX, PAREN, CALL } kind;
+        int op;                 // BINARY：运算符的词法单元；PREFIX：UnaryExpression::Operator
+        int precedence;
+        uint32_t offset;
+        size_t base;            // CALL：第一个实参在 operands 中的下标
+        std::string name;       // CALL：函数名
+    };
+    std::vector<Pending> pending;
+    std::vector<std::unique_ptr<Expression>> operands;
+
+public:
+    explicit PrattParser(const TokenBuffer& tokens);
+
+    // 分析整个编译单元，失败时返回 false，错误信息与 yyerror 的格式相同
+    bool parse(std::unique_ptr<CompilationUnit>& unit);
+    const std::string& getError() const { return error; }
+
+private:
+    // 词法单元游标
+    int peek(size_t ahead = 0) const;
+    uint32_t here() const;      // 当前词法单元的源码偏移
+    void advance();
+    void reportUnknown();
+    bool expect(int kind);
+    bool fail();
+    std::string identifier() const;
+
+    // 递归下降
+    std::unique_ptr<FunctionDefinition> parseFunction();
+    Walk parseBlock(std::unique_ptr<Block>& out);
+    Walk parseStatement(std::unique_ptr<Statement>& out);
+    std::unique_ptr<Statement> parseSimpleStatement();
+    std::unique_ptr<Statement> parseSimpleStatementBody();
+
+    // Pratt 表达式
+    std::unique_ptr<Expression> parseExpression();
+};
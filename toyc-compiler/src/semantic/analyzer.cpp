@@ -0,0 +1,243 @@
+#include "semantic/analyzer.hpp"
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
+bool SemanticAnalyzer::analyze(CompilationUnit& unit) {
+    return analyze(unit, std::vector<bool>(unit.functions.size(), false));
+}
+
+bool SemanticAnalyzer::analyze(CompilationUnit& unit, const std::vector<bool>& skip) {
+    errors.clear();
+    errorOffsets.clear();
+    
+    // 收集所有函数声明
+    for (auto& func : unit.functions) {
+        std::vector<Expression::Type> paramTypes;
+        for (const auto& param : func->parameters) {
+            paramTypes.push_back(param.type);
+        }
+        
+        if (functions.find(func->name) != functions.end()) {
+            addError("Function '" + func->name + "' is already declared", func->offset);
+            continue;
+        }
+        
+        functions.insert_or_assign(func->name, FunctionInfo(func->name, func->returnType, paramTypes, true));
+    }
+    
+    // 检查main函数
+    if (!checkMainFunction()) {
+        addError("Missing main function with signature: int main()");
+    }
+    
+    // 分析函数体
+    std::vector<size_t> bodies;
+    for (size_t i = 0; i < unit.functions.size(); ++i) {
+        if (i >= skip.size() || !skip[i]) bodies.push_back(i);
+    }
+    
+    WorkStealingPool pool(std::min<size_t>(threads, bodies.size()));
+    std::vector<std::unique_ptr<SemanticAnalyzer>> workers;
+    for (int t = 0; t < pool.size(); ++t) {
+        workers.push_back(std::make_unique<SemanticAnalyzer>());
+        workers.back()->signatures = &functions;
+    }
+    
+    std::vector<std::vector<std::string>> bodyErrors(bodies.size());
+    std::vector<std::vector<uint32_t>> bodyOffsets(bodies.size());
+    pool.run(bodies.size(), [&](size_t k, int t) {
+        SemanticAnalyzer& worker = *workers[t];
+        worker.errors.clear();
+        worker.errorOffsets.clear();
+        Walk::run(unit.functions[bodies[k]]->accept(worker));
+        bodyErrors[k] = std::move(worker.errors);
+        bodyOffsets[k] = std::move(worker.errorOffsets);
+    });
+    
+    for (size_t k = 0; k < bodyErrors.size(); ++k) {
+        for (size_t i = 0; i < bodyErrors[k].size(); ++i) {
+            errors.push_back(std::move(bodyErrors[k][i]));
+            errorOffsets.push_back(bodyOffsets[k][i]);
+        }
+    }
+    
+    return errors.empty();
+}
+
+void SemanticAnalyzer::addError(const std::string& message, uint32_t offset) {
+    errors.push_back(message);
+    errorOffsets.push_back(offset);
+}
+
+bool SemanticAnalyzer::checkMainFunction() {
+    auto it = functions.find("main");
+    if (it == functions.end()) {
+        return false;
+    }
+    
+    const FunctionInfo& mainFunc = it->second;
+    return mainFunc.returnType == Expression::INT && mainFunc.paramTypes.empty();
+}
+
+// Visitor实现
+Walk SemanticAnalyzer::visit(CompilationUnit& node) {
+    for (auto& func : node.functions) {
+        co_await func->accept(*this);
+    }
+}
+
+Walk SemanticAnalyzer::visit(FunctionDefinition& node) {
+    currentFunction = node.name;
+    hasReturn = false;
+    
+    scope.enterScope();
+    scope.resetOffset();
+    
+    // 添加参数到符号表
+    for (const auto& param : node.parameters) {
+        if (!scope.declareVariable(param.name, param.type, true)) {
+            addError("Parameter '" + param.name + "' is already declared", node.offset);
+        }
+    }
+    
+    // 分析函数体
+    co_await node.body->accept(*this);
+    
+    // 检查返回值
+    if (node.returnType == Expression::INT && !hasReturn) {
+        addError("Function '" + node.name + "' must return a value", node.offset);
+    }
+    
+    scope.exitScope();
+}
+
+Walk SemanticAnalyzer::visit(Block& node) {
+    scope.enterScope();
+    for (auto& stmt : node.statements) {
+        co_await stmt->accept(*this);
+    }
+    scope.exitScope();
+}
+
+Walk SemanticAnalyzer::visit(VariableDeclaration& node) {
+    if (!scope.declareVariable(node.name, Expression::INT)) {
+        addError("Variable '" + node.name + "' is already declared in this scope", node.offset);
+        co_return;
+    }
+    
+    if (node.initializer) {
+        co_await node.initializer->accept(*this);
+    }
+}
+
+Walk SemanticAnalyzer::visit(AssignmentStatement& node) {
+    Symbol* symbol = scope.lookupVariable(node.variable);
+    if (!symbol) {
+        addError("Undefined variable '" + node.variable + "'", node.offset);
+        co_return;
+    }
+    
+    co_await node.value->accept(*this);
+}
+
+Walk SemanticAnalyzer::visit(Identifier& node) {
+    Symbol* symbol = scope.lookupVariable(node.name);
+    if (!symbol) {
+        addError("Undefined variable '" + node.name + "'", node.offset);
+    }
+    co_return;
+}
+
+Walk SemanticAnalyzer::visit(FunctionCall& node) {
+    auto it = signatures->find(node.functionName);
+    if (it == signatures->end()) {
+        addError("Undefined function '" + node.functionName + "'", node.offset);
+        co_return;
+    }
+    
+    const FunctionInfo& funcInfo = it->second;
+    
+    // 检查参数数量
+    if (node.arguments.size() != funcInfo.paramTypes.size()) {
+        addError("Function '" + node.functionName + "' expects " + 
+                std::to_string(funcInfo.paramTypes.size()) + " arguments, got " + 
+                std::to_string(node.arguments.size()), node.offset);
+        co_return;
+    }
+    
+    // 检查参数
+    for (auto& arg : node.arguments) {
+        co_await arg->accept(*this);
+    }
+    
+    // 设置返回类型
+    const_cast<FunctionCall&>(node).returnType = funcInfo.returnType;
+}
+
+Walk SemanticAnalyzer::visit(BinaryExpression& node) {
+    co_await node.left->accept(*this);
+    co_await node.right->accept(*this);
+}
+
+Walk SemanticAnalyzer::visit(UnaryExpression& node) {
+    co_await node.operand->accept(*this);
+}
+
+Walk SemanticAnalyzer::visit(NumberLiteral& node) {
+    // 数字字面量总是有效的
+    co_return;
+}
+
+Walk SemanticAnalyzer::visit(IfStatement& node) {
+    co_await node.condition->accept(*this);
+    co_await node.thenStatement->accept(*this);
+    if (node.elseStatement) {
+        co_await node.elseStatement->accept(*this);
+    }
+}
+
+Walk SemanticAnalyzer::visit(WhileStatement& node) {
+    co_await node.condition->accept(*this);
+    loopDepth++;
+    co_await node.body->accept(*this);
+    loopDepth--;
+}
+
+Walk SemanticAnalyzer::visit(BreakStatement& node) {
+    if (loopDepth == 0) {
+        addError("break statement not within a loop", node.offset);
+    }
+    co_return;
+}
+
+Walk SemanticAnalyzer::visit(ContinueStatement& node) {
+    if (loopDepth == 0) {
+        addError("continue statement not within a loop", node.offset);
+    }
+    co_return;
+}
+
+Walk SemanticAnalyzer::visit(ReturnStatement& node) {
+    hasReturn = true;
+    
+    auto it = signatures->find(currentFunction);
+    if (it != signatures->end()) {
+        const FunctionInfo& funcInfo = it->second;
+        
+        if (funcInfo.returnType == Expression::VOID && node.value) {
+            addError("void function should not return a value", node.offset);
+        } else if (funcInfo.returnType == Expression::INT && !node.value) {
+            addError("non-void function must return a value", node.offset);
+        }
+    }
+    
+    if (node.value) {
+        co_await node.value->accept(*this);
+    }
+}
+
+Walk SemanticAnalyzer::visit(ExpressionStatement& node) {
+    co_await node.expression->accept(*this);
+}
\ No newline at end of file
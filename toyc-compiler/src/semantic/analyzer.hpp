@@ -0,0 +1,135 @@
+#pragma once
+#include "ast/ast.hpp"
+#include <unordered_map>
+#include <vector>
+#include <string>
+
+// 符号表项
+struct Symbol {
+    std::string name;
+    Expression::Type type;
+    int offset;
+    bool isParameter;
+    
+    Symbol(const std::string& n, Expression::Type t, int off = 0, bool param = false)
+        : name(n), type(t), offset(off), isParameter(param) {}
+};
+
+// 函数信息
+struct FunctionInfo {
+    std::string name;
+    Expression::Type returnType;
+    std::vector<Expression::Type> paramTypes;
+    bool isDefined;
+    
+    FunctionInfo(const std::string& n, Expression::Type ret, 
+                const std::vector<Expression::Type>& params, bool def = false)
+        : name(n), returnType(ret), paramTypes(params), isDefined(def) {}
+};
+
+// 作用域管理
+// 每个名字一个绑定栈，栈顶是最内层的声明；查找与嵌套深度无关
+class Scope {
+private:
+    struct Binding {
+        size_t depth;
+        Symbol symbol;
+    };
+    std::unordered_map<std::string, std::vector<Binding>> bindings;
+    std::vector<std::vector<std::string>> declared;    // 各层作用域中声明的名字，退出时弹出绑定
+    int currentOffset;
+    
+public:
+    Scope() : currentOffset(0) {
+        enterScope(); // 全局作用域
+    }
+    
+    void enterScope() {
+        declared.emplace_back();
+    }
+    
+    void exitScope() {
+        if (declared.size() > 1) {
+            for (const auto& name : declared.back()) {
+                auto it = bindings.find(name);
+                it->second.pop_back();
+                if (it->second.empty()) bindings.erase(it);
+            }
+            declared.pop_back();
+        }
+    }
+    
+    bool declareVariable(const std::string& name, Expression::Type type, bool isParam = false) {
+        auto& stack = bindings[name];
+        if (!stack.empty() && stack.back().depth == declared.size()) {
+            return false; // 重复声明
+        }
+        
+        int offset = isParam ? currentOffset : (currentOffset - 4);
+        stack.push_back(Binding{declared.size(), Symbol(name, type, offset, isParam)});
+        declared.back().push_back(name);
+        if (!isParam) currentOffset -= 4;
+        return true;
+    }
+    
+    Symbol* lookupVariable(const std::string& name) {
+        auto it = bindings.find(name);
+        if (it == bindings.end()) return nullptr;
+        return &it->second.back().symbol;
+    }
+    
+    void resetOffset() { currentOffset = 0; }
+};
+
+// 简化的语义分析器
+class SemanticAnalyzer : public Visitor {
+private:
+    Scope scope;
+    std::unordered_map<std::string, FunctionInfo> functions;
+    // 函数体检查时查找签名用；并行检查的工作实例指向主分析器的函数表
+    const std::unordered_map<std::string, FunctionInfo>* signatures;
+    int threads;
+    std::vector<std::string> errors;
+    std::vector<uint32_t> errorOffsets;     // 与 errors 一一对应的源码偏移，未知为 ASTNode::NO_OFFSET
+    std::string currentFunction;
+    int loopDepth;
+    bool hasReturn;
+    
+public:
+    SemanticAnalyzer() : signatures(&functions), threads(1), loopDepth(0), hasReturn(false) {}
+    SemanticAnalyzer(const SemanticAnalyzer&) = delete;
+    SemanticAnalyzer& operator=(const SemanticAnalyzer&) = delete;
+    
+    // 函数体检查的线程数：签名收集完后各函数体只读共享函数表，可以并行检查，
+    // 每个线程有自己的作用域和错误缓冲，错误按函数的源码顺序合并
+    void setThreads(int count) { threads = count < 1 ? 1 : count; }
+    
+    bool analyze(CompilationUnit& unit);
+    // skip[i]为真的函数只登记签名、不检查函数体（增量编译中复用的函数）
+    bool analyze(CompilationUnit& unit, const std::vector<bool>& skip);
+    const std::unordered_map<std::string, FunctionInfo>& getFunctions() const { return functions; }
+    const std::vector<std::string>& getErrors() const { return errors; }
+    const std::vector<uint32_t>& getErrorOffsets() const { return errorOffsets; }
+    
+    // Visitor接口实现
+    Walk visit(BinaryExpression& node) override;
+    Walk visit(UnaryExpression& node) override;
+    Walk visit(NumberLiteral& node) override;
+    Walk visit(Identifier& node) override;
+    Walk visit(FunctionCall& node) override;
+    Walk visit(AssignmentStatement& node) override;
+    Walk visit(VariableDeclaration& node) override;
+    Walk visit(Block& node) override;
+    Walk visit(IfStatement& node) override;
+    Walk visit(WhileStatement& node) override;
+    Walk visit(BreakStatement& node) override;
+    Walk visit(ContinueStatement& node) override;
+    Walk visit(ReturnStatement& node) override;
+    Walk visit(ExpressionStatement& node) override;
+    Walk visit(FunctionDefinition& node) override;
+    Walk visit(CompilationUnit& node) override;
+    
+private:
+    void addError(const std::string& message, uint32_t offset = ASTNode::NO_OFFSET);
+    bool checkMainFunction();
+};
\ No newline at end of file
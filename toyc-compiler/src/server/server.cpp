@@ -0,0 +1,417 @@
+#include "server/server.hpp"
+#include "utils/utils.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <unordered_map>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+const char messageHeader[] = "toyc-server 1";
+// 单个字段的上限，防止畸形请求耗尽内存
+const size_t maxFieldSize = 256u << 20;
+
+volatile sig_atomic_t stopRequested = 0;
+
+void onStopSignal(int) {
+    stopRequested = 1;
+}
+
+// 带缓冲的套接字读写
+class Connection {
+private:
+    int fd;
+    std::string buffer;
+    size_t pos;
+
+public:
+    explicit Connection(int fd) : fd(fd), pos(0) {}
+
+    bool readLine(std::string& line) {
+        while (true) {
+            size_t end = buffer.find('\n', pos);
+            if (end != std::string::npos) {
+                line = buffer.substr(pos, end - pos);
+                pos = end + 1;
+                return true;
+            }
+            if (buffer.size() - pos > 4096 || !fill()) return false;
+        }
+    }
+
+    bool readBytes(size_t size, std::string& data) {
+        while (buffer.size() - pos < size) {
+            if (!fill()) return false;
+        }
+        data = buffer.substr(pos, size);
+        pos += size;
+        return true;
+    }
+
+    bool writeAll(const std::string& data) {
+        size_t done = 0;
+        while (done < data.size()) {
+            ssize_t n = write(fd, data.data() + done, data.size() - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            done += n;
+        }
+        return true;
+    }
+
+private:
+    bool fill() {
+        if (pos > 0) {
+            buffer.erase(0, pos);
+            pos = 0;
+        }
+        char chunk[65536];
+        while (true) {
+            ssize_t n = read(fd, chunk, sizeof(chunk));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            buffer.append(chunk, n);
+            return true;
+        }
+    }
+};
+
+typedef std::vector<std::pair<std::string, std::string>> FieldList;
+
+void addField(std::string& message, const std::string& name, const std::string& value) {
+    message += name + " " + std::to_string(value.size()) + "\n" + value;
+}
+
+bool readMessage(Connection& conn, FieldList& fields) {
+    std::string line;
+    if (!conn.readLine(line) || line != messageHeader) return false;
+    while (conn.readLine(line)) {
+        if (line == "end") return true;
+        size_t space = line.find(' ');
+        if (space == std::string::npos) return false;
+        size_t size = std::strtoull(line.c_str() + space + 1, nullptr, 10);
+        std::string value;
+        if (size > maxFieldSize || !conn.readBytes(size, value)) return false;
+        fields.emplace_back(line.substr(0, space), std::move(value));
+    }
+    return false;
+}
+
+std::string encodeRequest(const CompileRequest& request) {
+    std::string message = std::string(messageHeader) + "\n";
+    addField(message, "cwd", request.cwd);
+    for (const auto& arg : request.args) addField(message, "arg", arg);
+    for (const auto& env : request.env) addField(message, "env", env);
+    if (request.hasSource) addField(message, "source", request.source);
+    return message + "end\n";
+}
+
+bool decodeRequest(const FieldList& fields, CompileRequest& request) {
+    for (const auto& field : fields) {
+        if (field.first == "cwd") request.cwd = field.second;
+        else if (field.first == "arg") request.args.push_back(field.second);
+        else if (field.first == "env") request.env.push_back(field.second);
+        else if (field.first == "source") {
+            request.source = field.second;
+            request.hasSource = true;
+        }
+    }
+    return !request.cwd.empty();
+}
+
+std::string encodeResponse(const CompileResponse& response) {
+    std::string message = std::string(messageHeader) + "\n";
+    addField(message, "status", std::to_string(response.status));
+    addField(message, "latency-us", std::to_string(response.latencyMicros));
+    addField(message, "stdout", response.out);
+    addField(message, "stderr", response.err);
+    addField(message, "output", response.output);
+    return message + "end\n";
+}
+
+void decodeResponse(const FieldList& fields, CompileResponse& response) {
+    for (const auto& field : fields) {
+        if (field.first == "status") response.status = std::atoi(field.second.c_str());
+        else if (field.first == "latency-us") response.latencyMicros = std::atol(field.second.c_str());
+        else if (field.first == "stdout") response.out = field.second;
+        else if (field.first == "stderr") response.err = field.second;
+        else if (field.first == "output") response.output = field.second;
+    }
+}
+
+bool fillAddress(const std::string& path, struct sockaddr_un& addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+// 会被转发给服务端的环境变量（影响编译结果或缓存位置）
+const char* const forwardedEnv[] = {"TOYC_CACHE_DIR"};
+
+} // namespace
+
+// CompileServer实现
+CompileServer::CompileServer(const std::string& socketPath, int workers, CompileEntry entry)
+    : socketPath(socketPath), workerCount(std::max(1, workers)), entry(entry), listenFd(-1) {}
+
+bool CompileServer::listenSocket() {
+    struct sockaddr_un addr;
+    if (!fillAddress(socketPath, addr)) {
+        error = "Socket path is too long: " + socketPath;
+        return false;
+    }
+
+    // 残留的套接字文件：能连上说明已有服务在运行，否则删掉重建
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe >= 0 && connect(probe, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0) {
+        close(probe);
+        error = "A server is already listening on " + socketPath;
+        return false;
+    }
+    if (probe >= 0) close(probe);
+    unlink(socketPath.c_str());
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0 || bind(listenFd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listenFd, 128) != 0) {
+        error = "Cannot listen on " + socketPath + ": " + std::strerror(errno);
+        if (listenFd >= 0) close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    // 非阻塞：所有工作进程等待同一个套接字，没抢到连接的进程回到poll
+    fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+bool CompileServer::run() {
+    if (!listenSocket()) return false;
+
+    // 主进程只负责管理工作进程：屏蔽信号后用sigwait同步处理
+    sigset_t signals, original;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &signals, &original);
+
+    std::unordered_map<pid_t, int> workers;
+    auto spawn = [&](int id) {
+        std::cout.flush();
+        std::cerr.flush();
+        pid_t pid = fork();
+        if (pid == 0) {
+            struct sigaction action;
+            std::memset(&action, 0, sizeof(action));
+            action.sa_handler = onStopSignal;
+            sigaction(SIGINT, &action, nullptr);
+            sigaction(SIGTERM, &action, nullptr);
+            signal(SIGPIPE, SIG_IGN);  // 客户端提前断开时只丢弃这次应答
+            sigprocmask(SIG_SETMASK, &original, nullptr);
+            workerLoop(id);
+            std::cout.flush();
+            std::cerr.flush();
+            _exit(0);
+        }
+        if (pid > 0) workers[pid] = id;
+        return pid > 0;
+    };
+
+    for (int id = 0; id < workerCount; ++id) {
+        if (!spawn(id)) {
+            error = std::string("Cannot start worker: ") + std::strerror(errno);
+            break;
+        }
+    }
+    if (error.empty()) {
+        std::cerr << "ToyC server listening on " << socketPath << " (" << workerCount << " workers)" << std::endl;
+    }
+
+    bool stopping = !error.empty();
+    while (!stopping) {
+        int sig = 0;
+        if (sigwait(&signals, &sig) != 0) continue;
+        if (sig != SIGCHLD) {
+            stopping = true;
+            break;
+        }
+        // 意外退出的工作进程用同一个编号重新启动
+        pid_t pid;
+        int status;
+        while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+            auto it = workers.find(pid);
+            if (it == workers.end()) continue;
+            int id = it->second;
+            workers.erase(it);
+            std::cerr << "[worker " << id << "] exited unexpectedly, restarting" << std::endl;
+            spawn(id);
+        }
+    }
+
+    for (const auto& worker : workers) kill(worker.first, SIGTERM);
+    for (const auto& worker : workers) waitpid(worker.first, nullptr, 0);
+    close(listenFd);
+    unlink(socketPath.c_str());
+    sigprocmask(SIG_SETMASK, &original, nullptr);
+    return error.empty();
+}
+
+void CompileServer::workerLoop(int id) {
+    long requests = 0;
+    double totalMs = 0;
+    double worstMs = 0;
+
+    while (!stopRequested) {
+        struct pollfd pfd = {listenFd, POLLIN, 0};
+        if (poll(&pfd, 1, 500) <= 0) continue;
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) continue;
+
+        Connection conn(fd);
+        FieldList fields;
+        CompileRequest request;
+        if (readMessage(conn, fields) && decodeRequest(fields, request)) {
+            CompileResponse response = handle(request);
+            conn.writeAll(encodeResponse(response));
+
+            double ms = response.latencyMicros / 1000.0;
+            requests++;
+            totalMs += ms;
+            worstMs = std::max(worstMs, ms);
+
+            std::ostringstream line;
+            line << "[worker " << id << "] " << std::fixed << std::setprecision(3) << ms
+                 << " ms, status " << response.status << ":";
+            for (const auto& arg : request.args) line << " " << arg;
+            std::cerr << line.str() << std::endl;
+        }
+        close(fd);
+    }
+
+    std::ostringstream summary;
+    summary << "[worker " << id << "] " << requests << " requests";
+    if (requests > 0) {
+        summary << ", mean " << std::fixed << std::setprecision(3) << totalMs / requests
+                << " ms, max " << worstMs << " ms";
+    }
+    std::cerr << summary.str() << std::endl;
+}
+
+CompileResponse CompileServer::handle(const CompileRequest& request) {
+    Utils::Timer timer;
+    CompileResponse response;
+
+    if (chdir(request.cwd.c_str()) != 0) {
+        response.err = "Error: Cannot change to directory: " + request.cwd + "\n";
+        response.latencyMicros = static_cast<long>(timer.elapsedMilliseconds() * 1000);
+        return response;
+    }
+    for (const char* name : forwardedEnv) unsetenv(name);
+    for (const auto& env : request.env) {
+        size_t eq = env.find('=');
+        if (eq != std::string::npos) setenv(env.substr(0, eq).c_str(), env.c_str() + eq + 1, 1);
+    }
+
+    // 源码随请求发来时直接从内存编译，没有指定 -o 时编译输出也放进应答
+    std::vector<std::string> args = request.args;
+    CompileIO io;
+    io.source = &request.source;
+    io.output = &response.output;
+
+    std::vector<char*> argv;
+    std::string programName = "toyc";
+    argv.push_back(&programName[0]);
+    for (auto& arg : args) argv.push_back(&arg[0]);
+    argv.push_back(nullptr);
+
+    // 编译器把诊断和进度写到std::cout/std::cerr，在请求期间重定向到缓冲区
+    std::ostringstream out, err;
+    std::streambuf* oldOut = std::cout.rdbuf(out.rdbuf());
+    std::streambuf* oldErr = std::cerr.rdbuf(err.rdbuf());
+    response.status = entry(static_cast<int>(argv.size() - 1), argv.data(), request.hasSource ? &io : nullptr);
+    std::cout.rdbuf(oldOut);
+    std::cerr.rdbuf(oldErr);
+    std::cout.clear();
+    std::cerr.clear();
+    response.out = out.str();
+    response.err = err.str();
+
+    response.latencyMicros = static_cast<long>(timer.elapsedMilliseconds() * 1000);
+    return response;
+}
+
+// CompileClient实现
+bool CompileClient::send(const CompileRequest& request, CompileResponse& response) {
+    struct sockaddr_un addr;
+    if (!fillAddress(socketPath, addr)) {
+        error = "Socket path is too long: " + socketPath;
+        return false;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        error = "Cannot connect to compile server at " + socketPath + ": " + std::strerror(errno);
+        if (fd >= 0) close(fd);
+        return false;
+    }
+
+    Connection conn(fd);
+    FieldList fields;
+    bool ok = conn.writeAll(encodeRequest(request)) && readMessage(conn, fields);
+    close(fd);
+    if (!ok) {
+        error = "Malformed response from compile server";
+        return false;
+    }
+    decodeResponse(fields, response);
+    return true;
+}
+
+int runClient(const std::string& socketPath, const std::vector<std::string>& args) {
+    CompileRequest request;
+    char cwd[4096];
+    if (!getcwd(cwd, sizeof(cwd))) {
+        std::cerr << "Error: Cannot determine the current directory" << std::endl;
+        return 1;
+    }
+    request.cwd = cwd;
+    request.args = args;
+    for (const char* name : forwardedEnv) {
+        if (const char* value = std::getenv(name)) request.env.push_back(std::string(name) + "=" + value);
+    }
+    if (std::find(args.begin(), args.end(), "-") != args.end()) {
+        request.source.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+        request.hasSource = true;
+    }
+
+    CompileClient client(socketPath);
+    CompileResponse response;
+    if (!client.send(request, response)) {
+        std::cerr << "Error: " << client.getError() << std::endl;
+        return 1;
+    }
+
+    // 标准输入模式下标准输出留给编译结果，进度信息改走标准错误
+    (request.hasSource ? std::cerr : std::cout) << response.out;
+    std::cerr << response.err;
+    if (request.hasSource) std::cout.write(response.output.data(), response.output.size());
+    if (std::find(args.begin(), args.end(), "-v") != args.end()) {
+        std::cerr << "Server latency: " << response.latencyMicros / 1000.0 << " ms" << std::endl;
+    }
+    return response.status;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// 常驻编译服务：toyc --server <socket> 预先fork出一组工作进程，
+// 每个工作进程在同一个监听套接字上accept，复用已经热身的进程依次处理请求。
+// 解析器使用flex/bison的全局状态，用进程而不是线程做并发可以避免加锁。
+//
+// 请求和应答都是带长度的字段序列：
+//   toyc-server 1\n
+//   <字段名> <字节数>\n<内容>    （可重复）
+//   end\n
+// 请求字段：cwd、arg（每个命令行参数一个）、env（NAME=VALUE）、source（可选，源码内容）
+// 应答字段：status、latency-us、stdout、stderr、output（source请求的编译输出）
+
+struct CompileRequest {
+    std::string cwd;
+    std::vector<std::string> args;      // 不含程序名
+    std::vector<std::string> env;
+    std::string source;
+    bool hasSource = false;
+};
+
+struct CompileResponse {
+    int status = 1;
+    long latencyMicros = 0;
+    std::string out;
+    std::string err;
+    std::string output;
+};
+
+// 请求在内存中的输入输出：输入文件为 "-" 时源码取自 source，
+// 输出文件为 "-"（从标准输入编译时的默认值）时编译输出放进 output，都不经过文件系统
+struct CompileIO {
+    const std::string* source = nullptr;
+    std::string* output = nullptr;
+};
+
+// 编译入口：main 的参数，加上可选的内存输入输出
+typedef int (*CompileEntry)(int argc, char* argv[], const CompileIO* io);
+
+class CompileServer {
+private:
+    std::string socketPath;
+    int workerCount;
+    CompileEntry entry;
+    int listenFd;
+    std::string error;
+
+public:
+    CompileServer(const std::string& socketPath, int workers, CompileEntry entry);
+
+    // 阻塞运行，直到收到SIGINT或SIGTERM；退出前删除套接字文件
+    bool run();
+    const std::string& getError() const { return error; }
+
+private:
+    bool listenSocket();
+    void workerLoop(int id);
+    CompileResponse handle(const CompileRequest& request);
+};
+
+class CompileClient {
+private:
+    std::string socketPath;
+    std::string error;
+
+public:
+    explicit CompileClient(const std::string& socketPath) : socketPath(socketPath) {}
+
+    bool send(const CompileRequest& request, CompileResponse& response);
+    const std::string& getError() const { return error; }
+};
+
+// 客户端模式：把命令行转发给服务端，输出服务端的结果并返回其退出码。
+// 输入文件为 "-" 时从标准输入读源码，编译输出写到标准输出
+int runClient(const std::string& socketPath, const std::vector<std::string>& args);
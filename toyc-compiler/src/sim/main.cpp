@@ -0,0 +1,118 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdlib>
+#include "sim/rv32.hpp"
+#include "codegen/machine.hpp"
+#include "utils/utils.hpp"
+
+void printUsage(const char* programName) {
+    std::cout << "ToyC RV32IM Simulator v1.0\n"
+              << "Usage: " << programName << " [options] <input.s>\n\n"
+              << "Options:\n"
+              << "  -mtune=<cpu>            Pipeline cost model (name or .mtune file, default: generic)\n"
+              << "  --entry=<label>         Entry function (default: main)\n"
+              << "  --max-instructions=<n>  Stop after n instructions (default: unlimited)\n"
+              << "  --memory=<MiB>          Data/stack memory size (default: 16)\n"
+              << "  --help                  Show this help\n\n"
+              << "Examples:\n"
+              << "  " << programName << " factorial.s\n"
+              << "  " << programName << " -mtune=rocket factorial.s\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputFile;
+    std::string mtune = "generic";
+    std::string entry = "main";
+    uint64_t maxInstructions = 0;
+    uint32_t memoryMiB = 16;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg.compare(0, 7, "-mtune=") == 0) {
+            mtune = arg.substr(7);
+        } else if (arg.compare(0, 8, "--entry=") == 0) {
+            entry = arg.substr(8);
+        } else if (arg.compare(0, 19, "--max-instructions=") == 0) {
+            maxInstructions = std::strtoull(arg.c_str() + 19, nullptr, 10);
+        } else if (arg.compare(0, 9, "--memory=") == 0) {
+            memoryMiB = std::max(1, std::atoi(arg.c_str() + 9));
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg[0] != '-') {
+            if (inputFile.empty()) {
+                inputFile = arg;
+            } else {
+                std::cerr << "Error: Multiple input files specified" << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "Error: Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (inputFile.empty()) {
+        std::cerr << "Error: No input file specified" << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    MachineModel machine;
+    std::string machineError;
+    if (!MachineModel::load(mtune, machine, machineError)) {
+        std::cerr << "Error: " << machineError << std::endl;
+        return 1;
+    }
+
+    std::string assembly;
+    try {
+        assembly = Utils::readFile(inputFile);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    RV32Simulator sim(machine, memoryMiB << 20);
+    if (!sim.load(assembly)) {
+        std::cerr << "Error: " << inputFile << ": " << sim.getError() << std::endl;
+        return 1;
+    }
+
+    Utils::Timer timer;
+    bool ok = sim.run(entry, maxInstructions);
+    double elapsed = timer.elapsedSeconds();
+
+    if (!ok) {
+        std::cerr << "Error: " << sim.getError() << std::endl;
+    }
+
+    const SimCounters& c = sim.getCounters();
+    std::cout << "=== Simulation Results ===" << std::endl;
+    if (ok) {
+        std::cout << "Return value:        " << sim.getReturnValue() << std::endl;
+    }
+    std::cout << "Static instructions: " << sim.getStaticInstructions() << std::endl;
+    std::cout << "Instructions:        " << c.instructions << std::endl;
+    std::cout << "Loads:               " << c.loads << std::endl;
+    std::cout << "Stores:              " << c.stores << std::endl;
+    std::cout << "Branches:            " << c.branches << std::endl;
+    std::cout << "Taken branches:      " << c.takenBranches << std::endl;
+    std::cout << "Calls:               " << c.calls << std::endl;
+    std::cout << "Cycles (" << machine.getName() << "):"
+              << std::string(std::max<int>(1, 11 - machine.getName().size()), ' ') << c.cycles << std::endl;
+    if (c.instructions > 0) {
+        std::cout << "CPI:                 " << std::fixed << std::setprecision(3)
+                  << static_cast<double>(c.cycles) / c.instructions << std::endl;
+    }
+    std::cout << "Host time:           " << std::fixed << std::setprecision(3) << elapsed * 1000.0 << " ms";
+    if (elapsed > 0) {
+        std::cout << " (" << std::setprecision(1) << c.instructions / elapsed / 1e6 << " MIPS)";
+    }
+    std::cout << std::endl;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,446 @@
+#include "sim/rv32.hpp"
+#include "utils/utils.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+const std::unordered_map<std::string, SimOp>& baseOps() {
+    static const std::unordered_map<std::string, SimOp> table = {
+        {"add", SimOp::ADD},     {"sub", SimOp::SUB},     {"and", SimOp::AND},
+        {"or", SimOp::OR},       {"xor", SimOp::XOR},     {"sll", SimOp::SLL},
+        {"srl", SimOp::SRL},     {"sra", SimOp::SRA},     {"slt", SimOp::SLT},
+        {"sltu", SimOp::SLTU},   {"mul", SimOp::MUL},     {"mulh", SimOp::MULH},
+        {"mulhsu", SimOp::MULHSU}, {"mulhu", SimOp::MULHU}, {"div", SimOp::DIV},
+        {"divu", SimOp::DIVU},   {"rem", SimOp::REM},     {"remu", SimOp::REMU},
+        {"addi", SimOp::ADDI},   {"andi", SimOp::ANDI},   {"ori", SimOp::ORI},
+        {"xori", SimOp::XORI},   {"slti", SimOp::SLTI},   {"sltiu", SimOp::SLTIU},
+        {"slli", SimOp::SLLI},   {"srli", SimOp::SRLI},   {"srai", SimOp::SRAI},
+        {"lw", SimOp::LW},       {"lh", SimOp::LH},       {"lhu", SimOp::LHU},
+        {"lb", SimOp::LB},       {"lbu", SimOp::LBU},
+        {"sw", SimOp::SW},       {"sh", SimOp::SH},       {"sb", SimOp::SB},
+        {"beq", SimOp::BEQ},     {"bne", SimOp::BNE},     {"blt", SimOp::BLT},
+        {"bge", SimOp::BGE},     {"bltu", SimOp::BLTU},   {"bgeu", SimOp::BGEU}
+    };
+    return table;
+}
+
+bool isRType(SimOp op) { return op <= SimOp::REMU; }
+bool isIType(SimOp op) { return op >= SimOp::ADDI && op <= SimOp::SRAI; }
+bool isLoad(SimOp op) { return op >= SimOp::LW && op <= SimOp::LBU; }
+bool isStore(SimOp op) { return op >= SimOp::SW && op <= SimOp::SB; }
+bool isBranch(SimOp op) { return op >= SimOp::BEQ && op <= SimOp::BGEU; }
+
+} // namespace
+
+RV32Simulator::RV32Simulator(const MachineModel& model, uint32_t memoryBytes)
+    : machine(model), memory(memoryBytes, 0) {
+    std::fill(std::begin(regs), std::end(regs), 0);
+}
+
+bool RV32Simulator::fail(const std::string& message) {
+    error = message;
+    return false;
+}
+
+InstrClass RV32Simulator::classOf(SimOp op) {
+    if (op >= SimOp::MUL && op <= SimOp::MULHU) return InstrClass::MUL;
+    if (op >= SimOp::DIV && op <= SimOp::REMU) return InstrClass::DIV;
+    if (isLoad(op)) return InstrClass::LOAD;
+    if (isStore(op)) return InstrClass::STORE;
+    if (isBranch(op)) return InstrClass::BRANCH;
+    if (op == SimOp::JAL || op == SimOp::JALR) return InstrClass::JUMP;
+    if (op == SimOp::ECALL || op == SimOp::HALT) return InstrClass::OTHER;
+    return InstrClass::ALU;
+}
+
+void RV32Simulator::emitInstr(SimOp op, int rd, int rs1, int rs2, int32_t imm) {
+    SimInstr inst;
+    inst.op = op;
+    inst.rd = static_cast<uint8_t>(rd <= 0 ? NO_REG : rd);
+    inst.rs1 = static_cast<uint8_t>(rs1 < 0 ? 0 : rs1);
+    inst.rs2 = static_cast<uint8_t>(rs2 < 0 ? 0 : rs2);
+    inst.imm = imm;
+    inst.cls = classOf(op);
+    inst.latency = machine.latency(inst.cls);
+    code.push_back(inst);
+}
+
+bool RV32Simulator::load(const std::string& assembly) {
+    code.clear();
+    labels.clear();
+    error.clear();
+    emitInstr(SimOp::HALT, 0, 0, 0, 0);
+
+    std::vector<std::pair<size_t, std::string>> fixups;
+    for (const auto& line : parseAssembly(assembly)) {
+        if (line.isLabel()) {
+            labels[line.opcode] = code.size();
+        } else if (line.isInstruction() && !decode(line, fixups)) {
+            error = "'" + Utils::trim(line.toString()) + "': " + error;
+            return false;
+        }
+    }
+
+    // 回填跳转目标
+    for (const auto& fixup : fixups) {
+        auto it = labels.find(fixup.second);
+        if (it == labels.end()) return fail("undefined label '" + fixup.second + "'");
+        code[fixup.first].imm = it->second;
+    }
+    return true;
+}
+
+bool RV32Simulator::decode(const AsmLine& line, std::vector<std::pair<size_t, std::string>>& fixups) {
+    const std::string& op = line.opcode;
+    const auto& ops = line.operands;
+
+    auto expect = [&](size_t n) {
+        return ops.size() == n || fail("expected " + std::to_string(n) + " operands");
+    };
+    auto reg = [&](size_t i, int& r) {
+        r = registerNumber(ops[i]);
+        return r >= 0 || fail("unknown register '" + ops[i] + "'");
+    };
+    auto imm = [&](size_t i, int32_t& v) {
+        return parseImmediate(ops[i], v) || fail("bad immediate '" + ops[i] + "'");
+    };
+    auto mem = [&](size_t i, int& base, int32_t& offset) {
+        int off;
+        std::string baseName;
+        if (!parseMemoryOperand(ops[i], off, baseName)) return fail("bad memory operand '" + ops[i] + "'");
+        base = registerNumber(baseName);
+        offset = off;
+        return base >= 0 || fail("unknown register '" + baseName + "'");
+    };
+    auto branchTo = [&](SimOp bop, int rs1, int rs2, const std::string& label) {
+        fixups.emplace_back(code.size(), label);
+        emitInstr(bop, 0, rs1, rs2, 0);
+        return true;
+    };
+
+    int rd, rs1, rs2;
+    int32_t value;
+
+    auto base = baseOps().find(op);
+    if (base != baseOps().end()) {
+        SimOp sop = base->second;
+        if (isRType(sop)) {
+            if (!expect(3) || !reg(0, rd) || !reg(1, rs1) || !reg(2, rs2)) return false;
+            emitInstr(sop, rd, rs1, rs2, 0);
+        } else if (isIType(sop)) {
+            if (!expect(3) || !reg(0, rd) || !reg(1, rs1) || !imm(2, value)) return false;
+            emitInstr(sop, rd, rs1, 0, value);
+        } else if (isLoad(sop)) {
+            if (!expect(2) || !reg(0, rd) || !mem(1, rs1, value)) return false;
+            emitInstr(sop, rd, rs1, 0, value);
+        } else if (isStore(sop)) {
+            if (!expect(2) || !reg(0, rs2) || !mem(1, rs1, value)) return false;
+            emitInstr(sop, 0, rs1, rs2, value);
+        } else {
+            if (!expect(3) || !reg(0, rs1) || !reg(1, rs2)) return false;
+            return branchTo(sop, rs1, rs2, ops[2]);
+        }
+        return true;
+    }
+
+    // 单操作数比较零的分支伪指令
+    static const std::unordered_map<std::string, std::pair<SimOp, bool>> zeroBranches = {
+        {"beqz", {SimOp::BEQ, false}}, {"bnez", {SimOp::BNE, false}},
+        {"bltz", {SimOp::BLT, false}}, {"bgez", {SimOp::BGE, false}},
+        {"bgtz", {SimOp::BLT, true}},  {"blez", {SimOp::BGE, true}}
+    };
+    // 交换操作数的分支伪指令
+    static const std::unordered_map<std::string, SimOp> swappedBranches = {
+        {"bgt", SimOp::BLT}, {"ble", SimOp::BGE}, {"bgtu", SimOp::BLTU}, {"bleu", SimOp::BGEU}
+    };
+
+    auto zb = zeroBranches.find(op);
+    if (zb != zeroBranches.end()) {
+        if (!expect(2) || !reg(0, rs1)) return false;
+        return zb->second.second ? branchTo(zb->second.first, 0, rs1, ops[1])
+                                 : branchTo(zb->second.first, rs1, 0, ops[1]);
+    }
+    auto sb = swappedBranches.find(op);
+    if (sb != swappedBranches.end()) {
+        if (!expect(3) || !reg(0, rs1) || !reg(1, rs2)) return false;
+        return branchTo(sb->second, rs2, rs1, ops[2]);
+    }
+
+    if (op == "li") {
+        if (!expect(2) || !reg(0, rd) || !imm(1, value)) return false;
+        emitInstr(SimOp::ADDI, rd, 0, 0, value);
+    } else if (op == "lui") {
+        if (!expect(2) || !reg(0, rd) || !imm(1, value)) return false;
+        emitInstr(SimOp::ADDI, rd, 0, 0, static_cast<int32_t>(static_cast<uint32_t>(value) << 12));
+    } else if (op == "mv") {
+        if (!expect(2) || !reg(0, rd) || !reg(1, rs1)) return false;
+        emitInstr(SimOp::ADDI, rd, rs1, 0, 0);
+    } else if (op == "neg") {
+        if (!expect(2) || !reg(0, rd) || !reg(1, rs2)) return false;
+        emitInstr(SimOp::SUB, rd, 0, rs2, 0);
+    } else if (op == "not") {
+        if (!expect(2) || !reg(0, rd) || !reg(1, rs1)) return false;
+        emitInstr(SimOp::XORI, rd, rs1, 0, -1);
+    } else if (op == "seqz") {
+        if (!expect(2) || !reg(0, rd) || !reg(1, rs1)) return false;
+        emitInstr(SimOp::SLTIU, rd, rs1, 0, 1);
+    } else if (op == "snez") {
+        if (!expect(2) || !reg(0, rd) || !reg(1, rs2)) return false;
+        emitInstr(SimOp::SLTU, rd, 0, rs2, 0);
+    } else if (op == "sltz") {
+        if (!expect(2) || !reg(0, rd) || !reg(1, rs1)) return false;
+        emitInstr(SimOp::SLT, rd, rs1, 0, 0);
+    } else if (op == "sgtz") {
+        if (!expect(2) || !reg(0, rd) || !reg(1, rs2)) return false;
+        emitInstr(SimOp::SLT, rd, 0, rs2, 0);
+    } else if (op == "nop") {
+        emitInstr(SimOp::ADDI, 0, 0, 0, 0);
+    } else if (op == "j" || op == "tail") {
+        if (!expect(1)) return false;
+        fixups.emplace_back(code.size(), ops[0]);
+        emitInstr(SimOp::JAL, 0, 0, 0, 0);
+    } else if (op == "call" || (op == "jal" && ops.size() == 1)) {
+        if (!expect(1)) return false;
+        fixups.emplace_back(code.size(), ops[0]);
+        emitInstr(SimOp::JAL, 1, 0, 0, 0);
+    } else if (op == "jal") {
+        if (!expect(2) || !reg(0, rd)) return false;
+        fixups.emplace_back(code.size(), ops[1]);
+        emitInstr(SimOp::JAL, rd, 0, 0, 0);
+    } else if (op == "jr") {
+        if (!expect(1) || !reg(0, rs1)) return false;
+        emitInstr(SimOp::JALR, 0, rs1, 0, 0);
+    } else if (op == "ret") {
+        if (!expect(0)) return false;
+        emitInstr(SimOp::JALR, 0, 1, 0, 0);
+    } else if (op == "jalr") {
+        // jalr rs / jalr rd, off(rs) / jalr rd, rs, imm
+        if (ops.size() == 1) {
+            if (!reg(0, rs1)) return false;
+            emitInstr(SimOp::JALR, 1, rs1, 0, 0);
+        } else if (ops.size() == 2) {
+            if (!reg(0, rd) || !mem(1, rs1, value)) return false;
+            emitInstr(SimOp::JALR, rd, rs1, 0, value);
+        } else {
+            if (!expect(3) || !reg(0, rd) || !reg(1, rs1) || !imm(2, value)) return false;
+            emitInstr(SimOp::JALR, rd, rs1, 0, value);
+        }
+    } else if (op == "ecall") {
+        emitInstr(SimOp::ECALL, 0, 0, 0, 0);
+    } else {
+        return fail("unsupported instruction");
+    }
+    return true;
+}
+
+bool RV32Simulator::run(const std::string& entry, uint64_t maxInstructions) {
+    auto it = labels.find(entry);
+    if (it == labels.end()) return fail("entry point '" + entry + "' not found");
+
+    std::fill(std::begin(regs), std::end(regs), 0);
+    std::fill(memory.begin(), memory.end(), 0);
+    counters = SimCounters();
+
+    // 栈指针指向数据空间顶部，返回地址指向停机指令
+    regs[1] = TEXT_BASE;
+    regs[2] = static_cast<uint32_t>(memory.size()) & ~15u;
+    regs[8] = regs[2];
+
+    // 热循环只使用局部变量，结束后再写回计数器
+    const SimInstr* text = code.data();
+    const uint32_t textSize = code.size();
+    uint8_t* mem = memory.data();
+    const uint32_t memSize = memory.size();
+    const uint64_t limit = maxInstructions ? maxInstructions : UINT64_MAX;
+    const uint32_t issueWidth = machine.getIssueWidth();
+    const uint32_t penalty = machine.getTakenBranchPenalty();
+
+    // 寄存器文件复制到局部数组，避免与数据内存的写入产生别名
+    uint32_t x[NO_REG + 1];
+    std::copy(std::begin(regs), std::end(regs), x);
+    uint64_t ready[NO_REG + 1] = {};
+    uint64_t cycle = 0, retired = 0;
+    uint64_t loads = 0, stores = 0, branches = 0, taken = 0, calls = 0;
+    uint32_t issued = 0;
+    uint32_t pc = it->second;
+    bool ok = true;
+
+    auto faultAt = [&](uint32_t at, const std::string& what) {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), " at pc 0x%x", TEXT_BASE + at * 4);
+        error = what + buf;
+        ok = false;
+    };
+
+    for (;;) {
+        const SimInstr& in = text[pc];
+        if (in.op == SimOp::HALT) break;
+        if (retired == limit) {
+            faultAt(pc, "instruction limit reached");
+            break;
+        }
+        retired++;
+
+        // 顺序发射：等待源操作数就绪，每周期最多发射 issueWidth 条
+        uint64_t operandsReady = std::max(ready[in.rs1], ready[in.rs2]);
+        if (operandsReady > cycle || issued >= issueWidth) {
+            cycle = std::max(operandsReady, cycle + 1);
+            issued = 0;
+        }
+        issued++;
+        ready[in.rd] = cycle + in.latency;
+
+        const uint32_t a = x[in.rs1];
+        const uint32_t b = x[in.rs2];
+        const int32_t sa = static_cast<int32_t>(a);
+        const int32_t sb = static_cast<int32_t>(b);
+        uint32_t next = pc + 1;
+        uint32_t addr = a + static_cast<uint32_t>(in.imm);
+
+        // 控制流转移后取指重定向，结束当前发射组
+        auto redirect = [&](uint32_t target) {
+            next = target;
+            cycle += penalty;
+            issued = issueWidth;
+        };
+        auto branch = [&](bool cond) {
+            branches++;
+            if (cond) {
+                taken++;
+                redirect(in.imm);
+            }
+        };
+
+        switch (in.op) {
+            case SimOp::ADD:   x[in.rd] = a + b; break;
+            case SimOp::SUB:   x[in.rd] = a - b; break;
+            case SimOp::AND:   x[in.rd] = a & b; break;
+            case SimOp::OR:    x[in.rd] = a | b; break;
+            case SimOp::XOR:   x[in.rd] = a ^ b; break;
+            case SimOp::SLL:   x[in.rd] = a << (b & 31); break;
+            case SimOp::SRL:   x[in.rd] = a >> (b & 31); break;
+            case SimOp::SRA:   x[in.rd] = static_cast<uint32_t>(sa >> (b & 31)); break;
+            case SimOp::SLT:   x[in.rd] = sa < sb; break;
+            case SimOp::SLTU:  x[in.rd] = a < b; break;
+            case SimOp::MUL:   x[in.rd] = a * b; break;
+            case SimOp::MULH:
+                x[in.rd] = static_cast<uint32_t>((static_cast<int64_t>(sa) * sb) >> 32);
+                break;
+            case SimOp::MULHSU:
+                x[in.rd] = static_cast<uint32_t>((static_cast<int64_t>(sa) * static_cast<int64_t>(b)) >> 32);
+                break;
+            case SimOp::MULHU:
+                x[in.rd] = static_cast<uint32_t>((static_cast<uint64_t>(a) * b) >> 32);
+                break;
+            // 除零与溢出按RISC-V规定的结果处理，不产生异常
+            case SimOp::DIV:
+                x[in.rd] = b == 0 ? UINT32_MAX
+                            : (sa == INT32_MIN && sb == -1) ? a
+                            : static_cast<uint32_t>(sa / sb);
+                break;
+            case SimOp::DIVU:  x[in.rd] = b == 0 ? UINT32_MAX : a / b; break;
+            case SimOp::REM:
+                x[in.rd] = b == 0 ? a
+                            : (sa == INT32_MIN && sb == -1) ? 0
+                            : static_cast<uint32_t>(sa % sb);
+                break;
+            case SimOp::REMU:  x[in.rd] = b == 0 ? a : a % b; break;
+
+            case SimOp::ADDI:  x[in.rd] = a + in.imm; break;
+            case SimOp::ANDI:  x[in.rd] = a & in.imm; break;
+            case SimOp::ORI:   x[in.rd] = a | in.imm; break;
+            case SimOp::XORI:  x[in.rd] = a ^ in.imm; break;
+            case SimOp::SLTI:  x[in.rd] = sa < in.imm; break;
+            case SimOp::SLTIU: x[in.rd] = a < static_cast<uint32_t>(in.imm); break;
+            case SimOp::SLLI:  x[in.rd] = a << (in.imm & 31); break;
+            case SimOp::SRLI:  x[in.rd] = a >> (in.imm & 31); break;
+            case SimOp::SRAI:  x[in.rd] = static_cast<uint32_t>(sa >> (in.imm & 31)); break;
+
+            case SimOp::LW:
+                if (addr > memSize - 4) { faultAt(pc, "load out of bounds"); break; }
+                std::memcpy(&x[in.rd], mem + addr, 4);
+                loads++;
+                break;
+            case SimOp::LH:
+            case SimOp::LHU: {
+                if (addr > memSize - 2) { faultAt(pc, "load out of bounds"); break; }
+                uint16_t h;
+                std::memcpy(&h, mem + addr, 2);
+                x[in.rd] = in.op == SimOp::LH ? static_cast<uint32_t>(static_cast<int16_t>(h)) : h;
+                loads++;
+                break;
+            }
+            case SimOp::LB:
+            case SimOp::LBU:
+                if (addr >= memSize) { faultAt(pc, "load out of bounds"); break; }
+                x[in.rd] = in.op == SimOp::LB ? static_cast<uint32_t>(static_cast<int8_t>(mem[addr])) : mem[addr];
+                loads++;
+                break;
+            case SimOp::SW:
+                if (addr > memSize - 4) { faultAt(pc, "store out of bounds"); break; }
+                std::memcpy(mem + addr, &b, 4);
+                stores++;
+                break;
+            case SimOp::SH:
+                if (addr > memSize - 2) { faultAt(pc, "store out of bounds"); break; }
+                std::memcpy(mem + addr, &b, 2);
+                stores++;
+                break;
+            case SimOp::SB:
+                if (addr >= memSize) { faultAt(pc, "store out of bounds"); break; }
+                mem[addr] = static_cast<uint8_t>(b);
+                stores++;
+                break;
+
+            case SimOp::BEQ:  branch(a == b); break;
+            case SimOp::BNE:  branch(a != b); break;
+            case SimOp::BLT:  branch(sa < sb); break;
+            case SimOp::BGE:  branch(sa >= sb); break;
+            case SimOp::BLTU: branch(a < b); break;
+            case SimOp::BGEU: branch(a >= b); break;
+
+            case SimOp::JAL:
+                x[in.rd] = TEXT_BASE + next * 4;
+                calls += in.rd == 1;
+                redirect(in.imm);
+                break;
+            case SimOp::JALR: {
+                uint32_t target = (addr & ~1u) - TEXT_BASE;
+                x[in.rd] = TEXT_BASE + next * 4;
+                if ((target & 3) != 0 || target / 4 >= textSize) {
+                    faultAt(pc, "jump to invalid address");
+                    break;
+                }
+                calls += in.rd == 1;
+                redirect(target / 4);
+                break;
+            }
+            case SimOp::ECALL:
+                // 只支持 exit (a7 = 93)
+                if (x[17] != 93) {
+                    faultAt(pc, "unsupported ecall");
+                    break;
+                }
+                next = 0;
+                break;
+            case SimOp::HALT:
+                break;
+        }
+        if (!ok) break;
+        pc = next;
+    }
+
+    std::copy(std::begin(x), std::end(x), regs);
+    counters.instructions = retired;
+    counters.loads = loads;
+    counters.stores = stores;
+    counters.branches = branches;
+    counters.takenBranches = taken;
+    counters.calls = calls;
+    counters.cycles = retired == 0 ? 0 : cycle + 1;
+    return ok;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "codegen/asm.hpp"
+#include "codegen/machine.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// 预解码后的操作；伪指令在装载时展开为基础指令
+enum class SimOp : uint8_t {
+    ADD, SUB, AND, OR, XOR, SLL, SRL, SRA, SLT, SLTU,
+    MUL, MULH, MULHSU, MULHU, DIV, DIVU, REM, REMU,
+    ADDI, ANDI, ORI, XORI, SLTI, SLTIU, SLLI, SRLI, SRAI,
+    LW, LH, LHU, LB, LBU, SW, SH, SB,
+    BEQ, BNE, BLT, BGE, BLTU, BGEU,
+    JAL, JALR, ECALL, HALT
+};
+
+// 定长的预解码指令，执行循环只读这个数组
+// 不使用的源寄存器记为 x0，不写回的目的寄存器记为 NO_REG
+struct SimInstr {
+    SimOp op;
+    uint8_t rd;
+    uint8_t rs1;
+    uint8_t rs2;
+    int32_t imm;        // 立即数 / 访存偏移 / 跳转目标的指令下标
+    int32_t latency;    // 由机器模型给出的结果延迟
+    InstrClass cls;
+};
+
+// 动态执行计数
+struct SimCounters {
+    uint64_t instructions = 0;
+    uint64_t loads = 0;
+    uint64_t stores = 0;
+    uint64_t branches = 0;
+    uint64_t takenBranches = 0;
+    uint64_t calls = 0;
+    uint64_t cycles = 0;
+};
+
+// RV32IM 指令集模拟器：汇编编译器输出的指令子集（含常用伪指令），
+// 从 main 开始执行直到其返回，并按机器模型估计顺序流水线周期数
+class RV32Simulator {
+public:
+    static constexpr int NO_REG = 32;
+    static constexpr uint32_t TEXT_BASE = 0x10000;
+
+private:
+    const MachineModel& machine;
+    std::vector<SimInstr> code;             // code[0] 为停机指令，main 返回到这里
+    std::unordered_map<std::string, int> labels;
+    std::vector<uint8_t> memory;            // 数据地址空间 [0, memory.size())，栈从顶部向下
+    std::string error;
+
+    uint32_t regs[NO_REG + 1];
+    SimCounters counters;
+
+public:
+    explicit RV32Simulator(const MachineModel& model, uint32_t memoryBytes = 16u << 20);
+
+    // 装载汇编文本；遇到不支持的指令或未定义的标签时返回false
+    bool load(const std::string& assembly);
+    // 从入口函数开始执行；maxInstructions为0表示不限
+    bool run(const std::string& entry = "main", uint64_t maxInstructions = 0);
+
+    int32_t getReturnValue() const { return static_cast<int32_t>(regs[10]); }
+    const SimCounters& getCounters() const { return counters; }
+    const std::string& getError() const { return error; }
+    size_t getStaticInstructions() const { return code.size() - 1; }
+
+private:
+    bool decode(const AsmLine& line, std::vector<std::pair<size_t, std::string>>& fixups);
+    bool fail(const std::string& message);
+    void emitInstr(SimOp op, int rd, int rs1, int rs2, int32_t imm);
+    static InstrClass classOf(SimOp op);
+};
@@ -0,0 +1,183 @@
+#include "utils/memory.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+#include <sys/resource.h>
+
+namespace {
+
+// 常量初始化，静态构造之前的分配也能安全计数
+std::atomic<bool> countingEnabled{false};
+std::atomic<uint64_t> allocationCount{0};
+std::atomic<uint64_t> freeCount{0};
+std::atomic<uint64_t> allocatedBytes{0};
+std::atomic<int64_t> liveBytes{0};
+std::atomic<int64_t> peakBytes{0};
+
+void recordAllocation(void* ptr, size_t size) {
+    if (!ptr || !countingEnabled.load(std::memory_order_relaxed)) return;
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    int64_t block = static_cast<int64_t>(malloc_usable_size(ptr));
+    int64_t live = liveBytes.fetch_add(block, std::memory_order_relaxed) + block;
+    int64_t peak = peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+}
+
+void recordFree(void* ptr) {
+    if (!ptr || !countingEnabled.load(std::memory_order_relaxed)) return;
+    freeCount.fetch_add(1, std::memory_order_relaxed);
+    liveBytes.fetch_sub(static_cast<int64_t>(malloc_usable_size(ptr)), std::memory_order_relaxed);
+}
+
+void* allocate(size_t size) {
+    void* ptr = std::malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    recordAllocation(ptr, size);
+    return ptr;
+}
+
+void* allocateNoThrow(size_t size) noexcept {
+    void* ptr = std::malloc(size ? size : 1);
+    recordAllocation(ptr, size);
+    return ptr;
+}
+
+void release(void* ptr) noexcept {
+    recordFree(ptr);
+    std::free(ptr);
+}
+
+// JSON 字符串转义（Utils::escapeString 会转义单引号，不是合法的 JSON）
+std::string jsonString(const std::string& text) {
+    std::string result = "\"";
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += static_cast<char>(c);
+        } else if (c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            result += escaped;
+        } else {
+            result += static_cast<char>(c);
+        }
+    }
+    return result + "\"";
+}
+
+} // namespace
+
+// 全局分配函数的替换；按对齐分配的版本不经过这里，计数中不包含它们
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocateNoThrow(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocateNoThrow(size); }
+void operator delete(void* ptr) noexcept { release(ptr); }
+void operator delete[](void* ptr) noexcept { release(ptr); }
+void operator delete(void* ptr, size_t) noexcept { release(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { release(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { release(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { release(ptr); }
+
+namespace Memory {
+
+void setEnabled(bool enabled) {
+    countingEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool isEnabled() {
+    return countingEnabled.load(std::memory_order_relaxed);
+}
+
+Counters snapshot() {
+    Counters counters;
+    counters.allocations = allocationCount.load(std::memory_order_relaxed);
+    counters.frees = freeCount.load(std::memory_order_relaxed);
+    counters.bytesAllocated = allocatedBytes.load(std::memory_order_relaxed);
+    counters.liveBytes = liveBytes.load(std::memory_order_relaxed);
+    counters.peakLiveBytes = peakBytes.load(std::memory_order_relaxed);
+    return counters;
+}
+
+void resetPeak() {
+    peakBytes.store(liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+long peakRssKb() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return usage.ru_maxrss;
+}
+
+} // namespace Memory
+
+void MemoryReport::begin(const std::string& name) {
+    current = name;
+    Memory::resetPeak();
+    phaseStart = Memory::snapshot();
+}
+
+void MemoryReport::end() {
+    if (current.empty()) return;
+    Memory::Counters now = Memory::snapshot();
+    Phase phase;
+    phase.name = current;
+    phase.allocations = now.allocations - phaseStart.allocations;
+    phase.frees = now.frees - phaseStart.frees;
+    phase.bytesAllocated = now.bytesAllocated - phaseStart.bytesAllocated;
+    phase.retainedBytes = now.liveBytes - phaseStart.liveBytes;
+    phase.peakLiveBytes = now.peakLiveBytes;
+    phases.push_back(phase);
+    current.clear();
+}
+
+const MemoryReport::Phase* MemoryReport::find(const std::string& name) const {
+    for (auto it = phases.rbegin(); it != phases.rend(); ++it) {
+        if (it->name == name) return &*it;
+    }
+    return nullptr;
+}
+
+void MemoryReport::addSize(const std::string& name, int64_t bytes) {
+    sizes.emplace_back(name, bytes);
+}
+
+void MemoryReport::write(std::ostream& out, const std::string& inputFile) const {
+    // 总计只包含各阶段：--server 的工作进程里计数器跨多次编译累积
+    uint64_t allocations = 0;
+    uint64_t bytesAllocated = 0;
+    int64_t heapPeak = 0;
+    for (const auto& phase : phases) {
+        allocations += phase.allocations;
+        bytesAllocated += phase.bytesAllocated;
+        heapPeak = std::max(heapPeak, phase.peakLiveBytes);
+    }
+
+    out << "{\n"
+        << "  \"version\": 1,\n"
+        << "  \"input\": " << jsonString(inputFile) << ",\n"
+        << "  \"peak_rss_kb\": " << Memory::peakRssKb() << ",\n"
+        << "  \"heap_peak_bytes\": " << heapPeak << ",\n"
+        << "  \"allocations\": " << allocations << ",\n"
+        << "  \"bytes_allocated\": " << bytesAllocated << ",\n"
+        << "  \"phases\": [";
+    for (size_t i = 0; i < phases.size(); ++i) {
+        const Phase& phase = phases[i];
+        out << (i ? ",\n" : "\n")
+            << "    {\"name\": " << jsonString(phase.name)
+            << ", \"allocations\": " << phase.allocations
+            << ", \"frees\": " << phase.frees
+            << ", \"bytes_allocated\": " << phase.bytesAllocated
+            << ", \"retained_bytes\": " << phase.retainedBytes
+            << ", \"peak_heap_bytes\": " << phase.peakLiveBytes << "}";
+    }
+    out << (phases.empty() ? "],\n" : "\n  ],\n") << "  \"sizes\": {";
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        out << (i ? ",\n" : "\n") << "    " << jsonString(sizes[i].first) << ": " << sizes[i].second;
+    }
+    out << (sizes.empty() ? "}\n" : "\n  }\n") << "}" << std::endl;
+}
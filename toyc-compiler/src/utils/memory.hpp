@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 内存使用统计（--mem-report）。
+// memory.cpp 替换了全局 operator new/delete：开启计数后每次分配和释放都记入全局原子计数器，
+// 当前存活字节数按 malloc_usable_size 计算并维护峰值；未开启时钩子只多一次读标志。
+namespace Memory {
+
+struct Counters {
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t bytesAllocated = 0;    // 申请的字节数之和
+    int64_t liveBytes = 0;          // 开启计数以来分配减释放（按实际块大小）
+    int64_t peakLiveBytes = 0;
+};
+
+void setEnabled(bool enabled);
+bool isEnabled();
+Counters snapshot();
+// 把峰值重置为当前存活字节数，用于统计单个阶段的峰值
+void resetPeak();
+// 进程的峰值常驻内存（getrusage），单位 KiB
+long peakRssKb();
+
+} // namespace Memory
+
+// 逐阶段的分配报告：begin/end 之间的分配次数、字节数、阶段结束时仍存活的字节数和阶段内的堆峰值，
+// 外加编译器主要数据结构的大小。以 JSON 输出，字段名固定，便于 CI 比较不同版本的内存回归
+class MemoryReport {
+public:
+    struct Phase {
+        std::string name;
+        uint64_t allocations;
+        uint64_t frees;
+        uint64_t bytesAllocated;
+        int64_t retainedBytes;      // 阶段结束时比开始时多存活的字节（阶段产物的大小）
+        int64_t peakLiveBytes;
+    };
+
+private:
+    std::vector<Phase> phases;
+    std::vector<std::pair<std::string, int64_t>> sizes;
+    Memory::Counters phaseStart;
+    std::string current;
+
+public:
+    void begin(const std::string& name);
+    void end();
+    // 最近结束的名为 name 的阶段，没有则为空
+    const Phase* find(const std::string& name) const;
+
+    void addSize(const std::string& name, int64_t bytes);
+
+    void write(std::ostream& out, const std::string& inputFile) const;
+};
@@ -0,0 +1,77 @@
+#include "utils/source_manager.hpp"
+#include "ast/ast.hpp"
+#include "utils/utils.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+bool SourceManager::load(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) return false;
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    setBuffer(filename, contents.str());
+    return true;
+}
+
+void SourceManager::setBuffer(const std::string& filename, std::string contents) {
+    name = filename;
+    text = std::move(contents);
+    lineStarts.clear();
+}
+
+void SourceManager::buildIndex() const {
+    if (!lineStarts.empty()) return;
+    lineStarts.push_back(0);
+    for (size_t pos = text.find('\n'); pos != std::string::npos; pos = text.find('\n', pos + 1)) {
+        lineStarts.push_back(static_cast<uint32_t>(pos + 1));
+    }
+}
+
+int SourceManager::lineCount() const {
+    buildIndex();
+    return static_cast<int>(lineStarts.size());
+}
+
+void SourceManager::lineColumn(uint32_t offset, int& line, int& column) const {
+    buildIndex();
+    offset = std::min<uint32_t>(offset, static_cast<uint32_t>(text.size()));
+    // 最后一个不大于 offset 的行首
+    auto it = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset) - 1;
+    line = static_cast<int>(it - lineStarts.begin()) + 1;
+    column = static_cast<int>(offset - *it) + 1;
+}
+
+std::string SourceManager::lineText(int line) const {
+    buildIndex();
+    if (line < 1 || line > static_cast<int>(lineStarts.size())) return "";
+    size_t begin = lineStarts[line - 1];
+    size_t end = line < static_cast<int>(lineStarts.size()) ? lineStarts[line] - 1 : text.size();
+    if (end > begin && text[end - 1] == '\r') end--;
+    return text.substr(begin, end - begin);
+}
+
+std::string SourceManager::format(uint32_t offset, const std::string& message) const {
+    if (offset == ASTNode::NO_OFFSET) return Utils::formatErrorMessage(name, 0, 0, message);
+    int line;
+    int column;
+    lineColumn(offset, line, column);
+    return Utils::formatErrorMessage(name, line, column, message);
+}
+
+void SourceManager::printContext(std::ostream& out, uint32_t offset) const {
+    if (offset == ASTNode::NO_OFFSET) return;
+    int line;
+    int column;
+    lineColumn(offset, line, column);
+
+    if (line > 1) {
+        std::string previous = lineText(line - 1);
+        if (!previous.empty()) out << std::setw(4) << (line - 1) << " | " << previous << "\n";
+    }
+    out << std::setw(4) << line << " | " << lineText(line) << "\n"
+        << "     | " << std::string(column - 1, ' ') << "^\n";
+    std::string next = lineText(line + 1);
+    if (!next.empty()) out << std::setw(4) << (line + 1) << " | " << next << "\n";
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 持有输入文件的内容和行首偏移索引。
+// AST 节点只记录32位字节偏移，行列号和源码行在输出诊断时才计算：
+// 索引在第一次查询时一次建好，之后偏移到行列是二分查找，取某一行是常数时间，
+// 不必像逐行读文件那样每条诊断都从头扫描。
+class SourceManager {
+private:
+    std::string name;
+    std::string text;
+    mutable std::vector<uint32_t> lineStarts;   // 第 i 行（从0计）的起始偏移，懒建立
+
+public:
+    // 读入文件，失败返回 false
+    bool load(const std::string& filename);
+    void setBuffer(const std::string& filename, std::string contents);
+
+    const std::string& getName() const { return name; }
+    const std::string& getBuffer() const { return text; }
+
+    // 偏移对应的行号和列号（都从1开始，列按字节计）
+    void lineColumn(uint32_t offset, int& line, int& column) const;
+    // 第 line 行的内容（不含换行符），越界时为空
+    std::string lineText(int line) const;
+    int lineCount() const;
+
+    // "文件:行:列: 消息"，offset 无效时省略行列
+    std::string format(uint32_t offset, const std::string& message) const;
+    // 出错行及前后各一行，出错列下方加 ^
+    void printContext(std::ostream& out, uint32_t offset) const;
+
+private:
+    void buildIndex() const;
+};
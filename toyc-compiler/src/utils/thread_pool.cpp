@@ -0,0 +1,72 @@
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+WorkStealingPool::WorkStealingPool(int threads)
+    : threadCount(std::max(1, threads)), queues(threadCount) {}
+
+int WorkStealingPool::defaultThreads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool WorkStealingPool::takeTask(int worker, size_t& task) {
+    {
+        TaskQueue& own = queues[worker];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            task = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+    // 从下一个线程开始轮流偷，避免所有空闲线程挤在同一个队列上
+    for (int step = 1; step < threadCount; ++step) {
+        TaskQueue& victim = queues[(worker + step) % threadCount];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run(size_t count, const std::function<void(size_t, int)>& job) {
+    int workers = static_cast<int>(std::min<size_t>(threadCount, count));
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; ++i) job(i, 0);
+        return;
+    }
+
+    for (int w = 0; w < workers; ++w) {
+        size_t begin = count * w / workers;
+        size_t end = count * (w + 1) / workers;
+        queues[w].tasks.clear();
+        for (size_t i = begin; i < end; ++i) queues[w].tasks.push_back(i);
+    }
+
+    std::mutex errorLock;
+    std::exception_ptr error;
+    auto work = [&](int worker) {
+        size_t task;
+        while (takeTask(worker, task)) {
+            try {
+                job(task, worker);
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(errorLock);
+                if (!error) error = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int w = 1; w < workers; ++w) {
+        threads.emplace_back(work, w);
+    }
+    work(0);
+    for (auto& thread : threads) thread.join();
+
+    if (error) std::rethrow_exception(error);
+}
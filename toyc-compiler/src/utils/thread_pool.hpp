@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// 工作窃取线程池，用于一批互不依赖的任务（如逐函数的代码生成）
+// 任务按下标连续分块放进每个线程自己的双端队列：线程从队头取自己的任务，
+// 队列空了就从其他线程的队尾偷，大函数集中在某一段时也能保持负载均衡。
+class WorkStealingPool {
+private:
+    struct TaskQueue {
+        std::mutex lock;
+        std::deque<size_t> tasks;
+    };
+
+    int threadCount;
+    std::vector<TaskQueue> queues;
+
+public:
+    explicit WorkStealingPool(int threads);
+
+    int size() const { return threadCount; }
+
+    // 对 [0, count) 的每个下标执行 job(下标, 线程编号)，全部完成后返回；
+    // 调用线程本身是 0 号线程。任务抛出的第一个异常在返回前重新抛出
+    void run(size_t count, const std::function<void(size_t, int)>& job);
+
+    // 默认线程数：硬件并发数（至少为1）
+    static int defaultThreads();
+
+private:
+    bool takeTask(int worker, size_t& task);
+};
@@ -0,0 +1,529 @@
+#include "vm/bytecode.hpp"
+#include <algorithm>
+#include <climits>
+#include <iomanip>
+
+namespace {
+
+const char* opName(Op op) {
+    static const char* names[] = {
+        "MOV", "LOADI", "ADD", "SUB", "MUL", "DIV", "MOD", "ADDI",
+        "LT", "LE", "GT", "GE", "EQ", "NE", "NEG", "NOT",
+        "JMP", "JZ", "JNZ", "JLT", "JLE", "JGT", "JGE", "JEQ", "JNE",
+        "CALL", "RET", "RET0"
+    };
+    return names[static_cast<int>(op)];
+}
+
+bool isComparison(BinaryExpression::Operator op) {
+    return op >= BinaryExpression::LT && op <= BinaryExpression::NE;
+}
+
+Op valueOp(BinaryExpression::Operator op) {
+    switch (op) {
+        case BinaryExpression::ADD: return Op::ADD;
+        case BinaryExpression::SUB: return Op::SUB;
+        case BinaryExpression::MUL: return Op::MUL;
+        case BinaryExpression::DIV: return Op::DIV;
+        case BinaryExpression::MOD: return Op::MOD;
+        case BinaryExpression::LT:  return Op::LT;
+        case BinaryExpression::LE:  return Op::LE;
+        case BinaryExpression::GT:  return Op::GT;
+        case BinaryExpression::GE:  return Op::GE;
+        case BinaryExpression::EQ:  return Op::EQ;
+        default:                    return Op::NE;
+    }
+}
+
+// 比较为真（jumpIfTrue）或为假时跳转的条件跳转
+Op jumpOp(BinaryExpression::Operator op, bool jumpIfTrue) {
+    switch (op) {
+        case BinaryExpression::LT: return jumpIfTrue ? Op::JLT : Op::JGE;
+        case BinaryExpression::LE: return jumpIfTrue ? Op::JLE : Op::JGT;
+        case BinaryExpression::GT: return jumpIfTrue ? Op::JGT : Op::JLE;
+        case BinaryExpression::GE: return jumpIfTrue ? Op::JGE : Op::JLT;
+        case BinaryExpression::EQ: return jumpIfTrue ? Op::JEQ : Op::JNE;
+        default:                   return jumpIfTrue ? Op::JNE : Op::JEQ;
+    }
+}
+
+// 字面量或对字面量取负（-2147483648 会被解析成这种形式）
+bool constantValue(const Expression& expr, int& value) {
+    const Expression* inner = &expr;
+    bool negate = false;
+    while (auto un = dynamic_cast<const UnaryExpression*>(inner)) {
+        if (un->op != UnaryExpression::MINUS) return false;
+        negate = !negate;
+        inner = un->operand.get();
+    }
+    auto num = dynamic_cast<const NumberLiteral*>(inner);
+    if (!num) return false;
+    value = negate ? static_cast<int>(0u - static_cast<unsigned>(num->value)) : num->value;
+    return true;
+}
+
+} // namespace
+
+int BytecodeProgram::findFunction(const std::string& name) const {
+    for (size_t i = 0; i < functions.size(); ++i) {
+        if (functions[i].name == name) return i;
+    }
+    return -1;
+}
+
+void BytecodeProgram::dump(std::ostream& out) const {
+    for (size_t f = 0; f < functions.size(); ++f) {
+        const BytecodeFunction& func = functions[f];
+        uint32_t end = f + 1 < functions.size() ? functions[f + 1].entry : code.size();
+        out << func.name << ": params=" << func.numParams << " regs=" << func.numRegs << "\n";
+
+        for (uint32_t i = func.entry; i < end; ++i) {
+            const Instr& in = code[i];
+            out << "  " << std::setw(5) << i << "  " << std::left << std::setw(6) << opName(in.op) << std::right;
+            switch (in.op) {
+                case Op::MOV: case Op::NEG: case Op::NOT:
+                    out << "r" << in.a << ", r" << in.b;
+                    break;
+                case Op::LOADI:
+                    out << "r" << in.a << ", " << in.k;
+                    break;
+                case Op::ADDI:
+                    out << "r" << in.a << ", r" << in.b << ", " << in.k;
+                    break;
+                case Op::JMP:
+                    out << in.k;
+                    break;
+                case Op::JZ: case Op::JNZ:
+                    out << "r" << in.a << ", " << in.k;
+                    break;
+                case Op::JLT: case Op::JLE: case Op::JGT: case Op::JGE: case Op::JEQ: case Op::JNE:
+                    out << "r" << in.a << ", r" << in.b << ", " << in.k;
+                    break;
+                case Op::CALL:
+                    out << "r" << in.a << ", " << functions[in.k].name;
+                    if (in.c > 0) out << ", r" << in.b << "..r" << (in.b + in.c - 1);
+                    break;
+                case Op::RET:
+                    out << "r" << in.a;
+                    break;
+                case Op::RET0:
+                    break;
+                default:
+                    out << "r" << in.a << ", r" << in.b << ", r" << in.c;
+                    break;
+            }
+            out << "\n";
+        }
+    }
+}
+
+bool BytecodeCompiler::compile(CompilationUnit& unit, BytecodeProgram& out) {
+    program = &out;
+    program->code.clear();
+    program->functions.clear();
+    functionIndex.clear();
+    error.clear();
+
+    // 先编号所有函数，允许调用后定义的函数
+    for (const auto& func : unit.functions) {
+        functionIndex[func->name] = program->functions.size();
+        program->functions.push_back({func->name, 0, static_cast<uint16_t>(func->parameters.size()), 0});
+    }
+
+    Walk::run(unit.accept(*this));
+    return error.empty();
+}
+
+size_t BytecodeCompiler::emit(Op op, int a, int b, int c, int32_t k) {
+    program->code.push_back({op, static_cast<uint16_t>(a), static_cast<uint16_t>(b), static_cast<uint16_t>(c), k});
+    return program->code.size() - 1;
+}
+
+void BytecodeCompiler::patch(const std::vector<size_t>& jumps, size_t target) {
+    for (size_t j : jumps) {
+        program->code[j].k = static_cast<int32_t>(target);
+    }
+}
+
+int BytecodeCompiler::allocRegister() {
+    if (top >= MAX_REGS) {
+        if (error.empty()) error = "function needs more than " + std::to_string(MAX_REGS) + " registers";
+        return MAX_REGS - 1;
+    }
+    int reg = top++;
+    maxRegs = std::max(maxRegs, top);
+    return reg;
+}
+
+int BytecodeCompiler::lookup(const std::string& name) const {
+    for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
+        auto found = it->find(name);
+        if (found != it->end()) return found->second;
+    }
+    return 0;
+}
+
+Walk BytecodeCompiler::compileExpression(Expression& expr, int dst) {
+    int saved = target;
+    target = dst;
+    co_await expr.accept(*this);
+    target = saved;
+}
+
+Walk BytecodeCompiler::branchOn(Expression& expr, bool when, std::vector<size_t>& patches) {
+    int value;
+    if (constantValue(expr, value)) {
+        if ((value != 0) == when) patches.push_back(emit(Op::JMP));
+        co_return;
+    }
+
+    if (auto bin = dynamic_cast<BinaryExpression*>(&expr)) {
+        // 短路：when 与运算符"吸收值"一致时两边都直接跳到目标
+        if (bin->op == BinaryExpression::AND || bin->op == BinaryExpression::OR) {
+            bool absorbing = bin->op == BinaryExpression::OR;
+            if (when == absorbing) {
+                co_await branchOn(*bin->left, when, patches);
+                co_await branchOn(*bin->right, when, patches);
+            } else {
+                std::vector<size_t> skip;
+                co_await branchOn(*bin->left, !when, skip);
+                co_await branchOn(*bin->right, when, patches);
+                patch(skip, here());
+            }
+            co_return;
+        }
+
+        if (isComparison(bin->op)) {
+            int mark = top;
+            co_await compileExpression(*bin->left);
+            int l = result;
+            int zero;
+            if ((bin->op == BinaryExpression::EQ || bin->op == BinaryExpression::NE) &&
+                constantValue(*bin->right, zero) && zero == 0) {
+                top = mark;
+                bool jumpIfZero = (bin->op == BinaryExpression::EQ) == when;
+                patches.push_back(emit(jumpIfZero ? Op::JZ : Op::JNZ, l));
+                co_return;
+            }
+            co_await compileExpression(*bin->right);
+            int r = result;
+            top = mark;
+            patches.push_back(emit(jumpOp(bin->op, when), l, r));
+            co_return;
+        }
+    }
+
+    if (auto un = dynamic_cast<UnaryExpression*>(&expr)) {
+        if (un->op == UnaryExpression::NOT) {
+            co_await branchOn(*un->operand, !when, patches);
+            co_return;
+        }
+    }
+
+    int mark = top;
+    co_await compileExpression(expr);
+    int reg = result;
+    top = mark;
+    patches.push_back(emit(when ? Op::JNZ : Op::JZ, reg));
+}
+
+void BytecodeCompiler::collectLoopConstants(const Statement& body, std::vector<int>& values) {
+    // 显式栈前序遍历，second 表示节点是否在循环内
+    std::vector<std::pair<const ASTNode*, bool>> stack{{&body, false}};
+    std::vector<ASTNode*> next;
+    while (!stack.empty()) {
+        auto [node, inLoop] = stack.back();
+        stack.pop_back();
+        auto bin = dynamic_cast<const BinaryExpression*>(node);
+        // 加减常量用 ADDI，其余二元运算的常量操作数需要寄存器
+        if (bin && inLoop && bin->op != BinaryExpression::ADD && bin->op != BinaryExpression::SUB &&
+            bin->op != BinaryExpression::AND && bin->op != BinaryExpression::OR) {
+            int value;
+            for (const Expression* operand : {bin->left.get(), bin->right.get()}) {
+                if (constantValue(*operand, value) && std::find(values.begin(), values.end(), value) == values.end()) {
+                    values.push_back(value);
+                }
+            }
+        }
+        if (dynamic_cast<const WhileStatement*>(node)) inLoop = true;
+        next.clear();
+        node->children(next);
+        for (auto it = next.rbegin(); it != next.rend(); ++it) {
+            stack.push_back({*it, inLoop});
+        }
+    }
+}
+
+// Visitor实现
+Walk BytecodeCompiler::visit(CompilationUnit& node) {
+    for (auto& func : node.functions) {
+        co_await func->accept(*this);
+    }
+}
+
+Walk BytecodeCompiler::visit(FunctionDefinition& node) {
+    BytecodeFunction& func = program->functions[functionIndex[node.name]];
+    func.entry = here();
+
+    scopes.clear();
+    scopes.emplace_back();
+    constRegs.clear();
+    breakPatches.clear();
+    continuePatches.clear();
+    top = 0;
+    maxRegs = 0;
+
+    for (const auto& param : node.parameters) {
+        scopes.back()[param.name] = allocRegister();
+    }
+
+    std::vector<int> constants;
+    collectLoopConstants(*node.body, constants);
+    for (size_t i = 0; i < constants.size() && i < MAX_CONST_REGS; ++i) {
+        int reg = allocRegister();
+        constRegs[constants[i]] = reg;
+        emit(Op::LOADI, reg, 0, 0, constants[i]);
+    }
+
+    co_await node.body->accept(*this);
+    // 直落到函数末尾（void函数或缺少return）
+    emit(Op::RET0);
+
+    func.numRegs = static_cast<uint16_t>(std::max(maxRegs, 1));
+}
+
+Walk BytecodeCompiler::visit(Block& node) {
+    int mark = top;
+    scopes.emplace_back();
+    for (auto& stmt : node.statements) {
+        co_await stmt->accept(*this);
+    }
+    scopes.pop_back();
+    top = mark;
+}
+
+Walk BytecodeCompiler::visit(NumberLiteral& node) {
+    if (target >= 0) {
+        emit(Op::LOADI, target, 0, 0, node.value);
+        result = target;
+        co_return;
+    }
+    auto it = constRegs.find(node.value);
+    if (it != constRegs.end()) {
+        result = it->second;
+        co_return;
+    }
+    result = allocRegister();
+    emit(Op::LOADI, result, 0, 0, node.value);
+}
+
+Walk BytecodeCompiler::visit(Identifier& node) {
+    int reg = lookup(node.name);
+    if (target >= 0 && target != reg) {
+        emit(Op::MOV, target, reg);
+        result = target;
+    } else {
+        result = reg;
+    }
+    co_return;
+}
+
+Walk BytecodeCompiler::visit(BinaryExpression& node) {
+    int mark = top;
+    int dst;
+
+    if (node.op == BinaryExpression::AND || node.op == BinaryExpression::OR) {
+        dst = target >= 0 ? target : allocRegister();
+        std::vector<size_t> falseJumps;
+        co_await branchOn(node, false, falseJumps);
+        emit(Op::LOADI, dst, 0, 0, 1);
+        size_t endJump = emit(Op::JMP);
+        patch(falseJumps, here());
+        emit(Op::LOADI, dst, 0, 0, 0);
+        patch({endJump}, here());
+        top = target >= 0 ? mark : dst + 1;
+        result = dst;
+        co_return;
+    }
+
+    // x + c / c + x / x - c 使用立即数形式
+    int value;
+    Expression* other = nullptr;
+    if ((node.op == BinaryExpression::ADD || node.op == BinaryExpression::SUB) &&
+        constantValue(*node.right, value) && (node.op == BinaryExpression::ADD || value != INT_MIN)) {
+        other = node.left.get();
+        if (node.op == BinaryExpression::SUB) value = -value;
+    } else if (node.op == BinaryExpression::ADD && constantValue(*node.left, value)) {
+        other = node.right.get();
+    }
+    if (other) {
+        co_await compileExpression(*other);
+        int src = result;
+        top = mark;
+        dst = target >= 0 ? target : allocRegister();
+        emit(Op::ADDI, dst, src, 0, value);
+        result = dst;
+        co_return;
+    }
+
+    co_await compileExpression(*node.left);
+    int l = result;
+    co_await compileExpression(*node.right);
+    int r = result;
+    top = mark;
+    dst = target >= 0 ? target : allocRegister();
+    emit(valueOp(node.op), dst, l, r);
+    result = dst;
+}
+
+Walk BytecodeCompiler::visit(UnaryExpression& node) {
+    if (node.op == UnaryExpression::MINUS) {
+        // 连续的取负一次走完，两两抵消；逐层调用 constantValue 在长链上是平方的
+        Expression* inner = &node;
+        bool negate = false;
+        while (auto un = dynamic_cast<UnaryExpression*>(inner)) {
+            if (un->op != UnaryExpression::MINUS) break;
+            negate = !negate;
+            inner = un->operand.get();
+        }
+        if (auto num = dynamic_cast<NumberLiteral*>(inner)) {
+            NumberLiteral folded(negate ? static_cast<int>(0u - static_cast<unsigned>(num->value)) : num->value);
+            co_await visit(folded);
+            co_return;
+        }
+        if (!negate) {
+            co_await compileExpression(*inner, target);
+            co_return;
+        }
+        int mark = top;
+        co_await compileExpression(*inner);
+        int src = result;
+        top = mark;
+        int dst = target >= 0 ? target : allocRegister();
+        emit(Op::NEG, dst, src);
+        result = dst;
+        co_return;
+    }
+    if (node.op == UnaryExpression::PLUS) {
+        co_await compileExpression(*node.operand, target);
+        co_return;
+    }
+
+    int mark = top;
+    co_await compileExpression(*node.operand);
+    int src = result;
+    top = mark;
+    int dst = target >= 0 ? target : allocRegister();
+    emit(node.op == UnaryExpression::MINUS ? Op::NEG : Op::NOT, dst, src);
+    result = dst;
+}
+
+Walk BytecodeCompiler::visit(FunctionCall& node) {
+    int mark = top;
+
+    // 实参依次放在帧顶的连续寄存器中，成为被调用者的 r0..
+    int base = top;
+    for (auto& arg : node.arguments) {
+        int reg = allocRegister();
+        co_await compileExpression(*arg, reg);
+        top = reg + 1;
+    }
+
+    top = mark;
+    int dst = target >= 0 ? target : allocRegister();
+    auto it = functionIndex.find(node.functionName);
+    if (it == functionIndex.end()) {
+        if (error.empty()) error = "call to undefined function '" + node.functionName + "'";
+        result = dst;
+        co_return;
+    }
+    emit(Op::CALL, dst, base, node.arguments.size(), it->second);
+    result = dst;
+}
+
+Walk BytecodeCompiler::visit(AssignmentStatement& node) {
+    int mark = top;
+    co_await compileExpression(*node.value, lookup(node.variable));
+    top = mark;
+}
+
+Walk BytecodeCompiler::visit(VariableDeclaration& node) {
+    int reg = allocRegister();
+    if (node.initializer) {
+        co_await compileExpression(*node.initializer, reg);
+    } else {
+        emit(Op::LOADI, reg, 0, 0, 0);
+    }
+    top = reg + 1;
+    scopes.back()[node.name] = reg;
+}
+
+Walk BytecodeCompiler::visit(IfStatement& node) {
+    std::vector<size_t> elseJumps;
+    co_await branchOn(*node.condition, false, elseJumps);
+
+    co_await node.thenStatement->accept(*this);
+
+    if (node.elseStatement) {
+        size_t endJump = emit(Op::JMP);
+        patch(elseJumps, here());
+        co_await node.elseStatement->accept(*this);
+        patch({endJump}, here());
+    } else {
+        patch(elseJumps, here());
+    }
+}
+
+Walk BytecodeCompiler::visit(WhileStatement& node) {
+    // 条件放在循环体之后，每次迭代只执行一次条件跳转
+    size_t entryJump = emit(Op::JMP);
+    size_t bodyStart = here();
+
+    breakPatches.emplace_back();
+    continuePatches.emplace_back();
+    co_await node.body->accept(*this);
+
+    size_t condStart = here();
+    patch({entryJump}, condStart);
+    patch(continuePatches.back(), condStart);
+
+    std::vector<size_t> loopJumps;
+    co_await branchOn(*node.condition, true, loopJumps);
+    patch(loopJumps, bodyStart);
+    patch(breakPatches.back(), here());
+
+    breakPatches.pop_back();
+    continuePatches.pop_back();
+}
+
+Walk BytecodeCompiler::visit(BreakStatement&) {
+    if (!breakPatches.empty()) {
+        breakPatches.back().push_back(emit(Op::JMP));
+    }
+    co_return;
+}
+
+Walk BytecodeCompiler::visit(ContinueStatement&) {
+    if (!continuePatches.empty()) {
+        continuePatches.back().push_back(emit(Op::JMP));
+    }
+    co_return;
+}
+
+Walk BytecodeCompiler::visit(ReturnStatement& node) {
+    if (node.value) {
+        int mark = top;
+        co_await compileExpression(*node.value);
+        int reg = result;
+        top = mark;
+        emit(Op::RET, reg);
+    } else {
+        emit(Op::RET0);
+    }
+}
+
+Walk BytecodeCompiler::visit(ExpressionStatement& node) {
+    int mark = top;
+    co_await compileExpression(*node.expression);
+    top = mark;
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include "ast/ast.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <ostream>
+
+// 寄存器式字节码操作码
+// 三地址形式 a = b op c；k 为32位立即数或跳转目标（程序内的绝对下标）
+enum class Op : uint16_t {
+    MOV,        // a = b
+    LOADI,      // a = k
+    ADD, SUB, MUL, DIV, MOD,
+    ADDI,       // a = b + k
+    LT, LE, GT, GE, EQ, NE,
+    NEG,        // a = -b
+    NOT,        // a = !b
+    JMP,        // goto k
+    JZ, JNZ,    // if (a ==/!= 0) goto k
+    JLT, JLE, JGT, JGE, JEQ, JNE,   // if (a op b) goto k
+    CALL,       // a = functions[k](b, ..., b + c - 1)
+    RET,        // return a
+    RET0,       // return 0（void函数或缺少return）
+    COUNT
+};
+
+struct Instr {
+    Op op;
+    uint16_t a;
+    uint16_t b;
+    uint16_t c;
+    int32_t k;
+};
+
+struct BytecodeFunction {
+    std::string name;
+    uint32_t entry;         // 第一条指令在 code 中的下标
+    uint16_t numParams;     // 参数位于 r0 .. r(numParams-1)
+    uint16_t numRegs;       // 帧内寄存器总数
+};
+
+struct BytecodeProgram {
+    std::vector<Instr> code;
+    std::vector<BytecodeFunction> functions;
+
+    int findFunction(const std::string& name) const;
+    void dump(std::ostream& out) const;
+};
+
+// 把语义检查后的AST降低为寄存器字节码
+// 寄存器按栈式分配：参数、常量寄存器、局部变量，表达式临时值在最上面；
+// 调用实参放在调用者帧顶，被调用者的帧从实参处开始，传参不需要复制
+class BytecodeCompiler : public Visitor {
+private:
+    static constexpr int MAX_REGS = 65535;
+    static constexpr size_t MAX_CONST_REGS = 32;
+
+    BytecodeProgram* program;
+    std::unordered_map<std::string, int> functionIndex;
+    std::string error;
+
+    // 当前函数的编译状态
+    std::vector<std::unordered_map<std::string, int>> scopes;
+    std::unordered_map<int, int> constRegs;     // 常量值 -> 预装载的寄存器
+    int top;
+    int maxRegs;
+    int target;     // 表达式结果的目标寄存器，-1 表示任意
+    int result;     // 表达式结果所在的寄存器
+    std::vector<std::vector<size_t>> breakPatches;
+    std::vector<std::vector<size_t>> continuePatches;
+
+public:
+    BytecodeCompiler() : program(nullptr), top(0), maxRegs(0), target(-1), result(0) {}
+
+    bool compile(CompilationUnit& unit, BytecodeProgram& out);
+    const std::string& getError() const { return error; }
+
+    // Visitor接口实现
+    Walk visit(BinaryExpression& node) override;
+    Walk visit(UnaryExpression& node) override;
+    Walk visit(NumberLiteral& node) override;
+    Walk visit(Identifier& node) override;
+    Walk visit(FunctionCall& node) override;
+    Walk visit(AssignmentStatement& node) override;
+    Walk visit(VariableDeclaration& node) override;
+    Walk visit(Block& node) override;
+    Walk visit(IfStatement& node) override;
+    Walk visit(WhileStatement& node) override;
+    Walk visit(BreakStatement& node) override;
+    Walk visit(ContinueStatement& node) override;
+    Walk visit(ReturnStatement& node) override;
+    Walk visit(ExpressionStatement& node) override;
+    Walk visit(FunctionDefinition& node) override;
+    Walk visit(CompilationUnit& node) override;
+
+private:
+    size_t emit(Op op, int a = 0, int b = 0, int c = 0, int32_t k = 0);
+    size_t here() const { return program->code.size(); }
+    void patch(const std::vector<size_t>& jumps, size_t target);
+
+    int allocRegister();
+    int lookup(const std::string& name) const;
+    // 编译表达式，co_await 之后结果寄存器在 result 中
+    Walk compileExpression(Expression& expr, int dst = -1);
+    // 当表达式真值等于 when 时跳转（跳转位置记入 patches），否则顺序执行
+    Walk branchOn(Expression& expr, bool when, std::vector<size_t>& patches);
+    // 循环内作为比较/乘除操作数的常量，在函数入口预装载到寄存器
+    void collectLoopConstants(const Statement& body, std::vector<int>& values);
+};
@@ -0,0 +1,161 @@
+#include "vm/vm.hpp"
+
+namespace {
+
+// 32位补码回绕运算，与RV32目标和编译期求值的结果一致
+inline int32_t wrapAdd(int32_t a, int32_t b) { return static_cast<int32_t>(static_cast<uint32_t>(a) + static_cast<uint32_t>(b)); }
+inline int32_t wrapSub(int32_t a, int32_t b) { return static_cast<int32_t>(static_cast<uint32_t>(a) - static_cast<uint32_t>(b)); }
+inline int32_t wrapMul(int32_t a, int32_t b) { return static_cast<int32_t>(static_cast<uint32_t>(a) * static_cast<uint32_t>(b)); }
+
+} // namespace
+
+VirtualMachine::VirtualMachine(size_t registerStackSize, size_t maxCallDepth)
+    : stackSize(registerStackSize), maxDepth(maxCallDepth), callsExecuted(0), peakDepth(0) {}
+
+bool VirtualMachine::run(const BytecodeProgram& program, const std::string& entry, int& result) {
+    error.clear();
+    callsExecuted = 0;
+    peakDepth = 0;
+
+    int index = program.findFunction(entry);
+    if (index < 0) {
+        error = "entry function '" + entry + "' not found";
+        return false;
+    }
+    const BytecodeFunction& entryFunc = program.functions[index];
+    if (entryFunc.numParams != 0) {
+        error = "entry function '" + entry + "' must not take parameters";
+        return false;
+    }
+
+    // 寄存器栈与帧栈按需分配，未触及的页不占物理内存
+    if (!registers) registers.reset(new int32_t[stackSize]);
+    if (!frames) frames.reset(new Frame[maxDepth]);
+
+    const Instr* const code = program.code.data();
+    const BytecodeFunction* const funcs = program.functions.data();
+    int32_t* const stackEnd = registers.get() + stackSize;
+    Frame* const frameBottom = frames.get();
+    Frame* const frameEnd = frameBottom + maxDepth;
+
+    int32_t* base = registers.get();
+    Frame* fp = frameBottom;
+    Frame* peak = frameBottom;
+    const Instr* ip = code + entryFunc.entry;
+    uint64_t calls = 0;
+    int32_t value;
+
+    if (base + entryFunc.numRegs > stackEnd) goto stackOverflow;
+
+#if defined(__GNUC__)
+    // 分派表顺序必须与 Op 的声明顺序一致
+    static const void* const dispatch[] = {
+        &&op_MOV, &&op_LOADI, &&op_ADD, &&op_SUB, &&op_MUL, &&op_DIV, &&op_MOD, &&op_ADDI,
+        &&op_LT, &&op_LE, &&op_GT, &&op_GE, &&op_EQ, &&op_NE, &&op_NEG, &&op_NOT,
+        &&op_JMP, &&op_JZ, &&op_JNZ, &&op_JLT, &&op_JLE, &&op_JGT, &&op_JGE, &&op_JEQ, &&op_JNE,
+        &&op_CALL, &&op_RET, &&op_RET0
+    };
+    static_assert(sizeof(dispatch) / sizeof(dispatch[0]) == static_cast<size_t>(Op::COUNT),
+                  "dispatch table out of sync with Op");
+#define CASE(name) op_##name:
+#define NEXT() goto *dispatch[static_cast<int>(ip->op)]
+    NEXT();
+#else
+#define CASE(name) case Op::name:
+#define NEXT() continue
+    for (;;) {
+    switch (ip->op) {
+#endif
+
+    CASE(MOV)   base[ip->a] = base[ip->b]; ++ip; NEXT();
+    CASE(LOADI) base[ip->a] = ip->k; ++ip; NEXT();
+    CASE(ADD)   base[ip->a] = wrapAdd(base[ip->b], base[ip->c]); ++ip; NEXT();
+    CASE(SUB)   base[ip->a] = wrapSub(base[ip->b], base[ip->c]); ++ip; NEXT();
+    CASE(MUL)   base[ip->a] = wrapMul(base[ip->b], base[ip->c]); ++ip; NEXT();
+    CASE(DIV) {
+        int32_t d = base[ip->c];
+        if (d == 0) goto divisionByZero;
+        base[ip->a] = d == -1 ? wrapSub(0, base[ip->b]) : base[ip->b] / d;
+        ++ip;
+        NEXT();
+    }
+    CASE(MOD) {
+        int32_t d = base[ip->c];
+        if (d == 0) goto divisionByZero;
+        base[ip->a] = d == -1 ? 0 : base[ip->b] % d;
+        ++ip;
+        NEXT();
+    }
+    CASE(ADDI)  base[ip->a] = wrapAdd(base[ip->b], ip->k); ++ip; NEXT();
+    CASE(LT)    base[ip->a] = base[ip->b] < base[ip->c]; ++ip; NEXT();
+    CASE(LE)    base[ip->a] = base[ip->b] <= base[ip->c]; ++ip; NEXT();
+    CASE(GT)    base[ip->a] = base[ip->b] > base[ip->c]; ++ip; NEXT();
+    CASE(GE)    base[ip->a] = base[ip->b] >= base[ip->c]; ++ip; NEXT();
+    CASE(EQ)    base[ip->a] = base[ip->b] == base[ip->c]; ++ip; NEXT();
+    CASE(NE)    base[ip->a] = base[ip->b] != base[ip->c]; ++ip; NEXT();
+    CASE(NEG)   base[ip->a] = wrapSub(0, base[ip->b]); ++ip; NEXT();
+    CASE(NOT)   base[ip->a] = !base[ip->b]; ++ip; NEXT();
+
+    CASE(JMP)   ip = code + ip->k; NEXT();
+    CASE(JZ)    ip = base[ip->a] == 0 ? code + ip->k : ip + 1; NEXT();
+    CASE(JNZ)   ip = base[ip->a] != 0 ? code + ip->k : ip + 1; NEXT();
+    CASE(JLT)   ip = base[ip->a] < base[ip->b] ? code + ip->k : ip + 1; NEXT();
+    CASE(JLE)   ip = base[ip->a] <= base[ip->b] ? code + ip->k : ip + 1; NEXT();
+    CASE(JGT)   ip = base[ip->a] > base[ip->b] ? code + ip->k : ip + 1; NEXT();
+    CASE(JGE)   ip = base[ip->a] >= base[ip->b] ? code + ip->k : ip + 1; NEXT();
+    CASE(JEQ)   ip = base[ip->a] == base[ip->b] ? code + ip->k : ip + 1; NEXT();
+    CASE(JNE)   ip = base[ip->a] != base[ip->b] ? code + ip->k : ip + 1; NEXT();
+
+    CASE(CALL) {
+        const BytecodeFunction& callee = funcs[ip->k];
+        int32_t* calleeBase = base + ip->b;
+        if (calleeBase + callee.numRegs > stackEnd || fp == frameEnd) goto stackOverflow;
+        fp->returnAddress = ip + 1;
+        fp->base = base;
+        fp->resultRegister = ip->a;
+        if (++fp > peak) peak = fp;
+        base = calleeBase;
+        ip = code + callee.entry;
+        calls++;
+        NEXT();
+    }
+    CASE(RET0)
+        value = 0;
+        goto doReturn;
+    CASE(RET)
+        value = base[ip->a];
+    doReturn:
+        if (fp == frameBottom) goto finished;
+        --fp;
+        base = fp->base;
+        base[fp->resultRegister] = value;
+        ip = fp->returnAddress;
+        NEXT();
+
+#if !defined(__GNUC__)
+    default:
+        break;
+    }
+    }
+#endif
+#undef CASE
+#undef NEXT
+
+finished:
+    result = value;
+    callsExecuted = calls;
+    peakDepth = peak - frameBottom;
+    return true;
+
+divisionByZero:
+    error = "division by zero";
+    callsExecuted = calls;
+    peakDepth = peak - frameBottom;
+    return false;
+
+stackOverflow:
+    error = "stack overflow (call depth " + std::to_string(fp - frameBottom) + ")";
+    callsExecuted = calls;
+    peakDepth = peak - frameBottom;
+    return false;
+}
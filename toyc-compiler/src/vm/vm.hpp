@@ -0,0 +1,34 @@
+#pragma once
+#include "vm/bytecode.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// 字节码虚拟机：线程化分派（GCC/Clang 的 computed goto，其他编译器退化为 switch）
+// 所有帧共享一条寄存器栈，调用时被调用者的帧从调用者放置实参的位置开始
+class VirtualMachine {
+private:
+    struct Frame {
+        const Instr* returnAddress;
+        int32_t* base;
+        uint16_t resultRegister;
+    };
+
+    size_t stackSize;
+    size_t maxDepth;
+    std::unique_ptr<int32_t[]> registers;
+    std::unique_ptr<Frame[]> frames;
+    std::string error;
+    uint64_t callsExecuted;
+    size_t peakDepth;
+
+public:
+    explicit VirtualMachine(size_t registerStackSize = 1u << 22, size_t maxCallDepth = 1u << 20);
+
+    // 执行无参数的入口函数；运行时错误（除零、栈溢出）时返回false
+    bool run(const BytecodeProgram& program, const std::string& entry, int& result);
+
+    const std::string& getError() const { return error; }
+    uint64_t getCallsExecuted() const { return callsExecuted; }
+    size_t getPeakDepth() const { return peakDepth; }
+};